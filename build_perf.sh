@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Build the perf configuration with profile guided optimization and report
+# how much faster it runs the benchmarks than the release configuration:
+#
+#   1. build release and record its benchmark results
+#   2. build perf instrumented and run the training workloads, which write
+#      the profiles to _build/pgo
+#   3. build perf again using the profiles, benchmark it and compare
+#
+# The report is written to _build/perf/speedup.txt, the results next to it.
+# Run ./build.sh once first so the dependencies are in place.  Without PGO,
+# ./build.sh regenerates the perf configuration with LTO only.
+
+set -e
+
+SCRIPT_DIR="$( cd "$(dirname "$0")" >/dev/null 2>&1 ; pwd -P )"
+PGO_DIR=${SCRIPT_DIR}/_build/pgo
+REPORT_DIR=${SCRIPT_DIR}/_build/perf
+
+pushd $SCRIPT_DIR > /dev/null
+
+if [ ! -d _build/linux-x86_64/release ]; then
+    echo "The release build is missing, run ./build.sh first"
+    exit 1
+fi
+
+generate_projects () {
+    SAMPLES_PGO=$1 ./prebuild.sh
+    MAKE_DIR=$(dirname $(ls _compiler/*/Makefile | head -n 1))
+}
+
+build () {
+    make -C ${MAKE_DIR} config=$1_x86_64 clean
+    make -C ${MAKE_DIR} config=$1_x86_64 -j$(nproc)
+}
+
+# The workloads the profiles are gathered from: the whole benchmark suite and
+# the mesh normal benchmark, which need no server
+train () {
+    BENCH_CONFIG=perf ./run_bench.sh -o ${REPORT_DIR}/training.json -r 1
+    LD_LIBRARY_PATH="${LD_LIBRARY_PATH}:${SCRIPT_DIR}/_build/linux-x86_64/release" \
+        ./_build/linux-x86_64/perf/omniMeshTool -b 1000000 -g
+}
+
+mkdir -p ${REPORT_DIR}
+
+echo "=== release"
+generate_projects
+build release
+./run_bench.sh -o ${REPORT_DIR}/release.json
+
+echo "=== perf, instrumented"
+rm -rf ${PGO_DIR}
+generate_projects generate
+build perf
+train
+
+echo "=== perf, optimized with the profiles"
+generate_projects use
+build perf
+
+# A benchmark that got slower than release shows as a regression in the
+# report, it doesn't stop the script
+BENCH_CONFIG=perf ./run_bench.sh -o ${REPORT_DIR}/perf.json -b ${REPORT_DIR}/release.json -t 5 \
+    | tee ${REPORT_DIR}/speedup.txt || true
+
+popd > /dev/null
@@ -53,7 +53,7 @@ local currentAbsPath = get_abs_path(".");
 -- premake5.lua
 workspace "Samples"
 
-    configurations { "debug", "release" }
+    configurations { "debug", "release", "perf" }
     platforms { "x86_64" }
     architecture "x86_64"
 
@@ -69,29 +69,32 @@ workspace "Samples"
     --local externalsDir = targetDepsDir..""
     local targetDir = "_build/"..platform.."/%{cfg.buildcfg}"
 
+    -- perf is an optimized release build, it uses the release dependencies
+    local depsConfig = "%{cfg.buildcfg == 'debug' and 'debug' or 'release'}"
+
     -- adding dependencies
     filter { "system:linux" }
-        linkoptions { '-Wl,--disable-new-dtags -Wl,-rpath,../../../_build/target-deps/nv_usd/%{cfg.buildcfg}/lib:../../../_build/target-deps/omni_client_library/%{cfg.buildcfg}:../../../_build/target-deps/python/lib:' }
+        linkoptions { '-Wl,--disable-new-dtags -Wl,-rpath,../../../_build/target-deps/nv_usd/'..depsConfig..'/lib:../../../_build/target-deps/omni_client_library/'..depsConfig..':../../../_build/target-deps/python/lib:' }
         includedirs { 
-            targetDepsDir.."/nv_usd/%{cfg.buildcfg}/include", 
-            targetDepsDir.."/usd_ext_physics/%{cfg.buildcfg}/include", 
+            targetDepsDir.."/nv_usd/"..depsConfig.."/include", 
+            targetDepsDir.."/usd_ext_physics/"..depsConfig.."/include", 
             targetDepsDir.."/omni_client_library/include", 
             targetDepsDir.."/python/include/python3.7m" }
         libdirs { 
-            targetDepsDir.."/nv_usd/%{cfg.buildcfg}/lib", 
-            targetDepsDir.."/usd_ext_physics/%{cfg.buildcfg}/lib", 
-            targetDepsDir.."/omni_client_library/%{cfg.buildcfg}", 
+            targetDepsDir.."/nv_usd/"..depsConfig.."/lib", 
+            targetDepsDir.."/usd_ext_physics/"..depsConfig.."/lib", 
+            targetDepsDir.."/omni_client_library/"..depsConfig, 
             targetDepsDir.."/python/lib" }
     filter { "system:windows" }
         includedirs { 
-            targetDepsDir.."/nv_usd/%{cfg.buildcfg}/include", 
-            targetDepsDir.."/usd_ext_physics/%{cfg.buildcfg}/include", 
+            targetDepsDir.."/nv_usd/"..depsConfig.."/include", 
+            targetDepsDir.."/usd_ext_physics/"..depsConfig.."/include", 
             targetDepsDir.."/omni_client_library/include", 
             targetDepsDir.."/python/include" }
         libdirs { 
-            targetDepsDir.."/nv_usd/%{cfg.buildcfg}/lib", 
-            targetDepsDir.."/usd_ext_physics/%{cfg.buildcfg}/lib", 
-            targetDepsDir.."/omni_client_library/%{cfg.buildcfg}", 
+            targetDepsDir.."/nv_usd/"..depsConfig.."/lib", 
+            targetDepsDir.."/usd_ext_physics/"..depsConfig.."/lib", 
+            targetDepsDir.."/omni_client_library/"..depsConfig, 
             targetDepsDir.."/python/lib" }
     filter {}
 
@@ -110,6 +113,31 @@ workspace "Samples"
         defines { "NDEBUG", "NOMINMAX" }
         optimize "On"
         runtime "Release"
+    -- For measuring: full optimization with intrinsics and inlining across
+    -- translation units, see build_perf.sh for the profile guided build
+    filter { "configurations:perf" }
+        defines { "NDEBUG", "NOMINMAX", "SAMPLES_PERF_BUILD" }
+        optimize "Full"
+        intrinsics "On"
+        inlining "Auto"
+        flags { "LinkTimeOptimization" }
+        runtime "Release"
+    filter {}
+
+    -- Profile guided optimization of the perf configuration on Linux.
+    -- build_perf.sh generates the projects with SAMPLES_PGO=generate for the
+    -- instrumented build, runs the training workloads, then generates them
+    -- again with SAMPLES_PGO=use for the optimized build.
+    local pgoPhase = os.getenv("SAMPLES_PGO")
+    local pgoDir = currentAbsPath.."/_build/pgo"
+    filter { "configurations:perf", "system:linux" }
+        if pgoPhase == "generate" then
+            buildoptions { "-fprofile-generate="..pgoDir, "-fprofile-update=atomic" }
+            linkoptions { "-fprofile-generate="..pgoDir }
+        elseif pgoPhase == "use" then
+            -- Objects the training didn't run, such as most of the samples, have no profile
+            buildoptions { "-fprofile-use="..pgoDir, "-fprofile-correction", "-Wno-missing-profile" }
+        end
     filter {}
 
     location (workspaceDir)
@@ -153,29 +181,87 @@ workspace "Samples"
     filter {}
 
 
-function sample(projectName, sourceFolder)
-    project(projectName)
-    kind "ConsoleApp"
-    optimize "Size"
-    intrinsics "off"
-    inlining "Explicit"
-    flags { "NoManifest", "NoIncrementalLink", "NoPCH" }
+function sample_links()
     filter { "system:windows", "configurations:debug" }
         links { "ar","arch","gf","js","kind","pcp","plug","sdf","tf","trace","usd","usdGeom", "vt","work","usdShade","usdLux","usdPhysics","omniclient","python37","boost_python37-vc141-mt-gd-x64-1_68" }
-    filter { "system:windows", "configurations:release" }
+    filter { "system:windows", "configurations:release or perf" }
         links { "ar","arch","gf","js","kind","pcp","plug","sdf","tf","trace","usd","usdGeom", "vt","work","usdShade","usdLux","usdPhysics","omniclient","python37","boost_python37-vc141-mt-x64-1_68" }
     filter { "system:linux" }
         links { "ar","arch","gf","js","kind","pcp","plug","sdf","tf","trace","usd","usdGeom", "vt","work","usdShade","usdLux","usdPhysics","omniclient","python3.7m","boost_python37", "pthread", "stdc++fs" }
     filter {}
+end
+
+function sample(projectName, sourceFolder)
+    project(projectName)
+    kind "ConsoleApp"
+    filter { "configurations:not perf" }
+        optimize "Size"
+        intrinsics "off"
+        inlining "Explicit"
+    filter {}
+    flags { "NoManifest", "NoIncrementalLink", "NoPCH" }
+    sample_links()
     location (workspaceDir.."/%{prj.name}")
+    includedirs { "source/common" }
     files { "source/"..sourceFolder.."/**.*" }
     filter { "system:windows" }
         links { "shlwapi" }
     filter {}
 end
 
+-- A Python extension module built with boost_python, it lands next to the
+-- sample executables and run_py_sample.sh puts that directory on PYTHONPATH
+function python_module(moduleName, sourceFolder)
+    project(moduleName)
+    kind "SharedLib"
+    targetprefix ""
+    flags { "NoManifest", "NoIncrementalLink", "NoPCH" }
+    sample_links()
+    filter { "system:windows" }
+        targetextension ".pyd"
+        links { "shlwapi" }
+    filter { "system:linux" }
+        targetextension ".so"
+        pic "On"
+    filter {}
+    location (workspaceDir.."/%{prj.name}")
+    includedirs { "source/common" }
+    files { "source/"..sourceFolder.."/**.*" }
+end
+
+-- The local Nucleus stand-in, a library that run_with_standin.sh preloads into
+-- a sample so its omniverse:// URLs are served from a local folder.  Linux only,
+-- it relies on LD_PRELOAD to take the place of the client library functions.
+function preload_library(libraryName, sourceFolder)
+    project(libraryName)
+    kind "SharedLib"
+    pic "On"
+    flags { "NoManifest", "NoIncrementalLink", "NoPCH" }
+    sample_links()
+    links { "dl" }
+    location (workspaceDir.."/%{prj.name}")
+    files { "source/"..sourceFolder.."/**.*" }
+    -- The plugInfo.json that registers its USD resolver
+    postbuildcommands {
+        "{MKDIR} %{cfg.targetdir}/"..libraryName,
+        "{COPY} "..get_abs_path("source/"..sourceFolder.."/plugInfo.json").." %{cfg.targetdir}/"..libraryName.."/"
+    }
+end
+
 sample("HelloWorld", "helloWorld")
 sample("omnicli", "omnicli")
 sample("omniUsdaWatcher", "omniUsdaWatcher")
 sample("omniSimpleSensor", "omniSimpleSensor")
 sample("omniSensorThread", "omniSensorThread")
+sample("OmniUSDReader", "omniUsdReader")
+sample("omniMeshTool", "omniMeshTool")
+sample("omniMeshImport", "omniMeshImport")
+sample("bench", "bench")
+    -- The traversal benchmarks time omniUsdReader's parallel traversal
+    includedirs { "source/omniUsdReader" }
+    files { "source/omniUsdReader/StageTraversal.*" }
+python_module("xform_batch", "xformBatch")
+python_module("sensor_ingest", "sensorIngest")
+if os.target() == "linux" then
+    preload_library("omniStandIn", "omniStandIn")
+end
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Run the benchmark suite against the local Nucleus stand-in, with a fixed
+# link and an empty server so runs on one machine are comparable:
+#
+#   ./run_bench.sh -o baseline.json     record a baseline
+#   ./run_bench.sh -b baseline.json     compare with it, exits with 1 on a regression
+#
+# The results go to _build/bench/results.json unless -o is given, see
+# source/bench/README.md for the other options.  BENCH_CONFIG=perf runs the
+# perf build instead of release.
+
+set -e
+
+SCRIPT_DIR="$( cd "$(dirname "$0")" >/dev/null 2>&1 ; pwd -P )"
+BENCH_CONFIG=${BENCH_CONFIG:-release}
+
+export OMNI_STANDIN_ROOT=${SCRIPT_DIR}/_build/bench/standin
+export OMNI_STANDIN_LATENCY_MS=${OMNI_STANDIN_LATENCY_MS:-1}
+export OMNI_STANDIN_JITTER_MS=${OMNI_STANDIN_JITTER_MS:-0}
+export OMNI_STANDIN_BANDWIDTH_MBPS=${OMNI_STANDIN_BANDWIDTH_MBPS:-1000}
+export OMNI_STANDIN_SEED=${OMNI_STANDIN_SEED:-1}
+rm -rf ${OMNI_STANDIN_ROOT}
+mkdir -p ${OMNI_STANDIN_ROOT}
+
+pushd $SCRIPT_DIR > /dev/null
+./run_with_standin.sh ./_build/linux-x86_64/${BENCH_CONFIG}/bench -o _build/bench/results.json "$@"
+popd > /dev/null
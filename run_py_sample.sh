@@ -13,7 +13,7 @@ export OMNI_CLIENT_DIR=${SCRIPT_DIR}/_build/target-deps/omni_client_library/rele
 export PYTHON=${SCRIPT_DIR}/_build/target-deps/python/python
 
 export LD_LIBRARY_PATH=${LD_LIBRARY_PATH}:${USD_LIB_DIR}:${OMNI_CLIENT_DIR}
-export PYTHONPATH=${USD_LIB_DIR}/python:${OMNI_CLIENT_DIR}/bindings-python
+export PYTHONPATH=${USD_LIB_DIR}/python:${USD_LIB_DIR}:${OMNI_CLIENT_DIR}/bindings-python
 
 if [ ! -f ${PYTHON} ]; then
     echo "echo Python, USD, and Omniverse Client libraries are missing.  Run ./prebuild.sh to retrieve them."
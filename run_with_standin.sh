@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Run any sample, or one of the run_*.sh scripts, against the local Nucleus
+# stand-in instead of a server:
+#
+#   ./run_with_standin.sh ./run_sample.sh
+#   OMNI_STANDIN_LATENCY_MS=40 OMNI_STANDIN_BANDWIDTH_MBPS=100 ./run_with_standin.sh ./run_omniUsdReader.sh -p omniverse://localhost/Users/test/references/references.usd
+#
+# Every omniverse:// URL is served from OMNI_STANDIN_ROOT (_build/standin by
+# default), see source/omniStandIn/README.md for the other settings.
+
+set -e
+
+SCRIPT_DIR="$( cd "$(dirname "$0")" >/dev/null 2>&1 ; pwd -P )"
+USD_LIB_DIR=${SCRIPT_DIR}/_build/linux-x86_64/release
+
+if [ ! -f ${USD_LIB_DIR}/libomniStandIn.so ]; then
+    echo "libomniStandIn.so is missing, run ./build.sh first"
+    exit 1
+fi
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 command [args...]"
+    exit 1
+fi
+
+export OMNI_STANDIN_ROOT=${OMNI_STANDIN_ROOT:-${SCRIPT_DIR}/_build/standin}
+export LD_LIBRARY_PATH="${LD_LIBRARY_PATH}:${USD_LIB_DIR}"
+export LD_PRELOAD="${USD_LIB_DIR}/libomniStandIn.so${LD_PRELOAD:+:${LD_PRELOAD}}"
+export PXR_PLUGINPATH_NAME="${USD_LIB_DIR}/omniStandIn${PXR_PLUGINPATH_NAME:+:${PXR_PLUGINPATH_NAME}}"
+
+"$@"
@@ -0,0 +1,86 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Counting the heap allocations of the benchmarks.  On Linux with glibc bench
+// defines malloc, calloc and realloc itself, counts the calls of each thread
+// and forwards them to glibc's allocator, which the USD and client libraries
+// then use too.  VtArray buffers and everything allocated with new go through
+// malloc.  Aligned allocations (memalign, aligned new) aren't counted.
+
+#include "Benchmark.h"
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__) && defined(__GLIBC__)
+
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+}
+
+// Static TLS of the executable, so counting doesn't allocate itself
+static thread_local uint64_t tAllocationCount = 0;
+
+extern "C" void* malloc(size_t size)
+{
+	tAllocationCount++;
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+	tAllocationCount++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+	tAllocationCount++;
+	return __libc_realloc(ptr, size);
+}
+
+bool benchmarkCountsAllocations()
+{
+	return true;
+}
+
+uint64_t benchmarkAllocationCount()
+{
+	return tAllocationCount;
+}
+
+#else
+
+bool benchmarkCountsAllocations()
+{
+	return false;
+}
+
+uint64_t benchmarkAllocationCount()
+{
+	return 0;
+}
+
+#endif
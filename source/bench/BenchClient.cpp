@@ -0,0 +1,198 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Benchmarks of moving files to and from a server: copies in each direction
+// and on the server, and uploading a folder with uploadChangedAssets() as
+// omniUpload does.  They run against the local stand-in (see
+// source/omniStandIn), so the link is the same on every machine, and are
+// skipped without it rather than timing whatever server happens to be there.
+
+#include "Benchmark.h"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "OmniClient.h"
+#include "AssetUpload.h"
+
+static const char* const kRemoteDir = "omniverse://localhost/bench";
+
+static bool haveStandIn(BenchmarkRun& run)
+{
+	if (!getenv("OMNI_STANDIN_ROOT"))
+	{
+		run.skip("needs the stand-in, run through run_bench.sh");
+		return false;
+	}
+	return true;
+}
+
+static bool writeLocalFile(const std::string& path, size_t size, uint32_t seed)
+{
+	std::vector<char> data(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		data[i] = char(seed >> 24);
+	}
+	std::ofstream out(path, std::ios::binary);
+	out.write(data.data(), data.size());
+	return bool(out);
+}
+
+static OmniClientResult copyUrl(const std::string& src, const std::string& dst)
+{
+	OmniClientResult copyResult = eOmniClientResult_Error;
+	omniClientWait(omniClientCopy(src.c_str(), dst.c_str(), &copyResult,
+		[](void* userData, OmniClientResult result) noexcept
+		{
+			*static_cast<OmniClientResult*>(userData) = result;
+		}, eOmniClientCopy_Overwrite));
+	return copyResult;
+}
+
+static void deleteUrl(const std::string& url)
+{
+	omniClientWait(omniClientDelete(url.c_str(), nullptr, [](void*, OmniClientResult) noexcept {}));
+}
+
+// Time one copy, skipping the benchmark if it fails
+static void measureCopy(BenchmarkRun& run, const std::string& src, const std::string& dst, size_t size)
+{
+	run.measure(double(size), [&]
+	{
+		OmniClientResult result = copyUrl(src, dst);
+		if (result != eOmniClientResult_Ok)
+		{
+			run.skip(std::string("copy failed: ") + omniClientGetResultString(result));
+		}
+	});
+}
+
+void addClientBenchmarks(BenchmarkSuite& suite)
+{
+	const size_t copySize = 1 << 20;
+
+	suite.add("copy/upload", eBenchmark_Macro, "bytes", [copySize](BenchmarkRun& run)
+	{
+		const std::string local = benchmarkTempDir() + "/upload.bin";
+		if (!haveStandIn(run) || !writeLocalFile(local, copySize, 1))
+		{
+			return;
+		}
+		measureCopy(run, local, std::string(kRemoteDir) + "/copy/upload.bin", copySize);
+	});
+
+	suite.add("copy/server", eBenchmark_Macro, "bytes", [copySize](BenchmarkRun& run)
+	{
+		const std::string local = benchmarkTempDir() + "/upload.bin";
+		const std::string remote = std::string(kRemoteDir) + "/copy/source.bin";
+		if (!haveStandIn(run) || !writeLocalFile(local, copySize, 2) || copyUrl(local, remote) != eOmniClientResult_Ok)
+		{
+			return;
+		}
+		measureCopy(run, remote, std::string(kRemoteDir) + "/copy/server.bin", copySize);
+	});
+
+	suite.add("copy/download", eBenchmark_Macro, "bytes", [copySize](BenchmarkRun& run)
+	{
+		const std::string local = benchmarkTempDir() + "/upload.bin";
+		const std::string remote = std::string(kRemoteDir) + "/copy/download.bin";
+		if (!haveStandIn(run) || !writeLocalFile(local, copySize, 3) || copyUrl(local, remote) != eOmniClientResult_Ok)
+		{
+			return;
+		}
+		measureCopy(run, remote, benchmarkTempDir() + "/download.bin", copySize);
+	});
+
+	// A folder of 64 files of 64KB: first everything is sent, then nothing has changed
+	struct SyncFixture
+	{
+		std::string localDir;
+		std::string remoteDir;
+		size_t fileCount = 64;
+		size_t fileSize = 64 << 10;
+	};
+	auto prepareSync = [](BenchmarkRun& run, SyncFixture& fixture)
+	{
+		if (!haveStandIn(run))
+		{
+			return false;
+		}
+		fixture.localDir = benchmarkTempDir() + "/sync";
+		fixture.remoteDir = std::string(kRemoteDir) + "/sync";
+#ifdef _WIN32
+		std::filesystem::create_directories(fixture.localDir);
+#else
+		std::experimental::filesystem::create_directories(fixture.localDir);
+#endif
+		for (size_t i = 0; i < fixture.fileCount; i++)
+		{
+			if (!writeLocalFile(fixture.localDir + "/asset_" + std::to_string(i) + ".bin", fixture.fileSize, uint32_t(i)))
+			{
+				run.skip("can't write to " + fixture.localDir);
+				return false;
+			}
+		}
+		return true;
+	};
+
+	suite.add("sync/full", eBenchmark_Macro, "files", [prepareSync](BenchmarkRun& run)
+	{
+		SyncFixture fixture;
+		if (!prepareSync(run, fixture))
+		{
+			return;
+		}
+		// Without the manifest every file is sent again
+		run.measure(double(fixture.fileCount), [&]
+		{
+			deleteUrl(fixture.remoteDir + "/" + kAssetManifestName);
+		}, [&]
+		{
+			AssetUploadResult result = uploadChangedAssets(fixture.localDir, fixture.remoteDir);
+			if (result.uploadedCount != fixture.fileCount)
+			{
+				run.skip("uploaded " + std::to_string(result.uploadedCount) + " of " + std::to_string(fixture.fileCount) + " files");
+			}
+		});
+	});
+
+	suite.add("sync/unchanged", eBenchmark_Macro, "files", [prepareSync](BenchmarkRun& run)
+	{
+		SyncFixture fixture;
+		if (!prepareSync(run, fixture))
+		{
+			return;
+		}
+		uploadChangedAssets(fixture.localDir, fixture.remoteDir);
+		run.measure(double(fixture.fileCount), [&]
+		{
+			AssetUploadResult result = uploadChangedAssets(fixture.localDir, fixture.remoteDir);
+			if (result.unchangedCount != fixture.fileCount)
+			{
+				run.skip(std::to_string(fixture.fileCount - result.unchangedCount) + " files weren't seen as unchanged");
+			}
+		});
+	});
+}
@@ -0,0 +1,249 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Benchmarks of the USD work the samples do: creating the sensor zone boxes,
+// committing sensor updates, exporting USDA and traversing a large stage.
+
+#include "Benchmark.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/primSpec.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/xform.h"
+#include "SensorZoneGeometry.h"
+#include "SensorZoneWriter.h"
+#include "StageTraversal.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+static void addZones(const UsdStageRefPtr& stage, int zoneCount)
+{
+	UsdGeomXform::Define(stage, SdfPath("/World"));
+	for (int zone = 0; zone < zoneCount; zone++)
+	{
+		createZoneGeometry(stage, zone, zoneCount);
+	}
+}
+
+static UsdStageRefPtr createZoneStage(int zoneCount)
+{
+	UsdStageRefPtr stage = UsdStage::CreateInMemory();
+	addZones(stage, zoneCount);
+	return stage;
+}
+
+// A batch of readings for every zone, the values change with the batch so every batch writes
+static std::vector<SensorRecord> sensorBatch(int zoneCount, uint32_t batch)
+{
+	std::vector<SensorRecord> records(zoneCount);
+	for (int zone = 0; zone < zoneCount; zone++)
+	{
+		records[zone].zone = zone;
+		records[zone].value = float((batch * 7 + uint32_t(zone) * 13) % 100) / 100.0f;
+	}
+	return records;
+}
+
+// A stage of about depth^width Xforms, built through Sdf so building it stays quick
+static UsdStageRefPtr createTraversalStage(int width, int depth)
+{
+	SdfLayerRefPtr layer = SdfLayer::CreateAnonymous(".usda");
+	{
+		SdfChangeBlock changeBlock;
+		SdfPrimSpecHandle world = SdfPrimSpec::New(layer, "World", SdfSpecifierDef, "Xform");
+		std::vector<SdfPrimSpecHandle> level(1, world);
+		for (int d = 0; d < depth; d++)
+		{
+			std::vector<SdfPrimSpecHandle> next;
+			next.reserve(level.size() * width);
+			for (const SdfPrimSpecHandle& parent : level)
+			{
+				for (int w = 0; w < width; w++)
+				{
+					next.push_back(SdfPrimSpec::New(parent, "node_" + std::to_string(w), SdfSpecifierDef, "Xform"));
+				}
+			}
+			level.swap(next);
+		}
+	}
+	return UsdStage::Open(layer);
+}
+
+void addStageBenchmarks(BenchmarkSuite& suite)
+{
+	// The boxes are created on a fresh stage every time, as omniSimpleSensor does at startup
+	for (int zoneCount : { 16, 256, 4096 })
+	{
+		suite.add("createZoneGeometry/" + std::to_string(zoneCount), zoneCount < 4096 ? eBenchmark_Micro : eBenchmark_Macro, "zones",
+			[zoneCount](BenchmarkRun& run)
+		{
+			UsdStageRefPtr stage;
+			run.measure(zoneCount, [&]
+			{
+				stage = UsdStage::CreateInMemory();
+				UsdGeomXform::Define(stage, SdfPath("/World"));
+			}, [&]
+			{
+				for (int zone = 0; zone < zoneCount; zone++)
+				{
+					createZoneGeometry(stage, zone, zoneCount);
+				}
+			});
+		});
+	}
+
+	// The readings of one update of every zone applied to the stage's root
+	// layer, as omniSensorThread does.  Two updates are applied first so every
+	// zone's color buffers are allocated: the allocations counted are then the
+	// layer's change list and the stage's handling of the change notice, which
+	// are made for every zone written.
+	suite.add("sensorApply/64", eBenchmark_Micro, "values", [](BenchmarkRun& run)
+	{
+		const int zoneCount = 64;
+		UsdStageRefPtr stage = createZoneStage(zoneCount);
+		SensorZoneWriter writer(stage);
+		std::vector<std::vector<SensorRecord>> batches;
+		for (uint32_t batch = 0; batch < 16; batch++)
+		{
+			batches.push_back(sensorBatch(zoneCount, batch));
+		}
+		size_t next = 0;
+		auto update = [&]
+		{
+			const std::vector<SensorRecord>& records = batches[next++ % batches.size()];
+			benchmarkKeep(writer.apply(records.data(), records.size()));
+		};
+		update();
+		update();
+		run.measure(zoneCount, update);
+	});
+
+	// The same plus saving the layer, which is what commits the update to a live layer
+	suite.add("sensorCommit/64", eBenchmark_Micro, "values", [](BenchmarkRun& run)
+	{
+		const int zoneCount = 64;
+		const std::string path = benchmarkTempDir() + "/sensorCommit.usdc";
+		UsdStageRefPtr stage = UsdStage::CreateNew(path);
+		if (!stage)
+		{
+			run.skip("can't create " + path);
+			return;
+		}
+		addZones(stage, zoneCount);
+		stage->Save();
+
+		SensorZoneWriter writer(stage);
+		uint32_t batch = 0;
+		run.measure(zoneCount, [&]
+		{
+			const std::vector<SensorRecord> records = sensorBatch(zoneCount, batch++);
+			writer.apply(records.data(), records.size());
+			stage->Save();
+		});
+	});
+
+	// omniUsdaWatcher exports the root layer of the sensor stage on every change
+	suite.add("usdaExport/string", eBenchmark_Micro, "zones", [](BenchmarkRun& run)
+	{
+		const int zoneCount = 256;
+		UsdStageRefPtr stage = createZoneStage(zoneCount);
+		std::string text;
+		run.measure(zoneCount, [&]
+		{
+			stage->GetRootLayer()->ExportToString(&text);
+			benchmarkKeep(text);
+		});
+	});
+
+	suite.add("usdaExport/file", eBenchmark_Micro, "zones", [](BenchmarkRun& run)
+	{
+		const int zoneCount = 256;
+		UsdStageRefPtr stage = createZoneStage(zoneCount);
+		const std::string path = benchmarkTempDir() + "/usdaExport.usda";
+		run.measure(zoneCount, [&]
+		{
+			if (!stage->GetRootLayer()->Export(path))
+			{
+				run.skip("can't write " + path);
+			}
+		});
+	});
+
+	// omniUsdReader's traversal: 16^4 + 16^3 + ... = about 70k prims
+	struct TraversalFixture
+	{
+		UsdStageRefPtr stage;
+		size_t primCount = 0;
+	};
+	auto traversalFixture = std::make_shared<TraversalFixture>();
+	auto getTraversalStage = [traversalFixture](BenchmarkRun& run) -> const TraversalFixture&
+	{
+		if (!traversalFixture->stage)
+		{
+			traversalFixture->stage = createTraversalStage(run.quick() ? 8 : 16, 4);
+			for (const UsdPrim& prim : traversalFixture->stage->Traverse())
+			{
+				(void)prim;
+				traversalFixture->primCount++;
+			}
+		}
+		return *traversalFixture;
+	};
+
+	suite.add("traversal/serial", eBenchmark_Macro, "prims", [getTraversalStage](BenchmarkRun& run)
+	{
+		const TraversalFixture& fixture = getTraversalStage(run);
+		run.measure(fixture.primCount, [&]
+		{
+			size_t count = 0;
+			for (const UsdPrim& prim : fixture.stage->Traverse())
+			{
+				(void)prim;
+				count++;
+			}
+			benchmarkKeep(count);
+		});
+	});
+
+	suite.add("traversal/count", eBenchmark_Macro, "prims", [getTraversalStage](BenchmarkRun& run)
+	{
+		const TraversalFixture& fixture = getTraversalStage(run);
+		run.measure(fixture.primCount, [&]
+		{
+			benchmarkKeep(listStagePaths(fixture.stage, false).primCount);
+		});
+	});
+
+	suite.add("traversal/paths", eBenchmark_Macro, "prims", [getTraversalStage](BenchmarkRun& run)
+	{
+		const TraversalFixture& fixture = getTraversalStage(run);
+		run.measure(fixture.primCount, [&]
+		{
+			benchmarkKeep(listStagePaths(fixture.stage, true).byteCount);
+		});
+	});
+}
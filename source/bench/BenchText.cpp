@@ -0,0 +1,93 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Benchmarks of omnicli's text handling: formatting list entries and tokenizing command lines
+
+#include "Benchmark.h"
+#include <string>
+#include <vector>
+#include <CommandLine.h>
+#include <ListFormat.h>
+
+void addTextBenchmarks(BenchmarkSuite& suite)
+{
+	// A folder listing of files, folders and mounts of varied sizes and owners
+	suite.add("listFormat/1000", eBenchmark_Micro, "entries", [](BenchmarkRun& run)
+	{
+		const uint32_t entryCount = 1000;
+		static const char* const owners[] = { "alice", "bob", "omniverse", "a_much_longer_user_name" };
+		std::vector<std::string> names;
+		std::vector<OmniClientListEntry> entries(entryCount);
+		for (uint32_t i = 0; i < entryCount; i++)
+		{
+			names.push_back("entry_" + std::to_string(i) + (i % 5 == 0 ? "" : ".usd"));
+		}
+		for (uint32_t i = 0; i < entryCount; i++)
+		{
+			OmniClientListEntry& entry = entries[i];
+			entry.relativePath = names[i].c_str();
+			entry.access = fOmniClientAccess_Read | (i % 3 ? fOmniClientAccess_Write : 0);
+			entry.flags = i % 5 == 0 ? fOmniClientItem_CanHaveChildren : fOmniClientItem_ReadableFile | (i % 4 ? fOmniClientItem_WriteableFile : 0);
+			if (i % 7 == 0)
+			{
+				entry.flags |= fOmniClientItem_IsInsideMount;
+			}
+			entry.size = uint64_t(i) * uint64_t(i) * 977;
+			entry.modifiedTimeNs = 1600000000ull * 1000000000ull + uint64_t(i) * 1000000000ull;
+			entry.createdBy = owners[i % 4];
+			entry.modifiedBy = owners[(i + 1) % 4];
+		}
+		run.measure(entryCount, [&]
+		{
+			benchmarkKeep(formatListEntries(entryCount, entries.data()));
+		});
+	});
+
+	// The kind of lines omnicli reads from a script, with quotes and escapes
+	suite.add("tokenize/1000", eBenchmark_Micro, "lines", [](BenchmarkRun& run)
+	{
+		const size_t lineCount = 1000;
+		static const char* const templates[] = {
+			"copy omniverse://localhost/Users/test/file_%zu.usd \"C:\\My Files\\file_%zu.usd\"\n",
+			"list omniverse://localhost/Projects/scene_%zu\n",
+			"  checkpoint   \t omniverse://localhost/Users/test/layer_%zu.usd  \"a \\\"quoted\\\" comment %zu\"\n",
+			"restoreCheckpoint omniverse://localhost/Users/test/model_%zu.usd?&%zu\n",
+		};
+		std::vector<std::string> lines;
+		for (size_t i = 0; i < lineCount; i++)
+		{
+			char line[256];
+			snprintf(line, sizeof(line), templates[i % 4], i, i / 4);
+			lines.push_back(line);
+		}
+		run.measure(lineCount, [&]
+		{
+			size_t tokenCount = 0;
+			for (const std::string& line : lines)
+			{
+				tokenCount += tokenize(line.c_str()).size();
+			}
+			benchmarkKeep(tokenCount);
+		});
+	});
+}
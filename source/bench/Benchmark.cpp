@@ -0,0 +1,385 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "pxr/base/js/json.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+using Clock = std::chrono::steady_clock;
+
+volatile char gBenchmarkSink = 0;
+
+static double elapsedNs(Clock::time_point start, Clock::time_point end)
+{
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+static const char* kindName(BenchmarkKind kind)
+{
+	return kind == eBenchmark_Macro ? "macro" : "micro";
+}
+
+void BenchmarkRun::measure(double items, const std::function<void()>& body)
+{
+	measure(items, nullptr, body);
+}
+
+void BenchmarkRun::measure(double items, const std::function<void()>& setup, const std::function<void()>& body)
+{
+	// One untimed call warms the caches and the allocator, and tells a micro
+	// benchmark how many calls make a repetition long enough to time
+	if (setup)
+	{
+		setup();
+	}
+	Clock::time_point start = Clock::now();
+	body();
+	double warmNs = std::max(elapsedNs(start, Clock::now()), 1.0);
+
+	size_t iterations = 1;
+	if (mResult.kind == eBenchmark_Micro)
+	{
+		double minNs = mOptions.minSeconds * 1e9 * (mOptions.quick ? 0.1 : 1.0);
+		iterations = size_t(std::max(1.0, std::ceil(minNs / warmNs)));
+	}
+	int repetitions = mOptions.quick ? 1 : std::max(mOptions.repetitions, 1);
+
+	std::vector<double> times;
+	uint64_t allocations = 0;
+	for (int repetition = 0; repetition < repetitions; ++repetition)
+	{
+		double totalNs = 0;
+		if (setup)
+		{
+			// Time the calls one by one so the setup isn't counted
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				setup();
+				const uint64_t allocationsBefore = benchmarkAllocationCount();
+				start = Clock::now();
+				body();
+				totalNs += elapsedNs(start, Clock::now());
+				allocations += benchmarkAllocationCount() - allocationsBefore;
+			}
+		}
+		else
+		{
+			const uint64_t allocationsBefore = benchmarkAllocationCount();
+			start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				body();
+			}
+			totalNs = elapsedNs(start, Clock::now());
+			allocations += benchmarkAllocationCount() - allocationsBefore;
+		}
+		times.push_back(totalNs / double(iterations));
+	}
+
+	std::sort(times.begin(), times.end());
+	size_t middle = times.size() / 2;
+	mResult.medianNs = times.size() % 2 ? times[middle] : (times[middle - 1] + times[middle]) / 2;
+	mResult.minNs = times.front();
+	mResult.maxNs = times.back();
+	mResult.iterations = iterations;
+	mResult.repetitions = times.size();
+	mResult.itemsPerIteration = items;
+	if (benchmarkCountsAllocations())
+	{
+		mResult.allocationsPerIteration = double(allocations) / double(iterations * times.size());
+	}
+}
+
+void BenchmarkRun::skip(const std::string& reason)
+{
+	mResult.skipped = reason;
+}
+
+void BenchmarkSuite::add(const std::string& name, BenchmarkKind kind, const std::string& unit, std::function<void(BenchmarkRun&)> function)
+{
+	mBenchmarks.push_back({ name, kind, unit, std::move(function) });
+}
+
+std::vector<std::string> BenchmarkSuite::names() const
+{
+	std::vector<std::string> names;
+	for (const Benchmark& benchmark : mBenchmarks)
+	{
+		names.push_back(benchmark.name);
+	}
+	return names;
+}
+
+std::vector<BenchmarkResult> BenchmarkSuite::run(const BenchmarkOptions& options) const
+{
+	std::vector<BenchmarkResult> results;
+	for (const Benchmark& benchmark : mBenchmarks)
+	{
+		if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		BenchmarkResult result;
+		result.name = benchmark.name;
+		result.kind = benchmark.kind;
+		result.unit = benchmark.unit;
+		BenchmarkRun run(result, options);
+		benchmark.function(run);
+
+		if (!result.skipped.empty())
+		{
+			printf("%-32s skipped: %s\n", result.name.c_str(), result.skipped.c_str());
+		}
+		else if (result.repetitions == 0)
+		{
+			result.skipped = "measured nothing";
+			printf("%-32s %s\n", result.name.c_str(), result.skipped.c_str());
+		}
+		else
+		{
+			char allocations[32] = "";
+			if (result.allocationsPerIteration >= 0)
+			{
+				snprintf(allocations, sizeof(allocations), "  %.1f allocs", result.allocationsPerIteration);
+			}
+			printf("%-32s %14.0f ns  %12.4g %s/s  (%zu x %zu, spread %.1f%%)%s\n", result.name.c_str(), result.medianNs,
+				result.itemsPerSecond(), result.unit.c_str(), result.repetitions, result.iterations,
+				result.medianNs > 0 ? 100.0 * (result.maxNs - result.minNs) / result.medianNs : 0.0, allocations);
+		}
+		fflush(stdout);
+		results.push_back(result);
+	}
+	return results;
+}
+
+bool writeBenchmarkJson(const std::string& path, const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options)
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		return false;
+	}
+
+	char date[32];
+	time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+	JsObject machine;
+	machine["threads"] = JsValue(uint64_t(std::thread::hardware_concurrency()));
+#if defined(SAMPLES_PERF_BUILD)
+	machine["build"] = JsValue(std::string("perf"));
+#elif defined(NDEBUG)
+	machine["build"] = JsValue(std::string("release"));
+#else
+	machine["build"] = JsValue(std::string("debug"));
+#endif
+	const char* standInRoot = getenv("OMNI_STANDIN_ROOT");
+	machine["standIn"] = JsValue(standInRoot != nullptr);
+
+	JsArray benchmarks;
+	for (const BenchmarkResult& result : results)
+	{
+		JsObject entry;
+		entry["name"] = JsValue(result.name);
+		entry["kind"] = JsValue(std::string(kindName(result.kind)));
+		entry["unit"] = JsValue(result.unit);
+		if (!result.skipped.empty())
+		{
+			entry["skipped"] = JsValue(result.skipped);
+		}
+		else
+		{
+			entry["itemsPerIteration"] = JsValue(result.itemsPerIteration);
+			entry["iterations"] = JsValue(uint64_t(result.iterations));
+			entry["repetitions"] = JsValue(uint64_t(result.repetitions));
+			entry["medianNs"] = JsValue(result.medianNs);
+			entry["minNs"] = JsValue(result.minNs);
+			entry["maxNs"] = JsValue(result.maxNs);
+			entry["itemsPerSecond"] = JsValue(result.itemsPerSecond());
+			if (result.allocationsPerIteration >= 0)
+			{
+				entry["allocationsPerIteration"] = JsValue(result.allocationsPerIteration);
+			}
+		}
+		benchmarks.push_back(JsValue(entry));
+	}
+
+	JsObject report;
+	report["date"] = JsValue(std::string(date));
+	report["quick"] = JsValue(options.quick);
+	report["machine"] = JsValue(machine);
+	report["benchmarks"] = JsValue(benchmarks);
+
+	JsWriteToStream(JsValue(report), out);
+	out << std::endl;
+	return bool(out);
+}
+
+// Whole numbers are written as integers, so read both
+static double jsonNumber(const JsObject& object, const char* key)
+{
+	JsObject::const_iterator it = object.find(key);
+	if (it == object.end())
+	{
+		return 0;
+	}
+	if (it->second.IsReal())
+	{
+		return it->second.GetReal();
+	}
+	if (it->second.IsUInt64())
+	{
+		return double(it->second.GetUInt64());
+	}
+	if (it->second.IsInt())
+	{
+		return double(it->second.GetInt64());
+	}
+	return 0;
+}
+
+static std::string jsonString(const JsObject& object, const char* key)
+{
+	JsObject::const_iterator it = object.find(key);
+	return it != object.end() && it->second.IsString() ? it->second.GetString() : std::string();
+}
+
+bool readBenchmarkJson(const std::string& path, std::vector<BenchmarkResult>& results, std::string& error)
+{
+	std::ifstream in(path);
+	if (!in)
+	{
+		error = "can't open " + path;
+		return false;
+	}
+
+	JsParseError parseError;
+	JsValue value = JsParseStream(in, &parseError);
+	if (!value.IsObject())
+	{
+		error = path + ":" + std::to_string(parseError.line) + ": " + (parseError.reason.empty() ? "not a benchmark report" : parseError.reason);
+		return false;
+	}
+
+	const JsObject& report = value.GetJsObject();
+	JsObject::const_iterator benchmarks = report.find("benchmarks");
+	if (benchmarks == report.end() || !benchmarks->second.IsArray())
+	{
+		error = path + ": no benchmarks";
+		return false;
+	}
+
+	for (const JsValue& entry : benchmarks->second.GetJsArray())
+	{
+		if (!entry.IsObject())
+		{
+			continue;
+		}
+		const JsObject& object = entry.GetJsObject();
+		BenchmarkResult result;
+		result.name = jsonString(object, "name");
+		result.kind = jsonString(object, "kind") == "macro" ? eBenchmark_Macro : eBenchmark_Micro;
+		result.unit = jsonString(object, "unit");
+		result.skipped = jsonString(object, "skipped");
+		result.itemsPerIteration = jsonNumber(object, "itemsPerIteration");
+		result.iterations = size_t(jsonNumber(object, "iterations"));
+		result.repetitions = size_t(jsonNumber(object, "repetitions"));
+		result.medianNs = jsonNumber(object, "medianNs");
+		result.minNs = jsonNumber(object, "minNs");
+		result.maxNs = jsonNumber(object, "maxNs");
+		if (object.count("allocationsPerIteration"))
+		{
+			result.allocationsPerIteration = jsonNumber(object, "allocationsPerIteration");
+		}
+		results.push_back(result);
+	}
+	return true;
+}
+
+size_t compareWithBaseline(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double thresholdPercent)
+{
+	size_t regressions = 0;
+	size_t compared = 0;
+	double logSpeedupSum = 0;
+
+	printf("\n%-32s %14s %14s %9s %8s\n", "benchmark", "baseline ns", "current ns", "change", "speedup");
+	for (const BenchmarkResult& result : results)
+	{
+		std::vector<BenchmarkResult>::const_iterator before = std::find_if(baseline.begin(), baseline.end(),
+			[&result](const BenchmarkResult& entry) { return entry.name == result.name; });
+		bool hasBefore = before != baseline.end() && before->skipped.empty() && before->medianNs > 0;
+		if (!result.skipped.empty())
+		{
+			printf("%-32s %14s %14s %9s\n", result.name.c_str(), hasBefore ? std::to_string(llround(before->medianNs)).c_str() : "-", "-", "skipped");
+			continue;
+		}
+		if (!hasBefore)
+		{
+			printf("%-32s %14s %14.0f %9s\n", result.name.c_str(), "-", result.medianNs, "new");
+			continue;
+		}
+
+		// Compare the time per item, so changing how much a benchmark does per iteration doesn't show as a change
+		double beforeNs = before->itemsPerIteration > 0 ? before->medianNs / before->itemsPerIteration : before->medianNs;
+		double currentNs = result.itemsPerIteration > 0 ? result.medianNs / result.itemsPerIteration : result.medianNs;
+		double change = 100.0 * (currentNs - beforeNs) / beforeNs;
+		double speedup = beforeNs / currentNs;
+		logSpeedupSum += std::log(speedup);
+		++compared;
+		const char* verdict = "";
+		if (change > thresholdPercent)
+		{
+			verdict = "  REGRESSION";
+			++regressions;
+		}
+		else if (change < -thresholdPercent)
+		{
+			verdict = "  faster";
+		}
+		// Allocations aren't a verdict of their own, but a change in them usually explains one
+		char allocations[48] = "";
+		if (before->allocationsPerIteration >= 0 && result.allocationsPerIteration >= 0
+			&& std::fabs(result.allocationsPerIteration - before->allocationsPerIteration) >= 0.05)
+		{
+			snprintf(allocations, sizeof(allocations), "  (allocs %.1f -> %.1f)", before->allocationsPerIteration, result.allocationsPerIteration);
+		}
+		printf("%-32s %14.0f %14.0f %+8.1f%% %7.2fx%s%s\n", result.name.c_str(), before->medianNs, result.medianNs, change, speedup, verdict, allocations);
+	}
+
+	if (compared > 0)
+	{
+		printf("\nGeometric mean speedup over %zu benchmarks: %.2fx\n", compared, std::exp(logSpeedupSum / double(compared)));
+	}
+	printf("%zu of %zu benchmarks regressed by more than %.1f%%\n", regressions, results.size(), thresholdPercent);
+	return regressions;
+}
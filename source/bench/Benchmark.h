@@ -0,0 +1,156 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// A small benchmark harness: benchmarks are registered by name, each one
+// times a body over several repetitions, and the results are written as JSON
+// and compared with a stored baseline.
+//
+// Micro benchmarks repeat the body until a repetition takes long enough to
+// time reliably, macro benchmarks run it once per repetition.  The median
+// time per iteration over the repetitions is what gets compared.  Where
+// the heap allocations can be counted, the allocations per iteration of the
+// body are reported with the time.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+enum BenchmarkKind : uint8_t
+{
+	eBenchmark_Micro,
+	eBenchmark_Macro,
+};
+
+struct BenchmarkOptions
+{
+	std::string filter;			// only the benchmarks whose name contains this
+	int repetitions = 5;
+	double minSeconds = 0.1;	// of a micro benchmark repetition
+	bool quick = false;
+};
+
+struct BenchmarkResult
+{
+	std::string name;
+	BenchmarkKind kind = eBenchmark_Micro;
+	std::string unit;				// what an item is: zones, values, prims...
+	double itemsPerIteration = 0;
+	size_t iterations = 0;			// per repetition
+	size_t repetitions = 0;
+	double medianNs = 0;			// per iteration
+	double minNs = 0;
+	double maxNs = 0;
+	double allocationsPerIteration = -1;	// made by the body on its thread, -1 when not counted
+	std::string skipped;			// why it didn't run, empty when it did
+
+	double itemsPerSecond() const
+	{
+		return medianNs > 0 ? itemsPerIteration * 1e9 / medianNs : 0;
+	}
+};
+
+// Handed to a benchmark function, which prepares its data and calls measure()
+class BenchmarkRun
+{
+public:
+	BenchmarkRun(BenchmarkResult& result, const BenchmarkOptions& options)
+		: mResult(result), mOptions(options)
+	{
+	}
+
+	bool quick() const
+	{
+		return mOptions.quick;
+	}
+
+	// Time body, which processes items items per call
+	void measure(double items, const std::function<void()>& body);
+
+	// The same, with setup called untimed before every call of body
+	void measure(double items, const std::function<void()>& setup, const std::function<void()>& body);
+
+	// The benchmark can't run here, say why
+	void skip(const std::string& reason);
+
+private:
+	BenchmarkResult& mResult;
+	const BenchmarkOptions& mOptions;
+};
+
+class BenchmarkSuite
+{
+public:
+	void add(const std::string& name, BenchmarkKind kind, const std::string& unit, std::function<void(BenchmarkRun&)> function);
+
+	std::vector<std::string> names() const;
+
+	// Run the benchmarks that match the filter in registration order, printing a line per benchmark
+	std::vector<BenchmarkResult> run(const BenchmarkOptions& options) const;
+
+private:
+	struct Benchmark
+	{
+		std::string name;
+		BenchmarkKind kind;
+		std::string unit;
+		std::function<void(BenchmarkRun&)> function;
+	};
+
+	std::vector<Benchmark> mBenchmarks;
+};
+
+// Write the results with a description of the machine, false if the file can't be written
+bool writeBenchmarkJson(const std::string& path, const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options);
+
+// Read the results of an earlier writeBenchmarkJson(), false with a message in error if it can't be read
+bool readBenchmarkJson(const std::string& path, std::vector<BenchmarkResult>& results, std::string& error);
+
+// Print the change of every benchmark against the baseline and return how
+// many got slower by more than thresholdPercent
+size_t compareWithBaseline(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double thresholdPercent);
+
+// Keep the optimizer from dropping a result
+extern volatile char gBenchmarkSink;
+
+template <typename T>
+inline void benchmarkKeep(const T& value)
+{
+	gBenchmarkSink = *reinterpret_cast<const volatile char*>(&value);
+}
+
+// Heap allocations made by this thread so far, see BenchAllocations.cpp.
+// Only counted where benchmarkCountsAllocations() is true.
+bool benchmarkCountsAllocations();
+uint64_t benchmarkAllocationCount();
+
+// The benchmarks of the samples, each file registers its own
+void addStageBenchmarks(BenchmarkSuite& suite);
+void addTextBenchmarks(BenchmarkSuite& suite);
+void addClientBenchmarks(BenchmarkSuite& suite);
+
+// A scratch folder for the files the benchmarks write, created on first use
+std::string benchmarkTempDir();
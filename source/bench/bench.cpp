@@ -0,0 +1,191 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+/*###############################################################################
+#
+# The "bench" application runs the benchmarks of the samples:
+#	* Micro benchmarks of the hot spots: creating the sensor zone boxes,
+#	  applying sensor readings, exporting USDA, formatting omnicli listings
+#	  and tokenizing its command lines
+#	* Macro benchmarks of whole operations: committing sensor updates,
+#	  traversing a large stage, copying files and uploading a folder
+#	* Writes the results as JSON and, given an earlier results file,
+#	  compares against it and fails if anything got slower than the threshold
+#
+###############################################################################*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <filesystem>
+#else
+#include <experimental/filesystem>
+#endif
+#include "OmniClient.h"
+#include "Benchmark.h"
+
+std::string benchmarkTempDir()
+{
+#ifdef _WIN32
+	namespace fs = std::filesystem;
+#else
+	namespace fs = std::experimental::filesystem;
+#endif
+	static const std::string dir = []()
+	{
+		fs::path path = fs::temp_directory_path() / "omni_bench";
+		fs::create_directories(path);
+		return path.string();
+	}();
+	return dir;
+}
+
+static void printCmdLineArgHelp()
+{
+	std::cout << "Usage: bench [options]" << std::endl;
+	std::cout << "  options:" << std::endl;
+	std::cout << "    -h, --help                    Print this help" << std::endl;
+	std::cout << "    -l, --list                    List the benchmarks and exit" << std::endl;
+	std::cout << "    -f, --filter text             Only run the benchmarks whose name contains text" << std::endl;
+	std::cout << "    -r, --repetitions count       Repetitions of each benchmark [default: 5]" << std::endl;
+	std::cout << "    -q, --quick                   One short repetition of each, to check they run" << std::endl;
+	std::cout << "    -o, --output file             Where to write the results [default: bench_results.json]" << std::endl;
+	std::cout << "    -b, --baseline file           Compare with earlier results, exit with 1 on a regression" << std::endl;
+	std::cout << "    -t, --threshold percent       How much slower is a regression [default: 10]" << std::endl;
+	std::cout << "\n\nExamples:\n";
+	std::cout << " * record a baseline, with the stand-in so the client benchmarks run too" << std::endl;
+	std::cout << "    > ./run_bench.sh -o baseline.json" << std::endl;
+	std::cout << "\n * check a change against it" << std::endl;
+	std::cout << "    > ./run_bench.sh -b baseline.json" << std::endl;
+	std::cout << "\n * only the zone geometry benchmarks" << std::endl;
+	std::cout << "    > bench -f createZoneGeometry" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	std::string outputPath = "bench_results.json";
+	std::string baselinePath;
+	double threshold = 10.0;
+	bool listOnly = false;
+
+	// Process the arguments
+	for (int x = 1; x < argc; x++)
+	{
+		const bool hasValue = x < argc - 1;
+		if (strcmp(argv[x], "-h") == 0 || strcmp(argv[x], "--help") == 0)
+		{
+			printCmdLineArgHelp();
+			return 0;
+		}
+		else if (strcmp(argv[x], "-l") == 0 || strcmp(argv[x], "--list") == 0)
+		{
+			listOnly = true;
+		}
+		else if (strcmp(argv[x], "-q") == 0 || strcmp(argv[x], "--quick") == 0)
+		{
+			options.quick = true;
+		}
+		else if ((strcmp(argv[x], "-f") == 0 || strcmp(argv[x], "--filter") == 0) && hasValue)
+		{
+			options.filter = argv[++x];
+		}
+		else if ((strcmp(argv[x], "-r") == 0 || strcmp(argv[x], "--repetitions") == 0) && hasValue && std::atoi(argv[x + 1]) > 0)
+		{
+			options.repetitions = std::atoi(argv[++x]);
+		}
+		else if ((strcmp(argv[x], "-o") == 0 || strcmp(argv[x], "--output") == 0) && hasValue)
+		{
+			outputPath = argv[++x];
+		}
+		else if ((strcmp(argv[x], "-b") == 0 || strcmp(argv[x], "--baseline") == 0) && hasValue)
+		{
+			baselinePath = argv[++x];
+		}
+		else if ((strcmp(argv[x], "-t") == 0 || strcmp(argv[x], "--threshold") == 0) && hasValue && std::atof(argv[x + 1]) > 0)
+		{
+			threshold = std::atof(argv[++x]);
+		}
+		else
+		{
+			std::cout << "ERROR: Unexpected argument " << argv[x] << ".\n" << std::endl;
+			printCmdLineArgHelp();
+			return -1;
+		}
+	}
+
+	BenchmarkSuite suite;
+	addStageBenchmarks(suite);
+	addTextBenchmarks(suite);
+	addClientBenchmarks(suite);
+
+	if (listOnly)
+	{
+		for (const std::string& name : suite.names())
+		{
+			std::cout << name << std::endl;
+		}
+		return 0;
+	}
+
+	// Read the baseline first, so a bad path fails before the benchmarks run
+	std::vector<BenchmarkResult> baseline;
+	if (!baselinePath.empty())
+	{
+		std::string error;
+		if (!readBenchmarkJson(baselinePath, baseline, error))
+		{
+			std::cout << "ERROR: " << error << std::endl;
+			return -1;
+		}
+	}
+
+	// Only the client benchmarks talk to a server, and only to the stand-in
+	omniClientSetLogLevel(eOmniClientLogLevel_Warning);
+	if (!omniClientInitialize(kOmniClientVersion))
+	{
+		std::cout << "ERROR: The client library failed to initialize." << std::endl;
+		return -1;
+	}
+
+	const std::vector<BenchmarkResult> results = suite.run(options);
+
+	omniClientShutdown();
+
+	if (!writeBenchmarkJson(outputPath, results, options))
+	{
+		std::cout << "ERROR: Can't write " << outputPath << std::endl;
+		return -1;
+	}
+	std::cout << "Results written to " << outputPath << std::endl;
+
+	if (!baselinePath.empty() && compareWithBaseline(results, baseline, threshold) > 0)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,274 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Asset dependency prefetch, shared by the samples that open existing stages.
+//
+// Composition discovers sublayers, references and payloads one layer at a time,
+// so opening a stage with many dependencies from a remote server pays the
+// latency of every layer in turn.  prefetchAssetDependencies() walks the layer
+// dependencies breadth first instead, opening each level of layers
+// concurrently, and can then read the other assets (textures etc.) through the
+// client library to warm its cache.  The opened layers are held in the result, and while
+// they are alive UsdStage::Open() finds them in the layer registry rather than
+// reading them again.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "OmniClient.h"
+#include "MemoryAccounting.h"
+#include "pxr/usd/sdf/assetPath.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/layerUtils.h"
+#include "pxr/usd/sdf/listOp.h"
+#include "pxr/usd/sdf/payload.h"
+#include "pxr/usd/sdf/reference.h"
+#include "pxr/usd/sdf/schema.h"
+#include "pxr/usd/usd/stage.h"
+
+struct AssetPrefetchOptions
+{
+	// Fetching is latency bound, so this is usually well above the core count
+	int maxConcurrency = 32;
+
+	// Skip payloads when the stage will be opened with UsdStage::LoadNone
+	bool followPayloads = true;
+
+	// Also read asset valued attributes (textures etc.) to warm the client cache,
+	// with the same concurrency limit.  Off by default, most samples never read them.
+	bool fetchAssets = false;
+
+	// How layers are opened, SdfLayer::FindOrOpen when empty (see LayerCache.h)
+	std::function<pxr::SdfLayerRefPtr(const std::string&)> openLayer;
+};
+
+struct AssetPrefetchResult
+{
+	// Keep these alive until the stage is opened
+	std::vector<pxr::SdfLayerRefPtr> layers;
+
+	size_t assetCount = 0;
+	uint64_t assetBytes = 0;
+	size_t failedCount = 0;
+	size_t depth = 0;
+	double seconds = 0.0;
+};
+
+// Run fn(i) for every i in [0, count) on up to maxThreads threads.  These are
+// plain threads, not the work (TBB) pool, since they mostly wait on the network.
+template <typename Fn>
+inline void runConcurrently(size_t count, int maxThreads, Fn&& fn)
+{
+	std::atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < count; i = next++)
+		{
+			fn(i);
+		}
+	};
+
+	const size_t threadCount = std::min(count, size_t(std::max(1, maxThreads)));
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < threadCount; t++)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// Gather the sublayers, references and payloads (layerPaths) and the asset
+// valued attribute defaults (assetPaths) of a layer, anchored to the layer
+inline void collectLayerDependencies(const pxr::SdfLayerRefPtr& layer, bool followPayloads,
+	std::vector<std::string>& layerPaths, std::vector<std::string>& assetPaths)
+{
+	auto addAnchored = [&layer](std::vector<std::string>& paths, const std::string& assetPath)
+	{
+		// Skip internal references and UDIM tile patterns, they aren't single files
+		if (!assetPath.empty() && assetPath.find("<UDIM>") == std::string::npos)
+		{
+			paths.push_back(pxr::SdfComputeAssetPathRelativeToLayer(layer, assetPath));
+		}
+	};
+
+	for (const std::string& subLayer : layer->GetSubLayerPaths())
+	{
+		addAnchored(layerPaths, subLayer);
+	}
+
+	layer->Traverse(pxr::SdfPath::AbsoluteRootPath(), [&](const pxr::SdfPath& path)
+	{
+		if (path.IsPrimPath() || path.IsPrimVariantSelectionPath())
+		{
+			const pxr::VtValue references = layer->GetField(path, pxr::SdfFieldKeys->References);
+			if (references.IsHolding<pxr::SdfReferenceListOp>())
+			{
+				pxr::SdfReferenceVector items;
+				references.UncheckedGet<pxr::SdfReferenceListOp>().ApplyOperations(&items);
+				for (const pxr::SdfReference& reference : items)
+				{
+					addAnchored(layerPaths, reference.GetAssetPath());
+				}
+			}
+
+			const pxr::VtValue payloads = followPayloads ? layer->GetField(path, pxr::SdfFieldKeys->Payload) : pxr::VtValue();
+			if (payloads.IsHolding<pxr::SdfPayloadListOp>())
+			{
+				pxr::SdfPayloadVector items;
+				payloads.UncheckedGet<pxr::SdfPayloadListOp>().ApplyOperations(&items);
+				for (const pxr::SdfPayload& payload : items)
+				{
+					addAnchored(layerPaths, payload.GetAssetPath());
+				}
+			}
+		}
+		else if (path.IsPropertyPath())
+		{
+			const pxr::VtValue value = layer->GetField(path, pxr::SdfFieldKeys->Default);
+			if (value.IsHolding<pxr::SdfAssetPath>())
+			{
+				addAnchored(assetPaths, value.UncheckedGet<pxr::SdfAssetPath>().GetAssetPath());
+			}
+			else if (value.IsHolding<pxr::VtArray<pxr::SdfAssetPath>>())
+			{
+				for (const pxr::SdfAssetPath& assetPath : value.UncheckedGet<pxr::VtArray<pxr::SdfAssetPath>>())
+				{
+					addAnchored(assetPaths, assetPath.GetAssetPath());
+				}
+			}
+		}
+	});
+}
+
+// Walk the dependencies of a stage breadth first and fetch them concurrently
+inline AssetPrefetchResult prefetchAssetDependencies(const std::string& stageUrl,
+	const AssetPrefetchOptions& options = AssetPrefetchOptions())
+{
+	MemoryScope memoryScope(eMemorySubsystem_StageOpen);
+	AssetPrefetchResult result;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<std::string> assets;
+	std::set<std::string> seen = { stageUrl };
+	std::vector<std::string> level = { stageUrl };
+	while (!level.empty())
+	{
+		result.depth++;
+
+		// Open the whole level at once, each layer lists its own dependencies
+		std::vector<pxr::SdfLayerRefPtr> layers(level.size());
+		std::vector<std::vector<std::string>> layerPaths(level.size());
+		std::vector<std::vector<std::string>> assetPaths(level.size());
+		runConcurrently(level.size(), options.maxConcurrency, [&](size_t i)
+		{
+			MemoryScope workerMemoryScope(eMemorySubsystem_StageOpen);
+			layers[i] = options.openLayer ? options.openLayer(level[i]) : pxr::SdfLayer::FindOrOpen(level[i]);
+			if (layers[i])
+			{
+				collectLayerDependencies(layers[i], options.followPayloads, layerPaths[i], assetPaths[i]);
+			}
+		});
+
+		// Merge in order so the next level is deterministic
+		std::vector<std::string> nextLevel;
+		for (size_t i = 0; i < level.size(); i++)
+		{
+			if (!layers[i])
+			{
+				result.failedCount++;
+				continue;
+			}
+			result.layers.push_back(layers[i]);
+
+			for (const std::string& path : layerPaths[i])
+			{
+				if (seen.insert(path).second)
+				{
+					nextLevel.push_back(path);
+				}
+			}
+			for (const std::string& path : assetPaths[i])
+			{
+				if (options.fetchAssets && seen.insert(path).second)
+				{
+					assets.push_back(path);
+				}
+			}
+		}
+		level.swap(nextLevel);
+	}
+
+	// Non-layer assets are only read to warm the client cache: each worker
+	// waits for its read, so at most maxConcurrency are in flight, and the
+	// contents are dropped when the callback returns
+	struct AssetFetchState
+	{
+		std::atomic<uint64_t> bytes{ 0 };
+		std::atomic<size_t> failed{ 0 };
+	} assetState;
+	runConcurrently(assets.size(), options.maxConcurrency, [&](size_t i)
+	{
+		omniClientWait(omniClientReadFile(assets[i].c_str(), &assetState,
+			[](void* userData, OmniClientResult clientResult, char const* version, OmniClientContent* content) noexcept
+			{
+				AssetFetchState* state = static_cast<AssetFetchState*>(userData);
+				if (clientResult == eOmniClientResult_Ok && content)
+				{
+					state->bytes += content->size;
+				}
+				else
+				{
+					state->failed++;
+				}
+			}));
+	});
+	result.assetCount = assets.size();
+	result.assetBytes = assetState.bytes;
+	result.failedCount += assetState.failed;
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+// The shared open path of the samples: prefetch the dependencies, then open the
+// stage while the prefetched layers are still alive
+inline pxr::UsdStageRefPtr openStageWithPrefetch(const std::string& stageUrl,
+	pxr::UsdStage::InitialLoadSet load = pxr::UsdStage::LoadAll, AssetPrefetchOptions options = AssetPrefetchOptions())
+{
+	options.followPayloads = load == pxr::UsdStage::LoadAll;
+	AssetPrefetchResult prefetch = prefetchAssetDependencies(stageUrl, options);
+	MemoryScope memoryScope(eMemorySubsystem_Composition);
+	return pxr::UsdStage::Open(stageUrl, load);
+}
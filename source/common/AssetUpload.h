@@ -0,0 +1,361 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Incremental, content addressed asset upload, shared by the samples that
+// publish their materials and textures.
+//
+// Deleting the remote folder and copying everything again sends every texture
+// over the network on every run.  uploadChangedAssets() hashes the local files
+// in parallel instead and compares them with a manifest stored next to the
+// uploaded files (path, size and content hash of what was last uploaded).  Only
+// new or changed files are sent, concurrently, and the manifest is rewritten
+// once they are all in place, so a rerun with unchanged assets only reads the
+// manifest and stats the remote files.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <filesystem>
+#else
+#include <experimental/filesystem>
+#endif
+#include "OmniClient.h"
+#include "AssetPrefetch.h"
+
+// Stored in the remote folder, one "<hash> <size> <relative path>" line per file
+static const char* const kAssetManifestName = ".assetmanifest";
+
+struct AssetUploadOptions
+{
+	// Upload is latency bound, so this is usually well above the core count
+	int maxConcurrency = 16;
+
+	// Hashing is bound by the disk and the CPU, 0 uses every hardware thread
+	int hashThreads = 0;
+
+	// Relative paths (with '/' separators) to upload, the whole folder when empty
+	std::vector<std::string> files;
+
+	// Stat the unchanged files on the server, so files deleted behind the
+	// manifest's back are sent again.  This costs a round trip per file but no transfer.
+	bool verifyRemote = true;
+};
+
+struct AssetUploadResult
+{
+	size_t fileCount = 0;
+	uint64_t fileBytes = 0;
+	size_t uploadedCount = 0;
+	uint64_t uploadedBytes = 0;
+	size_t unchangedCount = 0;
+	size_t failedCount = 0;
+	double hashSeconds = 0.0;
+	double seconds = 0.0;
+};
+
+struct AssetManifestEntry
+{
+	uint64_t hash = 0;
+	uint64_t size = 0;
+};
+
+using AssetManifest = std::map<std::string, AssetManifestEntry>;
+
+// 64-bit FNV-1a of a local file taken 8 bytes at a time (little endian words,
+// then the trailing bytes), false if it can't be read
+inline bool hashLocalFile(const std::string& path, uint64_t& hash, uint64_t& size)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	hash = 14695981039346656037ull;
+	size = 0;
+	// A multiple of the word size, so only the last read can leave trailing bytes
+	std::vector<char> buffer(1 << 20);
+	while (file)
+	{
+		file.read(buffer.data(), buffer.size());
+		const size_t count = size_t(file.gcount());
+		const size_t wordBytes = count & ~size_t(7);
+		for (size_t i = 0; i < wordBytes; i += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, buffer.data() + i, 8);
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		for (size_t i = wordBytes; i < count; i++)
+		{
+			hash = (hash ^ uint8_t(buffer[i])) * 1099511628211ull;
+		}
+		size += uint64_t(count);
+	}
+	return !file.bad();
+}
+
+// The regular files below a local folder, as sorted relative paths with '/' separators
+inline std::vector<std::string> listLocalFiles(const std::string& localDir)
+{
+#ifdef _WIN32
+	namespace fs = std::filesystem;
+#else
+	namespace fs = std::experimental::filesystem;
+#endif
+	std::vector<std::string> files;
+	std::error_code error;
+	for (fs::recursive_directory_iterator it(localDir, error), end; !error && it != end; it.increment(error))
+	{
+		if (fs::is_regular_file(it->path()))
+		{
+			std::string relative = it->path().generic_string().substr(fs::path(localDir).generic_string().size());
+			relative.erase(0, relative.find_first_not_of('/'));
+			files.push_back(relative);
+		}
+	}
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+inline std::string formatAssetManifest(const AssetManifest& manifest)
+{
+	std::ostringstream text;
+	for (const auto& entry : manifest)
+	{
+		char hash[17];
+		snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)entry.second.hash);
+		text << hash << " " << entry.second.size << " " << entry.first << "\n";
+	}
+	return text.str();
+}
+
+inline AssetManifest parseAssetManifest(const char* data, size_t size)
+{
+	AssetManifest manifest;
+	std::istringstream text(std::string(data, size));
+	std::string line;
+	while (std::getline(text, line))
+	{
+		std::istringstream fields(line);
+		std::string hash;
+		AssetManifestEntry entry;
+		std::string path;
+		if (fields >> hash >> entry.size && std::getline(fields >> std::ws, path) && !path.empty())
+		{
+			entry.hash = std::strtoull(hash.c_str(), nullptr, 16);
+			manifest[path] = entry;
+		}
+	}
+	return manifest;
+}
+
+// Read the manifest of a remote folder, empty if there is none yet
+inline AssetManifest readRemoteAssetManifest(const std::string& remoteDir)
+{
+	AssetManifest manifest;
+	const std::string url = remoteDir + "/" + kAssetManifestName;
+	omniClientWait(omniClientReadFile(url.c_str(), &manifest,
+		[](void* userData, OmniClientResult result, char const* version, OmniClientContent* content) noexcept
+		{
+			if (result == eOmniClientResult_Ok && content)
+			{
+				*static_cast<AssetManifest*>(userData) = parseAssetManifest(static_cast<const char*>(content->buffer), content->size);
+			}
+		}));
+	return manifest;
+}
+
+// Write content allocated with malloc to a remote file, replacing it.  The
+// client library frees the buffer.
+inline OmniClientResult writeRemoteContent(const std::string& url, OmniClientContent& content)
+{
+	OmniClientResult writeResult = eOmniClientResult_Error;
+	omniClientWait(omniClientWriteFile(url.c_str(), &content, &writeResult,
+		[](void* userData, OmniClientResult result) noexcept
+		{
+			*static_cast<OmniClientResult*>(userData) = result;
+		}));
+	return writeResult;
+}
+
+// Write a buffer to a remote file, replacing it
+inline OmniClientResult writeRemoteFile(const std::string& url, const void* data, size_t size)
+{
+	OmniClientContent content;
+	content.buffer = std::malloc(std::max<size_t>(size, 1));
+	content.size = size;
+	content.free = std::free;
+	if (size > 0)
+	{
+		std::memcpy(content.buffer, data, size);
+	}
+	return writeRemoteContent(url, content);
+}
+
+// Upload a local file of a known size, read straight into the buffer the client library sends
+inline OmniClientResult uploadLocalFile(const std::string& path, uint64_t size, const std::string& url)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return eOmniClientResult_Error;
+	}
+	OmniClientContent content;
+	content.buffer = std::malloc(std::max<size_t>(size_t(size), 1));
+	content.size = size_t(size);
+	content.free = std::free;
+	if (!content.buffer || !file.read(static_cast<char*>(content.buffer), std::streamsize(size)))
+	{
+		std::free(content.buffer);
+		return eOmniClientResult_Error;
+	}
+	return writeRemoteContent(url, content);
+}
+
+// Upload the new and changed files of localDir to remoteDir
+inline AssetUploadResult uploadChangedAssets(const std::string& localDir, const std::string& remoteDir,
+	const AssetUploadOptions& options = AssetUploadOptions())
+{
+	AssetUploadResult result;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// Fetch the manifest while the local files are hashed
+	AssetManifest remoteManifest;
+	std::thread manifestThread([&]() { remoteManifest = readRemoteAssetManifest(remoteDir); });
+
+	const std::vector<std::string> files = options.files.empty() ? listLocalFiles(localDir) : options.files;
+	std::vector<AssetManifestEntry> local(files.size());
+	std::vector<char> readable(files.size(), 0);
+	const int hashThreads = options.hashThreads > 0 ? options.hashThreads : int(std::max(1u, std::thread::hardware_concurrency()));
+	runConcurrently(files.size(), hashThreads, [&](size_t i)
+	{
+		readable[i] = hashLocalFile(localDir + "/" + files[i], local[i].hash, local[i].size);
+	});
+	result.hashSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	manifestThread.join();
+
+	// A file is unchanged when the manifest has its hash and size
+	std::vector<size_t> changed;
+	std::vector<size_t> unchanged;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		if (!readable[i])
+		{
+			result.failedCount++;
+			continue;
+		}
+		result.fileCount++;
+		result.fileBytes += local[i].size;
+		auto found = remoteManifest.find(files[i]);
+		const bool same = found != remoteManifest.end() && found->second.hash == local[i].hash && found->second.size == local[i].size;
+		(same ? unchanged : changed).push_back(i);
+	}
+
+	// The manifest can't see files removed from the server, their stat fails
+	if (options.verifyRemote && !unchanged.empty())
+	{
+		struct StatState
+		{
+			uint64_t expectedSize = 0;
+			bool present = false;
+		};
+		std::vector<StatState> stats(unchanged.size());
+		std::vector<OmniClientRequestId> requests;
+		for (size_t u = 0; u < unchanged.size(); u++)
+		{
+			stats[u].expectedSize = local[unchanged[u]].size;
+			const std::string url = remoteDir + "/" + files[unchanged[u]];
+			requests.push_back(omniClientStat(url.c_str(), &stats[u],
+				[](void* userData, OmniClientResult clientResult, struct OmniClientListEntry const* entry) noexcept
+				{
+					StatState* state = static_cast<StatState*>(userData);
+					state->present = clientResult == eOmniClientResult_Ok && entry && entry->size == state->expectedSize;
+				}));
+		}
+		for (OmniClientRequestId request : requests)
+		{
+			omniClientWait(request);
+		}
+
+		std::vector<size_t> stillUnchanged;
+		for (size_t u = 0; u < unchanged.size(); u++)
+		{
+			(stats[u].present ? stillUnchanged : changed).push_back(unchanged[u]);
+		}
+		unchanged.swap(stillUnchanged);
+	}
+	result.unchangedCount = unchanged.size();
+
+	// Send the changed files.  Each one is read again rather than kept from
+	// hashing, so only maxConcurrency files are held in memory at once.
+	std::vector<char> uploaded(changed.size(), 0);
+	runConcurrently(changed.size(), options.maxConcurrency, [&](size_t c)
+	{
+		const size_t i = changed[c];
+		uploaded[c] = uploadLocalFile(localDir + "/" + files[i], local[i].size, remoteDir + "/" + files[i]) == eOmniClientResult_Ok;
+	});
+
+	// Record what is on the server now.  Entries of files outside this upload
+	// are kept, failed files are dropped so the next run sends them again.
+	AssetManifest manifest = remoteManifest;
+	for (size_t c = 0; c < changed.size(); c++)
+	{
+		const size_t i = changed[c];
+		if (uploaded[c])
+		{
+			manifest[files[i]] = local[i];
+			result.uploadedCount++;
+			result.uploadedBytes += local[i].size;
+		}
+		else
+		{
+			manifest.erase(files[i]);
+			result.failedCount++;
+		}
+	}
+	if (!changed.empty() || manifest.size() != remoteManifest.size())
+	{
+		const std::string text = formatAssetManifest(manifest);
+		if (writeRemoteFile(remoteDir + "/" + kAssetManifestName, text.data(), text.size()) != eOmniClientResult_Ok)
+		{
+			result.failedCount++;
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
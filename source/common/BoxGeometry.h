@@ -0,0 +1,106 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// The 100 unit box with normals and UVs that helloWorld and the sensor zones
+// create, its sides don't share points.
+//
+// Everything but the points is the same for every box, so those values are
+// built once and every box's attributes share them: a layer keeps the
+// VtValue it's given, and these are only ever read.  VtArray's copy on write
+// gives anyone who edits one of these attributes their own copy.
+
+#pragma once
+
+#include <iterator>
+#include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/vt/types.h"
+#include "pxr/base/vt/value.h"
+#include "MeshNormals.h"
+
+namespace box_geometry_detail
+{
+	constexpr double h = 50.0;
+	constexpr int kBoxVertexIndices[] = { 0, 1, 2, 1, 3, 2, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11, 12, 13, 14, 12, 14, 15, 16, 17, 18, 16, 18, 19, 20, 21, 22, 20, 22, 23 };
+	constexpr double kBoxPoints[][3] = { {h, -h, -h}, {-h, -h, -h}, {h, h, -h}, {-h, h, -h}, {h, h, h}, {-h, h, h}, {-h, -h, h}, {h, -h, h}, {h, -h, h}, {-h, -h, h}, {-h, -h, -h}, {h, -h, -h}, {h, h, h}, {h, -h, h}, {h, -h, -h}, {h, h, -h}, {-h, h, h}, {h, h, h}, {h, h, -h}, {-h, h, -h}, {-h, -h, h}, {-h, h, h}, {-h, h, -h}, {-h, -h, -h} };
+	constexpr float kBoxUV[][2] = { {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0} };
+	constexpr int kBoxPointCount = int(sizeof(kBoxPoints) / sizeof(kBoxPoints[0]));
+	constexpr int kBoxIndexCount = int(sizeof(kBoxVertexIndices) / sizeof(kBoxVertexIndices[0]));
+	constexpr int kBoxUVCount = int(sizeof(kBoxUV) / sizeof(kBoxUV[0]));
+	constexpr int kBoxTriangleCount = kBoxIndexCount / 3;
+}
+
+// The points of a box centered on center, the only array a box doesn't share
+inline pxr::VtVec3fArray boxPoints(const pxr::GfVec3f& center)
+{
+	using namespace box_geometry_detail;
+	pxr::VtVec3fArray points(kBoxPointCount);
+	for (int i = 0; i < kBoxPointCount; i++)
+	{
+		points[i] = pxr::GfVec3f(kBoxPoints[i][0] + center[0], kBoxPoints[i][1] + center[1], kBoxPoints[i][2] + center[2]);
+	}
+	return points;
+}
+
+struct BoxMeshValues
+{
+	pxr::VtValue points;			// centered on the origin
+	pxr::VtValue faceVertexIndices;
+	pxr::VtValue faceVertexCounts;
+	pxr::VtValue normals;
+	pxr::VtValue displayColor;
+	pxr::VtValue st;
+};
+
+// The shared values, built on first use
+inline const BoxMeshValues& boxMeshValues()
+{
+	using namespace box_geometry_detail;
+	static const BoxMeshValues values = []()
+	{
+		const pxr::VtVec3fArray points = boxPoints(pxr::GfVec3f(0.0f));
+		const pxr::VtIntArray faceVertexIndices(std::begin(kBoxVertexIndices), std::end(kBoxVertexIndices));
+		const pxr::VtIntArray faceVertexCounts(kBoxTriangleCount, 3);
+
+		// The sides don't share points so the smooth normals are the side normals,
+		// and moving the box doesn't change them
+		pxr::VtVec3fArray normals;
+		computeNormals(points, faceVertexCounts, faceVertexIndices, eMeshNormals_Smooth, normals);
+
+		pxr::VtVec2fArray st(kBoxUVCount);
+		for (int i = 0; i < kBoxUVCount; ++i)
+		{
+			st[i].Set(kBoxUV[i]);
+		}
+
+		BoxMeshValues result;
+		result.points = pxr::VtValue(points);
+		result.faceVertexIndices = pxr::VtValue(faceVertexIndices);
+		result.faceVertexCounts = pxr::VtValue(faceVertexCounts);
+		result.normals = pxr::VtValue(normals);
+		result.displayColor = pxr::VtValue(pxr::VtVec3fArray(1, pxr::GfVec3f(0.463f, 0.725f, 0.0f)));
+		result.st = pxr::VtValue(st);
+		return result;
+	}();
+	return values;
+}
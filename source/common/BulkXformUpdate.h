@@ -0,0 +1,364 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Bulk transform updates for many prims, shared by the samples that drive live edits.
+//
+// Setting a transform one op at a time through UsdGeomXformable looks up the op
+// stack, may add ops and rewrites xformOpOrder for every prim on every edit, and
+// every Set() sends its own change notice.  BulkXformUpdater validates the op
+// stacks once when the prims are prepared (each must be some of translate,
+// rotate and scale in that order, the rotate op being one of the three axis
+// rotateXYZ..rotateZYX ops or orient, and the missing ones are added with
+// identity values), keeps the spec paths of the op attributes, and
+// then writes all of the values of a frame to the edit target layer inside a
+// single SdfChangeBlock.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "pxr/base/gf/quatd.h"
+#include "pxr/base/gf/quatf.h"
+#include "pxr/base/gf/rotation.h"
+#include "pxr/base/gf/vec3d.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/gf/vec3i.h"
+#include "pxr/base/vt/value.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/sdf/schema.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/xformable.h"
+
+// One transform, rotateXYZ is the angle about the X, Y and Z axes in degrees
+// like the value of the rotateXYZ op (and of rotateZYX and the other orders)
+struct XformSrt
+{
+	pxr::GfVec3d translate = pxr::GfVec3d(0.0);
+	pxr::GfVec3f rotateXYZ = pxr::GfVec3f(0.0f);
+	pxr::GfVec3f scale = pxr::GfVec3f(1.0f);
+};
+
+// Which ops write() sets, the others keep their values
+enum XformChannel : uint8_t
+{
+	eXformChannel_Translate = 1,
+	eXformChannel_Rotate = 2,
+	eXformChannel_Scale = 4,
+	eXformChannel_All = 7
+};
+
+class BulkXformUpdater
+{
+public:
+	// Returned by indexOf() for prims that were rejected or never prepared
+	static constexpr size_t kRejected = size_t(-1);
+
+	// All of the prims belong to this stage and are written to its current edit
+	// target.  rotationOrder gives the axes in the order they are applied, (0, 1, 2)
+	// is XYZ like TransformPrimSRT in xform_utils.py.  It picks the rotate op added
+	// to prims that have none and how angles are converted for orient ops.
+	explicit BulkXformUpdater(const pxr::UsdStageRefPtr& stage, const pxr::GfVec3i& rotationOrder = pxr::GfVec3i(0, 1, 2))
+		: mStage(stage)
+		, mRotationOrder(rotationOrder)
+	{
+	}
+
+	// Find or add the translate, rotate (rotateXYZ..rotateZYX or orient) and scale ops of
+	// the prims, put them in that order and cache where their values go.
+	// Prims with other ops (transform, pivots...), animated ops or half
+	// precision are rejected rather than having their transform reinterpreted.
+	// Returns the number of prims that can be written, in prepared order.
+	size_t prepare(const std::vector<pxr::UsdPrim>& prims)
+	{
+		const pxr::UsdEditTarget editTarget = mStage->GetEditTarget();
+		mLayer = editTarget.GetLayer();
+		for (const pxr::UsdPrim& prim : prims)
+		{
+			if (mIndices.count(prim.GetPath()) == 0)
+			{
+				mIndices[prim.GetPath()] = prepareTarget(prim, editTarget) ? mTargets.size() - 1 : kRejected;
+			}
+		}
+		return mTargets.size();
+	}
+
+	// Write one transform per prepared prim, in prepared order
+	void write(const XformSrt* values, size_t count, uint8_t channels = eXformChannel_All)
+	{
+		pxr::SdfChangeBlock changeBlock;
+		for (size_t i = 0; i < count && i < mTargets.size(); i++)
+		{
+			writeTarget(mTargets[i], values[i], channels);
+		}
+	}
+
+	void write(const std::vector<XformSrt>& values, uint8_t channels = eXformChannel_All)
+	{
+		write(values.data(), values.size(), channels);
+	}
+
+	// Write the transforms of any prims, preparing the ones seen for the first
+	// time.  Returns the number of prims written.
+	size_t update(const std::vector<pxr::UsdPrim>& prims, const std::vector<XformSrt>& values,
+		uint8_t channels = eXformChannel_All)
+	{
+		prepare(prims);
+		size_t written = 0;
+		pxr::SdfChangeBlock changeBlock;
+		for (size_t i = 0; i < prims.size() && i < values.size(); i++)
+		{
+			const size_t index = mIndices[prims[i].GetPath()];
+			if (index != kRejected)
+			{
+				writeTarget(mTargets[index], values[i], channels);
+				written++;
+			}
+		}
+		return written;
+	}
+
+	// Number of prepared prims
+	size_t size() const
+	{
+		return mTargets.size();
+	}
+
+	// Path of a prepared prim
+	const pxr::SdfPath& primPath(size_t index) const
+	{
+		return mTargets[index].prim;
+	}
+
+	// Prepared index of a prim or kRejected
+	size_t indexOf(const pxr::SdfPath& path) const
+	{
+		const auto it = mIndices.find(path);
+		return it == mIndices.end() ? kRejected : it->second;
+	}
+
+	// Prims that can't be written and why
+	const std::vector<std::pair<pxr::SdfPath, const char*>>& rejected() const
+	{
+		return mRejected;
+	}
+
+private:
+	// The spec paths of the op values in the edit target layer
+	struct Target
+	{
+		pxr::SdfPath prim;
+		pxr::SdfPath translate;
+		pxr::SdfPath rotate;
+		pxr::SdfPath scale;
+		bool translateDouble = true;
+		bool rotateDouble = true;
+		bool scaleDouble = true;
+		bool orient = false;
+	};
+
+	bool reject(const pxr::UsdPrim& prim, const char* reason)
+	{
+		mRejected.emplace_back(prim.GetPath(), reason);
+		return false;
+	}
+
+	bool prepareTarget(const pxr::UsdPrim& prim, const pxr::UsdEditTarget& editTarget)
+	{
+		pxr::UsdGeomXformable xForm(prim);
+		if (!xForm)
+		{
+			return reject(prim, "not xformable");
+		}
+
+		pxr::UsdGeomXformOp translateOp;
+		pxr::UsdGeomXformOp rotateOp;
+		pxr::UsdGeomXformOp scaleOp;
+		bool resetXformStack = false;
+		const std::vector<pxr::UsdGeomXformOp> ops = xForm.GetOrderedXformOps(&resetXformStack);
+		// The position in translate, rotate, scale order of the last op, reordering
+		// the ops would change the transform
+		int lastRank = -1;
+		for (const pxr::UsdGeomXformOp& op : ops)
+		{
+			pxr::UsdGeomXformOp* slot = nullptr;
+			int rank = 0;
+			switch (op.GetOpType()) {
+			case pxr::UsdGeomXformOp::TypeTranslate:
+				slot = &translateOp;
+				rank = 0;
+				break;
+			case pxr::UsdGeomXformOp::TypeRotateXYZ:
+			case pxr::UsdGeomXformOp::TypeRotateXZY:
+			case pxr::UsdGeomXformOp::TypeRotateYXZ:
+			case pxr::UsdGeomXformOp::TypeRotateYZX:
+			case pxr::UsdGeomXformOp::TypeRotateZXY:
+			case pxr::UsdGeomXformOp::TypeRotateZYX:
+			case pxr::UsdGeomXformOp::TypeOrient:
+				slot = &rotateOp;
+				rank = 1;
+				break;
+			case pxr::UsdGeomXformOp::TypeScale:
+				slot = &scaleOp;
+				rank = 2;
+				break;
+			default:
+				break;
+			}
+			if (!slot || op.IsInverseOp())
+			{
+				return reject(prim, "has other xform ops");
+			}
+			if (rank <= lastRank)
+			{
+				return reject(prim, "has xform ops out of translate, rotate, scale order");
+			}
+			lastRank = rank;
+			if (op.GetNumTimeSamples() > 0)
+			{
+				return reject(prim, "has animated xform ops");
+			}
+			if (op.GetPrecision() == pxr::UsdGeomXformOp::PrecisionHalf)
+			{
+				return reject(prim, "has half precision xform ops");
+			}
+			*slot = op;
+		}
+
+		// Missing ops get identity values, present ones are written again so
+		// the edit target layer has a spec for every value
+		if (!translateOp)
+		{
+			translateOp = xForm.AddTranslateOp(pxr::UsdGeomXformOp::PrecisionDouble);
+		}
+		if (!rotateOp)
+		{
+			rotateOp = xForm.AddXformOp(rotateOpType(mRotationOrder), pxr::UsdGeomXformOp::PrecisionDouble);
+		}
+		if (!scaleOp)
+		{
+			scaleOp = xForm.AddScaleOp(pxr::UsdGeomXformOp::PrecisionDouble);
+		}
+		for (const pxr::UsdGeomXformOp& op : { translateOp, rotateOp, scaleOp })
+		{
+			pxr::VtValue value;
+			if (!op.GetAttr().Get(&value))
+			{
+				value = identityValue(op);
+			}
+			op.GetAttr().Set(value);
+		}
+
+		// Added ops go to the end of the stack, they are identity so moving them doesn't change the transform
+		if (ops.size() != 3)
+		{
+			xForm.SetXformOpOrder({ translateOp, rotateOp, scaleOp }, resetXformStack);
+		}
+
+		Target target;
+		target.prim = prim.GetPath();
+		target.translate = editTarget.MapToSpecPath(translateOp.GetAttr().GetPath());
+		target.rotate = editTarget.MapToSpecPath(rotateOp.GetAttr().GetPath());
+		target.scale = editTarget.MapToSpecPath(scaleOp.GetAttr().GetPath());
+		target.translateDouble = translateOp.GetPrecision() == pxr::UsdGeomXformOp::PrecisionDouble;
+		target.rotateDouble = rotateOp.GetPrecision() == pxr::UsdGeomXformOp::PrecisionDouble;
+		target.scaleDouble = scaleOp.GetPrecision() == pxr::UsdGeomXformOp::PrecisionDouble;
+		target.orient = rotateOp.GetOpType() == pxr::UsdGeomXformOp::TypeOrient;
+		mTargets.push_back(target);
+		return true;
+	}
+
+	// The three axis rotate op applying the axes in this order
+	static pxr::UsdGeomXformOp::Type rotateOpType(const pxr::GfVec3i& order)
+	{
+		switch (order[0] * 9 + order[1] * 3 + order[2]) {
+		case 0 * 9 + 2 * 3 + 1:
+			return pxr::UsdGeomXformOp::TypeRotateXZY;
+		case 1 * 9 + 0 * 3 + 2:
+			return pxr::UsdGeomXformOp::TypeRotateYXZ;
+		case 1 * 9 + 2 * 3 + 0:
+			return pxr::UsdGeomXformOp::TypeRotateYZX;
+		case 2 * 9 + 0 * 3 + 1:
+			return pxr::UsdGeomXformOp::TypeRotateZXY;
+		case 2 * 9 + 1 * 3 + 0:
+			return pxr::UsdGeomXformOp::TypeRotateZYX;
+		default:
+			return pxr::UsdGeomXformOp::TypeRotateXYZ;
+		}
+	}
+
+	static pxr::VtValue identityValue(const pxr::UsdGeomXformOp& op)
+	{
+		const bool isDouble = op.GetPrecision() == pxr::UsdGeomXformOp::PrecisionDouble;
+		switch (op.GetOpType()) {
+		case pxr::UsdGeomXformOp::TypeOrient:
+			return isDouble ? pxr::VtValue(pxr::GfQuatd(1.0)) : pxr::VtValue(pxr::GfQuatf(1.0f));
+		case pxr::UsdGeomXformOp::TypeScale:
+			return isDouble ? pxr::VtValue(pxr::GfVec3d(1.0)) : pxr::VtValue(pxr::GfVec3f(1.0f));
+		default:
+			return isDouble ? pxr::VtValue(pxr::GfVec3d(0.0)) : pxr::VtValue(pxr::GfVec3f(0.0f));
+		}
+	}
+
+	// Write straight to the layer, the specs exist since prepare()
+	void writeTarget(const Target& target, const XformSrt& value, uint8_t channels)
+	{
+		const pxr::TfToken& field = pxr::SdfFieldKeys->Default;
+		if (channels & eXformChannel_Translate)
+		{
+			mLayer->SetField(target.translate, field, target.translateDouble ?
+				pxr::VtValue(value.translate) : pxr::VtValue(pxr::GfVec3f(value.translate)));
+		}
+		if ((channels & eXformChannel_Rotate) && target.orient)
+		{
+			// The first axis of the rotation order is applied first
+			const pxr::GfVec3d axes[3] = { pxr::GfVec3d::XAxis(), pxr::GfVec3d::YAxis(), pxr::GfVec3d::ZAxis() };
+			const int* order = mRotationOrder.data();
+			const pxr::GfQuatd orient = (pxr::GfRotation(axes[order[0]], value.rotateXYZ[order[0]]) *
+				pxr::GfRotation(axes[order[1]], value.rotateXYZ[order[1]]) *
+				pxr::GfRotation(axes[order[2]], value.rotateXYZ[order[2]])).GetQuat();
+			mLayer->SetField(target.rotate, field, target.rotateDouble ? pxr::VtValue(orient) : pxr::VtValue(pxr::GfQuatf(orient)));
+		}
+		else if (channels & eXformChannel_Rotate)
+		{
+			mLayer->SetField(target.rotate, field, target.rotateDouble ?
+				pxr::VtValue(pxr::GfVec3d(value.rotateXYZ)) : pxr::VtValue(value.rotateXYZ));
+		}
+		if (channels & eXformChannel_Scale)
+		{
+			mLayer->SetField(target.scale, field, target.scaleDouble ?
+				pxr::VtValue(pxr::GfVec3d(value.scale)) : pxr::VtValue(value.scale));
+		}
+	}
+
+	pxr::UsdStageRefPtr mStage;
+	pxr::GfVec3i mRotationOrder;
+	pxr::SdfLayerHandle mLayer;
+	std::vector<Target> mTargets;
+	std::unordered_map<pxr::SdfPath, size_t, pxr::SdfPath::Hash> mIndices;
+	std::vector<std::pair<pxr::SdfPath, const char*>> mRejected;
+};
@@ -0,0 +1,112 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Command line parsing shared by omnicli and the benchmarks
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+Tokenize a line using the Windows command line rules:
+* Arguments are delimited by white space, which is either a space or a tab.
+* A string surrounded by double quotation marks is interpreted as a single argument,
+	regardless of white space contained within. A quoted string can be embedded in an argument.
+* A double quotation mark preceded by a backslash, \", is interpreted as a literal double quotation mark (").
+* Backslashes are interpreted literally, unless they immediately precede a double quotation mark.
+* If an even number of backslashes is followed by a double quotation mark, then one backslash (\) is placed in
+	the argv array for every pair of backslashes (\\), and the double quotation mark (") is interpreted as a string
+delimiter.
+* If an odd number of backslashes is followed by a double quotation mark, then one backslash (\) is placed in the argv
+array for every pair of backslashes (\\) and the double quotation mark is interpreted as an escape sequence by the
+remaining backslash, causing a literal double quotation mark (") to be placed in argv.
+*/
+inline std::vector<std::string> tokenize(char const* line)
+{
+	std::vector<std::string> tokens;
+	std::string token;
+	bool inWhiteSpace = true;
+	bool inQuote = false;
+	uint32_t backslashCount = 0;
+	for (char const* p = line; *p; p++)
+	{
+		if (*p == '\n')
+		{
+			break;
+		}
+		if (inWhiteSpace)
+		{
+			if (*p == ' ' || *p == '\t')
+			{
+				continue;
+			}
+			else
+			{
+				inWhiteSpace = false;
+			}
+		}
+		if (*p == '\\')
+		{
+			backslashCount++;
+			continue;
+		}
+		if (*p == '\"')
+		{
+			token.append(backslashCount / 2, '\\');
+			if (backslashCount % 2 == 1)
+			{
+				token.push_back('\"');
+			}
+			else
+			{
+				inQuote = !inQuote;
+			}
+			backslashCount = 0;
+			continue;
+		}
+		if (backslashCount > 0)
+		{
+			token.append(backslashCount, '\\');
+			backslashCount = 0;
+		}
+		if (!inQuote && (*p == ' ' || *p == '\t'))
+		{
+			tokens.emplace_back(std::move(token));
+			token.clear();
+			inWhiteSpace = true;
+			continue;
+		}
+		token.push_back(*p);
+	}
+	if (backslashCount > 0)
+	{
+		token.append(backslashCount, '\\');
+	}
+	if (!token.empty())
+	{
+		tokens.emplace_back(std::move(token));
+	}
+	return tokens;
+}
@@ -0,0 +1,246 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// A local cache of text layers converted to crate (.usdc) files.
+//
+// Each text layer that is opened through the cache is exported to
+// <folder>/<key>.usdc, where the key is a hash of the URL and the version the
+// server reports (its content hash, version or modified time and size).  Later
+// opens of the same version memory map the crate file instead of downloading
+// and parsing the text, and move the layer to the original URL so composition
+// anchors and finds it exactly as if it had come from the server.  A new
+// version of a layer gets a new key, so stale entries are never used.
+//
+// Layers opened from the cache are clean, but they keep the crate format, so
+// saving an edited one would write crate data to the text URL.  It's meant for
+// read-only use.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include "OmniClient.h"
+#include "pxr/base/tf/fileUtils.h"
+#include "pxr/usd/sdf/fileFormat.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/usdFileFormat.h"
+#include "pxr/usd/usd/usdaFileFormat.h"
+
+class LayerCache
+{
+public:
+	explicit LayerCache(const std::string& folder)
+		: mFolder(folder)
+	{
+		pxr::TfMakeDirs(mFolder, -1, true);
+	}
+
+	const std::string& folder() const { return mFolder; }
+
+	// Open a layer through the cache, safe to call from several threads
+	pxr::SdfLayerRefPtr open(const std::string& url)
+	{
+		if (pxr::SdfLayerRefPtr layer = pxr::SdfLayer::Find(url))
+		{
+			return layer;
+		}
+
+		std::string key;
+		if (!versionKey(url, key))
+		{
+			mUncached++;
+			return pxr::SdfLayer::FindOrOpen(url);
+		}
+		const std::string cachePath = mFolder + "/" + key + ".usdc";
+		const std::string timePath = mFolder + "/" + key + ".txt";
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (pxr::TfIsFile(cachePath))
+		{
+			if (pxr::SdfLayerRefPtr layer = openCached(url, cachePath))
+			{
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				double originalSeconds = 0.0;
+				mHits++;
+				if (std::ifstream(timePath) >> originalSeconds)
+				{
+					addSeconds(mSavedMicroseconds, originalSeconds - seconds);
+				}
+				{
+					std::lock_guard<std::mutex> lock(mCachedMutex);
+					mCachedUrls.insert(layer->GetIdentifier());
+				}
+				return layer;
+			}
+		}
+
+		pxr::SdfLayerRefPtr layer = pxr::SdfLayer::FindOrOpen(url);
+		if (!layer || !isTextLayer(layer))
+		{
+			// Crate layers are already memory mapped by USD, there's nothing to gain
+			mUncached++;
+			return layer;
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		mMisses++;
+
+		// Write to a temporary name first so a concurrent reader never sees a partial file
+		const std::string tempPath = mFolder + "/" + key + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".usdc";
+		if (layer->Export(tempPath) && std::rename(tempPath.c_str(), cachePath.c_str()) == 0)
+		{
+			std::ofstream(timePath) << seconds;
+		}
+		else
+		{
+			std::remove(tempPath.c_str());
+		}
+		return layer;
+	}
+
+	size_t hits() const { return mHits; }
+	size_t misses() const { return mMisses; }
+	size_t uncached() const { return mUncached; }
+
+	double hitRate() const
+	{
+		const size_t lookups = mHits + mMisses;
+		return lookups > 0 ? double(mHits) / double(lookups) : 0.0;
+	}
+
+	// The load time of the hits when they were misses, minus their load time now
+	double savedSeconds() const { return mSavedMicroseconds * 1e-6; }
+
+	// True if any of the layers was opened from a cached crate file
+	bool anyFromCache(const pxr::SdfLayerHandleVector& layers) const
+	{
+		std::lock_guard<std::mutex> lock(mCachedMutex);
+		for (const pxr::SdfLayerHandle& layer : layers)
+		{
+			if (layer && mCachedUrls.count(layer->GetIdentifier()))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	static uint64_t fnv1a(const std::string& text)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned char c : text)
+		{
+			hash = (hash ^ c) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static void addSeconds(std::atomic<int64_t>& microseconds, double seconds)
+	{
+		microseconds += int64_t(seconds * 1e6);
+	}
+
+	// Build the cache key from the URL and what the server knows about its version
+	static bool versionKey(const std::string& url, std::string& key)
+	{
+		struct StatResult
+		{
+			bool ok = false;
+			std::string version;
+		} stat;
+		omniClientWait(omniClientStat(url.c_str(), &stat, [](void* userData, OmniClientResult result, struct OmniClientListEntry const* entry) noexcept
+		{
+			StatResult* stat = static_cast<StatResult*>(userData);
+			if (result != eOmniClientResult_Ok || !entry)
+			{
+				return;
+			}
+			stat->ok = true;
+			if (entry->hash)
+			{
+				stat->version = std::string("hash:") + entry->hash;
+			}
+			else if (entry->version)
+			{
+				stat->version = std::string("version:") + entry->version;
+			}
+			else
+			{
+				stat->version = "modified:" + std::to_string(entry->modifiedTimeNs) + ":" + std::to_string(entry->size);
+			}
+		}));
+		if (!stat.ok)
+		{
+			return false;
+		}
+
+		char hex[17];
+		snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)fnv1a(url + "\n" + stat.version));
+		key = hex;
+		return true;
+	}
+
+	static bool isTextLayer(const pxr::SdfLayerRefPtr& layer)
+	{
+		const pxr::TfToken& formatId = layer->GetFileFormat()->GetFormatId();
+		if (formatId == pxr::UsdUsdFileFormatTokens->Id)
+		{
+			return pxr::UsdUsdFileFormat::GetUnderlyingFormatForLayer(*layer) == pxr::UsdUsdaFileFormatTokens->Id;
+		}
+		return formatId == pxr::UsdUsdaFileFormatTokens->Id;
+	}
+
+	// Open the crate file and move it to the original URL, which keeps its data
+	// memory mapped and the layer clean (copying the content would do neither)
+	static pxr::SdfLayerRefPtr openCached(const std::string& url, const std::string& cachePath)
+	{
+		pxr::SdfLayerRefPtr layer = pxr::SdfLayer::FindOrOpen(cachePath);
+		if (!layer)
+		{
+			return layer;
+		}
+		const std::string cachedIdentifier = layer->GetIdentifier();
+		layer->SetIdentifier(url);
+		if (layer->GetIdentifier() == cachedIdentifier)
+		{
+			return pxr::SdfLayerRefPtr();
+		}
+		return layer;
+	}
+
+	std::string mFolder;
+	std::atomic<size_t> mHits{ 0 };
+	std::atomic<size_t> mMisses{ 0 };
+	std::atomic<size_t> mUncached{ 0 };
+	std::atomic<int64_t> mSavedMicroseconds{ 0 };
+	mutable std::mutex mCachedMutex;
+	std::set<std::string> mCachedUrls;
+};
@@ -0,0 +1,184 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Formatting of client library list entries, shared by omnicli and the benchmarks
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "OmniClient.h"
+
+inline char const* formatTime(uint64_t tns)
+{
+	time_t time = (time_t)(tns / 1'000'000'000);
+	static char timeStr[30];
+	strftime(timeStr, sizeof(timeStr), "%F %T", localtime(&time));
+	return timeStr;
+}
+
+inline std::string getAccessString(uint16_t access)
+{
+	std::string accessString;
+	if (access & fOmniClientAccess_Read)
+	{
+		if (!accessString.empty())
+		{
+			accessString += ", ";
+		}
+		accessString += "Read";
+	}
+	if (access & fOmniClientAccess_Write)
+	{
+		if (!accessString.empty())
+		{
+			accessString += ", ";
+		}
+		accessString += "Write";
+	}
+	if (access & fOmniClientAccess_Admin)
+	{
+		if (!accessString.empty())
+		{
+			accessString += ", ";
+		}
+		accessString += "Admin";
+	}
+	if (accessString.empty())
+	{
+		accessString = "None";
+	}
+	return accessString;
+}
+
+// The lines omnicli prints for list and checkpoints: modified time, type and size, owner and name
+inline std::string formatListEntries(uint32_t numEntries, struct OmniClientListEntry const* entries)
+{
+	size_t longestOwner = 0;
+	size_t longestType = 0;
+	std::vector<std::string> types;
+	for (uint32_t i = 0; i < numEntries; i++)
+	{
+		if (entries[i].createdBy != nullptr)
+		{
+			longestOwner = std::max(longestOwner, strlen(entries[i].createdBy));
+		}
+		std::string type;
+		{
+			auto flags = entries[i].flags;
+			if (flags & fOmniClientItem_IsInsideMount)
+			{
+				type.append("mounted ");
+			}
+			if (flags & fOmniClientItem_ReadableFile)
+			{
+				auto size = entries[i].size;
+				auto sizeSuffix = "B ";
+				if (size > 1000 * 1000 * 1000)
+				{
+					size /= 1000 * 1000 * 1000;
+					sizeSuffix = "GB ";
+				}
+				else if (size > 1000 * 1000)
+				{
+					size /= 1000 * 1000;
+					sizeSuffix = "MB ";
+				}
+				else if (size > 1000)
+				{
+					size /= 1000;
+					sizeSuffix = "KB ";
+				}
+				type.append(std::to_string(size));
+				type.append(sizeSuffix);
+
+				if ((flags & fOmniClientItem_WriteableFile) == 0)
+				{
+					type.append("read-only ");
+				}
+				type.append("file ");
+			}
+			if (flags & fOmniClientItem_IsMount)
+			{
+				type.append("mount-point ");
+			}
+			else if (flags & fOmniClientItem_CanHaveChildren)
+			{
+				if (flags & fOmniClientItem_DoesNotHaveChildren)
+				{
+					type.append("empty-folder ");
+				}
+				else
+				{
+					type.append("folder ");
+				}
+			}
+			if (flags & fOmniClientItem_CanLiveUpdate)
+			{
+				type.append("live ");
+			}
+			if (flags & fOmniClientItem_IsOmniObject)
+			{
+				type.append("omni-object ");
+			}
+			if (flags & fOmniClientItem_IsChannel)
+			{
+				type.append("channel ");
+			}
+			if (flags & fOmniClientItem_IsCheckpointed)
+			{
+				type.append("checkpointed ");
+			}
+		}
+		longestType = std::max(longestType, type.size());
+		types.emplace_back(std::move(type));
+	}
+	std::string text;
+	std::vector<char> line;
+	for (uint32_t i = 0; i < numEntries; i++)
+	{
+		auto ownerStr = entries[i].createdBy;
+		if (ownerStr == nullptr)
+		{
+			ownerStr = "";
+		}
+		//     Date, type/size, owner, relative name
+		const char* format = "%18s  %*s %*s %s %s\n";
+		const char* time = formatTime(entries[i].modifiedTimeNs);
+		const int length = snprintf(nullptr, 0, format, time, (int)longestType, types[i].c_str(),
+			(int)longestOwner, ownerStr, entries[i].relativePath, entries[i].comment);
+		if (length > 0)
+		{
+			line.resize(size_t(length) + 1);
+			snprintf(line.data(), line.size(), format, time, (int)longestType, types[i].c_str(),
+				(int)longestOwner, ownerStr, entries[i].relativePath, entries[i].comment);
+			text.append(line.data(), size_t(length));
+		}
+	}
+	return text;
+}
@@ -0,0 +1,285 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Opt-in accounting of the heap by subsystem, with USD's TfMallocTag.
+//
+// Every sample constructs a MemoryAccounting at the top of main().  It does
+// nothing unless OMNI_MEMORY_REPORT names a report file, in which case it
+// turns TfMallocTag on and, every OMNI_MEMORY_REPORT_SECONDS (10 by default),
+// rewrites the file with the bytes of each subsystem over time followed by
+// the current TfMallocTag call tree.  At exit it writes the file a last time
+// and prints the peaks.
+//
+// The subsystems are tagged with a MemoryScope where the samples do that
+// work.  Tags are per thread: allocations made on USD's worker threads during
+// a tagged call are counted under the tags USD gives them itself, or the root.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pxr/base/tf/mallocTag.h"
+#include "ProcessMemory.h"
+
+enum MemorySubsystem : uint8_t
+{
+	eMemorySubsystem_StageOpen,			// reading and parsing the layers of a stage
+	eMemorySubsystem_Composition,		// composing the stage, loading payloads
+	eMemorySubsystem_GeometryAuthoring,	// creating and editing meshes
+	eMemorySubsystem_LiveProcessing,	// receiving and sending live updates
+	eMemorySubsystem_Export,			// saving and exporting layers
+	eMemorySubsystem_Count
+};
+
+inline const char* memorySubsystemName(MemorySubsystem subsystem)
+{
+	static const char* const names[eMemorySubsystem_Count] = {
+		"Stage open",
+		"Composition",
+		"Geometry authoring",
+		"Live processing",
+		"Export",
+	};
+	return names[subsystem];
+}
+
+// Counts the allocations of this thread in its scope under the subsystem.
+// Only a check of a flag when the accounting is off.
+class MemoryScope
+{
+public:
+	explicit MemoryScope(MemorySubsystem subsystem)
+		: mTag(memorySubsystemName(subsystem))
+	{
+	}
+
+private:
+	pxr::TfAutoMallocTag mTag;
+};
+
+class MemoryAccounting
+{
+public:
+	explicit MemoryAccounting(const char* programName)
+		: mProgramName(programName)
+	{
+		const char* path = getenv("OMNI_MEMORY_REPORT");
+		if (!path || !*path)
+		{
+			return;
+		}
+
+		std::string error;
+		if (!pxr::TfMallocTag::Initialize(&error))
+		{
+			printf("Memory accounting is not available: %s\n", error.c_str());
+			return;
+		}
+
+		mPath = path;
+		const char* seconds = getenv("OMNI_MEMORY_REPORT_SECONDS");
+		mIntervalSeconds = std::max(seconds ? atof(seconds) : 10.0, 0.1);
+		mStart = std::chrono::steady_clock::now();
+		printf("Memory accounting on, reporting to %s every %g s\n", mPath.c_str(), mIntervalSeconds);
+
+		mThread = std::thread([this]() { reportLoop(); });
+
+		// Samples that end with exit() don't get to the destructor
+		sActive = this;
+		std::atexit([]()
+		{
+			if (sActive)
+			{
+				sActive->finish();
+			}
+		});
+	}
+
+	~MemoryAccounting()
+	{
+		finish();
+	}
+
+	MemoryAccounting(const MemoryAccounting&) = delete;
+	MemoryAccounting& operator=(const MemoryAccounting&) = delete;
+
+private:
+	struct Sample
+	{
+		double seconds = 0.0;
+		size_t taggedBytes = 0;
+		size_t residentBytes = 0;
+		size_t subsystemBytes[eMemorySubsystem_Count] = {};
+	};
+
+	void reportLoop()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (!mStopping)
+		{
+			mWake.wait_for(lock, std::chrono::duration<double>(mIntervalSeconds), [this]() { return mStopping; });
+			if (!mStopping)
+			{
+				lock.unlock();
+				report();
+				lock.lock();
+			}
+		}
+	}
+
+	// Stop the reports, write the last one and print the peaks, once
+	void finish()
+	{
+		if (mPath.empty())
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mStopping)
+			{
+				return;
+			}
+			mStopping = true;
+		}
+		mWake.notify_all();
+		if (mThread.joinable())
+		{
+			mThread.join();
+		}
+		sActive = nullptr;
+
+		report();
+		printSummary();
+	}
+
+	// The bytes under each subsystem tag, including the tags below it.  A
+	// subsystem that shows up again below itself is only counted once.
+	static void addSubsystemBytes(const pxr::TfMallocTag::CallTree::PathNode& node, uint32_t activeMask, size_t* bytes)
+	{
+		for (uint8_t s = 0; s < eMemorySubsystem_Count; s++)
+		{
+			if (node.siteName == memorySubsystemName(MemorySubsystem(s)) && !(activeMask & (1u << s)))
+			{
+				bytes[s] += node.nBytes;
+				activeMask |= 1u << s;
+			}
+		}
+		for (const pxr::TfMallocTag::CallTree::PathNode& child : node.children)
+		{
+			addSubsystemBytes(child, activeMask, bytes);
+		}
+	}
+
+	static std::string formatBytes(size_t bytes)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%.1f MB", double(bytes) / (1024.0 * 1024.0));
+		return text;
+	}
+
+	void report()
+	{
+		pxr::TfMallocTag::CallTree tree;
+		if (!pxr::TfMallocTag::GetCallTree(&tree))
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mReportMutex);
+		Sample sample;
+		sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+		sample.taggedBytes = pxr::TfMallocTag::GetTotalBytes();
+		sample.residentBytes = getResidentMemoryBytes();
+		addSubsystemBytes(tree.root, 0, sample.subsystemBytes);
+		mSamples.push_back(sample);
+		for (uint8_t s = 0; s < eMemorySubsystem_Count; s++)
+		{
+			mPeakBytes[s] = std::max(mPeakBytes[s], sample.subsystemBytes[s]);
+		}
+
+		// Written next to the report and renamed over it, so it's never seen half written
+		const std::string tempPath = mPath + ".tmp";
+		{
+			std::ofstream out(tempPath);
+			out << mProgramName << " memory, MB\n\n";
+			char line[256];
+			snprintf(line, sizeof(line), "%10s %10s %10s", "seconds", "resident", "heap");
+			out << line;
+			for (uint8_t s = 0; s < eMemorySubsystem_Count; s++)
+			{
+				snprintf(line, sizeof(line), " %20s", memorySubsystemName(MemorySubsystem(s)));
+				out << line;
+			}
+			out << "\n";
+			for (const Sample& entry : mSamples)
+			{
+				snprintf(line, sizeof(line), "%10.1f %10.1f %10.1f", entry.seconds,
+					double(entry.residentBytes) / (1024.0 * 1024.0), double(entry.taggedBytes) / (1024.0 * 1024.0));
+				out << line;
+				for (uint8_t s = 0; s < eMemorySubsystem_Count; s++)
+				{
+					snprintf(line, sizeof(line), " %20.1f", double(entry.subsystemBytes[s]) / (1024.0 * 1024.0));
+					out << line;
+				}
+				out << "\n";
+			}
+			out << "\n" << tree.GetPrettyPrintString();
+		}
+		std::rename(tempPath.c_str(), mPath.c_str());
+	}
+
+	void printSummary() const
+	{
+		printf("%s peak memory: %s resident, %s tracked heap\n", mProgramName.c_str(),
+			formatBytes(getPeakResidentMemoryBytes()).c_str(), formatBytes(pxr::TfMallocTag::GetMaxTotalBytes()).c_str());
+		for (uint8_t s = 0; s < eMemorySubsystem_Count; s++)
+		{
+			printf("  %-20s %12s\n", memorySubsystemName(MemorySubsystem(s)), formatBytes(mPeakBytes[s]).c_str());
+		}
+		printf("  (subsystem peaks as sampled every %g s, see %s)\n", mIntervalSeconds, mPath.c_str());
+	}
+
+	static inline MemoryAccounting* sActive = nullptr;
+
+	std::string mProgramName;
+	std::string mPath;
+	double mIntervalSeconds = 10.0;
+	std::chrono::steady_clock::time_point mStart;
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	bool mStopping = false;
+	std::mutex mReportMutex;
+	std::vector<Sample> mSamples;
+	size_t mPeakBytes[eMemorySubsystem_Count] = {};
+};
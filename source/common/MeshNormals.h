@@ -0,0 +1,469 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Normal and tangent generation for arbitrary polygon meshes.
+//
+// Face normals are area weighted (Newell's method, so concave and non-planar
+// polygons work).  Smooth normals sum the normals of the faces around each
+// point through a point to face adjacency, so every point is written by one
+// thread and the sums don't depend on the thread count.  Faceted normals repeat
+// the face normal for each face vertex (faceVarying).  Every pass is a
+// WorkParallelForN over faces or points and the normalization is SSE.
+//
+// Tangents follow the glTF convention: xyz is the tangent, w is the sign of the
+// bitangent.  They need a float2 "st" primvar and have the same interpolation
+// as the normals, so with smooth normals the tangents of faces on either side
+// of a UV seam are averaged.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define OMNI_MESH_NORMALS_USE_SSE 1
+#endif
+#include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/gf/vec4f.h"
+#include "pxr/base/tf/token.h"
+#include "pxr/base/vt/types.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/usd/sdf/types.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/primvarsAPI.h"
+
+enum MeshNormalMode
+{
+	eMeshNormals_Smooth,
+	eMeshNormals_Faceted,
+};
+
+// Normalize count xyz vectors in place, zero length vectors stay zero
+inline void normalizeVectors(float* xyz, size_t count)
+{
+	size_t i = 0;
+
+#if OMNI_MESH_NORMALS_USE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		// 4 vectors are 3 registers, (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+		float* p = xyz + i * 3;
+		const __m128 v0 = _mm_loadu_ps(p);
+		const __m128 v1 = _mm_loadu_ps(p + 4);
+		const __m128 v2 = _mm_loadu_ps(p + 8);
+		const __m128 s0 = _mm_mul_ps(v0, v0);
+		const __m128 s1 = _mm_mul_ps(v1, v1);
+		const __m128 s2 = _mm_mul_ps(v2, v2);
+
+		// Transpose the squares to one register per component and add them up
+		const __m128 a = _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(1, 0, 3, 0));
+		const __m128 b = _mm_shuffle_ps(s1, s2, _MM_SHUFFLE(2, 1, 3, 2));
+		const __m128 c = _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(1, 0, 2, 1));
+		const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(
+			_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 1, 0)),
+			_mm_shuffle_ps(c, b, _MM_SHUFFLE(3, 1, 2, 0))),
+			_mm_shuffle_ps(c, s2, _MM_SHUFFLE(3, 0, 3, 1)));
+		const __m128 scale = _mm_and_ps(_mm_div_ps(one, _mm_sqrt_ps(lengthSquared)), _mm_cmpgt_ps(lengthSquared, zero));
+
+		// Spread the 4 scales back over the xyz layout
+		_mm_storeu_ps(p, _mm_mul_ps(v0, _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(1, 0, 0, 0))));
+		_mm_storeu_ps(p + 4, _mm_mul_ps(v1, _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(2, 2, 1, 1))));
+		_mm_storeu_ps(p + 8, _mm_mul_ps(v2, _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(3, 3, 3, 2))));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float* v = xyz + i * 3;
+		const float lengthSquared = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+		const float scale = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+		v[0] *= scale;
+		v[1] *= scale;
+		v[2] *= scale;
+	}
+}
+
+// The start of each face in faceVertexIndices plus the total at the end.
+// Returns false when the counts and indices don't describe a valid mesh.
+inline bool computeFaceOffsets(const pxr::VtIntArray& faceVertexCounts, const pxr::VtIntArray& faceVertexIndices,
+	size_t pointCount, std::vector<size_t>& faceOffsets)
+{
+	faceOffsets.resize(faceVertexCounts.size() + 1);
+	size_t offset = 0;
+	for (size_t face = 0; face < faceVertexCounts.size(); face++)
+	{
+		if (faceVertexCounts[face] < 3)
+		{
+			return false;
+		}
+		faceOffsets[face] = offset;
+		offset += size_t(faceVertexCounts[face]);
+	}
+	faceOffsets.back() = offset;
+	if (offset != faceVertexIndices.size())
+	{
+		return false;
+	}
+	for (int index : faceVertexIndices)
+	{
+		if (index < 0 || size_t(index) >= pointCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Area weighted face normals, their length is twice the face area
+inline void computeFaceNormals(const pxr::GfVec3f* points, const int* faceVertexIndices,
+	const std::vector<size_t>& faceOffsets, std::vector<pxr::GfVec3f>& faceNormals)
+{
+	const size_t faceCount = faceOffsets.size() - 1;
+	faceNormals.resize(faceCount);
+	pxr::WorkParallelForN(faceCount, [&](size_t begin, size_t end)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			const int* indices = faceVertexIndices + faceOffsets[face];
+			const size_t count = faceOffsets[face + 1] - faceOffsets[face];
+			pxr::GfVec3f normal(0.0f);
+			if (count == 3)
+			{
+				const pxr::GfVec3f& p0 = points[indices[0]];
+				normal = pxr::GfCross(points[indices[1]] - p0, points[indices[2]] - p0);
+			}
+			else
+			{
+				// Newell's method
+				for (size_t corner = 0; corner < count; corner++)
+				{
+					const pxr::GfVec3f& current = points[indices[corner]];
+					const pxr::GfVec3f& next = points[indices[(corner + 1) % count]];
+					normal[0] += (current[1] - next[1]) * (current[2] + next[2]);
+					normal[1] += (current[2] - next[2]) * (current[0] + next[0]);
+					normal[2] += (current[0] - next[0]) * (current[1] + next[1]);
+				}
+			}
+			faceNormals[face] = normal;
+		}
+	});
+}
+
+// The faces around each point, each list in face order
+struct PointFaceAdjacency
+{
+	std::vector<size_t> offsets;
+	std::vector<int> faces;
+};
+
+inline PointFaceAdjacency buildPointFaceAdjacency(size_t pointCount, const int* faceVertexIndices,
+	const std::vector<size_t>& faceOffsets)
+{
+	const size_t faceCount = faceOffsets.size() - 1;
+	const size_t indexCount = faceOffsets.back();
+	std::unique_ptr<std::atomic<size_t>[]> cursors(new std::atomic<size_t>[pointCount]);
+	pxr::WorkParallelForN(pointCount, [&](size_t begin, size_t end)
+	{
+		for (size_t point = begin; point < end; point++)
+		{
+			cursors[point].store(0, std::memory_order_relaxed);
+		}
+	});
+
+	// Count the faces of each point, then turn the counts into offsets
+	pxr::WorkParallelForN(indexCount, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			cursors[faceVertexIndices[i]].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+	PointFaceAdjacency adjacency;
+	adjacency.offsets.resize(pointCount + 1);
+	size_t offset = 0;
+	for (size_t point = 0; point < pointCount; point++)
+	{
+		adjacency.offsets[point] = offset;
+		offset += cursors[point].load(std::memory_order_relaxed);
+		cursors[point].store(adjacency.offsets[point], std::memory_order_relaxed);
+	}
+	adjacency.offsets.back() = offset;
+
+	// Fill in parallel, then sort each list so the normal sums are deterministic
+	adjacency.faces.resize(indexCount);
+	pxr::WorkParallelForN(faceCount, [&](size_t begin, size_t end)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			for (size_t i = faceOffsets[face]; i < faceOffsets[face + 1]; i++)
+			{
+				adjacency.faces[cursors[faceVertexIndices[i]].fetch_add(1, std::memory_order_relaxed)] = int(face);
+			}
+		}
+	});
+	pxr::WorkParallelForN(pointCount, [&](size_t begin, size_t end)
+	{
+		for (size_t point = begin; point < end; point++)
+		{
+			std::sort(adjacency.faces.begin() + adjacency.offsets[point], adjacency.faces.begin() + adjacency.offsets[point + 1]);
+		}
+	});
+	return adjacency;
+}
+
+// Sum per face vectors over the faces around each point and normalize them
+inline void gatherPointVectors(const PointFaceAdjacency& adjacency, const std::vector<pxr::GfVec3f>& faceVectors,
+	pxr::GfVec3f* pointVectors, bool normalize)
+{
+	const size_t pointCount = adjacency.offsets.size() - 1;
+	pxr::WorkParallelForN(pointCount, [&](size_t begin, size_t end)
+	{
+		for (size_t point = begin; point < end; point++)
+		{
+			pxr::GfVec3f sum(0.0f);
+			for (size_t i = adjacency.offsets[point]; i < adjacency.offsets[point + 1]; i++)
+			{
+				sum += faceVectors[adjacency.faces[i]];
+			}
+			pointVectors[point] = sum;
+		}
+		if (normalize)
+		{
+			normalizeVectors(pointVectors[begin].data(), end - begin);
+		}
+	});
+}
+
+// Repeat a per face vector for each vertex of the face
+inline void expandFaceVectors(const std::vector<size_t>& faceOffsets, const std::vector<pxr::GfVec3f>& faceVectors,
+	pxr::GfVec3f* faceVertexVectors)
+{
+	pxr::WorkParallelForN(faceOffsets.size() - 1, [&](size_t begin, size_t end)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			std::fill(faceVertexVectors + faceOffsets[face], faceVertexVectors + faceOffsets[face + 1], faceVectors[face]);
+		}
+	});
+}
+
+// The face offsets and, for smooth normals, the point to face adjacency of a
+// mesh, shared by the normal and tangent passes
+struct MeshTopology
+{
+	std::vector<size_t> faceOffsets;
+	PointFaceAdjacency adjacency;
+};
+
+inline bool buildMeshTopology(size_t pointCount, const pxr::VtIntArray& faceVertexCounts, const pxr::VtIntArray& faceVertexIndices,
+	MeshNormalMode mode, MeshTopology& topology)
+{
+	if (!computeFaceOffsets(faceVertexCounts, faceVertexIndices, pointCount, topology.faceOffsets))
+	{
+		return false;
+	}
+	if (mode == eMeshNormals_Smooth)
+	{
+		topology.adjacency = buildPointFaceAdjacency(pointCount, faceVertexIndices.cdata(), topology.faceOffsets);
+	}
+	return true;
+}
+
+// Normals of a mesh, vertex interpolated when smooth and faceVarying when faceted
+inline void computeNormals(const pxr::VtVec3fArray& points, const pxr::VtIntArray& faceVertexIndices,
+	const MeshTopology& topology, MeshNormalMode mode, pxr::VtVec3fArray& normals)
+{
+	std::vector<pxr::GfVec3f> faceNormals;
+	computeFaceNormals(points.cdata(), faceVertexIndices.cdata(), topology.faceOffsets, faceNormals);
+
+	if (mode == eMeshNormals_Smooth)
+	{
+		normals.resize(points.size());
+		gatherPointVectors(topology.adjacency, faceNormals, normals.data(), true);
+	}
+	else
+	{
+		if (!faceNormals.empty())
+		{
+			normalizeVectors(faceNormals.front().data(), faceNormals.size());
+		}
+		normals.resize(faceVertexIndices.size());
+		expandFaceVectors(topology.faceOffsets, faceNormals, normals.data());
+	}
+}
+
+// Normals of a mesh from its arrays, false if the topology isn't valid
+inline bool computeNormals(const pxr::VtVec3fArray& points, const pxr::VtIntArray& faceVertexCounts,
+	const pxr::VtIntArray& faceVertexIndices, MeshNormalMode mode, pxr::VtVec3fArray& normals)
+{
+	MeshTopology topology;
+	if (!buildMeshTopology(points.size(), faceVertexCounts, faceVertexIndices, mode, topology))
+	{
+		return false;
+	}
+	computeNormals(points, faceVertexIndices, topology, mode, normals);
+	return true;
+}
+
+// The result of computeMeshNormals(), authored by authorMeshNormals()
+struct GeneratedNormals
+{
+	pxr::VtVec3fArray normals;
+	pxr::VtVec4fArray tangents;
+	pxr::TfToken interpolation;
+};
+
+// Tangents for normals computed by computeNormals(), uvs are per point or per
+// face vertex.  Faces with degenerate uvs don't contribute.
+inline void computeTangents(const pxr::VtVec3fArray& points, const pxr::VtIntArray& faceVertexIndices,
+	const MeshTopology& topology, const pxr::VtVec2fArray& uvs, bool faceVaryingUvs,
+	MeshNormalMode mode, const pxr::VtVec3fArray& normals, pxr::VtVec4fArray& tangents)
+{
+	const std::vector<size_t>& faceOffsets = topology.faceOffsets;
+
+	// Area weighted tangent and bitangent of each face, summed over its fan triangles
+	const size_t faceCount = faceOffsets.size() - 1;
+	std::vector<pxr::GfVec3f> faceTangents(faceCount), faceBitangents(faceCount);
+	pxr::WorkParallelForN(faceCount, [&](size_t begin, size_t end)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			const size_t start = faceOffsets[face];
+			auto uvAt = [&](size_t i) { return uvs[faceVaryingUvs ? i : size_t(faceVertexIndices[i])]; };
+			const pxr::GfVec3f& p0 = points[faceVertexIndices[start]];
+			const pxr::GfVec2f w0 = uvAt(start);
+			pxr::GfVec3f tangent(0.0f), bitangent(0.0f);
+			for (size_t i = start + 1; i + 1 < faceOffsets[face + 1]; i++)
+			{
+				const pxr::GfVec3f e1 = points[faceVertexIndices[i]] - p0;
+				const pxr::GfVec3f e2 = points[faceVertexIndices[i + 1]] - p0;
+				const pxr::GfVec2f d1 = uvAt(i) - w0;
+				const pxr::GfVec2f d2 = uvAt(i + 1) - w0;
+				const float r = d1[0] * d2[1] - d2[0] * d1[1];
+				if (r == 0.0f)
+				{
+					continue;
+				}
+				const float sign = r > 0.0f ? 1.0f : -1.0f;
+				tangent += (e1 * d2[1] - e2 * d1[1]) * sign;
+				bitangent += (e2 * d1[0] - e1 * d2[0]) * sign;
+			}
+			faceTangents[face] = tangent;
+			faceBitangents[face] = bitangent;
+		}
+	});
+
+	std::vector<pxr::GfVec3f> slotTangents(normals.size()), slotBitangents(normals.size());
+	if (mode == eMeshNormals_Smooth)
+	{
+		gatherPointVectors(topology.adjacency, faceTangents, slotTangents.data(), false);
+		gatherPointVectors(topology.adjacency, faceBitangents, slotBitangents.data(), false);
+	}
+	else
+	{
+		expandFaceVectors(faceOffsets, faceTangents, slotTangents.data());
+		expandFaceVectors(faceOffsets, faceBitangents, slotBitangents.data());
+	}
+
+	// Gram-Schmidt against the normal, the sign says which way the bitangent points
+	tangents.resize(normals.size());
+	pxr::WorkParallelForN(normals.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const pxr::GfVec3f& normal = normals[i];
+			pxr::GfVec3f tangent = slotTangents[i] - normal * pxr::GfDot(normal, slotTangents[i]);
+			if (tangent.GetLengthSq() == 0.0f)
+			{
+				// No usable uvs, any direction perpendicular to the normal will do
+				tangent = pxr::GfCross(normal, std::fabs(normal[0]) < 0.9f ? pxr::GfVec3f(1, 0, 0) : pxr::GfVec3f(0, 1, 0));
+			}
+			slotTangents[i] = tangent;
+		}
+		normalizeVectors(slotTangents[begin].data(), end - begin);
+		for (size_t i = begin; i < end; i++)
+		{
+			const float sign = pxr::GfDot(pxr::GfCross(normals[i], slotTangents[i]), slotBitangents[i]) < 0.0f ? -1.0f : 1.0f;
+			tangents[i] = pxr::GfVec4f(slotTangents[i][0], slotTangents[i][1], slotTangents[i][2], sign);
+		}
+	});
+}
+
+// Compute the normals, and the tangents when withTangents is set and the mesh
+// has st uvs, from the default time points and topology.  Safe to call from
+// several threads since it only reads the stage.
+inline bool computeMeshNormals(const pxr::UsdGeomMesh& mesh, MeshNormalMode mode, bool withTangents, GeneratedNormals& out)
+{
+	pxr::VtVec3fArray points;
+	pxr::VtIntArray faceVertexCounts, faceVertexIndices;
+	mesh.GetPointsAttr().Get(&points);
+	mesh.GetFaceVertexCountsAttr().Get(&faceVertexCounts);
+	mesh.GetFaceVertexIndicesAttr().Get(&faceVertexIndices);
+	MeshTopology topology;
+	if (!buildMeshTopology(points.size(), faceVertexCounts, faceVertexIndices, mode, topology))
+	{
+		return false;
+	}
+	computeNormals(points, faceVertexIndices, topology, mode, out.normals);
+	out.interpolation = mode == eMeshNormals_Smooth ? pxr::UsdGeomTokens->vertex : pxr::UsdGeomTokens->faceVarying;
+	out.tangents.clear();
+	if (!withTangents)
+	{
+		return true;
+	}
+
+	static const pxr::TfToken stToken("st");
+	pxr::UsdGeomPrimvar st = pxr::UsdGeomPrimvarsAPI(mesh.GetPrim()).GetPrimvar(stToken);
+	pxr::VtVec2fArray uvs;
+	if (!st || !st.ComputeFlattened(&uvs))
+	{
+		return true;
+	}
+	const bool faceVaryingUvs = st.GetInterpolation() == pxr::UsdGeomTokens->faceVarying;
+	if (uvs.size() != (faceVaryingUvs ? faceVertexIndices.size() : points.size()))
+	{
+		return true;
+	}
+	computeTangents(points, faceVertexIndices, topology, uvs, faceVaryingUvs, mode, out.normals, out.tangents);
+	return true;
+}
+
+// Write primvars:normals (and primvars:tangents), which win over the normals attribute
+inline void authorMeshNormals(const pxr::UsdGeomMesh& mesh, const GeneratedNormals& generated)
+{
+	static const pxr::TfToken normalsToken("normals");
+	static const pxr::TfToken tangentsToken("tangents");
+	pxr::UsdGeomPrimvarsAPI primvars(mesh.GetPrim());
+	primvars.CreatePrimvar(normalsToken, pxr::SdfValueTypeNames->Normal3fArray, generated.interpolation).Set(generated.normals);
+	if (!generated.tangents.empty())
+	{
+		primvars.CreatePrimvar(tangentsToken, pxr::SdfValueTypeNames->Float4Array, generated.interpolation).Set(generated.tangents);
+	}
+}
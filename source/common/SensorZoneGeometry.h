@@ -0,0 +1,85 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// The zone boxes of the SimpleSensorExample stage, /World/box_<zone>, laid
+// out on a cube of zones 150 units apart.  omniSimpleSensor creates them and
+// the benchmarks create them on in memory stages.
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/tf/token.h"
+#include "pxr/base/vt/types.h"
+#include "pxr/base/vt/value.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/sdf/types.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/primvar.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "BoxGeometry.h"
+#include "MemoryAccounting.h"
+
+// Create the box of one zone, an invalid mesh if the prim can't be defined
+inline pxr::UsdGeomMesh createZoneGeometry(const pxr::UsdStageRefPtr& stage, int zoneNumber, int totalZones)
+{
+	MemoryScope memoryScope(eMemorySubsystem_GeometryAuthoring);
+
+	// Create the geometry inside of "/World"
+	const std::string boxName = "/World/box_" + std::to_string(zoneNumber);
+	pxr::UsdGeomMesh mesh = pxr::UsdGeomMesh::Define(stage, pxr::SdfPath(boxName));
+	if (!mesh)
+	{
+		return mesh;
+	}
+
+	// Set orientation
+	mesh.CreateOrientationAttr(pxr::VtValue(pxr::UsdGeomTokens->rightHanded));
+
+	// Calculate the offset for the box based on the zone number
+	int zoneSize = (int)floor(std::cbrt((double)totalZones));
+	if (zoneSize < 1)
+		zoneSize = 1;
+	float xOffset = (zoneNumber % zoneSize) * 150;
+	int yZone = zoneNumber % (zoneSize * zoneSize);
+	float yOffset = int(yZone / zoneSize) * 150;
+	float zOffset = int(floor(zoneNumber / (zoneSize * zoneSize))) * 150;
+
+	// Only the points are the zone's own, the other arrays are shared by every box
+	const BoxMeshValues& values = boxMeshValues();
+	mesh.CreatePointsAttr(pxr::VtValue(boxPoints(pxr::GfVec3f(xOffset, yOffset, zOffset))));
+	mesh.CreateFaceVertexIndicesAttr(values.faceVertexIndices);
+	mesh.CreateFaceVertexCountsAttr(values.faceVertexCounts);
+	mesh.CreateNormalsAttr(values.normals);
+	mesh.CreateDisplayColorAttr(values.displayColor);
+
+	// Set the UV (st) values for this mesh
+	static const pxr::TfToken st("st");
+	pxr::UsdGeomPrimvar attr2 = mesh.CreatePrimvar(st, pxr::SdfValueTypeNames->TexCoord2fArray);
+	attr2.Set(values.st);
+	attr2.SetInterpolation(pxr::UsdGeomTokens->vertex);
+
+	return mesh;
+}
@@ -0,0 +1,263 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Sensor readings applied to the zone boxes of the SimpleSensorExample stage
+// (/World/box_<zone>, created by omniSimpleSensor), shared by omniSensorThread
+// and the sensor_ingest Python module.
+//
+// A reading sets the displayColor of its zone.  apply() takes a batch of
+// (zone, value) records, keeps the last value of each zone and writes those
+// straight to the edit target layer inside one SdfChangeBlock, so a batch
+// costs one layer write per zone however many readings it carries.  Each
+// zone's color is written from a VtArrayPool, so once every zone has been
+// written a couple of times the writes allocate no value storage.  The layer
+// write itself still allocates: Sdf records every change in a change list and
+// the stage handles the change notice, for each zone written.  Zones are
+// looked up again when their box or its displayColor is resynced, so boxes
+// added, removed or renamed after the first batch are followed.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/tf/notice.h"
+#include "pxr/base/tf/weakBase.h"
+#include "pxr/base/vt/types.h"
+#include "pxr/base/vt/value.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/sdf/schema.h"
+#include "pxr/usd/usd/notice.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "VtArrayPool.h"
+
+// One sensor reading.  8 bytes without padding so a buffer of them can come
+// straight from Python, e.g. numpy dtype [("zone", "<i4"), ("value", "<f4")].
+struct SensorRecord
+{
+	int32_t zone;
+	float value;
+};
+
+static_assert(sizeof(SensorRecord) == 8, "SensorRecord is shared with Python as 8 byte records");
+
+// The display color a reading gives its zone, the box green scaled by the value
+inline pxr::GfVec3f sensorZoneColor(float value)
+{
+	return pxr::GfVec3f(0.463f * value, 0.725f * value, 0.0f);
+}
+
+struct SensorApplyStats
+{
+	size_t values = 0;
+	size_t zoneWrites = 0;
+	size_t unknownValues = 0;
+};
+
+class SensorZoneWriter : public pxr::TfWeakBase
+{
+public:
+	// Zone numbers are small and dense, the zones are kept in a vector indexed by zone
+	static constexpr int32_t kMaxZone = 1 << 20;
+
+	// Readings are written to the current edit target of the stage
+	explicit SensorZoneWriter(const pxr::UsdStageRefPtr& stage)
+		: mStage(stage)
+		, mEditTarget(stage->GetEditTarget())
+		, mLayer(mEditTarget.GetLayer())
+	{
+		mObjectsChangedKey = pxr::TfNotice::Register(pxr::TfCreateWeakPtr(this), &SensorZoneWriter::onObjectsChanged, stage);
+	}
+
+	~SensorZoneWriter()
+	{
+		pxr::TfNotice::Revoke(mObjectsChangedKey);
+	}
+
+	SensorZoneWriter(const SensorZoneWriter&) = delete;
+	SensorZoneWriter& operator=(const SensorZoneWriter&) = delete;
+
+	// Apply a batch of readings, returns the number of zones written.  Zones
+	// are looked up (and get a displayColor spec in the edit target layer) the
+	// first time they are seen and again after their box is resynced.
+	// Readings of zones without a box are counted in stats().unknownValues
+	// and dropped.
+	size_t apply(const SensorRecord* records, size_t count)
+	{
+		resetResyncedZones();
+		mBatch++;
+		mTouched.clear();
+		for (size_t i = 0; i < count; i++)
+		{
+			const SensorRecord& record = records[i];
+			Zone* zone = findZone(record.zone);
+			if (!zone)
+			{
+				mStats.unknownValues++;
+				continue;
+			}
+			if (zone->batch != mBatch)
+			{
+				zone->batch = mBatch;
+				mTouched.push_back(record.zone);
+			}
+			zone->value = record.value;
+		}
+
+		{
+			pxr::SdfChangeBlock changeBlock;
+			for (int32_t touched : mTouched)
+			{
+				Zone& zone = mZones[touched];
+				const pxr::GfVec3f color = sensorZoneColor(zone.value);
+				mLayer->SetField(zone.displayColor, pxr::SdfFieldKeys->Default,
+					zone.colors.write(1, [&color](pxr::GfVec3f* data, size_t) { data[0] = color; }));
+			}
+		}
+
+		mStats.values += count;
+		mStats.zoneWrites += mTouched.size();
+		return mTouched.size();
+	}
+
+	const SensorApplyStats& stats() const
+	{
+		return mStats;
+	}
+
+private:
+	enum ZoneState : uint8_t
+	{
+		eZoneState_Unknown,
+		eZoneState_Ready,
+		eZoneState_Missing
+	};
+
+	struct Zone
+	{
+		pxr::SdfPath box;
+		pxr::SdfPath displayColorAttr;
+		pxr::SdfPath displayColor;		// the spec in the edit target layer
+		VtArrayPool<pxr::GfVec3f> colors;
+		uint64_t batch = 0;
+		float value = 0.0f;
+		ZoneState state = eZoneState_Unknown;
+	};
+
+	// A resynced box may have been added, removed or renamed, and a resynced
+	// attribute may have lost its spec.  The paths are kept for the next
+	// apply(), the notice can come from another thread's live update.
+	void onObjectsChanged(const pxr::UsdNotice::ObjectsChanged& notice)
+	{
+		std::lock_guard<std::mutex> lock(mResyncedMutex);
+		for (const pxr::SdfPath& path : notice.GetResyncedPaths())
+		{
+			mResynced.push_back(path);
+		}
+	}
+
+	// Look up the zones at or below the resynced paths again
+	void resetResyncedZones()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mResyncedMutex);
+			if (mResynced.empty())
+			{
+				return;
+			}
+			mResynced.swap(mResyncedApplied);
+		}
+		for (const pxr::SdfPath& path : mResyncedApplied)
+		{
+			for (Zone& zone : mZones)
+			{
+				if (zone.state != eZoneState_Unknown && (zone.box.HasPrefix(path) || zone.displayColorAttr.HasPrefix(path)))
+				{
+					zone.state = eZoneState_Unknown;
+				}
+			}
+		}
+		mResyncedApplied.clear();
+	}
+
+	Zone* findZone(int32_t zoneNumber)
+	{
+		if (zoneNumber < 0 || zoneNumber >= kMaxZone)
+		{
+			return nullptr;
+		}
+		if (size_t(zoneNumber) >= mZones.size())
+		{
+			mZones.resize(size_t(zoneNumber) + 1);
+		}
+		Zone& zone = mZones[zoneNumber];
+		if (zone.state == eZoneState_Unknown)
+		{
+			zone.state = prepareZone(zoneNumber, zone) ? eZoneState_Ready : eZoneState_Missing;
+		}
+		return zone.state == eZoneState_Ready ? &zone : nullptr;
+	}
+
+	// Runs outside of the change block, creating the attribute goes through Usd
+	bool prepareZone(int32_t zoneNumber, Zone& zone)
+	{
+		zone.box = pxr::SdfPath("/World/box_" + std::to_string(zoneNumber));
+		zone.displayColorAttr = pxr::SdfPath();
+		const pxr::UsdGeomMesh mesh(mStage->GetPrimAtPath(zone.box));
+		if (!mesh)
+		{
+			return false;
+		}
+		const pxr::UsdAttribute displayColorAttr = mesh.CreateDisplayColorAttr();
+		zone.displayColorAttr = displayColorAttr.GetPath();
+		zone.displayColor = mEditTarget.MapToSpecPath(displayColorAttr.GetPath());
+		if (!mLayer->GetAttributeAtPath(zone.displayColor))
+		{
+			pxr::VtVec3fArray color;
+			if (!displayColorAttr.Get(&color))
+			{
+				color = pxr::VtVec3fArray(1, sensorZoneColor(1.0f));
+			}
+			displayColorAttr.Set(color);
+		}
+		return true;
+	}
+
+	pxr::UsdStageRefPtr mStage;
+	pxr::UsdEditTarget mEditTarget;
+	pxr::SdfLayerHandle mLayer;
+	std::vector<Zone> mZones;
+	std::vector<int32_t> mTouched;
+	uint64_t mBatch = 0;
+	std::mutex mResyncedMutex;
+	std::vector<pxr::SdfPath> mResynced;
+	std::vector<pxr::SdfPath> mResyncedApplied;
+	pxr::TfNotice::Key mObjectsChangedKey;
+	SensorApplyStats mStats;
+};
@@ -0,0 +1,282 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Decomposition of many transform matrices into translate, euler rotation and
+// scale, the batch counterpart of extract_srt_xform_from_matrix4 and
+// decompose_rotation in pyHelloWorld's xform_utils.py.
+//
+// Matrices are GfMatrix4d (16 doubles, row vectors, translation in the last
+// row) made of a scale, a rotation and a translation.  The scale of each axis
+// is the length of its row of the upper 3x3, negated on all axes when the
+// matrix mirrors.  The rotation is returned as the angle about X, Y and Z in
+// degrees, the value a rotateXYZ..rotateZYX op with that rotation order
+// takes.  The middle axis of the order gets an angle in [-90, 90] and when it
+// is at +-90 (gimbal lock) the last axis gets 0.
+//
+// Two matrices are decomposed at once in SSE2 registers, including the
+// atan2 (Cephes' atan with range reduction), and blocks of matrices run on
+// the Work thread pool.  Angles are within about 1e-13 degrees of the ones
+// the matrix was built from.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/vec3d.h"
+#include "pxr/base/gf/vec3i.h"
+#include "pxr/base/work/loops.h"
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SRT_DECOMPOSE_SSE2 1
+#endif
+
+namespace srt_decompose_detail
+{
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr double kDegrees = 180.0 / kPi;
+
+	// Below this cosine of the middle angle the first and last axes line up
+	constexpr double kGimbalEpsilon = 1e-12;
+
+	// Cephes atan for 0 <= x <= 1 (the tan(3pi/8) reduction is not needed)
+	inline double atanUnit(double x)
+	{
+		const bool reduce = x > 0.66;
+		const double offset = reduce ? kPi / 4.0 : 0.0;
+		const double moreBits = reduce ? 0.5 * 6.123233995736765886130e-17 : 0.0;
+		if (reduce)
+		{
+			x = (x - 1.0) / (x + 1.0);
+		}
+		const double z = x * x;
+		const double p = (((-8.750608600031904122785e-1 * z - 1.615753718733365076637e1) * z - 7.500855792314704667340e1) * z
+			- 1.228866684490136173410e2) * z - 6.485021904942025371773e1;
+		const double q = ((((z + 2.485846490142306297962e1) * z + 1.650270098316988542046e2) * z + 4.328810604912902668951e2) * z
+			+ 4.853903996359136964868e2) * z + 1.945506571482613964425e2;
+		return offset + (x * z * p / q + x + moreBits);
+	}
+
+	// atan2 through atanUnit of min(|x|, |y|) / max(|x|, |y|), atan2(0, 0) is 0
+	inline double atan2Unit(double y, double x)
+	{
+		const double ax = std::fabs(x);
+		const double ay = std::fabs(y);
+		const double denominator = ax > ay ? ax : ay;
+		double angle = atanUnit(denominator > 0.0 ? (ax > ay ? ay : ax) / denominator : 0.0);
+		angle = ay > ax ? kPi / 2.0 - angle : angle;
+		angle = x < 0.0 ? kPi - angle : angle;
+		return std::signbit(y) ? -angle : angle;
+	}
+
+	// The axes of a rotation order and the sign of the sine terms, +1 when
+	// the order is a cyclic XYZ order (XYZ, YZX, ZXY)
+	struct Axes
+	{
+		int i, j, k;
+		double parity;
+	};
+
+	inline Axes orderAxes(const pxr::GfVec3i& order)
+	{
+		return Axes{ order[0], order[1], order[2], order[1] == (order[0] + 1) % 3 ? 1.0 : -1.0 };
+	}
+
+	inline void decomposeOne(const double* m, const Axes& axes, double* translate, double* rotate, double* scale)
+	{
+		double n[3][3];
+		const double det = m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8]) + m[2] * (m[4] * m[9] - m[5] * m[8]);
+		const double sign = det < 0.0 ? -1.0 : 1.0;
+		for (int r = 0; r < 3; r++)
+		{
+			const double* row = m + 4 * r;
+			const double length = std::sqrt(row[0] * row[0] + row[1] * row[1] + row[2] * row[2]);
+			const double inverse = length > 0.0 ? sign / length : 0.0;
+			scale[r] = sign * length;
+			translate[r] = m[12 + r];
+			for (int c = 0; c < 3; c++)
+			{
+				n[r][c] = row[c] * inverse;
+			}
+		}
+
+		// n holds row vectors, the column vector matrix is its transpose
+		const int i = axes.i, j = axes.j, k = axes.k;
+		const double p = axes.parity;
+		const double cosMiddle = std::sqrt(n[i][i] * n[i][i] + n[i][j] * n[i][j]);
+		const bool gimbal = cosMiddle < kGimbalEpsilon;
+		const double first = gimbal ? atan2Unit(-p * n[k][j], n[j][j]) : atan2Unit(p * n[j][k], n[k][k]);
+		const double middle = atan2Unit(-p * n[i][k], cosMiddle);
+		const double last = gimbal ? 0.0 : atan2Unit(p * n[i][j], n[i][i]);
+		rotate[i] = first * kDegrees;
+		rotate[j] = middle * kDegrees;
+		rotate[k] = last * kDegrees;
+	}
+
+#ifdef SRT_DECOMPOSE_SSE2
+	inline __m128d select(__m128d mask, __m128d a, __m128d b)
+	{
+		return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+	}
+
+	inline __m128d atanUnit2(__m128d x)
+	{
+		const __m128d reduce = _mm_cmpgt_pd(x, _mm_set1_pd(0.66));
+		const __m128d one = _mm_set1_pd(1.0);
+		x = select(reduce, _mm_div_pd(_mm_sub_pd(x, one), _mm_add_pd(x, one)), x);
+		const __m128d z = _mm_mul_pd(x, x);
+		__m128d p = _mm_set1_pd(-8.750608600031904122785e-1);
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.615753718733365076637e1));
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-7.500855792314704667340e1));
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.228866684490136173410e2));
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-6.485021904942025371773e1));
+		__m128d q = _mm_add_pd(z, _mm_set1_pd(2.485846490142306297962e1));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.650270098316988542046e2));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.328810604912902668951e2));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.853903996359136964868e2));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.945506571482613964425e2));
+		const __m128d offset = _mm_and_pd(reduce, _mm_set1_pd(kPi / 4.0));
+		const __m128d moreBits = _mm_and_pd(reduce, _mm_set1_pd(0.5 * 6.123233995736765886130e-17));
+		const __m128d angle = _mm_add_pd(_mm_add_pd(_mm_div_pd(_mm_mul_pd(_mm_mul_pd(x, z), p), q), x), moreBits);
+		return _mm_add_pd(offset, angle);
+	}
+
+	inline __m128d atan2Unit2(__m128d y, __m128d x)
+	{
+		const __m128d signBit = _mm_set1_pd(-0.0);
+		const __m128d ax = _mm_andnot_pd(signBit, x);
+		const __m128d ay = _mm_andnot_pd(signBit, y);
+		const __m128d denominator = _mm_max_pd(ax, ay);
+		const __m128d nonZero = _mm_cmpgt_pd(denominator, _mm_setzero_pd());
+		const __m128d ratio = _mm_and_pd(nonZero, _mm_div_pd(_mm_min_pd(ax, ay), select(nonZero, denominator, _mm_set1_pd(1.0))));
+		__m128d angle = atanUnit2(ratio);
+		angle = select(_mm_cmpgt_pd(ay, ax), _mm_sub_pd(_mm_set1_pd(kPi / 2.0), angle), angle);
+		angle = select(_mm_cmplt_pd(x, _mm_setzero_pd()), _mm_sub_pd(_mm_set1_pd(kPi), angle), angle);
+		return _mm_xor_pd(angle, _mm_and_pd(y, signBit));
+	}
+
+	// Decompose matrices a and b, each lane of the registers is one matrix
+	inline void decomposeTwo(const double* a, const double* b, const Axes& axes, double* translate, double* rotate, double* scale)
+	{
+		__m128d m[3][3];
+		for (int r = 0; r < 3; r++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				m[r][c] = _mm_loadh_pd(_mm_load_sd(a + 4 * r + c), b + 4 * r + c);
+			}
+		}
+
+		const __m128d signBit = _mm_set1_pd(-0.0);
+		const __m128d det = _mm_add_pd(_mm_sub_pd(
+			_mm_mul_pd(m[0][0], _mm_sub_pd(_mm_mul_pd(m[1][1], m[2][2]), _mm_mul_pd(m[1][2], m[2][1]))),
+			_mm_mul_pd(m[0][1], _mm_sub_pd(_mm_mul_pd(m[1][0], m[2][2]), _mm_mul_pd(m[1][2], m[2][0])))),
+			_mm_mul_pd(m[0][2], _mm_sub_pd(_mm_mul_pd(m[1][0], m[2][1]), _mm_mul_pd(m[1][1], m[2][0]))));
+		const __m128d sign = _mm_and_pd(_mm_cmplt_pd(det, _mm_setzero_pd()), signBit);
+
+		__m128d n[3][3];
+		for (int r = 0; r < 3; r++)
+		{
+			const __m128d length = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m[r][0], m[r][0]), _mm_mul_pd(m[r][1], m[r][1])),
+				_mm_mul_pd(m[r][2], m[r][2])));
+			const __m128d nonZero = _mm_cmpgt_pd(length, _mm_setzero_pd());
+			const __m128d inverse = _mm_xor_pd(_mm_and_pd(nonZero, _mm_div_pd(_mm_set1_pd(1.0), select(nonZero, length, _mm_set1_pd(1.0)))), sign);
+			for (int c = 0; c < 3; c++)
+			{
+				n[r][c] = _mm_mul_pd(m[r][c], inverse);
+			}
+			const __m128d signedLength = _mm_xor_pd(length, sign);
+			_mm_storel_pd(scale + r, signedLength);
+			_mm_storeh_pd(scale + 3 + r, signedLength);
+			translate[r] = a[12 + r];
+			translate[3 + r] = b[12 + r];
+		}
+
+		const int i = axes.i, j = axes.j, k = axes.k;
+		const __m128d p = _mm_set1_pd(axes.parity);
+		const __m128d cosMiddle = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(n[i][i], n[i][i]), _mm_mul_pd(n[i][j], n[i][j])));
+		const __m128d gimbal = _mm_cmplt_pd(cosMiddle, _mm_set1_pd(kGimbalEpsilon));
+		const __m128d first = atan2Unit2(_mm_mul_pd(p, select(gimbal, _mm_xor_pd(n[k][j], signBit), n[j][k])), select(gimbal, n[j][j], n[k][k]));
+		const __m128d middle = atan2Unit2(_mm_xor_pd(_mm_mul_pd(p, n[i][k]), signBit), cosMiddle);
+		const __m128d last = _mm_andnot_pd(gimbal, atan2Unit2(_mm_mul_pd(p, n[i][j]), n[i][i]));
+		const __m128d degrees = _mm_set1_pd(kDegrees);
+		const __m128d angles[3] = { _mm_mul_pd(first, degrees), _mm_mul_pd(middle, degrees), _mm_mul_pd(last, degrees) };
+		const int axis[3] = { i, j, k };
+		for (int c = 0; c < 3; c++)
+		{
+			_mm_storel_pd(rotate + axis[c], angles[c]);
+			_mm_storeh_pd(rotate + 3 + axis[c], angles[c]);
+		}
+	}
+#endif
+
+	inline void decomposeRange(const double* matrices, size_t begin, size_t end, const Axes& axes, double* translate, double* rotate, double* scale)
+	{
+		size_t index = begin;
+#ifdef SRT_DECOMPOSE_SSE2
+		for (; index + 2 <= end; index += 2)
+		{
+			decomposeTwo(matrices + 16 * index, matrices + 16 * (index + 1), axes, translate + 3 * index, rotate + 3 * index, scale + 3 * index);
+		}
+#endif
+		for (; index < end; index++)
+		{
+			decomposeOne(matrices + 16 * index, axes, translate + 3 * index, rotate + 3 * index, scale + 3 * index);
+		}
+	}
+}
+
+// Matrices per work item of the parallel decomposition
+constexpr size_t kSrtDecomposeGrain = 4096;
+
+// Decompose count matrices of 16 doubles into 3 doubles per matrix of
+// translate, rotate (degrees about X, Y and Z) and scale.  rotationOrder gives
+// the axes in the order they are applied, (0, 1, 2) is XYZ.
+inline void decomposeSrt(const double* matrices, size_t count, const pxr::GfVec3i& rotationOrder,
+	double* translate, double* rotate, double* scale, bool parallel = true)
+{
+	const srt_decompose_detail::Axes axes = srt_decompose_detail::orderAxes(rotationOrder);
+	if (!parallel || count <= kSrtDecomposeGrain)
+	{
+		srt_decompose_detail::decomposeRange(matrices, 0, count, axes, translate, rotate, scale);
+		return;
+	}
+	pxr::WorkParallelForN((count + kSrtDecomposeGrain - 1) / kSrtDecomposeGrain, [&](size_t begin, size_t end)
+	{
+		srt_decompose_detail::decomposeRange(matrices, begin * kSrtDecomposeGrain, std::min(end * kSrtDecomposeGrain, count),
+			axes, translate, rotate, scale);
+	});
+}
+
+inline void decomposeSrt(const pxr::GfMatrix4d* matrices, size_t count, const pxr::GfVec3i& rotationOrder,
+	pxr::GfVec3d* translate, pxr::GfVec3d* rotate, pxr::GfVec3d* scale, bool parallel = true)
+{
+	static_assert(sizeof(pxr::GfMatrix4d) == 16 * sizeof(double) && sizeof(pxr::GfVec3d) == 3 * sizeof(double),
+		"GfMatrix4d and GfVec3d arrays are read as plain doubles");
+	if (count == 0)
+	{
+		return;
+	}
+	decomposeSrt(matrices[0].data(), count, rotationOrder, translate[0].data(), rotate[0].data(), scale[0].data(), parallel);
+}
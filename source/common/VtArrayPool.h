@@ -0,0 +1,71 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// Reused VtArray storage for an attribute value that's written over and
+// over, such as a sensor zone's color.
+//
+// A layer keeps the VtValue it's given and shares its storage: both the
+// VtValue's holder and the VtArray's buffer are reference counted.  The
+// pool keeps Depth values and fills the oldest one in place.  By the time a
+// value comes round again the layer has replaced it with a newer one and
+// let go of it, so it's unique and filling it allocates nothing.  If
+// anything still shares it (a caller kept the array it read, or the layer
+// holds on to values longer than Depth writes), copy on write gives the
+// pool a fresh copy to fill and what the other holder sees doesn't change.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "pxr/base/vt/array.h"
+#include "pxr/base/vt/value.h"
+
+template <typename T, size_t Depth = 2>
+class VtArrayPool
+{
+public:
+	// Fill the next value with size elements through fill(T* data, size_t
+	// size) and return it, to be handed to SdfLayer::SetField() or
+	// UsdAttribute::Set().  The value stays valid until Depth more writes.
+	template <typename Fill>
+	const pxr::VtValue& write(size_t size, Fill&& fill)
+	{
+		pxr::VtValue& value = mValues[mNext];
+		mNext = (mNext + 1) % Depth;
+
+		// Borrow the array, swapping copies nothing while the holder is
+		// unique, and data() only copies the buffer if it's shared
+		value.Swap(mArray);
+		mArray.resize(size);
+		fill(mArray.data(), size);
+		value.Swap(mArray);
+		return value;
+	}
+
+private:
+	static_assert(Depth >= 2, "the layer holds the latest value, so one value would always be shared");
+
+	std::array<pxr::VtValue, Depth> mValues;
+	pxr::VtArray<T> mArray;		// empty between writes
+	size_t mNext = 0;
+};
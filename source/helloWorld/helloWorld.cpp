@@ -39,6 +39,9 @@
 #  * optional stuff:
 #  *  print verbose Omniverse logs
 #  *  open an existing stage and find a mesh to do live edits
+#  *  batch the scene edits between checkpoints into a single save
+#  *  generate physics stress scenes with thousands of instanced rigid bodies
+#  *  measure the live edit throughput by moving many prims automatically
 #
 ###############################################################################*/
 
@@ -62,6 +65,13 @@
 #include <memory>
 #include <map>
 #include <condition_variable>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <cmath>
 
 #include "OmniClient.h"
 #include "OmniUsdLive.h"
@@ -69,6 +79,7 @@
 #include "pxr/usd/usdGeom/mesh.h"
 #include "pxr/usd/usdGeom/metrics.h"
 #include <pxr/base/gf/matrix4f.h>
+#include "pxr/base/gf/matrix4d.h"
 #include "pxr/base/gf/vec2f.h"
 #include "pxr/usd/usdUtils/pipeline.h"
 #include "pxr/usd/usdUtils/sparseValueWriter.h"
@@ -81,6 +92,17 @@
 #include <pxr/usd/usdGeom/xform.h>
 #include <pxr/usd/usdGeom/cube.h>
 #include "pxr/usd/usdShade/materialBindingAPI.h"
+#include "pxr/usd/sdf/attributeSpec.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/primSpec.h"
+#include "pxr/usd/usd/tokens.h"
+#include "pxr/base/gf/quatf.h"
+#include "AssetPrefetch.h"
+#include "AssetUpload.h"
+#include "BoxGeometry.h"
+#include "BulkXformUpdate.h"
+#include "MemoryAccounting.h"
 #include <pxr/usd/usdLux/distantLight.h>
 #include <pxr/usd/usdLux/domeLight.h>
 #include <pxr/usd/usdShade/shader.h>
@@ -104,6 +126,171 @@ static bool gOmniverseLoggingEnabled = false;
 // Global for making the logging reasonable
 static std::mutex gLogMutex;
 
+using Clock = std::chrono::steady_clock;
+
+// Seconds elapsed since "start"
+static double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Saves done and avoided while building the scene, see commitStage()
+struct AuthoringStats
+{
+	int saves = 0;
+	int savesAvoided = 0;
+	double saveSeconds = 0.0;
+};
+static AuthoringStats gAuthoringStats;
+
+// Defers the Save() and live update flush of every step authored in its scope
+// to a single commit when it closes.  Checkpoints need the edits on the server
+// so a batch should close before each one.
+class AuthoringBatch
+{
+public:
+	explicit AuthoringBatch(bool enabled)
+	{
+		if (enabled && !sCurrent)
+		{
+			sCurrent = this;
+		}
+	}
+
+	~AuthoringBatch()
+	{
+		commit();
+	}
+
+	// The batch that is open, if any
+	static AuthoringBatch* current()
+	{
+		return sCurrent;
+	}
+
+	void deferCommit()
+	{
+		mDeferredCommits++;
+	}
+
+	// Save and flush once for all of the deferred steps
+	void commit();
+
+private:
+	static AuthoringBatch* sCurrent;
+	int mDeferredCommits = 0;
+};
+AuthoringBatch* AuthoringBatch::sCurrent = nullptr;
+
+// A checkpoint in flight, see checkpointFile()
+struct PendingCheckpoint
+{
+	std::string comment;
+	OmniClientRequestId request = 0;
+	Clock::time_point issued;
+	OmniClientResult result = eOmniClientResult_Ok;
+	double seconds = 0.0;
+};
+
+// Checkpoints created and how long the main thread waited for them
+struct CheckpointStats
+{
+	int created = 0;
+	int failed = 0;
+	double roundTripSeconds = 0.0;
+	double blockedSeconds = 0.0;
+};
+static std::vector<std::unique_ptr<PendingCheckpoint>> gPendingCheckpoints;
+static CheckpointStats gCheckpointStats;
+
+// Join the checkpoints in flight and report the ones that failed
+static void waitForCheckpoints()
+{
+	if (gPendingCheckpoints.empty())
+	{
+		return;
+	}
+
+	Clock::time_point waitStart = Clock::now();
+	for (const std::unique_ptr<PendingCheckpoint>& checkpoint : gPendingCheckpoints)
+	{
+		omniClientWait(checkpoint->request);
+	}
+	gCheckpointStats.blockedSeconds += secondsSince(waitStart);
+
+	for (const std::unique_ptr<PendingCheckpoint>& checkpoint : gPendingCheckpoints)
+	{
+		gCheckpointStats.roundTripSeconds += checkpoint->seconds;
+		if (checkpoint->result == eOmniClientResult_Ok)
+		{
+			gCheckpointStats.created++;
+			continue;
+		}
+		gCheckpointStats.failed++;
+		std::unique_lock<std::mutex> lk(gLogMutex);
+		std::cout << "Checkpoint <" << checkpoint->comment << "> failed: "
+			<< omniClientGetResultString(checkpoint->result) << std::endl;
+	}
+	gPendingCheckpoints.clear();
+}
+
+// Save the stage and flush the live updates, unless a batch defers them
+static void commitStage()
+{
+	if (AuthoringBatch* batch = AuthoringBatch::current())
+	{
+		batch->deferCommit();
+		return;
+	}
+
+	// A checkpoint captures whatever the file holds when the server gets to it,
+	// so the checkpoints of the previous save have to finish before this one
+	waitForCheckpoints();
+
+	Clock::time_point saveStart = Clock::now();
+	{
+		MemoryScope memoryScope(eMemorySubsystem_Export);
+		gStage->Save();
+	}
+	{
+		MemoryScope memoryScope(eMemorySubsystem_LiveProcessing);
+		omniUsdLiveProcess();
+	}
+	gAuthoringStats.saveSeconds += secondsSince(saveStart);
+	gAuthoringStats.saves++;
+}
+
+void AuthoringBatch::commit()
+{
+	if (sCurrent != this)
+	{
+		return;
+	}
+	sCurrent = nullptr;
+	if (mDeferredCommits > 0)
+	{
+		gAuthoringStats.savesAvoided += mDeferredCommits - 1;
+		commitStage();
+	}
+	mDeferredCommits = 0;
+}
+
+// Print the saves of the scene build and, when batched, roughly how long the avoided ones would have taken
+static void printAuthoringStats(double buildSeconds)
+{
+	std::unique_lock<std::mutex> lk(gLogMutex);
+	std::cout << "Scene build: " << buildSeconds << " s, " << gAuthoringStats.saves << " saves taking "
+		<< gAuthoringStats.saveSeconds << " s";
+	if (gAuthoringStats.savesAvoided > 0 && gAuthoringStats.saves > 0)
+	{
+		// Not measured, the unbatched saves would each write a smaller layer than the batched ones
+		const double secondsPerSave = gAuthoringStats.saveSeconds / gAuthoringStats.saves;
+		std::cout << ", " << gAuthoringStats.savesAvoided << " saves avoided (estimated "
+			<< secondsPerSave * gAuthoringStats.savesAvoided << " s at the average save time)";
+	}
+	std::cout << std::endl;
+}
+
 // Multiplatform array size
 #define HW_ARRAY_COUNT(array) (sizeof(array) / sizeof(array[0]))
 
@@ -116,6 +303,11 @@ static std::mutex gLogMutex;
 TF_DEFINE_PRIVATE_TOKENS(
 	_tokens,
 	(box)
+	(Bodies)
+	(LiveEdit)
+	(Body)
+	(Geometry)
+	(Prototypes)
 	(DistantLight)
 	(DomeLight)
 	(Looks)
@@ -181,6 +373,18 @@ static void shutdownOmniverse()
 	// Calling this prior to shutdown ensures that all pending live updates complete.
 	omniUsdLiveWaitForPendingUpdates();
 
+	// Join the checkpoints still in flight.  The difference between their round
+	// trips and the time spent waiting for them is what blocking on each would have cost.
+	waitForCheckpoints();
+	if (gCheckpointStats.created + gCheckpointStats.failed > 0)
+	{
+		std::unique_lock<std::mutex> lk(gLogMutex);
+		std::cout << "Checkpoints: " << gCheckpointStats.created << " created, " << gCheckpointStats.failed << " failed, "
+			<< gCheckpointStats.roundTripSeconds << " s of round trips, " << gCheckpointStats.blockedSeconds
+			<< " s waited, " << std::max(0.0, gCheckpointStats.roundTripSeconds - gCheckpointStats.blockedSeconds)
+			<< " s taken off the critical path" << std::endl;
+	}
+
 	// The stage is a sophisticated object that needs to be destroyed properly.  
 	// Since gStage is a smart pointer we can just reset it
 	gStage.Reset();
@@ -241,7 +445,10 @@ static std::string createOmniverseModel(const std::string& destinationPath)
 	}
 
 	// Create this file in Omniverse cleanly
-	gStage = UsdStage::CreateNew(stageUrl);
+	{
+		MemoryScope memoryScope(eMemorySubsystem_StageOpen);
+		gStage = UsdStage::CreateNew(stageUrl);
+	}
 	if (!gStage)
 	{
 		failNotify("Failure to create model in Omniverse", stageUrl.c_str());
@@ -265,6 +472,8 @@ static std::string createOmniverseModel(const std::string& destinationPath)
 // This function will add a commented checkpoint to a file on Nucleus if:
 //   Live mode is disabled (live checkpoints are ill-supported)
 //   The Nucleus server supports checkpoints
+// The checkpoint is created in the background against the last save, the next
+// commitStage() or shutdownOmniverse() waits for it.
 static void checkpointFile(const std::string& stageUrl, const char* comment)
 {
 	if (omniUsdLiveGetDefaultEnabled())
@@ -272,23 +481,38 @@ static void checkpointFile(const std::string& stageUrl, const char* comment)
 		return;
 	}
 
-	bool bCheckpointsSupported = false;
-	omniClientWait(omniClientGetServerInfo(stageUrl.c_str(), &bCheckpointsSupported, 
-		[](void* UserData, OmniClientResult Result, OmniClientServerInfo const * Info) noexcept
-		{
-			if (Result == eOmniClientResult_Ok && Info && UserData)
+	// Every checkpoint of this sample goes to the same server, so ask it only once
+	static bool bServerQueried = false;
+	static bool bCheckpointsSupported = false;
+	if (!bServerQueried)
+	{
+		bServerQueried = true;
+		omniClientWait(omniClientGetServerInfo(stageUrl.c_str(), &bCheckpointsSupported,
+			[](void* UserData, OmniClientResult Result, OmniClientServerInfo const * Info) noexcept
 			{
-				bool* bCheckpointsSupported = static_cast<bool*>(UserData);
-				*bCheckpointsSupported = Info->checkpointsEnabled;
-			}
-		}));
+				if (Result == eOmniClientResult_Ok && Info && UserData)
+				{
+					bool* bCheckpointsSupported = static_cast<bool*>(UserData);
+					*bCheckpointsSupported = Info->checkpointsEnabled;
+				}
+			}));
+	}
 
 	if (bCheckpointsSupported)
 	{
+		gPendingCheckpoints.emplace_back(new PendingCheckpoint());
+		PendingCheckpoint* checkpoint = gPendingCheckpoints.back().get();
+		checkpoint->comment = comment;
+		checkpoint->issued = Clock::now();
+
 		const bool bForceCheckpoint = true;
-		omniClientWait(omniClientCreateCheckpoint(stageUrl.c_str(), comment, bForceCheckpoint, nullptr, 
+		checkpoint->request = omniClientCreateCheckpoint(stageUrl.c_str(), comment, bForceCheckpoint, checkpoint,
 		[](void* userData, OmniClientResult result, char const * checkpointQuery) noexcept
-		{}));
+		{
+			PendingCheckpoint* checkpoint = static_cast<PendingCheckpoint*>(userData);
+			checkpoint->result = result;
+			checkpoint->seconds = secondsSince(checkpoint->issued);
+		});
 
 		std::unique_lock<std::mutex> lk(gLogMutex);
 		std::cout << "Adding checkpoint comment <" << comment << "> to stage <" << stageUrl <<">" << std::endl;
@@ -371,8 +595,7 @@ static void createDynamicCube(const SdfPath& rootPrimPath, double size)
 	enablePhysics(cube.GetPrim(), true);
 
 	// Commit the changes to the USD
-	gStage->Save();
-	omniUsdLiveProcess();
+	commitStage();
 }
 
 // Create a simple quad in USD with normals and add a collider
@@ -419,19 +642,14 @@ static void createQuad(const SdfPath& rootPrimPath, double size)
 	enablePhysics(mesh.GetPrim(), false);
 
 	// Commit the changes to the USD
-	gStage->Save();
-	omniUsdLiveProcess();
+	commitStage();
 }
 
-// Create a simple box in USD with normals and UV information
-double h = 50.0;
-int gBoxVertexIndices[] = { 0, 1, 2, 1, 3, 2, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11, 12, 13, 14, 12, 14, 15, 16, 17, 18, 16, 18, 19, 20, 21, 22, 20, 22, 23 };
-double gBoxNormals[][3] = { {0, 0, -1}, {0, 0, -1}, {0, 0, -1}, {0, 0, -1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, -1, 0}, {0, -1, 0}, {0, -1, 0}, {0, -1, 0}, {1, 0, 0}, {1, 0, 0}, {1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 1, 0}, {0, 1, 0}, {0, 1, 0}, {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0} };
-double gBoxPoints[][3] = { {h, -h, -h}, {-h, -h, -h}, {h, h, -h}, {-h, h, -h}, {h, h, h}, {-h, h, h}, {-h, -h, h}, {h, -h, h}, {h, -h, h}, {-h, -h, h}, {-h, -h, -h}, {h, -h, -h}, {h, h, h}, {h, -h, h}, {h, -h, -h}, {h, h, -h}, {-h, h, h}, {h, h, h}, {h, h, -h}, {-h, h, -h}, {-h, -h, h}, {-h, h, h}, {-h, h, -h}, {-h, -h, -h} };
-float gBoxUV[][2] = { {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0} };
-
+// Create a simple box in USD with normals and UV information, see BoxGeometry.h
 static UsdGeomMesh createBox(const SdfPath& rootPrimPath, int boxNumber=0)
 {
+	MemoryScope memoryScope(eMemorySubsystem_GeometryAuthoring);
+
 	// Create the geometry inside of "Root"
 	std::string boxName("box_");
 	boxName.append(std::to_string(boxNumber));
@@ -444,65 +662,17 @@ static UsdGeomMesh createBox(const SdfPath& rootPrimPath, int boxNumber=0)
 	// Set orientation
 	mesh.CreateOrientationAttr(VtValue(UsdGeomTokens->rightHanded));
 
-	// Add all of the vertices
-	int num_vertices = HW_ARRAY_COUNT(gBoxPoints);
-	VtArray<GfVec3f> points;
-	points.resize(num_vertices);
-	for (int i = 0; i < num_vertices; i++)
-	{
-		points[i] = GfVec3f(gBoxPoints[i][0], gBoxPoints[i][1], gBoxPoints[i][2]);
-	}
-	mesh.CreatePointsAttr(VtValue(points));
-
-	// Calculate indices for each triangle
-	int num_indices = HW_ARRAY_COUNT(gBoxVertexIndices); // 2 Triangles per face * 3 Vertices per Triangle * 6 Faces
-	VtArray<int> vecIndices;
-	vecIndices.resize(num_indices);
-	for (int i = 0; i < num_indices; i++)
-	{
-		vecIndices[i] = gBoxVertexIndices[i];
-	}
-	mesh.CreateFaceVertexIndicesAttr(VtValue(vecIndices));
-
-	// Add vertex normals
-	int num_normals = HW_ARRAY_COUNT(gBoxNormals);
-	VtArray<GfVec3f> meshNormals;
-	meshNormals.resize(num_vertices);
-	for (int i = 0; i < num_vertices; i++)
-	{
-		meshNormals[i] = GfVec3f((float)gBoxNormals[i][0], (float)gBoxNormals[i][1], (float)gBoxNormals[i][2]);
-	}
-	mesh.CreateNormalsAttr(VtValue(meshNormals));
-
-	// Add face vertex count
-	VtArray<int> faceVertexCounts;
-	faceVertexCounts.resize(12); // 2 Triangles per face * 6 faces
-	std::fill(faceVertexCounts.begin(), faceVertexCounts.end(), 3);
-	mesh.CreateFaceVertexCountsAttr(VtValue(faceVertexCounts));
-
-	// Set the color on the mesh
-	UsdPrim meshPrim = mesh.GetPrim();
-	UsdAttribute displayColorAttr = mesh.CreateDisplayColorAttr();
-	{
-		VtVec3fArray valueArray;
-		GfVec3f rgbFace(0.463f, 0.725f, 0.0f);
-		valueArray.push_back(rgbFace);
-		displayColorAttr.Set(valueArray);
-	}
+	// The box is at the origin, so all of its arrays are the shared ones
+	const BoxMeshValues& values = boxMeshValues();
+	mesh.CreatePointsAttr(values.points);
+	mesh.CreateFaceVertexIndicesAttr(values.faceVertexIndices);
+	mesh.CreateFaceVertexCountsAttr(values.faceVertexCounts);
+	mesh.CreateNormalsAttr(values.normals);
+	mesh.CreateDisplayColorAttr(values.displayColor);
 
 	// Set the UV (st) values for this mesh
 	UsdGeomPrimvar attr2 = mesh.CreatePrimvar(_tokens->st, SdfValueTypeNames->TexCoord2fArray);
-	{
-		int uv_count = HW_ARRAY_COUNT(gBoxUV);
-		VtVec2fArray valueArray;
-		valueArray.resize(uv_count);
-		for (int i = 0; i < uv_count; ++i)
-		{
-			valueArray[i].Set(gBoxUV[i]);
-		}
-
-		bool status = attr2.Set(valueArray);
-	}
+	attr2.Set(values.st);
 	attr2.SetInterpolation(UsdGeomTokens->vertex);
 
 	// Move it up
@@ -513,8 +683,7 @@ static UsdGeomMesh createBox(const SdfPath& rootPrimPath, int boxNumber=0)
 	enablePhysics(mesh.GetPrim(), true);
 
 	// Commit the changes to the USD
-	gStage->Save();
-	omniUsdLiveProcess();
+	commitStage();
 
 	return mesh;
 }
@@ -522,8 +691,8 @@ static UsdGeomMesh createBox(const SdfPath& rootPrimPath, int boxNumber=0)
 // Opens an existing stage and finds the first UsdGeomMesh
 static UsdGeomMesh findGeomMesh(const std::string& existingStage)
 {
-	// Open this file from Omniverse
-	gStage = UsdStage::Open(existingStage);
+	// Open this file from Omniverse, fetching its dependencies concurrently first
+	gStage = openStageWithPrefetch(existingStage);
 	if (!gStage)
 	{
 		failNotify("Failure to open stage in Omniverse:", existingStage.c_str());
@@ -565,26 +734,24 @@ static void uploadMaterial(const std::string& destinationPath)
 {
 	std::string uriPath = destinationPath + "/Materials";
 
-	// Delete the old version of this folder on Omniverse and wait for the operation to complete
-	{
-		std::unique_lock<std::mutex> lk(gLogMutex);
-		std::cout << "Waiting for " << uriPath << " to delete... ";
-	}
-	omniClientWait(omniClientDelete(uriPath.c_str(), nullptr, nullptr));
-	{
-		std::unique_lock<std::mutex> lk(gLogMutex);
-		std::cout << "finished" << std::endl;
-	}
-
-	// Upload the material folder (MDL and textures)
+	// Upload the material folder (MDL and textures).  Only files that changed
+	// since the last run are sent, see AssetUpload.h.
 	{
 		std::unique_lock<std::mutex> lk(gLogMutex);
 		std::cout << "Waiting for the resources/Materials folder to upload to " << uriPath << " ... ";
 	}
-	omniClientWait(omniClientCopy("resources/Materials", uriPath.c_str(), nullptr, nullptr));
+	AssetUploadResult upload = uploadChangedAssets("resources/Materials", uriPath);
 	{
 		std::unique_lock<std::mutex> lk(gLogMutex);
 		std::cout << "finished" << std::endl;
+		std::cout << "    " << upload.fileCount << " files (" << std::fixed << std::setprecision(1) << upload.fileBytes / 1e6 << " MB) hashed in "
+			<< std::setprecision(3) << upload.hashSeconds << " s, " << upload.uploadedCount << " uploaded ("
+			<< std::setprecision(1) << upload.uploadedBytes / 1e6 << " MB), " << upload.unchangedCount << " unchanged, "
+			<< std::setprecision(3) << upload.seconds << " s total" << std::defaultfloat << std::endl;
+		if (upload.failedCount > 0)
+		{
+			std::cout << "    " << upload.failedCount << " files failed to upload" << std::endl;
+		}
 	}
 }
 
@@ -675,8 +842,7 @@ static void createMaterial(UsdGeomMesh meshIn)
 	usdMaterialBinding.Bind(newMat);
 
 	// Commit the changes to the USD
-	gStage->Save();
-	omniUsdLiveProcess();
+	commitStage();
 }
 
 // Create a light source in the scene.
@@ -695,8 +861,7 @@ static void createDistantLight()
 	newLight.CreateIntensityAttr(VtValue(5000.0f));
 
 	// Commit the changes to the USD
-	gStage->Save();
-	omniUsdLiveProcess();
+	commitStage();
 }
 
 // Create a light source in the scene.
@@ -721,8 +886,7 @@ static void createDomeLight(const std::string& texturePath)
 	rotateOp.Set(rotXYZ);
 
 	// Commit the changes to the USD
-	gStage->Save();
-	omniUsdLiveProcess();
+	commitStage();
 }
 
 // Create an empty folder, just as an example.
@@ -748,6 +912,73 @@ static void createEmptyFolder(const std::string& emptyFolderPath)
 	}
 }
 
+// Set the translate, rotateXYZ and scale ops of a prim one at a time, adding
+// the missing ones and rewriting the op order.  This is the per keystroke path
+// of liveEdit, BulkXformUpdater does the same for many prims at once.
+static void setXformOps(UsdGeomXformable xForm, const GfVec3d& position, const GfVec3d& rotXYZ, const GfVec3d& scale, bool logOps)
+{
+	UsdGeomXformOp translateOp;
+	UsdGeomXformOp rotateOp;
+	UsdGeomXformOp scaleOp;
+	bool resetXformStack = false;
+	for (const UsdGeomXformOp& op : xForm.GetOrderedXformOps(&resetXformStack))
+	{
+		switch (op.GetOpType()) {
+		case UsdGeomXformOp::TypeTranslate:
+			translateOp = op;
+			break;
+		case UsdGeomXformOp::TypeRotateXYZ:
+			rotateOp = op;
+			break;
+		case UsdGeomXformOp::TypeScale:
+			scaleOp = op;
+			break;
+		default:
+			break;
+		}
+	}
+
+	// A utility class to set the position, rotation, or scale values
+	class SetOp
+	{
+	public:
+		SetOp(UsdGeomXformable& xForm, UsdGeomXformOp& op, UsdGeomXformOp::Type opType, const GfVec3d& value, const UsdGeomXformOp::Precision precision, bool logOps)
+		{
+			if (!op)
+			{
+				op = xForm.AddXformOp(opType, precision);
+				if (logOps)
+				{
+					std::unique_lock<std::mutex> lk(gLogMutex);
+					std::cout << " Adding " << UsdGeomXformOp::GetOpTypeToken(opType) << std::endl;
+				}
+			}
+
+			if (op.GetPrecision() == UsdGeomXformOp::Precision::PrecisionFloat)
+				op.Set(GfVec3f(value));
+			else
+				op.Set(value);
+
+			if (logOps)
+			{
+				std::unique_lock<std::mutex> lk(gLogMutex);
+				std::cout << " Setting " << UsdGeomXformOp::GetOpTypeToken(opType) << std::endl;
+			}
+		}
+	};
+
+	SetOp(xForm, translateOp, UsdGeomXformOp::TypeTranslate, position, UsdGeomXformOp::Precision::PrecisionDouble, logOps);
+	SetOp(xForm, rotateOp, UsdGeomXformOp::TypeRotateXYZ, rotXYZ, UsdGeomXformOp::Precision::PrecisionDouble, logOps);
+	SetOp(xForm, scaleOp, UsdGeomXformOp::TypeScale, scale, UsdGeomXformOp::Precision::PrecisionDouble, logOps);
+
+	// Make sure the xform op order is correct (translate, rotate, scale)
+	std::vector<UsdGeomXformOp> xFormOpsReordered;
+	xFormOpsReordered.push_back(translateOp);
+	xFormOpsReordered.push_back(rotateOp);
+	xFormOpsReordered.push_back(scaleOp);
+	xForm.SetXformOpOrder(xFormOpsReordered);
+}
+
 // Perform a live edit on the box
 static void liveEdit(UsdGeomMesh meshIn)
 {
@@ -821,39 +1052,7 @@ static void liveEdit(UsdGeomMesh meshIn)
 			position += GfVec3d(x, 0, y);
 			rotXYZ = GfVec3d(rotXYZ[0], angle, rotXYZ[2]);
 
-			// A utility class to set the position, rotation, or scale values
-			class SetOp
-			{
-			public:
-				SetOp(UsdGeomXformable& xForm, UsdGeomXformOp& op, UsdGeomXformOp::Type opType, const GfVec3d& value, const UsdGeomXformOp::Precision precision)
-				{
-					if (!op)
-					{
-						op = xForm.AddXformOp(opType, precision);
-						std::unique_lock<std::mutex> lk(gLogMutex);
-						std::cout << " Adding " << UsdGeomXformOp::GetOpTypeToken(opType) << std::endl;
-					}
-
-					if (op.GetPrecision() == UsdGeomXformOp::Precision::PrecisionFloat)
-						op.Set(GfVec3d(value));
-					else
-						op.Set(value);
-
-					std::unique_lock<std::mutex> lk(gLogMutex);
-					std::cout << " Setting " << UsdGeomXformOp::GetOpTypeToken(opType) << std::endl;
-				}
-			};
-
-			SetOp(xForm, translateOp, UsdGeomXformOp::TypeTranslate, position, UsdGeomXformOp::Precision::PrecisionDouble);
-			SetOp(xForm, rotateOp, UsdGeomXformOp::TypeRotateXYZ, rotXYZ, UsdGeomXformOp::Precision::PrecisionDouble);
-			SetOp(xForm, scaleOp, UsdGeomXformOp::TypeScale, scale, UsdGeomXformOp::Precision::PrecisionDouble);
-
-			// Make sure the xform op order is correct (translate, rotate, scale)
-			std::vector<UsdGeomXformOp> xFormOpsReordered;
-			xFormOpsReordered.push_back(translateOp);
-			xFormOpsReordered.push_back(rotateOp);
-			xFormOpsReordered.push_back(scaleOp);
-			xForm.SetXformOpOrder(xFormOpsReordered);
+			setXformOps(xForm, position, rotXYZ, scale, true);
 
 			// Commit the change to USD
 			gStage->Save();
@@ -870,6 +1069,334 @@ static void liveEdit(UsdGeomMesh meshIn)
 	}
 }
 
+// What one stress scene took to author and save
+struct StressSceneStats
+{
+	size_t bodyCount = 0;
+	double authorSeconds = 0.0;
+	double saveSeconds = 0.0;
+	uint64_t fileBytes = 0;
+};
+
+// Size of a file on the server (or disk), 0 if it can't be found
+static uint64_t getFileSize(const std::string& url)
+{
+	uint64_t size = 0;
+	omniClientWait(omniClientStat(url.c_str(), &size, [](void* userData, OmniClientResult result, OmniClientListEntry const* entry) noexcept
+		{
+			if (result == eOmniClientResult_Ok && entry)
+			{
+				*static_cast<uint64_t*>(userData) = entry->size;
+			}
+		}));
+	return size;
+}
+
+// Create a stage with bodyCount dynamic rigid bodies dropping onto a ground quad.
+// The bodies are instances of one prototype cube that carries the collider, and
+// are authored straight into the layer in a single change block with random
+// (but seeded) positions and orientations.
+static StressSceneStats createStressScene(const std::string& destinationPath, size_t bodyCount, unsigned seed)
+{
+	StressSceneStats stats;
+	stats.bodyCount = bodyCount;
+	const std::string stageUrl = destinationPath + "/stress_" + std::to_string(bodyCount) + ".usd";
+	omniClientWait(omniClientDelete(stageUrl.c_str(), nullptr, nullptr));
+	gStage = UsdStage::CreateNew(stageUrl);
+	if (!gStage)
+	{
+		failNotify("Failure to create stress scene in Omniverse", stageUrl.c_str());
+		return stats;
+	}
+	UsdGeomSetStageUpAxis(gStage, UsdGeomTokens->y);
+	UsdGeomSetStageMetersPerUnit(gStage, 0.01);
+
+	// The bodies fill a jittered cube of cells above the ground
+	const double bodySize = 50.0;
+	const double spacing = bodySize * 3.0;
+	const size_t cellsPerSide = size_t(std::ceil(std::cbrt(double(bodyCount))));
+	const double halfWidth = 0.5 * spacing * double(cellsPerSide);
+
+	// The scene, ground and prototype are few prims, the regular Usd API is fine for them
+	const SdfPath rootPrimPath = SdfPath::AbsoluteRootPath().AppendChild(_tokens->Root);
+	const SdfPath prototypePath = rootPrimPath.AppendChild(_tokens->Prototypes).AppendChild(_tokens->Body);
+	{
+		AuthoringBatch batch(true);
+		gStage->SetDefaultPrim(UsdGeomXform::Define(gStage, rootPrimPath).GetPrim());
+		createPhysicsScene(rootPrimPath);
+		createQuad(rootPrimPath, halfWidth + spacing);
+
+		// A class prim isn't drawn or simulated itself, only through the instances
+		gStage->CreateClassPrim(prototypePath.GetParentPath());
+		UsdGeomXform::Define(gStage, prototypePath);
+		UsdGeomCube cube = UsdGeomCube::Define(gStage, prototypePath.AppendChild(_tokens->Geometry));
+		cube.GetSizeAttr().Set(bodySize);
+		enablePhysics(cube.GetPrim(), false);
+	}
+
+	// The rigid body API schema list, as UsdPhysicsRigidBodyAPI::Apply() authors it
+	UsdStageRefPtr templateStage = UsdStage::CreateInMemory();
+	UsdPrim templatePrim = UsdGeomXform::Define(templateStage, prototypePath).GetPrim();
+	UsdPhysicsRigidBodyAPI::Apply(templatePrim);
+	const VtValue apiSchemas = templateStage->GetRootLayer()->GetPrimAtPath(prototypePath)->GetInfo(UsdTokens->apiSchemas);
+
+	// Author the bodies in the layer without a stage on it, so nothing recomposes
+	SdfLayerRefPtr layer = gStage->GetRootLayer();
+	gStage.Reset();
+
+	const TfToken translateName = UsdGeomXformOp::GetOpName(UsdGeomXformOp::TypeTranslate);
+	const TfToken orientName = UsdGeomXformOp::GetOpName(UsdGeomXformOp::TypeOrient);
+	const VtTokenArray xformOpOrder = { translateName, orientName };
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> jitter(-0.25 * spacing, 0.25 * spacing);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	Clock::time_point authorStart = Clock::now();
+	{
+		SdfChangeBlock changeBlock;
+		SdfPrimSpecHandle bodiesSpec = SdfPrimSpec::New(layer->GetPrimAtPath(rootPrimPath), _tokens->Bodies.GetString(),
+			SdfSpecifierDef, UsdGeomTokens->Xform.GetString());
+		for (size_t i = 0; i < bodyCount; i++)
+		{
+			SdfPrimSpecHandle body = SdfPrimSpec::New(bodiesSpec, "body_" + std::to_string(i), SdfSpecifierDef, UsdGeomTokens->Xform.GetString());
+			body->SetInstanceable(true);
+			body->GetReferenceList().Prepend(SdfReference(std::string(), prototypePath));
+			body->SetInfo(UsdTokens->apiSchemas, apiSchemas);
+
+			const size_t column = i % cellsPerSide;
+			const size_t row = (i / cellsPerSide) % cellsPerSide;
+			const size_t level = i / (cellsPerSide * cellsPerSide);
+			const GfVec3d position(double(column) * spacing - halfWidth + jitter(random),
+				double(level) * spacing + spacing + jitter(random),
+				double(row) * spacing - halfWidth + jitter(random));
+
+			// Uniformly distributed random rotation
+			const float u1 = unit(random);
+			const float u2 = unit(random) * 6.2831853f;
+			const float u3 = unit(random) * 6.2831853f;
+			const float a = std::sqrt(1.0f - u1);
+			const float b = std::sqrt(u1);
+			const GfQuatf orientation(a * std::cos(u2), a * std::sin(u2), b * std::sin(u3), b * std::cos(u3));
+
+			SdfAttributeSpec::New(body, translateName.GetString(), SdfValueTypeNames->Double3)->SetDefaultValue(VtValue(position));
+			SdfAttributeSpec::New(body, orientName.GetString(), SdfValueTypeNames->Quatf)->SetDefaultValue(VtValue(orientation));
+			SdfAttributeSpec::New(body, UsdGeomTokens->xformOpOrder.GetString(), SdfValueTypeNames->TokenArray, SdfVariabilityUniform)->SetDefaultValue(VtValue(xformOpOrder));
+		}
+	}
+	stats.authorSeconds = secondsSince(authorStart);
+
+	Clock::time_point saveStart = Clock::now();
+	layer->Save();
+	stats.saveSeconds = secondsSince(saveStart);
+	stats.fileBytes = getFileSize(stageUrl);
+
+	std::unique_lock<std::mutex> lk(gLogMutex);
+	std::cout << "Stress scene " << stageUrl << ": " << bodyCount << " bodies authored in " << stats.authorSeconds
+		<< " s, saved in " << stats.saveSeconds << " s" << std::endl;
+	return stats;
+}
+
+// Print the stress scene results side by side
+static void printStressSceneStats(const std::vector<StressSceneStats>& results)
+{
+	std::unique_lock<std::mutex> lk(gLogMutex);
+	std::cout << std::setw(10) << "bodies" << std::setw(12) << "author s" << std::setw(12) << "bodies/s"
+		<< std::setw(10) << "save s" << std::setw(12) << "file MB" << std::setw(12) << "bytes/body" << std::endl;
+	for (const StressSceneStats& stats : results)
+	{
+		std::cout << std::fixed << std::setw(10) << stats.bodyCount << std::setprecision(3) << std::setw(12) << stats.authorSeconds
+			<< std::setprecision(0) << std::setw(12) << (stats.authorSeconds > 0.0 ? stats.bodyCount / stats.authorSeconds : 0.0)
+			<< std::setprecision(3) << std::setw(10) << stats.saveSeconds
+			<< std::setprecision(2) << std::setw(12) << stats.fileBytes / (1024.0 * 1024.0)
+			<< std::setprecision(0) << std::setw(12) << (stats.bodyCount ? double(stats.fileBytes) / stats.bodyCount : 0.0) << std::endl;
+	}
+	std::cout << std::defaultfloat;
+}
+
+// Where a driven prim started and its phase along the circle
+struct LiveEditTarget
+{
+	GfVec3d origin;
+	double phase = 0.0;
+};
+
+// Gather up to primCount gprims to drive, adding small cubes under the default
+// prim (or /Root) when the stage doesn't have enough of them.  Their op stacks
+// are validated once by the updater, targets[i] goes with its i-th prim.
+static std::vector<LiveEditTarget> gatherLiveEditTargets(size_t primCount, BulkXformUpdater& updater)
+{
+	std::vector<UsdPrim> prims;
+	for (const UsdPrim& prim : gStage->Traverse())
+	{
+		if (prims.size() == primCount)
+			break;
+		if (prim.IsA<UsdGeomGprim>() && !prim.IsInstanceProxy())
+			prims.push_back(prim);
+	}
+
+	const UsdPrim defaultPrim = gStage->GetDefaultPrim();
+	const SdfPath parentPath = (defaultPrim ? defaultPrim.GetPath() : SdfPath::AbsoluteRootPath().AppendChild(_tokens->Root)).AppendChild(_tokens->LiveEdit);
+	for (size_t i = prims.size(), added = 0; i < primCount; i++, added++)
+	{
+		UsdGeomCube cube = UsdGeomCube::Define(gStage, parentPath.AppendChild(TfToken("cube_" + std::to_string(added))));
+		cube.GetSizeAttr().Set(10.0);
+		cube.AddTranslateOp(UsdGeomXformOp::PrecisionDouble).Set(GfVec3d(double(added % 32) * 20.0, 50.0, double(added / 32) * 20.0));
+		prims.push_back(cube.GetPrim());
+	}
+
+	updater.prepare(prims);
+	for (const auto& rejected : updater.rejected())
+	{
+		std::unique_lock<std::mutex> lk(gLogMutex);
+		std::cout << "Skipping " << rejected.first << ": " << rejected.second << std::endl;
+	}
+
+	std::vector<LiveEditTarget> targets(updater.size());
+	for (size_t i = 0; i < targets.size(); i++)
+	{
+		GfMatrix4d localTransform(1.0);
+		bool resetXformStack = false;
+		UsdGeomXformable(gStage->GetPrimAtPath(updater.primPath(i))).GetLocalTransformation(&localTransform, &resetXformStack);
+		targets[i].origin = localTransform.ExtractTranslation();
+		targets[i].phase = double(i) * 0.61803398875 * 6.2831853;
+	}
+	commitStage();
+	omniUsdLiveWaitForPendingUpdates();
+	return targets;
+}
+
+// Move primCount prims along circles for duration seconds at editsPerSecond
+// (as fast as possible when 0), one change block and one flush per frame, then
+// print the edit rate and how long each frame took from the first edit until
+// the live updates were sent
+static void runLiveEditThroughput(size_t primCount, double editsPerSecond, double duration)
+{
+	BulkXformUpdater updater(gStage);
+	std::vector<LiveEditTarget> targets = gatherLiveEditTargets(primCount, updater);
+	std::vector<XformSrt> values(targets.size());
+	{
+		std::unique_lock<std::mutex> lk(gLogMutex);
+		std::cout << "Driving " << targets.size() << " prims for " << duration << " s";
+		if (editsPerSecond > 0.0)
+			std::cout << " at " << editsPerSecond << " edits/s";
+		std::cout << std::endl;
+	}
+
+	const double frameSeconds = editsPerSecond > 0.0 ? double(targets.size()) / editsPerSecond : 0.0;
+	std::vector<double> latencies;
+	size_t edits = 0;
+	const Clock::time_point start = Clock::now();
+	Clock::time_point nextFrame = start;
+	while (secondsSince(start) < duration)
+	{
+		if (frameSeconds > 0.0)
+		{
+			std::this_thread::sleep_until(nextFrame);
+			nextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frameSeconds));
+		}
+
+		const Clock::time_point frameStart = Clock::now();
+		const double time = std::chrono::duration<double>(frameStart - start).count();
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			const double angle = time + targets[i].phase;
+			values[i].translate = targets[i].origin + GfVec3d(std::sin(angle) * 100.0, std::sin(angle * 2.0) * 20.0, std::cos(angle) * 100.0);
+			values[i].rotateXYZ = GfVec3f(0.0f, float(std::fmod(angle * 57.29578, 360.0)), 0.0f);
+		}
+		{
+			MemoryScope memoryScope(eMemorySubsystem_LiveProcessing);
+			updater.write(values, eXformChannel_Translate | eXformChannel_Rotate);
+			gStage->Save();
+			omniUsdLiveProcess();
+			omniUsdLiveWaitForPendingUpdates();
+		}
+		latencies.push_back(secondsSince(frameStart));
+		edits += targets.size();
+	}
+	const double elapsed = secondsSince(start);
+
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&latencies](double fraction)
+	{
+		return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, size_t(fraction * double(latencies.size())))] * 1000.0;
+	};
+	std::unique_lock<std::mutex> lk(gLogMutex);
+	std::cout << std::fixed << std::setprecision(1) << "Live edits: " << edits << " in " << elapsed << " s, "
+		<< double(edits) / elapsed << " edits/s over " << latencies.size() << " frames" << std::endl;
+	std::cout << std::setprecision(2) << "Edit to flush latency: p50 " << percentile(0.5) << " ms, p95 " << percentile(0.95)
+		<< " ms, max " << percentile(1.0) << " ms" << std::endl;
+	std::cout << std::defaultfloat;
+}
+
+// Move primCount prims for a number of frames, once with setXformOps() per prim
+// (the liveEdit path) and once with BulkXformUpdater, and print the time per
+// frame of each.  The stage is in memory, so only the authoring is measured.
+static void runXformBenchmark(size_t primCount)
+{
+	UsdStageRefPtr stage = UsdStage::CreateInMemory();
+	const SdfPath parentPath = SdfPath::AbsoluteRootPath().AppendChild(_tokens->Root).AppendChild(_tokens->LiveEdit);
+	std::vector<UsdPrim> prims;
+	for (size_t i = 0; i < primCount; i++)
+	{
+		UsdGeomCube cube = UsdGeomCube::Define(stage, parentPath.AppendChild(TfToken("cube_" + std::to_string(i))));
+		cube.AddTranslateOp(UsdGeomXformOp::PrecisionDouble).Set(GfVec3d(double(i % 32) * 20.0, 50.0, double(i / 32) * 20.0));
+		prims.push_back(cube.GetPrim());
+	}
+
+	std::vector<XformSrt> values(primCount);
+	auto frameValues = [&values](int frame)
+	{
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			const double angle = frame * 0.1 + double(i) * 0.61803398875 * 6.2831853;
+			values[i].translate = GfVec3d(double(i % 32) * 20.0 + std::sin(angle) * 100.0, 50.0, double(i / 32) * 20.0 + std::cos(angle) * 100.0);
+			values[i].rotateXYZ = GfVec3f(0.0f, float(std::fmod(angle * 57.29578, 360.0)), 0.0f);
+		}
+	};
+
+	// Run frames for about a second, after one warm up frame that adds the ops
+	auto timeFrames = [&frameValues](const std::function<void()>& writeFrame)
+	{
+		frameValues(0);
+		writeFrame();
+		int frames = 0;
+		const Clock::time_point start = Clock::now();
+		while (frames < 3 || secondsSince(start) < 1.0)
+		{
+			frameValues(++frames);
+			writeFrame();
+		}
+		return secondsSince(start) / frames;
+	};
+
+	const double setOpSeconds = timeFrames([&]()
+	{
+		for (size_t i = 0; i < prims.size(); i++)
+		{
+			setXformOps(UsdGeomXformable(prims[i]), values[i].translate, GfVec3d(values[i].rotateXYZ), GfVec3d(values[i].scale), false);
+		}
+	});
+
+	BulkXformUpdater updater(stage);
+	const Clock::time_point prepareStart = Clock::now();
+	updater.prepare(prims);
+	const double prepareSeconds = secondsSince(prepareStart);
+	const double bulkSeconds = timeFrames([&]()
+	{
+		updater.write(values);
+	});
+
+	std::unique_lock<std::mutex> lk(gLogMutex);
+	std::cout << "Xform updates of " << primCount << " prims, time per frame:" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "  SetOp per prim:  " << std::setw(10) << setOpSeconds * 1000.0 << " ms  (" << std::setprecision(0)
+		<< primCount / setOpSeconds << " prims/s)" << std::endl;
+	std::cout << std::setprecision(3) << "  bulk update:     " << std::setw(10) << bulkSeconds * 1000.0 << " ms  (" << std::setprecision(0)
+		<< primCount / bulkSeconds << " prims/s), " << std::setprecision(3) << prepareSeconds * 1000.0 << " ms to prepare once" << std::endl;
+	std::cout << std::setprecision(1) << "  speedup:         " << std::setw(10) << setOpSeconds / bulkSeconds << "x" << std::endl;
+	std::cout << std::defaultfloat;
+}
+
 // Returns true if the provided maybeURL contains a host and path
 static bool isValidOmniURL(const std::string& maybeURL)
 {
@@ -895,18 +1422,43 @@ static void printCmdLineArgHelp()
 	std::cout << "    -p, --path dest_stage_folder  Alternate destination stage path folder [default: omniverse://localhost/Users/test]" << std::endl;
 	std::cout << "    -e, --existing path_to_stage  Open an existing stage and perform live transform edits (full omniverse URL)" << std::endl;
 	std::cout << "    -v, --verbose                 Show the verbose Omniverse logging" << std::endl;
+	std::cout << "    -b, --batch                   Save the scene once per checkpoint instead of after every step" << std::endl;
+	std::cout << "    -s, --stress counts           Create physics stress scenes with these comma separated body counts instead" << std::endl;
+	std::cout << "    -r, --seed seed               Random seed of the stress scene transforms [default: 1]" << std::endl;
+	std::cout << "    -t, --throughput prims        Instead of waiting for 't', move this many prims live and measure the edit rate" << std::endl;
+	std::cout << "    -u, --rate edits_per_second   Target rate of the --throughput edits [default: as fast as possible]" << std::endl;
+	std::cout << "    -d, --duration seconds        How long the --throughput edits run [default: 10]" << std::endl;
+	std::cout << "    -x, --xform-benchmark prims   Compare per op and bulk transform updates of this many prims, without a server" << std::endl;
 	std::cout << "\n\nExamples:\n";
 	std::cout << " * create a stage on the ov-prod server at /Projects/HelloWorld/helloworld.usd" << std::endl;
 	std::cout << "    > samples -p omniverse://ov-prod/Projects/HelloWorld" << std::endl;
+	std::cout << "\n * create the stage with one save per checkpoint and compare the build time" << std::endl;
+	std::cout << "    > samples -b" << std::endl;
+	std::cout << "\n * create stress scenes with 1k, 10k and 100k rigid bodies and compare the authoring time and file size" << std::endl;
+	std::cout << "    > samples -s 1000,10000,100000" << std::endl;
 	std::cout << "\n * live edit a stage on the ov-prod server at /Projects/LiveEdit/livestage.usd" << std::endl;
 	std::cout << "    > samples -e omniverse://ov-prod/Projects/LiveEdit/livestage.usd" << std::endl;
+	std::cout << "\n * move 100 prims of a live stage at 2000 edits per second for 30 seconds" << std::endl;
+	std::cout << "    > samples -e omniverse://ov-prod/Projects/LiveEdit/livestage.usd -t 100 -u 2000 -d 30" << std::endl;
+	std::cout << "\n * compare the time per frame of moving 10000 prims one op at a time and in bulk" << std::endl;
+	std::cout << "    > samples -x 10000" << std::endl;
 }
 
 
 // Main Application 
 int main(int argc, char*argv[])
 {
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("HelloWorld");
+
 	bool doLiveEdit = false;
+	bool batchAuthoring = false;
+	std::vector<size_t> stressBodyCounts;
+	unsigned stressSeed = 1;
+	size_t throughputPrims = 0;
+	size_t xformBenchmarkPrims = 0;
+	double throughputRate = 0.0;
+	double throughputDuration = 10.0;
 	std::string existingStage;
 	std::string destinationPath = "omniverse://localhost/Users/test";
 	UsdGeomMesh boxMesh;
@@ -943,6 +1495,79 @@ int main(int argc, char*argv[])
 		{
 			gOmniverseLoggingEnabled = true;
 		}
+		else if (strcmp(argv[x], "-b") == 0 || strcmp(argv[x], "--batch") == 0)
+		{
+			batchAuthoring = true;
+		}
+		else if (strcmp(argv[x], "-s") == 0 || strcmp(argv[x], "--stress") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing the body counts of the stress scenes.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			std::stringstream counts(argv[++x]);
+			std::string count;
+			while (std::getline(counts, count, ','))
+			{
+				if (std::atoll(count.c_str()) > 0)
+				{
+					stressBodyCounts.push_back(size_t(std::atoll(count.c_str())));
+				}
+			}
+		}
+		else if (strcmp(argv[x], "-r") == 0 || strcmp(argv[x], "--seed") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a random seed.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			stressSeed = unsigned(std::atoi(argv[++x]));
+		}
+		else if (strcmp(argv[x], "-t") == 0 || strcmp(argv[x], "--throughput") == 0)
+		{
+			if (x == argc - 1 || std::atoll(argv[x + 1]) <= 0)
+			{
+				std::cout << "ERROR: Missing the number of prims to move.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			doLiveEdit = true;
+			throughputPrims = size_t(std::atoll(argv[++x]));
+		}
+		else if (strcmp(argv[x], "-u") == 0 || strcmp(argv[x], "--rate") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing an edit rate.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			throughputRate = std::atof(argv[++x]);
+		}
+		else if (strcmp(argv[x], "-d") == 0 || strcmp(argv[x], "--duration") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a duration.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			throughputDuration = std::atof(argv[++x]);
+		}
+		else if (strcmp(argv[x], "-x") == 0 || strcmp(argv[x], "--xform-benchmark") == 0)
+		{
+			if (x == argc - 1 || std::atoll(argv[x + 1]) <= 0)
+			{
+				std::cout << "ERROR: Missing the number of prims to move.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			xformBenchmarkPrims = size_t(std::atoll(argv[++x]));
+		}
 		else if (strcmp(argv[x], "-e") == 0 || strcmp(argv[x], "--existing") == 0)
 		{
 			doLiveEdit = true;
@@ -966,11 +1591,28 @@ int main(int argc, char*argv[])
 		}
 	}
 
+	// The transform benchmark doesn't need a server
+	if (xformBenchmarkPrims > 0)
+	{
+		runXformBenchmark(xformBenchmarkPrims);
+		return 0;
+	}
+
 	// Startup Omniverse with the default login
 	if (!startOmniverse(doLiveEdit))
 		exit(1);
 
-	if (existingStage.empty())
+	if (!stressBodyCounts.empty())
+	{
+		// Only the stress scenes, each in its own stage
+		std::vector<StressSceneStats> results;
+		for (size_t bodyCount : stressBodyCounts)
+		{
+			results.push_back(createStressScene(destinationPath, bodyCount, stressSeed));
+		}
+		printStressSceneStats(results);
+	}
+	else if (existingStage.empty())
 	{
 		// Create the USD model in Omniverse
 		const std::string stageUrl = createOmniverseModel(destinationPath);
@@ -985,23 +1627,32 @@ int main(int argc, char*argv[])
 		// Define the defaultPrim as the /Root prim
 		gStage->SetDefaultPrim(rootPrim.GetPrim());
 
-		// Create physics scene
-		createPhysicsScene(rootPrimPath);
+		// With --batch the steps between two checkpoints are saved once
+		Clock::time_point buildStart = Clock::now();
+		{
+			AuthoringBatch batch(batchAuthoring);
 
-		// Create box geometry in the model
-		boxMesh = createBox(rootPrimPath);
+			// Create physics scene
+			createPhysicsScene(rootPrimPath);
 
-		// Create dynamic cube
-		createDynamicCube(rootPrimPath, 100.0);
+			// Create box geometry in the model
+			boxMesh = createBox(rootPrimPath);
 
-		// Create quad - static tri mesh collision so that the box collides with it
-		createQuad(rootPrimPath, 500.0);
+			// Create dynamic cube
+			createDynamicCube(rootPrimPath, 100.0);
+
+			// Create quad - static tri mesh collision so that the box collides with it
+			createQuad(rootPrimPath, 500.0);
+		}
 
 		checkpointFile(stageUrl, "Add box and nothing else");
 
 		// Create lights in the scene
-		createDistantLight();
-		createDomeLight("./Materials/kloofendal_48d_partly_cloudy.hdr");
+		{
+			AuthoringBatch batch(batchAuthoring);
+			createDistantLight();
+			createDomeLight("./Materials/kloofendal_48d_partly_cloudy.hdr");
+		}
 
 		// Add a Nucleus Checkpoint to the stage
 		checkpointFile(stageUrl, "Add lights to stage");
@@ -1011,6 +1662,7 @@ int main(int argc, char*argv[])
 
 		// Add a material to the box
 		createMaterial(boxMesh);
+		printAuthoringStats(secondsSince(buildStart));
 
 		// Add a Nucleus Checkpoint to the stage
 		checkpointFile(stageUrl, "Add material to the box");
@@ -1025,7 +1677,9 @@ int main(int argc, char*argv[])
 	}
 
 	// Do a live edit session moving the box around, changing a material
-	if (doLiveEdit && boxMesh)
+	if (throughputPrims > 0 && gStage)
+		runLiveEditThroughput(throughputPrims, throughputRate, throughputDuration);
+	else if (doLiveEdit && boxMesh)
 		liveEdit(boxMesh);
 
 	// All done, shut down our connection to Omniverse
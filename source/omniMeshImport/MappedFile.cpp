@@ -0,0 +1,151 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+	close();
+	mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		mFile = nullptr;
+		error = "Can't open " + path;
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size))
+	{
+		error = "Can't get the size of " + path;
+		close();
+		return false;
+	}
+	mSize = size_t(size.QuadPart);
+	if (mSize == 0)
+	{
+		return true;
+	}
+
+	mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	mData = mMapping ? static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (!mData)
+	{
+		error = "Can't map " + path;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (mData)
+	{
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping)
+	{
+		CloseHandle(mMapping);
+	}
+	if (mFile)
+	{
+		CloseHandle(mFile);
+	}
+	mData = nullptr;
+	mMapping = nullptr;
+	mFile = nullptr;
+	mSize = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+	close();
+	mFile = ::open(path.c_str(), O_RDONLY);
+	if (mFile < 0)
+	{
+		error = "Can't open " + path;
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(mFile, &status) != 0)
+	{
+		error = "Can't get the size of " + path;
+		close();
+		return false;
+	}
+	mSize = size_t(status.st_size);
+	if (mSize == 0)
+	{
+		return true;
+	}
+
+	void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+	if (data == MAP_FAILED)
+	{
+		error = "Can't map " + path;
+		close();
+		return false;
+	}
+	mData = static_cast<const char*>(data);
+
+	// The parsers read every chunk front to back
+	madvise(data, mSize, MADV_SEQUENTIAL);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (mData)
+	{
+		munmap(const_cast<char*>(mData), mSize);
+	}
+	if (mFile >= 0)
+	{
+		::close(mFile);
+	}
+	mData = nullptr;
+	mFile = -1;
+	mSize = 0;
+}
+
+#endif
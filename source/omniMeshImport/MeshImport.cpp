@@ -0,0 +1,1072 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "MeshImport.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+using Clock = std::chrono::steady_clock;
+
+// Chunks smaller than this aren't worth a task
+static const size_t kMinChunkBytes = 256 * 1024;
+
+// Binary PLY faces are located serially, then copied in blocks of this many faces
+static const size_t kPlyFaceBlock = 16384;
+
+static const double kPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool isDigit(char c)
+{
+	return unsigned(c - '0') < 10u;
+}
+
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skipBlanks(const char* p, const char* end)
+{
+	while (p < end && isBlank(*p))
+	{
+		p++;
+	}
+	return p;
+}
+
+static inline const char* skipToken(const char* p, const char* end)
+{
+	while (p < end && !isBlank(*p))
+	{
+		p++;
+	}
+	return p;
+}
+
+static inline const char* lineEnd(const char* p, const char* end)
+{
+	const char* newline = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+	return newline ? newline : end;
+}
+
+const char* parseMeshFloat(const char* p, const char* end, float& value)
+{
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		p++;
+	}
+
+	// 19 significant digits fit in the mantissa, the ones after that only scale it
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	for (; p < end && isDigit(*p); p++)
+	{
+		anyDigits = true;
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + uint64_t(*p - '0');
+			digits += mantissa != 0;
+		}
+		else
+		{
+			exponent++;
+		}
+	}
+	if (p < end && *p == '.')
+	{
+		for (p++; p < end && isDigit(*p); p++)
+		{
+			anyDigits = true;
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + uint64_t(*p - '0');
+				digits += mantissa != 0;
+				exponent--;
+			}
+		}
+	}
+	if (!anyDigits)
+	{
+		return nullptr;
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p + 1;
+		const bool negativeExponent = q < end && *q == '-';
+		q += q < end && (*q == '-' || *q == '+');
+		if (q < end && isDigit(*q))
+		{
+			int decimalExponent = 0;
+			for (; q < end && isDigit(*q); q++)
+			{
+				decimalExponent = std::min(decimalExponent * 10 + (*q - '0'), 100000);
+			}
+			exponent += negativeExponent ? -decimalExponent : decimalExponent;
+			p = q;
+		}
+	}
+
+	// Both the mantissa and the power of 10 are exact doubles in the common case
+	double result = double(mantissa);
+	if (mantissa != 0 && exponent != 0)
+	{
+		if (exponent > 0 && exponent <= 22)
+		{
+			result *= kPowersOf10[exponent];
+		}
+		else if (exponent < 0 && exponent >= -22)
+		{
+			result /= kPowersOf10[-exponent];
+		}
+		else
+		{
+			result *= std::pow(10.0, double(exponent));
+		}
+	}
+	value = float(negative ? -result : result);
+	return p;
+}
+
+// Parse an optionally signed integer, returns the end or nullptr if there is none
+static inline const char* parseInteger(const char* p, const char* end, int64_t& value)
+{
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		p++;
+	}
+	if (p == end || !isDigit(*p))
+	{
+		return nullptr;
+	}
+	int64_t result = 0;
+	for (; p < end && isDigit(*p); p++)
+	{
+		result = std::min<int64_t>(result * 10 + (*p - '0'), int64_t(1) << 40);
+	}
+	value = negative ? -result : result;
+	return p;
+}
+
+// Split [begin, end) into chunks that start at the beginning of a line, chunk i is [bounds[i], bounds[i + 1])
+static std::vector<const char*> splitLines(const char* begin, const char* end)
+{
+	const size_t size = size_t(end - begin);
+	const size_t maxChunks = 8 * size_t(std::max(1, int(WorkGetConcurrencyLimit())));
+	const size_t chunkCount = std::max<size_t>(1, std::min(size / kMinChunkBytes, maxChunks));
+
+	std::vector<const char*> bounds = { begin };
+	for (size_t i = 1; i < chunkCount; i++)
+	{
+		const char* split = lineEnd(std::max(begin + size * i / chunkCount, bounds.back()), end);
+		if (split < end)
+		{
+			bounds.push_back(split + 1);
+		}
+	}
+	bounds.push_back(end);
+	return bounds;
+}
+
+// The first error found by the chunks of a parallel parse
+class ParseErrors
+{
+public:
+	void set(const std::string& message)
+	{
+		if (!mFailed.exchange(true))
+		{
+			mMessage = message;
+		}
+	}
+
+	bool failed() const
+	{
+		return mFailed;
+	}
+
+	const std::string& message() const
+	{
+		return mMessage;
+	}
+
+private:
+	std::atomic<bool> mFailed{ false };
+	std::string mMessage;
+};
+
+// Count the triangles of the faces in parallel
+static size_t countMeshTriangles(const VtIntArray& faceVertexCounts)
+{
+	std::atomic<size_t> triangles(0);
+	WorkParallelForN(faceVertexCounts.size(), [&](size_t begin, size_t end)
+	{
+		size_t chunkTriangles = 0;
+		for (size_t f = begin; f < end; f++)
+		{
+			chunkTriangles += size_t(std::max(0, faceVertexCounts.cdata()[f] - 2));
+		}
+		triangles += chunkTriangles;
+	});
+	return triangles;
+}
+
+// ---------------------------------------------------------------------------
+// OBJ
+
+// What one chunk of an OBJ file holds, and where it goes in the arrays
+struct ObjChunk
+{
+	size_t vertices = 0;
+	size_t faces = 0;
+	size_t indices = 0;
+	size_t firstVertex = 0;
+	size_t firstFace = 0;
+	size_t firstIndex = 0;
+};
+
+static inline bool isObjKeyword(const char* p, const char* end, char keyword)
+{
+	return p + 1 < end && p[0] == keyword && isBlank(p[1]);
+}
+
+static bool parseObj(const char* data, size_t size, ImportedMesh& mesh, std::string& error)
+{
+	const std::vector<const char*> bounds = splitLines(data, data + size);
+	const size_t chunkCount = bounds.size() - 1;
+	std::vector<ObjChunk> chunks(chunkCount);
+
+	// Count the vertices, faces and face indices of every chunk
+	WorkParallelForN(chunkCount, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; c++)
+		{
+			ObjChunk& chunk = chunks[c];
+			const char* chunkEnd = bounds[c + 1];
+			for (const char* p = bounds[c]; p < chunkEnd; )
+			{
+				const char* e = lineEnd(p, chunkEnd);
+				p = skipBlanks(p, e);
+				if (isObjKeyword(p, e, 'v'))
+				{
+					chunk.vertices++;
+				}
+				else if (isObjKeyword(p, e, 'f'))
+				{
+					chunk.faces++;
+					for (p = skipBlanks(p + 1, e); p < e; p = skipBlanks(skipToken(p, e), e))
+					{
+						chunk.indices++;
+					}
+				}
+				p = e + 1;
+			}
+		}
+	});
+
+	size_t vertexCount = 0;
+	size_t faceCount = 0;
+	size_t indexCount = 0;
+	for (ObjChunk& chunk : chunks)
+	{
+		chunk.firstVertex = vertexCount;
+		chunk.firstFace = faceCount;
+		chunk.firstIndex = indexCount;
+		vertexCount += chunk.vertices;
+		faceCount += chunk.faces;
+		indexCount += chunk.indices;
+	}
+	if (vertexCount > size_t(INT32_MAX) || indexCount > size_t(INT32_MAX))
+	{
+		error = "Too many vertices for a UsdGeomMesh";
+		return false;
+	}
+
+	// Every chunk writes its own part of the arrays, no chunk results are merged
+	mesh.points.resize(vertexCount);
+	mesh.faceVertexCounts.resize(faceCount);
+	mesh.faceVertexIndices.resize(indexCount);
+	GfVec3f* points = mesh.points.data();
+	int* faceVertexCounts = mesh.faceVertexCounts.data();
+	int* faceVertexIndices = mesh.faceVertexIndices.data();
+
+	ParseErrors errors;
+	WorkParallelForN(chunkCount, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end && !errors.failed(); c++)
+		{
+			const ObjChunk& chunk = chunks[c];
+			size_t vertex = chunk.firstVertex;
+			size_t face = chunk.firstFace;
+			size_t index = chunk.firstIndex;
+			const char* chunkEnd = bounds[c + 1];
+			for (const char* p = bounds[c]; p < chunkEnd; )
+			{
+				const char* e = lineEnd(p, chunkEnd);
+				p = skipBlanks(p, e);
+				if (isObjKeyword(p, e, 'v'))
+				{
+					GfVec3f& point = points[vertex++];
+					for (int axis = 0; axis < 3 && p; axis++)
+					{
+						p = parseMeshFloat(skipBlanks(p + (axis == 0), e), e, point[axis]);
+					}
+					if (!p)
+					{
+						errors.set("Invalid vertex at byte " + std::to_string(e - data));
+						return;
+					}
+				}
+				else if (isObjKeyword(p, e, 'f'))
+				{
+					// Only the position index of "v/vt/vn" is used, relative indices count back from this line
+					const size_t faceStart = index;
+					for (p = skipBlanks(p + 1, e); p < e; p = skipBlanks(skipToken(p, e), e))
+					{
+						int64_t value = 0;
+						if (!parseInteger(p, e, value) || value == 0)
+						{
+							errors.set("Invalid face at byte " + std::to_string(p - data));
+							return;
+						}
+						const int64_t resolved = value > 0 ? value - 1 : int64_t(vertex) + value;
+						if (resolved < 0 || resolved >= int64_t(vertexCount))
+						{
+							errors.set("Face index out of range at byte " + std::to_string(p - data));
+							return;
+						}
+						faceVertexIndices[index++] = int(resolved);
+					}
+					if (index - faceStart < 3)
+					{
+						errors.set("Face with fewer than 3 vertices at byte " + std::to_string(e - data));
+						return;
+					}
+					faceVertexCounts[face++] = int(index - faceStart);
+				}
+				p = e + 1;
+			}
+		}
+	});
+
+	if (errors.failed())
+	{
+		error = errors.message();
+		return false;
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// PLY
+
+enum PlyType : uint8_t
+{
+	ePlyType_Invalid,
+	ePlyType_Int8,
+	ePlyType_UInt8,
+	ePlyType_Int16,
+	ePlyType_UInt16,
+	ePlyType_Int32,
+	ePlyType_UInt32,
+	ePlyType_Float32,
+	ePlyType_Float64
+};
+
+enum PlyFormat : uint8_t
+{
+	ePlyFormat_Ascii,
+	ePlyFormat_BinaryLittleEndian,
+	ePlyFormat_BinaryBigEndian
+};
+
+struct PlyProperty
+{
+	std::string name;
+	PlyType type = ePlyType_Invalid;
+
+	// The type of the element count for lists, ePlyType_Invalid for scalars
+	PlyType countType = ePlyType_Invalid;
+};
+
+struct PlyElement
+{
+	std::string name;
+	size_t count = 0;
+	std::vector<PlyProperty> properties;
+};
+
+static PlyType plyType(const std::string& name)
+{
+	static const std::pair<const char*, PlyType> kTypes[] = {
+		{ "char", ePlyType_Int8 }, { "int8", ePlyType_Int8 }, { "uchar", ePlyType_UInt8 }, { "uint8", ePlyType_UInt8 },
+		{ "short", ePlyType_Int16 }, { "int16", ePlyType_Int16 }, { "ushort", ePlyType_UInt16 }, { "uint16", ePlyType_UInt16 },
+		{ "int", ePlyType_Int32 }, { "int32", ePlyType_Int32 }, { "uint", ePlyType_UInt32 }, { "uint32", ePlyType_UInt32 },
+		{ "float", ePlyType_Float32 }, { "float32", ePlyType_Float32 }, { "double", ePlyType_Float64 }, { "float64", ePlyType_Float64 } };
+	for (const auto& type : kTypes)
+	{
+		if (name == type.first)
+		{
+			return type.second;
+		}
+	}
+	return ePlyType_Invalid;
+}
+
+static size_t plyTypeSize(PlyType type)
+{
+	static const size_t kSizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+	return kSizes[type];
+}
+
+// Read a binary scalar, swapping its bytes for big endian files
+static inline double readPlyValue(const char* p, PlyType type, bool swap)
+{
+	unsigned char bytes[8];
+	const size_t size = plyTypeSize(type);
+	memcpy(bytes, p, size);
+	if (swap)
+	{
+		std::reverse(bytes, bytes + size);
+	}
+	switch (type)
+	{
+	case ePlyType_Int8: { int8_t v; memcpy(&v, bytes, 1); return v; }
+	case ePlyType_UInt8: { uint8_t v; memcpy(&v, bytes, 1); return v; }
+	case ePlyType_Int16: { int16_t v; memcpy(&v, bytes, 2); return v; }
+	case ePlyType_UInt16: { uint16_t v; memcpy(&v, bytes, 2); return v; }
+	case ePlyType_Int32: { int32_t v; memcpy(&v, bytes, 4); return v; }
+	case ePlyType_UInt32: { uint32_t v; memcpy(&v, bytes, 4); return v; }
+	case ePlyType_Float32: { float v; memcpy(&v, bytes, 4); return v; }
+	case ePlyType_Float64: { double v; memcpy(&v, bytes, 8); return v; }
+	default: return 0.0;
+	}
+}
+
+// Parse the header, headerSize is where the data starts
+static bool parsePlyHeader(const char* data, size_t size, PlyFormat& format, std::vector<PlyElement>& elements,
+	size_t& headerSize, std::string& error)
+{
+	const char* end = data + size;
+	bool hasFormat = false;
+	for (const char* p = data; p < end; )
+	{
+		const char* e = lineEnd(p, end);
+		std::istringstream line(std::string(p, e));
+		p = e + 1;
+
+		std::string keyword;
+		line >> keyword;
+		if (keyword == "format")
+		{
+			std::string name;
+			line >> name;
+			hasFormat = true;
+			if (name == "ascii")
+			{
+				format = ePlyFormat_Ascii;
+			}
+			else if (name == "binary_little_endian")
+			{
+				format = ePlyFormat_BinaryLittleEndian;
+			}
+			else if (name == "binary_big_endian")
+			{
+				format = ePlyFormat_BinaryBigEndian;
+			}
+			else
+			{
+				error = "Unknown PLY format " + name;
+				return false;
+			}
+		}
+		else if (keyword == "element")
+		{
+			PlyElement element;
+			line >> element.name >> element.count;
+			elements.push_back(element);
+		}
+		else if (keyword == "property")
+		{
+			PlyProperty property;
+			std::string type;
+			line >> type;
+			if (type == "list")
+			{
+				std::string countType;
+				line >> countType >> type;
+				property.countType = plyType(countType);
+				if (property.countType == ePlyType_Invalid)
+				{
+					error = "Unknown PLY type " + countType;
+					return false;
+				}
+			}
+			line >> property.name;
+			property.type = plyType(type);
+			if (property.type == ePlyType_Invalid || elements.empty())
+			{
+				error = "Invalid PLY property " + property.name;
+				return false;
+			}
+			elements.back().properties.push_back(property);
+		}
+		else if (keyword == "end_header")
+		{
+			headerSize = size_t(std::min(p, end) - data);
+			if (!hasFormat)
+			{
+				error = "The PLY header has no format";
+				return false;
+			}
+			return true;
+		}
+	}
+	error = "The PLY header has no end";
+	return false;
+}
+
+// Where the positions and the face indices are in their elements
+struct PlyLayout
+{
+	size_t vertexElement = SIZE_MAX;
+	size_t faceElement = SIZE_MAX;
+	size_t positionProperties[3] = { SIZE_MAX, SIZE_MAX, SIZE_MAX };
+	size_t indexProperty = SIZE_MAX;
+};
+
+static bool findPlyLayout(const std::vector<PlyElement>& elements, PlyLayout& layout, std::string& error)
+{
+	static const char* const kAxes[] = { "x", "y", "z" };
+	for (size_t e = 0; e < elements.size(); e++)
+	{
+		const PlyElement& element = elements[e];
+		if (element.name == "vertex")
+		{
+			layout.vertexElement = e;
+			for (size_t p = 0; p < element.properties.size(); p++)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					if (element.properties[p].name == kAxes[axis] && element.properties[p].countType == ePlyType_Invalid)
+					{
+						layout.positionProperties[axis] = p;
+					}
+				}
+			}
+		}
+		else if (element.name == "face")
+		{
+			layout.faceElement = e;
+			for (size_t p = 0; p < element.properties.size(); p++)
+			{
+				const PlyProperty& property = element.properties[p];
+				if ((property.name == "vertex_indices" || property.name == "vertex_index") && property.countType != ePlyType_Invalid)
+				{
+					layout.indexProperty = p;
+				}
+			}
+		}
+	}
+	if (layout.vertexElement == SIZE_MAX || layout.positionProperties[0] == SIZE_MAX ||
+		layout.positionProperties[1] == SIZE_MAX || layout.positionProperties[2] == SIZE_MAX)
+	{
+		error = "The PLY file has no vertex positions";
+		return false;
+	}
+	if (layout.faceElement != SIZE_MAX && layout.indexProperty == SIZE_MAX)
+	{
+		error = "The PLY faces have no vertex_indices";
+		return false;
+	}
+	if (elements[layout.vertexElement].count > size_t(INT32_MAX))
+	{
+		error = "Too many vertices for a UsdGeomMesh";
+		return false;
+	}
+	return true;
+}
+
+// Check the indices of a face and store them
+static inline bool storeFaceIndex(double value, size_t vertexCount, int& index)
+{
+	if (value < 0.0 || value >= double(vertexCount))
+	{
+		return false;
+	}
+	index = int(value);
+	return true;
+}
+
+// Binary PLY: the vertices have a fixed size and are read in parallel.  Faces
+// are lists, so their records are located serially (reading only the counts)
+// and then copied in parallel blocks.
+static bool parsePlyBinary(const char* data, size_t size, size_t offset, bool swap, const std::vector<PlyElement>& elements,
+	const PlyLayout& layout, ImportedMesh& mesh, std::string& error)
+{
+	const char* dataEnd = data + size;
+	const char* p = data + offset;
+	ParseErrors errors;
+
+	for (size_t e = 0; e < elements.size(); e++)
+	{
+		const PlyElement& element = elements[e];
+		bool hasLists = false;
+		size_t recordSize = 0;
+		std::vector<size_t> propertyOffsets;
+		for (const PlyProperty& property : element.properties)
+		{
+			propertyOffsets.push_back(recordSize);
+			hasLists |= property.countType != ePlyType_Invalid;
+			recordSize += plyTypeSize(property.type);
+		}
+
+		if (e == layout.vertexElement)
+		{
+			if (hasLists)
+			{
+				error = "PLY vertices with list properties aren't supported";
+				return false;
+			}
+			if (size_t(dataEnd - p) / std::max<size_t>(1, recordSize) < element.count)
+			{
+				error = "The PLY file is truncated";
+				return false;
+			}
+			mesh.points.resize(element.count);
+			GfVec3f* points = mesh.points.data();
+			const char* vertices = p;
+			WorkParallelForN(element.count, [&](size_t begin, size_t end)
+			{
+				for (size_t v = begin; v < end; v++)
+				{
+					const char* record = vertices + v * recordSize;
+					for (int axis = 0; axis < 3; axis++)
+					{
+						const size_t property = layout.positionProperties[axis];
+						points[v][axis] = float(readPlyValue(record + propertyOffsets[property], element.properties[property].type, swap));
+					}
+				}
+			});
+			p += element.count * recordSize;
+			continue;
+		}
+
+		if (!hasLists)
+		{
+			if (size_t(dataEnd - p) / std::max<size_t>(1, recordSize) < element.count)
+			{
+				error = "The PLY file is truncated";
+				return false;
+			}
+			p += element.count * recordSize;
+			continue;
+		}
+
+		// Walk the records serially, noting where each block of faces starts
+		const bool isFace = e == layout.faceElement;
+		std::vector<const char*> blockRecords;
+		std::vector<size_t> blockIndices;
+		size_t indexCount = 0;
+		if (isFace)
+		{
+			mesh.faceVertexCounts.resize(element.count);
+		}
+		int* faceVertexCounts = isFace ? mesh.faceVertexCounts.data() : nullptr;
+		for (size_t r = 0; r < element.count; r++)
+		{
+			if (isFace && r % kPlyFaceBlock == 0)
+			{
+				blockRecords.push_back(p);
+				blockIndices.push_back(indexCount);
+			}
+			for (size_t i = 0; i < element.properties.size(); i++)
+			{
+				const PlyProperty& property = element.properties[i];
+				size_t count = 1;
+				if (property.countType != ePlyType_Invalid)
+				{
+					if (size_t(dataEnd - p) < plyTypeSize(property.countType))
+					{
+						error = "The PLY file is truncated";
+						return false;
+					}
+					const double listCount = readPlyValue(p, property.countType, swap);
+					count = listCount > 0.0 ? size_t(listCount) : 0;
+					p += plyTypeSize(property.countType);
+					if (isFace && i == layout.indexProperty)
+					{
+						if (count < 3)
+						{
+							error = "Face with fewer than 3 vertices at byte " + std::to_string(p - data);
+							return false;
+						}
+						faceVertexCounts[r] = int(count);
+						indexCount += count;
+					}
+				}
+				if (size_t(dataEnd - p) / plyTypeSize(property.type) < count)
+				{
+					error = "The PLY file is truncated";
+					return false;
+				}
+				p += count * plyTypeSize(property.type);
+			}
+		}
+		if (!isFace)
+		{
+			continue;
+		}
+		if (indexCount > size_t(INT32_MAX))
+		{
+			error = "Too many face indices for a UsdGeomMesh";
+			return false;
+		}
+
+		mesh.faceVertexIndices.resize(indexCount);
+		int* faceVertexIndices = mesh.faceVertexIndices.data();
+		const size_t vertexCount = elements[layout.vertexElement].count;
+		WorkParallelForN(blockRecords.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t b = begin; b < end; b++)
+			{
+				const char* record = blockRecords[b];
+				size_t index = blockIndices[b];
+				const size_t lastFace = std::min(element.count, (b + 1) * kPlyFaceBlock);
+				for (size_t r = b * kPlyFaceBlock; r < lastFace; r++)
+				{
+					for (size_t i = 0; i < element.properties.size(); i++)
+					{
+						const PlyProperty& property = element.properties[i];
+						size_t count = 1;
+						if (property.countType != ePlyType_Invalid)
+						{
+							const double listCount = readPlyValue(record, property.countType, swap);
+							count = listCount > 0.0 ? size_t(listCount) : 0;
+							record += plyTypeSize(property.countType);
+						}
+						if (i == layout.indexProperty)
+						{
+							const size_t valueSize = plyTypeSize(property.type);
+							for (size_t k = 0; k < count; k++)
+							{
+								if (!storeFaceIndex(readPlyValue(record + k * valueSize, property.type, swap), vertexCount, faceVertexIndices[index++]))
+								{
+									errors.set("Face index out of range at byte " + std::to_string(record - data));
+									return;
+								}
+							}
+						}
+						record += count * plyTypeSize(property.type);
+					}
+				}
+			}
+		});
+	}
+
+	if (errors.failed())
+	{
+		error = errors.message();
+		return false;
+	}
+	return true;
+}
+
+// What one chunk of an ASCII PLY file holds, and where it goes in the arrays
+struct PlyAsciiChunk
+{
+	size_t lines = 0;
+	size_t indices = 0;
+	size_t firstLine = 0;
+	size_t firstIndex = 0;
+};
+
+// ASCII PLY: one line per element, so the chunks count their lines first to
+// know which element each line belongs to
+static bool parsePlyAscii(const char* data, size_t size, size_t offset, const std::vector<PlyElement>& elements,
+	const PlyLayout& layout, ImportedMesh& mesh, std::string& error)
+{
+	size_t vertexLines[2] = { 0, 0 };
+	size_t faceLines[2] = { 0, 0 };
+	size_t line = 0;
+	for (size_t e = 0; e < elements.size(); e++)
+	{
+		if (e == layout.vertexElement)
+		{
+			vertexLines[0] = line;
+			vertexLines[1] = line + elements[e].count;
+		}
+		else if (e == layout.faceElement)
+		{
+			faceLines[0] = line;
+			faceLines[1] = line + elements[e].count;
+		}
+		line += elements[e].count;
+	}
+	const PlyElement& vertexElement = elements[layout.vertexElement];
+	const PlyElement* faceElement = layout.faceElement != SIZE_MAX ? &elements[layout.faceElement] : nullptr;
+
+	const std::vector<const char*> bounds = splitLines(data + offset, data + size);
+	const size_t chunkCount = bounds.size() - 1;
+	std::vector<PlyAsciiChunk> chunks(chunkCount);
+
+	// Skip a property of an element, lists are their count followed by the values
+	auto skipProperty = [](const PlyProperty& property, const char* p, const char* e) -> const char*
+	{
+		int64_t count = 1;
+		if (property.countType != ePlyType_Invalid)
+		{
+			p = parseInteger(skipBlanks(p, e), e, count);
+		}
+		for (int64_t k = 0; p && k < count; k++)
+		{
+			p = skipToken(skipBlanks(p, e), e);
+		}
+		return p;
+	};
+
+	// Count the lines, and the face indices of the face lines, of every chunk
+	WorkParallelForN(chunkCount, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; c++)
+		{
+			PlyAsciiChunk& chunk = chunks[c];
+			const char* chunkEnd = bounds[c + 1];
+			for (const char* p = bounds[c]; p < chunkEnd; )
+			{
+				const char* e = lineEnd(p, chunkEnd);
+				chunk.lines++;
+				p = e + 1;
+			}
+		}
+	});
+	line = 0;
+	for (PlyAsciiChunk& chunk : chunks)
+	{
+		chunk.firstLine = line;
+		line += chunk.lines;
+	}
+	if (line < std::max(vertexLines[1], faceLines[1]))
+	{
+		error = "The PLY file is truncated";
+		return false;
+	}
+
+	if (faceElement)
+	{
+		WorkParallelForN(chunkCount, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				PlyAsciiChunk& chunk = chunks[c];
+				const char* chunkEnd = bounds[c + 1];
+				size_t lineIndex = chunk.firstLine;
+				for (const char* p = bounds[c]; p < chunkEnd; lineIndex++)
+				{
+					const char* e = lineEnd(p, chunkEnd);
+					if (lineIndex >= faceLines[0] && lineIndex < faceLines[1])
+					{
+						for (size_t i = 0; i < layout.indexProperty && p; i++)
+						{
+							p = skipProperty(faceElement->properties[i], p, e);
+						}
+						int64_t count = 0;
+						if (p && parseInteger(skipBlanks(p, e), e, count) && count > 0)
+						{
+							chunk.indices += size_t(count);
+						}
+					}
+					p = e + 1;
+				}
+			}
+		});
+	}
+
+	size_t indexCount = 0;
+	for (PlyAsciiChunk& chunk : chunks)
+	{
+		chunk.firstIndex = indexCount;
+		indexCount += chunk.indices;
+	}
+	if (indexCount > size_t(INT32_MAX))
+	{
+		error = "Too many face indices for a UsdGeomMesh";
+		return false;
+	}
+
+	mesh.points.resize(vertexElement.count);
+	mesh.faceVertexCounts.resize(faceElement ? faceElement->count : 0);
+	mesh.faceVertexIndices.resize(indexCount);
+	GfVec3f* points = mesh.points.data();
+	int* faceVertexCounts = mesh.faceVertexCounts.data();
+	int* faceVertexIndices = mesh.faceVertexIndices.data();
+
+	ParseErrors errors;
+	WorkParallelForN(chunkCount, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end && !errors.failed(); c++)
+		{
+			const PlyAsciiChunk& chunk = chunks[c];
+			const char* chunkEnd = bounds[c + 1];
+			size_t lineIndex = chunk.firstLine;
+			size_t index = chunk.firstIndex;
+			for (const char* p = bounds[c]; p < chunkEnd; lineIndex++)
+			{
+				const char* e = lineEnd(p, chunkEnd);
+				if (lineIndex >= vertexLines[0] && lineIndex < vertexLines[1])
+				{
+					GfVec3f& point = points[lineIndex - vertexLines[0]];
+					for (size_t i = 0; i < vertexElement.properties.size() && p; i++)
+					{
+						const size_t* axis = std::find(layout.positionProperties, layout.positionProperties + 3, i);
+						p = axis != layout.positionProperties + 3 ?
+							parseMeshFloat(skipBlanks(p, e), e, point[int(axis - layout.positionProperties)]) :
+							skipProperty(vertexElement.properties[i], p, e);
+					}
+					if (!p)
+					{
+						errors.set("Invalid vertex at byte " + std::to_string(e - data));
+						return;
+					}
+				}
+				else if (lineIndex >= faceLines[0] && lineIndex < faceLines[1])
+				{
+					for (size_t i = 0; i < layout.indexProperty && p; i++)
+					{
+						p = skipProperty(faceElement->properties[i], p, e);
+					}
+					int64_t count = 0;
+					p = p ? parseInteger(skipBlanks(p, e), e, count) : nullptr;
+					if (!p || count < 3)
+					{
+						errors.set("Invalid face at byte " + std::to_string(e - data));
+						return;
+					}
+					for (int64_t k = 0; k < count; k++)
+					{
+						int64_t value = 0;
+						p = p ? parseInteger(skipBlanks(p, e), e, value) : nullptr;
+						if (!p || !storeFaceIndex(double(value), vertexElement.count, faceVertexIndices[index++]))
+						{
+							errors.set("Invalid face index at byte " + std::to_string(e - data));
+							return;
+						}
+					}
+					faceVertexCounts[lineIndex - faceLines[0]] = int(count);
+				}
+				p = e + 1;
+			}
+		}
+	});
+
+	if (errors.failed())
+	{
+		error = errors.message();
+		return false;
+	}
+	return true;
+}
+
+static bool parsePly(const char* data, size_t size, ImportedMesh& mesh, std::string& error)
+{
+	PlyFormat format = ePlyFormat_Ascii;
+	std::vector<PlyElement> elements;
+	size_t headerSize = 0;
+	PlyLayout layout;
+	if (!parsePlyHeader(data, size, format, elements, headerSize, error) || !findPlyLayout(elements, layout, error))
+	{
+		return false;
+	}
+
+	if (format == ePlyFormat_Ascii)
+	{
+		return parsePlyAscii(data, size, headerSize, elements, layout, mesh, error);
+	}
+
+	// The samples are built for little endian machines
+	return parsePlyBinary(data, size, headerSize, format == ePlyFormat_BinaryBigEndian, elements, layout, mesh, error);
+}
+
+// ---------------------------------------------------------------------------
+
+bool importMeshFile(const std::string& path, ImportedMesh& mesh, std::string& error)
+{
+	const size_t nameStart = path.find_last_of("/\\") + 1;
+	const size_t extensionStart = path.find_last_of('.');
+	mesh.name = path.substr(nameStart, extensionStart != std::string::npos && extensionStart > nameStart ?
+		extensionStart - nameStart : std::string::npos);
+	std::string extension = extensionStart != std::string::npos ? path.substr(extensionStart + 1) : std::string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return char(tolower(c)); });
+
+	Clock::time_point mapStart = Clock::now();
+	MappedFile file;
+	if (!file.open(path, error))
+	{
+		return false;
+	}
+	mesh.fileBytes = file.size();
+	mesh.mapSeconds = std::chrono::duration<double>(Clock::now() - mapStart).count();
+
+	// Anything that starts like a PLY file is read as one
+	Clock::time_point parseStart = Clock::now();
+	bool parsed = false;
+	if (file.size() >= 4 && memcmp(file.data(), "ply", 3) == 0 && (file.data()[3] == '\n' || file.data()[3] == '\r'))
+	{
+		parsed = parsePly(file.data(), file.size(), mesh, error);
+	}
+	else if (extension == "obj")
+	{
+		parsed = parseObj(file.data(), file.size(), mesh, error);
+	}
+	else
+	{
+		error = "Not an OBJ or PLY file: " + path;
+		return false;
+	}
+	if (!parsed)
+	{
+		return false;
+	}
+
+	mesh.triangleCount = countMeshTriangles(mesh.faceVertexCounts);
+	mesh.parseSeconds = std::chrono::duration<double>(Clock::now() - parseStart).count();
+	return true;
+}
@@ -0,0 +1,64 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pxr/base/vt/types.h"
+
+// A mesh read from an OBJ or PLY file, ready to be authored as a UsdGeomMesh
+struct ImportedMesh
+{
+	// The file name without its folder and extension
+	std::string name;
+
+	pxr::VtVec3fArray points;
+	pxr::VtIntArray faceVertexCounts;
+	pxr::VtIntArray faceVertexIndices;
+
+	size_t triangleCount = 0;
+	uint64_t fileBytes = 0;
+
+	// Mapping the file and parsing it (which includes reading the pages)
+	double mapSeconds = 0.0;
+	double parseSeconds = 0.0;
+};
+
+// Read the positions and faces of a local .obj or .ply file (ASCII or binary).
+// The file is memory mapped and parsed in parallel chunks on the work pool,
+// straight into the arrays of mesh.  Returns false with a message in error
+// if the file can't be read or isn't valid.
+//
+// OBJ: "v" and "f" lines, relative (negative) indices are resolved and the
+// texture and normal indices of "f" are ignored.  All groups go into one mesh.
+// PLY: the x, y and z properties of "vertex" and the vertex_indices (or
+// vertex_index) list of "face", other elements and properties are skipped.
+bool importMeshFile(const std::string& path, ImportedMesh& mesh, std::string& error);
+
+// Parse a decimal number like "-1.5e-3" starting at p, returns the end of the
+// number or nullptr if there is none.  Numbers with up to 15 significant digits
+// and exponents within 1e22, which covers what mesh writers produce, are read
+// exactly before the conversion to float.
+const char* parseMeshFloat(const char* p, const char* end, float& value);
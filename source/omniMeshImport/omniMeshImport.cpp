@@ -0,0 +1,365 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+/*###############################################################################
+#
+# The "omniMeshImport" application brings large OBJ and PLY meshes into a stage:
+#	* Expects one or more local .obj or .ply files and some options
+#	* Memory map every file and parse it in parallel chunks straight into VtArrays
+#		* Print the import throughput in MB/s and triangles/s
+#	* Optionally generate smooth normals for the imported meshes
+#	* Initialize Omniverse (only when a stage is given with --output)
+#		* Set the Omniverse Client log callback (using a lambda)
+#		* Set the Omniverse Client log level
+#		* Initialize the Omniverse Client library
+#		* Register an Omniverse Client status callback (using a static function)
+#	* Open or create the USD stage
+#	* Author every mesh as a UsdGeomMesh under /World in a single change block
+#	* Save the stage
+#	* Shutdown the Omniverse Client library
+#
+###############################################################################*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <set>
+#include <vector>
+#include "OmniClient.h"
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/base/work/threadLimits.h"
+#include "pxr/usd/sdf/attributeSpec.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/primSpec.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/metrics.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "pxr/usd/usdGeom/xform.h"
+#include "MeshImport.h"
+#include "MeshNormals.h"
+#include "MemoryAccounting.h"
+
+using namespace pxr;
+
+static void OmniClientConnectionStatusCallbackImpl(void* userData, const char* url, OmniClientConnectionStatus status) noexcept
+{
+	std::cout << "Connection Status: " << omniClientGetConnectionStatusString(status) << " [" << url << "]" << std::endl;
+	if (status == eOmniClientConnectionStatus_ConnectError)
+	{
+		// We shouldn't just exit here - we should clean up a bit, but we're going to do it anyway
+		std::cout << "[ERROR] Failed connection, exiting." << std::endl;
+		exit(-1);
+	}
+}
+
+// Startup Omniverse 
+static bool startOmniverse()
+{
+	// Register a function to be called whenever the library wants to print something to a log
+	omniClientSetLogCallback(
+		[](char const* threadName, char const* component, OmniClientLogLevel level, char const* message)
+		{
+			std::cout << "[" << omniClientGetLogLevelString(level) << "] " << message << std::endl;
+		});
+
+	// The default log level is "Info", set it to "Debug" to see all messages
+	omniClientSetLogLevel(eOmniClientLogLevel_Info);
+
+	// Initialize the library and pass it the version constant defined in OmniClient.h
+	// This allows the library to verify it was built with a compatible version. It will
+	// return false if there is a version mismatch.
+	if (!omniClientInitialize(kOmniClientVersion))
+	{
+		return false;
+	}
+
+	omniClientRegisterConnectionStatusCallback(nullptr, OmniClientConnectionStatusCallbackImpl);
+
+	return true;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Seconds elapsed since "start"
+static double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Print one row of the import table
+static void printImportRow(const std::string& name, uint64_t bytes, size_t points, size_t triangles, double seconds)
+{
+	std::cout << std::setw(24) << name.substr(0, 24) << std::fixed << std::setprecision(1) << std::setw(10) << bytes / 1e6
+		<< std::setw(12) << points << std::setw(12) << triangles << std::setprecision(3) << std::setw(10) << seconds
+		<< std::setprecision(1) << std::setw(10) << bytes / 1e6 / seconds << std::setprecision(2) << std::setw(10)
+		<< triangles / 1e6 / seconds << std::endl;
+}
+
+// Import every file, returns false if one of them failed
+static bool importFiles(const std::vector<std::string>& paths, std::vector<ImportedMesh>& meshes)
+{
+	std::cout << std::setw(24) << "file" << std::setw(10) << "MB" << std::setw(12) << "points" << std::setw(12) << "triangles"
+		<< std::setw(10) << "seconds" << std::setw(10) << "MB/s" << std::setw(10) << "Mtris/s" << std::endl;
+
+	// Each file is already spread over all of the threads, so they're imported one at a time
+	bool succeeded = true;
+	uint64_t totalBytes = 0;
+	size_t totalPoints = 0;
+	size_t totalTriangles = 0;
+	double totalSeconds = 0.0;
+	for (const std::string& path : paths)
+	{
+		ImportedMesh mesh;
+		std::string error;
+		if (!importMeshFile(path, mesh, error))
+		{
+			std::cout << "ERROR: " << error << std::endl;
+			succeeded = false;
+			continue;
+		}
+
+		const double seconds = mesh.mapSeconds + mesh.parseSeconds;
+		printImportRow(mesh.name, mesh.fileBytes, mesh.points.size(), mesh.triangleCount, seconds);
+		totalBytes += mesh.fileBytes;
+		totalPoints += mesh.points.size();
+		totalTriangles += mesh.triangleCount;
+		totalSeconds += seconds;
+		meshes.push_back(std::move(mesh));
+	}
+	if (meshes.size() > 1)
+	{
+		printImportRow("total", totalBytes, totalPoints, totalTriangles, totalSeconds);
+	}
+	return succeeded;
+}
+
+// Author an attribute with its value in a prim spec.  The VtValue shares the
+// array buffer, so the imported data isn't copied.
+static void authorAttribute(const SdfPrimSpecHandle& primSpec, const TfToken& name, const SdfValueTypeName& typeName,
+	SdfVariability variability, const VtValue& value, const TfToken& interpolation = TfToken())
+{
+	SdfAttributeSpecHandle spec = SdfAttributeSpec::New(primSpec, name.GetString(), typeName, variability);
+	spec->SetDefaultValue(value);
+	if (!interpolation.IsEmpty())
+	{
+		spec->SetInfo(UsdGeomTokens->interpolation, VtValue(interpolation));
+	}
+}
+
+// Author the meshes under /World of the stage in one change block, so the
+// stage recomposes once for all of them
+static void authorMeshes(const UsdStageRefPtr& stage, const std::vector<ImportedMesh>& meshes,
+	const std::vector<VtVec3fArray>& normals)
+{
+	const SdfPath worldPath("/World");
+	if (!stage->GetPrimAtPath(worldPath))
+	{
+		UsdGeomXform world = UsdGeomXform::Define(stage, worldPath);
+		stage->SetDefaultPrim(world.GetPrim());
+	}
+
+	SdfLayerHandle layer = stage->GetRootLayer();
+	MemoryScope memoryScope(eMemorySubsystem_GeometryAuthoring);
+	SdfChangeBlock changeBlock;
+	SdfPrimSpecHandle worldSpec = SdfCreatePrimInLayer(layer, worldPath);
+	std::set<std::string> usedNames;
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const ImportedMesh& mesh = meshes[i];
+
+		// Importing the same file again, or two files with the same name, adds a new prim
+		const std::string baseName = TfMakeValidIdentifier(mesh.name);
+		std::string name = baseName;
+		for (int suffix = 1; usedNames.count(name) || layer->GetPrimAtPath(worldPath.AppendChild(TfToken(name))); suffix++)
+		{
+			name = baseName + "_" + std::to_string(suffix);
+		}
+		usedNames.insert(name);
+
+		SdfPrimSpecHandle primSpec = SdfPrimSpec::New(worldSpec, name, SdfSpecifierDef, UsdGeomTokens->Mesh.GetString());
+		VtVec3fArray extent;
+		UsdGeomPointBased::ComputeExtent(mesh.points, &extent);
+		authorAttribute(primSpec, UsdGeomTokens->points, SdfValueTypeNames->Point3fArray, SdfVariabilityVarying, VtValue(mesh.points));
+		authorAttribute(primSpec, UsdGeomTokens->faceVertexCounts, SdfValueTypeNames->IntArray, SdfVariabilityVarying, VtValue(mesh.faceVertexCounts));
+		authorAttribute(primSpec, UsdGeomTokens->faceVertexIndices, SdfValueTypeNames->IntArray, SdfVariabilityVarying, VtValue(mesh.faceVertexIndices));
+		authorAttribute(primSpec, UsdGeomTokens->extent, SdfValueTypeNames->Float3Array, SdfVariabilityVarying, VtValue(extent));
+
+		// Scans are polygon soups, not subdivision cages
+		authorAttribute(primSpec, UsdGeomTokens->subdivisionScheme, SdfValueTypeNames->Token, SdfVariabilityUniform, VtValue(UsdGeomTokens->none));
+		if (!normals[i].empty())
+		{
+			authorAttribute(primSpec, UsdGeomTokens->normals, SdfValueTypeNames->Normal3fArray, SdfVariabilityVarying,
+				VtValue(normals[i]), UsdGeomTokens->vertex);
+		}
+	}
+}
+
+static void printCmdLineArgHelp()
+{
+	std::cout << "Usage: omniMeshImport [options] file.obj|file.ply..." << std::endl;
+	std::cout << "  options:" << std::endl;
+	std::cout << "    -h, --help                    Print this help" << std::endl;
+	std::cout << "    -o, --output stage_url        Author the meshes under /World of this stage, created if it doesn't exist" << std::endl;
+	std::cout << "    -n, --normals                 Also generate smooth normals" << std::endl;
+	std::cout << "    -t, --threads count           Number of threads [default: all cores]" << std::endl;
+	std::cout << "\n\nExamples:\n";
+	std::cout << " * measure how fast a scan is read, without a server" << std::endl;
+	std::cout << "    > omniMeshImport scans/statue.ply" << std::endl;
+	std::cout << "\n * import two scans with normals into a stage" << std::endl;
+	std::cout << "    > omniMeshImport -n -o omniverse://localhost/Users/test/scans.usd scans/statue.ply scans/room.obj" << std::endl;
+}
+
+// The program expects local mesh files and some options
+int main(int argc, char* argv[])
+{
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("omniMeshImport");
+
+	std::string stageUrl;
+	std::vector<std::string> paths;
+	bool withNormals = false;
+
+	// Process the arguments
+	for (int x = 1; x < argc; x++)
+	{
+		if (strcmp(argv[x], "-h") == 0 || strcmp(argv[x], "--help") == 0)
+		{
+			printCmdLineArgHelp();
+			return 0;
+		}
+		else if (strcmp(argv[x], "-o") == 0 || strcmp(argv[x], "--output") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a stage URL.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			stageUrl = argv[++x];
+		}
+		else if (strcmp(argv[x], "-n") == 0 || strcmp(argv[x], "--normals") == 0)
+		{
+			withNormals = true;
+		}
+		else if (strcmp(argv[x], "-t") == 0 || strcmp(argv[x], "--threads") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a thread count.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			WorkSetConcurrencyLimitArgument(std::atoi(argv[++x]));
+		}
+		else
+		{
+			paths.push_back(argv[x]);
+		}
+	}
+
+	if (paths.empty())
+	{
+		std::cout << "Please provide an OBJ or PLY file to import." << std::endl;
+		return -1;
+	}
+
+	std::cout << "Omniverse Mesh Import: " << paths.size() << " files, " << WorkGetConcurrencyLimit() << " threads" << std::endl;
+
+	Clock::time_point importStart = Clock::now();
+	std::vector<ImportedMesh> meshes;
+	int result = importFiles(paths, meshes) ? 0 : -3;
+
+	std::vector<VtVec3fArray> normals(meshes.size());
+	if (withNormals)
+	{
+		Clock::time_point normalsStart = Clock::now();
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			computeNormals(meshes[i].points, meshes[i].faceVertexCounts, meshes[i].faceVertexIndices, eMeshNormals_Smooth, normals[i]);
+		}
+		std::cout << "Normals: " << std::fixed << std::setprecision(3) << secondsSince(normalsStart) << " s" << std::endl;
+	}
+
+	if (stageUrl.empty() || meshes.empty())
+	{
+		return result;
+	}
+
+	startOmniverse();
+
+	UsdStageRefPtr stage;
+	{
+		MemoryScope memoryScope(eMemorySubsystem_StageOpen);
+		stage = UsdStage::Open(stageUrl);
+		if (!stage)
+		{
+			stage = UsdStage::CreateNew(stageUrl);
+			if (stage)
+			{
+				UsdGeomSetStageUpAxis(stage, UsdGeomTokens->y);
+			}
+		}
+	}
+	if (!stage)
+	{
+		std::cout << "Failure to open or create stage.  Exiting." << std::endl;
+		omniClientShutdown();
+		return -2;
+	}
+
+	Clock::time_point authorStart = Clock::now();
+	authorMeshes(stage, meshes, normals);
+	const double authorSeconds = secondsSince(authorStart);
+
+	Clock::time_point saveStart = Clock::now();
+	{
+		MemoryScope memoryScope(eMemorySubsystem_Export);
+		stage->Save();
+	}
+	const double saveSeconds = secondsSince(saveStart);
+
+	uint64_t totalBytes = 0;
+	size_t totalTriangles = 0;
+	for (const ImportedMesh& mesh : meshes)
+	{
+		totalBytes += mesh.fileBytes;
+		totalTriangles += mesh.triangleCount;
+	}
+	const double totalSeconds = secondsSince(importStart);
+	std::cout << std::fixed << std::setprecision(3) << "Author: " << authorSeconds << " s, save: " << saveSeconds << " s, end to end: "
+		<< totalSeconds << " s (" << std::setprecision(1) << totalBytes / 1e6 / totalSeconds << " MB/s, " << std::setprecision(2)
+		<< totalTriangles / 1e6 / totalSeconds << " Mtris/s)" << std::endl;
+
+	// The stage is a sophisticated object that needs to be destroyed properly.  
+	// Since stage is a smart pointer we can just reset it
+	stage.Reset();
+
+	omniClientShutdown();
+
+	return result;
+}
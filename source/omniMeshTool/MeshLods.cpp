@@ -0,0 +1,429 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "MeshLods.h"
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+#include "pxr/base/gf/vec2d.h"
+#include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/vec3d.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/gf/vec4d.h"
+#include "pxr/base/gf/vec4f.h"
+#include "pxr/base/tf/token.h"
+#include "pxr/base/vt/value.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/usd/sdf/attributeSpec.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/primSpec.h"
+#include "pxr/usd/sdf/types.h"
+#include "pxr/usd/sdf/variantSetSpec.h"
+#include "pxr/usd/sdf/variantSpec.h"
+#include "pxr/usd/usd/primRange.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/pointBased.h"
+#include "pxr/usd/usdGeom/primvarsAPI.h"
+#include "pxr/usd/usdGeom/tokens.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+using Clock = std::chrono::steady_clock;
+
+// A per point, per face or per face vertex attribute authored again in every level
+struct LodAttribute
+{
+	TfToken name;
+	SdfValueTypeName typeName;
+	SdfVariability variability = SdfVariabilityVarying;
+	TfToken interpolation;
+	VtValue value;
+
+	// Primvar values are authored flattened, so indices from weaker layers are blocked
+	bool blockIndices = false;
+};
+
+// A mesh read for simplification and its levels
+struct LodMesh
+{
+	UsdGeomMesh mesh;
+	VtVec3fArray points;
+	VtIntArray faceVertexCounts;
+	VtIntArray faceVertexIndices;
+	std::vector<LodAttribute> attributes;
+	std::vector<SimplifiedMesh> levels;
+	std::string skipReason;
+	bool small = false;
+};
+
+static double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Call fn with the typed array held by value, false for element types that aren't handled
+template <typename Fn>
+static bool visitArray(const VtValue& value, Fn&& fn)
+{
+	if (value.IsHolding<VtFloatArray>())
+		fn(value.UncheckedGet<VtFloatArray>());
+	else if (value.IsHolding<VtDoubleArray>())
+		fn(value.UncheckedGet<VtDoubleArray>());
+	else if (value.IsHolding<VtIntArray>())
+		fn(value.UncheckedGet<VtIntArray>());
+	else if (value.IsHolding<VtVec2fArray>())
+		fn(value.UncheckedGet<VtVec2fArray>());
+	else if (value.IsHolding<VtVec3fArray>())
+		fn(value.UncheckedGet<VtVec3fArray>());
+	else if (value.IsHolding<VtVec4fArray>())
+		fn(value.UncheckedGet<VtVec4fArray>());
+	else if (value.IsHolding<VtVec2dArray>())
+		fn(value.UncheckedGet<VtVec2dArray>());
+	else if (value.IsHolding<VtVec3dArray>())
+		fn(value.UncheckedGet<VtVec3dArray>());
+	else if (value.IsHolding<VtVec4dArray>())
+		fn(value.UncheckedGet<VtVec4dArray>());
+	else
+		return false;
+	return true;
+}
+
+static size_t arrayBytes(const VtValue& value)
+{
+	size_t bytes = 0;
+	visitArray(value, [&](const auto& array)
+	{
+		bytes = array.size() * sizeof(typename std::decay_t<decltype(array)>::value_type);
+	});
+	return bytes;
+}
+
+// Pick the elements of an array by their indices in the original mesh
+static VtValue remapArray(const VtValue& value, const std::vector<int>& sources)
+{
+	VtValue result;
+	visitArray(value, [&](const auto& array)
+	{
+		std::decay_t<decltype(array)> remapped(sources.size());
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			remapped[i] = array[sources[i]];
+		}
+		result = VtValue::Take(remapped);
+	});
+	return result;
+}
+
+// Which source indices of a level carry data with this interpolation
+static const std::vector<int>& levelSources(const SimplifiedMesh& level, const TfToken& interpolation)
+{
+	if (interpolation == UsdGeomTokens->uniform)
+		return level.faceSources;
+	if (interpolation == UsdGeomTokens->faceVarying)
+		return level.faceVertexSources;
+	return level.pointSources;
+}
+
+// How many elements data with this interpolation has on the original mesh
+static size_t expectedSize(const LodMesh& lodMesh, const TfToken& interpolation)
+{
+	if (interpolation == UsdGeomTokens->uniform)
+		return lodMesh.faceVertexCounts.size();
+	if (interpolation == UsdGeomTokens->faceVarying)
+		return lodMesh.faceVertexIndices.size();
+	return lodMesh.points.size();
+}
+
+// True when a sublayer of the root layer has an opinion, the variants couldn't override it
+static bool authoredInSublayer(const UsdAttribute& attribute, const SdfLayerHandleVector& localLayers, const SdfLayerHandle& rootLayer)
+{
+	for (const SdfPropertySpecHandle& spec : attribute.GetPropertyStack())
+	{
+		const SdfLayerHandle layer = spec->GetLayer();
+		if (layer != rootLayer && std::find(localLayers.begin(), localLayers.end(), layer) != localLayers.end())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Read the geometry and every attribute that has to follow it into the levels
+static bool readLodMesh(const UsdPrim& prim, const SdfLayerHandleVector& localLayers, const SdfLayerHandle& rootLayer,
+	const MeshLodOptions& options, LodMesh& out)
+{
+	out.mesh = UsdGeomMesh(prim);
+	if (prim.GetVariantSets().HasVariantSet(kMeshLodVariantSet))
+	{
+		out.skipReason = "already has LODs";
+		return false;
+	}
+
+	const UsdAttribute geometry[] = { out.mesh.GetPointsAttr(), out.mesh.GetFaceVertexCountsAttr(), out.mesh.GetFaceVertexIndicesAttr() };
+	for (const UsdAttribute& attribute : geometry)
+	{
+		if (attribute.GetNumTimeSamples() > 0)
+		{
+			out.skipReason = "animated geometry";
+			return false;
+		}
+		if (authoredInSublayer(attribute, localLayers, rootLayer))
+		{
+			out.skipReason = "geometry authored in a sublayer";
+			return false;
+		}
+	}
+	const UsdAttribute subdivisionTags[] = { out.mesh.GetCornerIndicesAttr(), out.mesh.GetCreaseIndicesAttr(), out.mesh.GetHoleIndicesAttr() };
+	for (const UsdAttribute& attribute : subdivisionTags)
+	{
+		VtIntArray tagIndices;
+		if (attribute.Get(&tagIndices) && !tagIndices.empty())
+		{
+			out.skipReason = "has subdivision tags";
+			return false;
+		}
+	}
+
+	out.mesh.GetPointsAttr().Get(&out.points);
+	out.mesh.GetFaceVertexCountsAttr().Get(&out.faceVertexCounts);
+	out.mesh.GetFaceVertexIndicesAttr().Get(&out.faceVertexIndices);
+	if (countTriangles(out.faceVertexCounts) < options.minTriangles)
+	{
+		out.small = true;
+		return false;
+	}
+
+	auto addAttribute = [&](const UsdAttribute& attribute, const TfToken& interpolation, const VtValue& value, bool blockIndices)
+	{
+		if (attribute.GetNumTimeSamples() > 0 || authoredInSublayer(attribute, localLayers, rootLayer))
+		{
+			out.skipReason = attribute.GetName().GetString() + " is animated or authored in a sublayer";
+			return false;
+		}
+		if (!visitArray(value, [](const auto&) {}))
+		{
+			out.skipReason = attribute.GetName().GetString() + " has an unsupported type";
+			return false;
+		}
+		if (value.GetArraySize() != expectedSize(out, interpolation))
+		{
+			out.skipReason = attribute.GetName().GetString() + " doesn't match the topology";
+			return false;
+		}
+		out.attributes.push_back(LodAttribute{ attribute.GetName(), attribute.GetTypeName(), attribute.GetVariability(),
+			interpolation, value, blockIndices });
+		return true;
+	};
+
+	const UsdAttribute normalsAttribute = out.mesh.GetNormalsAttr();
+	VtValue normals;
+	if (normalsAttribute.HasAuthoredValue() && normalsAttribute.Get(&normals) &&
+		!addAttribute(normalsAttribute, out.mesh.GetNormalsInterpolation(), normals, false))
+	{
+		return false;
+	}
+
+	// Constant primvars are the same for every level and stay where they are
+	for (const UsdGeomPrimvar& primvar : UsdGeomPrimvarsAPI(prim).GetAuthoredPrimvars())
+	{
+		const TfToken interpolation = primvar.GetInterpolation();
+		if (interpolation == UsdGeomTokens->constant)
+		{
+			continue;
+		}
+		VtValue value;
+		if (primvar.GetElementSize() != 1 || !primvar.ComputeFlattened(&value))
+		{
+			out.skipReason = primvar.GetName().GetString() + " can't be flattened";
+			return false;
+		}
+		if (primvar.IsIndexed() && authoredInSublayer(primvar.GetIndicesAttr(), localLayers, rootLayer))
+		{
+			out.skipReason = primvar.GetName().GetString() + " indices authored in a sublayer";
+			return false;
+		}
+		if (!addAttribute(primvar.GetAttr(), interpolation, value, primvar.IsIndexed()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Author an attribute with its value in a prim spec
+static void authorAttribute(const SdfPrimSpecHandle& primSpec, const TfToken& name, const SdfValueTypeName& typeName,
+	SdfVariability variability, const VtValue& value, const TfToken& interpolation = TfToken())
+{
+	SdfAttributeSpecHandle spec = SdfAttributeSpec::New(primSpec, name.GetString(), typeName, variability);
+	spec->SetDefaultValue(value);
+	if (!interpolation.IsEmpty())
+	{
+		spec->SetInfo(UsdGeomTokens->interpolation, VtValue(interpolation));
+	}
+}
+
+// Author one level in its variant, returns the bytes of the arrays
+static size_t authorLevel(const SdfVariantSetSpecHandle& variantSet, int level, const LodMesh& lodMesh,
+	const VtVec3fArray& points, const VtIntArray& faceVertexCounts, const VtIntArray& faceVertexIndices, const SimplifiedMesh* simplified)
+{
+	SdfVariantSpecHandle variant = SdfVariantSpec::New(variantSet, kMeshLodVariantSet + std::to_string(level));
+	SdfPrimSpecHandle primSpec = variant->GetPrimSpec();
+
+	VtVec3fArray extent;
+	UsdGeomPointBased::ComputeExtent(points, &extent);
+	authorAttribute(primSpec, UsdGeomTokens->points, SdfValueTypeNames->Point3fArray, SdfVariabilityVarying, VtValue(points));
+	authorAttribute(primSpec, UsdGeomTokens->faceVertexCounts, SdfValueTypeNames->IntArray, SdfVariabilityVarying, VtValue(faceVertexCounts));
+	authorAttribute(primSpec, UsdGeomTokens->faceVertexIndices, SdfValueTypeNames->IntArray, SdfVariabilityVarying, VtValue(faceVertexIndices));
+	authorAttribute(primSpec, UsdGeomTokens->extent, SdfValueTypeNames->Float3Array, SdfVariabilityVarying, VtValue(extent));
+	size_t bytes = points.size() * sizeof(GfVec3f) + (faceVertexCounts.size() + faceVertexIndices.size()) * sizeof(int);
+
+	for (const LodAttribute& attribute : lodMesh.attributes)
+	{
+		const VtValue value = simplified ? remapArray(attribute.value, levelSources(*simplified, attribute.interpolation)) : attribute.value;
+		authorAttribute(primSpec, attribute.name, attribute.typeName, attribute.variability, value, attribute.interpolation);
+		if (attribute.blockIndices)
+		{
+			authorAttribute(primSpec, TfToken(attribute.name.GetString() + ":indices"), SdfValueTypeNames->IntArray,
+				SdfVariabilityVarying, VtValue(SdfValueBlock()));
+		}
+		bytes += arrayBytes(value);
+	}
+	return bytes;
+}
+
+// Move the root layer geometry into LOD0 and add the simplified levels
+static void authorMeshLods(const SdfLayerHandle& rootLayer, const LodMesh& lodMesh, MeshLodResult& result)
+{
+	const SdfPath path = lodMesh.mesh.GetPath();
+	SdfPrimSpecHandle primSpec = SdfCreatePrimInLayer(rootLayer, path);
+
+	// The root layer opinions would be stronger than any variant
+	std::vector<TfToken> movedNames = { UsdGeomTokens->points, UsdGeomTokens->faceVertexCounts,
+		UsdGeomTokens->faceVertexIndices, UsdGeomTokens->extent };
+	for (const LodAttribute& attribute : lodMesh.attributes)
+	{
+		movedNames.push_back(attribute.name);
+		if (attribute.blockIndices)
+		{
+			movedNames.push_back(TfToken(attribute.name.GetString() + ":indices"));
+		}
+	}
+	for (const TfToken& name : movedNames)
+	{
+		if (SdfAttributeSpecHandle spec = rootLayer->GetAttributeAtPath(path.AppendProperty(name)))
+		{
+			primSpec->RemoveProperty(spec);
+		}
+	}
+
+	SdfVariantSetSpecHandle variantSet = SdfVariantSetSpec::New(primSpec, kMeshLodVariantSet);
+	primSpec->GetVariantSetNameList().Prepend(kMeshLodVariantSet);
+
+	MeshLodLevelStats& original = result.levels[0];
+	original.triangles += countTriangles(lodMesh.faceVertexCounts);
+	original.points += lodMesh.points.size();
+	original.bytes += authorLevel(variantSet, 0, lodMesh, lodMesh.points, lodMesh.faceVertexCounts, lodMesh.faceVertexIndices, nullptr);
+	for (size_t level = 0; level < lodMesh.levels.size(); level++)
+	{
+		const SimplifiedMesh& simplified = lodMesh.levels[level];
+		MeshLodLevelStats& stats = result.levels[level + 1];
+		stats.triangles += simplified.faceVertexCounts.size();
+		stats.points += simplified.points.size();
+		stats.seconds += simplified.seconds;
+		stats.bytes += authorLevel(variantSet, int(level + 1), lodMesh, simplified.points, simplified.faceVertexCounts,
+			simplified.faceVertexIndices, &simplified);
+	}
+	primSpec->SetVariantSelection(kMeshLodVariantSet, kMeshLodVariantSet + std::string("0"));
+}
+
+MeshLodResult generateMeshLods(const UsdStageRefPtr& stage, const MeshLodOptions& options)
+{
+	MeshLodResult result;
+	result.levels.resize(size_t(options.levels) + 1);
+
+	std::vector<UsdPrim> prims;
+	for (const UsdPrim& prim : stage->Traverse())
+	{
+		if (prim.IsA<UsdGeomMesh>())
+		{
+			prims.push_back(prim);
+		}
+	}
+	result.meshCount = prims.size();
+
+	// Reading is thread safe so every mesh is read and simplified in parallel,
+	// and each simplification spreads its passes over the threads as well
+	Clock::time_point computeStart = Clock::now();
+	const SdfLayerHandle rootLayer = stage->GetRootLayer();
+	const SdfLayerHandleVector localLayers = stage->GetLayerStack(false);
+	std::vector<LodMesh> lodMeshes(prims.size());
+	WorkParallelForN(prims.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			LodMesh& lodMesh = lodMeshes[i];
+			if (!readLodMesh(prims[i], localLayers, rootLayer, options, lodMesh))
+			{
+				continue;
+			}
+			const size_t triangles = countTriangles(lodMesh.faceVertexCounts);
+			std::vector<size_t> targets;
+			for (int level = 1; level <= options.levels; level++)
+			{
+				targets.push_back(std::max<size_t>(1, size_t(double(triangles) * std::pow(options.ratio, level))));
+			}
+			if (!simplifyMesh(lodMesh.points, lodMesh.faceVertexCounts, lodMesh.faceVertexIndices, targets, lodMesh.levels))
+			{
+				lodMesh.skipReason = "invalid topology";
+			}
+		}
+	});
+	result.computeSeconds = secondsSince(computeStart);
+
+	// Authoring isn't thread safe, everything goes into the root layer in one change block
+	Clock::time_point authorStart = Clock::now();
+	{
+		SdfChangeBlock changeBlock;
+		for (const LodMesh& lodMesh : lodMeshes)
+		{
+			if (lodMesh.small)
+			{
+				result.smallMeshCount++;
+			}
+			else if (!lodMesh.skipReason.empty())
+			{
+				result.skipped.push_back(MeshLodSkip{ lodMesh.mesh.GetPath().GetString(), lodMesh.skipReason });
+			}
+			else
+			{
+				authorMeshLods(rootLayer, lodMesh, result);
+				result.lodMeshCount++;
+			}
+		}
+	}
+	result.authorSeconds = secondsSince(authorStart);
+	return result;
+}
@@ -0,0 +1,86 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "pxr/usd/usd/stage.h"
+
+// Options of generateMeshLods()
+struct MeshLodOptions
+{
+	// Levels generated after LOD0, the original mesh
+	int levels = 3;
+
+	// Fraction of the triangles kept by each level relative to the previous one
+	double ratio = 0.5;
+
+	// Meshes with fewer triangles are left alone
+	size_t minTriangles = 64;
+};
+
+// Totals of one level over all of the meshes that got LODs
+struct MeshLodLevelStats
+{
+	size_t triangles = 0;
+	size_t points = 0;
+
+	// Bytes of the arrays authored in the variant
+	size_t bytes = 0;
+
+	// Simplification time summed over the meshes, they run in parallel
+	double seconds = 0.0;
+};
+
+// A mesh that didn't get LODs and why
+struct MeshLodSkip
+{
+	std::string path;
+	std::string reason;
+};
+
+struct MeshLodResult
+{
+	size_t meshCount = 0;
+	size_t lodMeshCount = 0;
+	std::vector<MeshLodSkip> skipped;
+
+	// Meshes under MeshLodOptions::minTriangles, not listed in skipped
+	size_t smallMeshCount = 0;
+
+	// LOD0 first
+	std::vector<MeshLodLevelStats> levels;
+
+	double computeSeconds = 0.0;
+	double authorSeconds = 0.0;
+};
+
+// The variant set holding the levels, its variants are named LOD0, LOD1...
+static const char* const kMeshLodVariantSet = "LOD";
+
+// Simplify every mesh in parallel and author the levels as variants of the
+// mesh prim in the root layer.  The geometry opinions of the root layer move
+// into the LOD0 variant, otherwise they would be stronger than the variants.
+MeshLodResult generateMeshLods(const pxr::UsdStageRefPtr& stage, const MeshLodOptions& options);
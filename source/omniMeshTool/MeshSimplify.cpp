@@ -0,0 +1,533 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "MeshSimplify.h"
+#include "MeshNormals.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "pxr/base/gf/vec3d.h"
+#include "pxr/base/work/loops.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+using Clock = std::chrono::steady_clock;
+
+// Open edges are weighted more than the surface so they keep their outline
+static const double kBoundaryWeight = 10.0;
+
+// A collapse may turn the normal of a remaining triangle by at most about 60 degrees,
+// a plain flip test lets triangles turn over bit by bit across passes
+static const double kMinNormalCosineSq = 0.25;
+
+// Symmetric 4x4 matrix summing the squared distances to a set of planes,
+// stored as xx xy xz xw yy yz yw zz zw ww
+struct Quadric
+{
+	double m[10] = {};
+
+	void addPlane(const GfVec3d& normal, double distance, double weight)
+	{
+		const double a = normal[0];
+		const double b = normal[1];
+		const double c = normal[2];
+		const double d = distance;
+		m[0] += weight * a * a;
+		m[1] += weight * a * b;
+		m[2] += weight * a * c;
+		m[3] += weight * a * d;
+		m[4] += weight * b * b;
+		m[5] += weight * b * c;
+		m[6] += weight * b * d;
+		m[7] += weight * c * c;
+		m[8] += weight * c * d;
+		m[9] += weight * d * d;
+	}
+
+	void add(const Quadric& other)
+	{
+		for (int i = 0; i < 10; i++)
+		{
+			m[i] += other.m[i];
+		}
+	}
+
+	double error(const GfVec3f& point) const
+	{
+		const double x = point[0];
+		const double y = point[1];
+		const double z = point[2];
+		const double e = m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x
+			+ m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y
+			+ m[7] * z * z + 2.0 * m[8] * z + m[9];
+		return std::max(e, 0.0);
+	}
+};
+
+// Moving the point "from" onto the point "to", and what it costs
+struct Collapse
+{
+	double cost;
+	int from;
+	int to;
+};
+
+enum PointFlags : uint8_t
+{
+	ePointFlags_Boundary = 1 << 0,
+	ePointFlags_NonManifold = 1 << 1,
+};
+
+static double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool triangleHas(const int* triangle, int point)
+{
+	return triangle[0] == point || triangle[1] == point || triangle[2] == point;
+}
+
+// The triangles, where each of them came from and the point quadrics, changed
+// by collapse passes until a target triangle count is reached
+class Simplifier
+{
+public:
+	explicit Simplifier(const VtVec3fArray& points)
+		: mPoints(points)
+	{
+	}
+
+	size_t triangleCount() const
+	{
+		return mTriangles.size() / 3;
+	}
+
+	// Fan triangulate the faces, dropping triangles that repeat a point
+	void triangulate(const std::vector<size_t>& faceOffsets, const VtIntArray& faceVertexIndices)
+	{
+		const size_t faceCount = faceOffsets.size() - 1;
+		std::vector<size_t> triangleOffsets(faceCount + 1, 0);
+		for (size_t face = 0; face < faceCount; face++)
+		{
+			triangleOffsets[face + 1] = triangleOffsets[face] + (faceOffsets[face + 1] - faceOffsets[face] - 2);
+		}
+		std::vector<int> triangles(triangleOffsets.back() * 3);
+		std::vector<int> triangleFaces(triangleOffsets.back());
+		std::vector<int> cornerSources(triangleOffsets.back() * 3);
+		WorkParallelForN(faceCount, [&](size_t begin, size_t end)
+		{
+			for (size_t face = begin; face < end; face++)
+			{
+				const size_t start = faceOffsets[face];
+				size_t triangle = triangleOffsets[face];
+				for (size_t i = start + 1; i + 1 < faceOffsets[face + 1]; i++, triangle++)
+				{
+					const size_t corners[3] = { start, i, i + 1 };
+					for (int k = 0; k < 3; k++)
+					{
+						triangles[triangle * 3 + k] = faceVertexIndices[corners[k]];
+						cornerSources[triangle * 3 + k] = int(corners[k]);
+					}
+					triangleFaces[triangle] = int(face);
+				}
+			}
+		});
+
+		mTriangles.clear();
+		mTriangleFaces.clear();
+		mCornerSources.clear();
+		for (size_t triangle = 0; triangle < triangleFaces.size(); triangle++)
+		{
+			const int* t = &triangles[triangle * 3];
+			if (t[0] != t[1] && t[1] != t[2] && t[0] != t[2])
+			{
+				mTriangles.insert(mTriangles.end(), t, t + 3);
+				mCornerSources.insert(mCornerSources.end(), &cornerSources[triangle * 3], &cornerSources[triangle * 3] + 3);
+				mTriangleFaces.push_back(triangleFaces[triangle]);
+			}
+		}
+	}
+
+	// Sum the planes of the triangles around each point, plus a perpendicular
+	// plane along each open edge
+	void computeQuadrics()
+	{
+		const PointFaceAdjacency adjacency = buildAdjacency();
+		mQuadrics.assign(mPoints.size(), Quadric());
+		WorkParallelForN(mPoints.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t point = begin; point < end; point++)
+			{
+				Quadric& quadric = mQuadrics[point];
+				for (size_t i = adjacency.offsets[point]; i < adjacency.offsets[point + 1]; i++)
+				{
+					const int* triangle = &mTriangles[size_t(adjacency.faces[i]) * 3];
+					const GfVec3d p0(mPoints[triangle[0]]);
+					GfVec3d normal = GfCross(GfVec3d(mPoints[triangle[1]]) - p0, GfVec3d(mPoints[triangle[2]]) - p0);
+					const double length = normal.GetLength();
+					if (length == 0.0)
+					{
+						continue;
+					}
+					normal /= length;
+					quadric.addPlane(normal, -GfDot(normal, p0), 0.5 * length);
+
+					for (int k = 0; k < 3; k++)
+					{
+						if (triangle[k] != int(point))
+						{
+							continue;
+						}
+						const int others[2] = { triangle[(k + 1) % 3], triangle[(k + 2) % 3] };
+						for (int other : others)
+						{
+							int first;
+							if (countEdgeTriangles(adjacency, int(point), other, first) != 1)
+							{
+								continue;
+							}
+							const GfVec3d p(mPoints[point]);
+							const GfVec3d edge = GfVec3d(mPoints[other]) - p;
+							GfVec3d edgeNormal = GfCross(edge, normal);
+							const double edgeNormalLength = edgeNormal.GetLength();
+							if (edgeNormalLength > 0.0)
+							{
+								edgeNormal /= edgeNormalLength;
+								quadric.addPlane(edgeNormal, -GfDot(edgeNormal, p), kBoundaryWeight * edge.GetLengthSq());
+							}
+						}
+					}
+				}
+			}
+		});
+	}
+
+	// Collapse edges until at most target triangles are left, false if it got stuck first
+	bool simplify(size_t target)
+	{
+		while (triangleCount() > target)
+		{
+			if (!runPass(target))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Copy the current triangles and the points they use
+	void snapshot(SimplifiedMesh& level) const
+	{
+		std::vector<int> newIndices(mPoints.size(), -1);
+		level.pointSources.clear();
+		level.faceVertexIndices.resize(mTriangles.size());
+		for (size_t i = 0; i < mTriangles.size(); i++)
+		{
+			int& newIndex = newIndices[mTriangles[i]];
+			if (newIndex < 0)
+			{
+				newIndex = int(level.pointSources.size());
+				level.pointSources.push_back(mTriangles[i]);
+			}
+			level.faceVertexIndices[i] = newIndex;
+		}
+		level.points.resize(level.pointSources.size());
+		for (size_t i = 0; i < level.pointSources.size(); i++)
+		{
+			level.points[i] = mPoints[level.pointSources[i]];
+		}
+		level.faceVertexCounts.assign(triangleCount(), 3);
+		level.faceSources = mTriangleFaces;
+		level.faceVertexSources = mCornerSources;
+		level.maxError = mMaxError;
+	}
+
+private:
+	PointFaceAdjacency buildAdjacency() const
+	{
+		std::vector<size_t> triangleOffsets(triangleCount() + 1);
+		for (size_t i = 0; i < triangleOffsets.size(); i++)
+		{
+			triangleOffsets[i] = i * 3;
+		}
+		return buildPointFaceAdjacency(mPoints.size(), mTriangles.data(), triangleOffsets);
+	}
+
+	// Number of triangles sharing the edge a-b and the first of them
+	size_t countEdgeTriangles(const PointFaceAdjacency& adjacency, int a, int b, int& first) const
+	{
+		size_t count = 0;
+		first = -1;
+		for (size_t i = adjacency.offsets[a]; i < adjacency.offsets[a + 1]; i++)
+		{
+			if (triangleHas(&mTriangles[size_t(adjacency.faces[i]) * 3], b))
+			{
+				first = count == 0 ? adjacency.faces[i] : first;
+				count++;
+			}
+		}
+		return count;
+	}
+
+	// The points connected to a point, sorted
+	void gatherRing(const PointFaceAdjacency& adjacency, int point, std::vector<int>& ring) const
+	{
+		ring.clear();
+		for (size_t i = adjacency.offsets[point]; i < adjacency.offsets[point + 1]; i++)
+		{
+			const int* triangle = &mTriangles[size_t(adjacency.faces[i]) * 3];
+			for (int k = 0; k < 3; k++)
+			{
+				if (triangle[k] != point)
+				{
+					ring.push_back(triangle[k]);
+				}
+			}
+		}
+		std::sort(ring.begin(), ring.end());
+		ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+	}
+
+	// True if moving "from" onto "to" turns a remaining triangle over, or too far
+	bool flipsTriangle(const PointFaceAdjacency& adjacency, int from, int to) const
+	{
+		for (size_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++)
+		{
+			const int* triangle = &mTriangles[size_t(adjacency.faces[i]) * 3];
+			if (triangleHas(triangle, to))
+			{
+				continue;
+			}
+			GfVec3d before[3], after[3];
+			for (int k = 0; k < 3; k++)
+			{
+				before[k] = GfVec3d(mPoints[triangle[k]]);
+				after[k] = GfVec3d(mPoints[triangle[k] == from ? to : triangle[k]]);
+			}
+			const GfVec3d normalBefore = GfCross(before[1] - before[0], before[2] - before[0]);
+			const GfVec3d normalAfter = GfCross(after[1] - after[0], after[2] - after[0]);
+			const double dot = GfDot(normalBefore, normalAfter);
+			if (normalBefore.GetLengthSq() > 0.0 && (dot <= 0.0 || dot * dot < kMinNormalCosineSq * normalBefore.GetLengthSq() * normalAfter.GetLengthSq()))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// One round of the cheapest collapses that don't touch each other's triangles,
+	// so each of them sees the triangles as they were at the start of the pass.
+	// A collapse locks its ring, which may not be moved or become a target again,
+	// and can't start from a point next to a point that already moved.
+	bool runPass(size_t target)
+	{
+		const size_t triangles = triangleCount();
+		const PointFaceAdjacency adjacency = buildAdjacency();
+
+		// Each edge once, from the first triangle that has it, with the number of triangles sharing it
+		std::vector<int> edgeTriangles(triangles * 3, 0);
+		WorkParallelForN(triangles, [&](size_t begin, size_t end)
+		{
+			for (size_t triangle = begin; triangle < end; triangle++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					int first;
+					const size_t count = countEdgeTriangles(adjacency, mTriangles[triangle * 3 + k], mTriangles[triangle * 3 + (k + 1) % 3], first);
+					edgeTriangles[triangle * 3 + k] = first == int(triangle) ? int(count) : 0;
+				}
+			}
+		});
+
+		// Points on an open edge may only slide along it, points on a non-manifold edge stay
+		std::vector<uint8_t> pointFlags(mPoints.size(), 0);
+		for (size_t edge = 0; edge < edgeTriangles.size(); edge++)
+		{
+			const uint8_t flag = edgeTriangles[edge] == 1 ? ePointFlags_Boundary : edgeTriangles[edge] > 2 ? ePointFlags_NonManifold : 0;
+			pointFlags[mTriangles[edge]] |= flag;
+			pointFlags[mTriangles[edge - edge % 3 + (edge % 3 + 1) % 3]] |= flag;
+		}
+
+		// The cheaper direction of every edge
+		const double noCollapse = std::numeric_limits<double>::infinity();
+		std::vector<Collapse> collapses(edgeTriangles.size(), Collapse{ noCollapse, -1, -1 });
+		WorkParallelForN(edgeTriangles.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t edge = begin; edge < end; edge++)
+			{
+				const int count = edgeTriangles[edge];
+				if (count == 0)
+				{
+					continue;
+				}
+				const int ends[2] = { mTriangles[edge], mTriangles[edge - edge % 3 + (edge % 3 + 1) % 3] };
+				for (int direction = 0; direction < 2; direction++)
+				{
+					const int from = ends[direction];
+					const int to = ends[1 - direction];
+					if ((pointFlags[from] & ePointFlags_NonManifold) || ((pointFlags[from] & ePointFlags_Boundary) && count != 1))
+					{
+						continue;
+					}
+					Quadric quadric = mQuadrics[from];
+					quadric.add(mQuadrics[to]);
+					const double cost = quadric.error(mPoints[to]);
+					if (cost < collapses[edge].cost)
+					{
+						collapses[edge] = Collapse{ cost, from, to };
+					}
+				}
+			}
+		});
+		collapses.erase(std::remove_if(collapses.begin(), collapses.end(), [](const Collapse& c) { return c.from < 0; }), collapses.end());
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+		{
+			return a.cost != b.cost ? a.cost < b.cost : a.from != b.from ? a.from < b.from : a.to < b.to;
+		});
+
+		std::vector<int> moveTo(mPoints.size(), -1);
+		std::vector<uint8_t> locked(mPoints.size(), 0);
+		std::vector<int> fromRing, toRing, sharedRing;
+		size_t remaining = triangles;
+		size_t applied = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (remaining <= target)
+			{
+				break;
+			}
+			if (locked[collapse.from] || locked[collapse.to])
+			{
+				continue;
+			}
+			gatherRing(adjacency, collapse.from, fromRing);
+			if (std::any_of(fromRing.begin(), fromRing.end(), [&](int point) { return moveTo[point] >= 0; }))
+			{
+				continue;
+			}
+
+			// The two rings may only share the points opposite the edge, otherwise the surface folds
+			int first;
+			const size_t sharedTriangles = countEdgeTriangles(adjacency, collapse.from, collapse.to, first);
+			gatherRing(adjacency, collapse.to, toRing);
+			sharedRing.clear();
+			std::set_intersection(fromRing.begin(), fromRing.end(), toRing.begin(), toRing.end(), std::back_inserter(sharedRing));
+			if (sharedRing.size() != sharedTriangles || flipsTriangle(adjacency, collapse.from, collapse.to))
+			{
+				continue;
+			}
+
+			moveTo[collapse.from] = collapse.to;
+			mQuadrics[collapse.to].add(mQuadrics[collapse.from]);
+			mMaxError = std::max(mMaxError, collapse.cost);
+			locked[collapse.from] = 1;
+			for (int point : fromRing)
+			{
+				locked[point] = 1;
+			}
+			remaining -= sharedTriangles;
+			applied++;
+		}
+		if (applied == 0)
+		{
+			return false;
+		}
+
+		// Move the points and drop the triangles that collapsed
+		WorkParallelForN(mTriangles.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				if (moveTo[mTriangles[i]] >= 0)
+				{
+					mTriangles[i] = moveTo[mTriangles[i]];
+				}
+			}
+		});
+		size_t kept = 0;
+		for (size_t triangle = 0; triangle < triangles; triangle++)
+		{
+			const int* t = &mTriangles[triangle * 3];
+			if (t[0] == t[1] || t[1] == t[2] || t[0] == t[2])
+			{
+				continue;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				mTriangles[kept * 3 + k] = t[k];
+				mCornerSources[kept * 3 + k] = mCornerSources[triangle * 3 + k];
+			}
+			mTriangleFaces[kept] = mTriangleFaces[triangle];
+			kept++;
+		}
+		mTriangles.resize(kept * 3);
+		mCornerSources.resize(kept * 3);
+		mTriangleFaces.resize(kept);
+		return true;
+	}
+
+	const VtVec3fArray& mPoints;
+	std::vector<int> mTriangles;
+	std::vector<int> mTriangleFaces;
+	std::vector<int> mCornerSources;
+	std::vector<Quadric> mQuadrics;
+	double mMaxError = 0.0;
+};
+
+size_t countTriangles(const VtIntArray& faceVertexCounts)
+{
+	size_t count = 0;
+	for (int faceVertexCount : faceVertexCounts)
+	{
+		count += faceVertexCount > 2 ? size_t(faceVertexCount - 2) : 0;
+	}
+	return count;
+}
+
+bool simplifyMesh(const VtVec3fArray& points, const VtIntArray& faceVertexCounts,
+	const VtIntArray& faceVertexIndices, const std::vector<size_t>& targetTriangleCounts,
+	std::vector<SimplifiedMesh>& levels)
+{
+	std::vector<size_t> faceOffsets;
+	if (!computeFaceOffsets(faceVertexCounts, faceVertexIndices, points.size(), faceOffsets))
+	{
+		return false;
+	}
+
+	Clock::time_point start = Clock::now();
+	Simplifier simplifier(points);
+	simplifier.triangulate(faceOffsets, faceVertexIndices);
+	simplifier.computeQuadrics();
+	levels.assign(targetTriangleCounts.size(), SimplifiedMesh());
+	for (size_t level = 0; level < targetTriangleCounts.size(); level++)
+	{
+		simplifier.simplify(targetTriangleCounts[level]);
+		simplifier.snapshot(levels[level]);
+		levels[level].seconds = secondsSince(start);
+		start = Clock::now();
+	}
+	return true;
+}
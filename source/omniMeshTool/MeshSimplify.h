@@ -0,0 +1,59 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "pxr/base/vt/types.h"
+
+// One level of detail produced by simplifyMesh().  The source arrays map each
+// point, face and face vertex back to the input mesh so its other per point,
+// per face and per face vertex data can be carried over.
+struct SimplifiedMesh
+{
+	pxr::VtVec3fArray points;
+	pxr::VtIntArray faceVertexCounts;
+	pxr::VtIntArray faceVertexIndices;
+	std::vector<int> pointSources;
+	std::vector<int> faceSources;
+	std::vector<int> faceVertexSources;
+
+	// Time spent on this level after the previous one
+	double seconds = 0.0;
+
+	// Largest quadric error of the collapses so far
+	double maxError = 0.0;
+};
+
+// Simplify a polygon mesh with quadric error edge collapses, producing one
+// triangulated level per target triangle count (in decreasing order).  Each
+// level continues from the previous one and stops early when no collapse is
+// left that keeps the surface manifold and unflipped.  Returns false if the
+// topology isn't valid.
+bool simplifyMesh(const pxr::VtVec3fArray& points, const pxr::VtIntArray& faceVertexCounts,
+	const pxr::VtIntArray& faceVertexIndices, const std::vector<size_t>& targetTriangleCounts,
+	std::vector<SimplifiedMesh>& levels);
+
+// Number of triangles in a fan triangulation of the faces
+size_t countTriangles(const pxr::VtIntArray& faceVertexCounts);
@@ -0,0 +1,513 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+/*###############################################################################
+#
+# The "omniMeshTool" application generates mesh data:
+#	* Expects a path to a USD stage and some options, or --benchmark
+#	* Initialize Omniverse
+#		* Set the Omniverse Client log callback (using a lambda)
+#		* Set the Omniverse Client log level
+#		* Initialize the Omniverse Client library
+#		* Register an Omniverse Client status callback (using a static function)
+#	* Open the USD stage
+#	* Compute smooth or faceted normals, and optionally tangents, for every mesh in parallel
+#	* Author them as primvars in a single change block
+#	* Optionally simplify every mesh into levels of detail authored as variants (--lods)
+#		* Print the size reduction and processing time of each level
+#	* Save the stage
+#	* Or, with --benchmark, time normal and tangent generation on a large generated
+#	  mesh with an increasing number of threads and print the speedup
+#	* Shutdown the Omniverse Client library
+#
+###############################################################################*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include "OmniClient.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/primRange.h"
+#include "pxr/usd/sdf/changeBlock.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+#include "AssetPrefetch.h"
+#include "MeshNormals.h"
+#include "MeshLods.h"
+#include "MeshSimplify.h"
+#include "MemoryAccounting.h"
+
+using namespace pxr;
+
+static void OmniClientConnectionStatusCallbackImpl(void* userData, const char* url, OmniClientConnectionStatus status) noexcept
+{
+	std::cout << "Connection Status: " << omniClientGetConnectionStatusString(status) << " [" << url << "]" << std::endl;
+	if (status == eOmniClientConnectionStatus_ConnectError)
+	{
+		// We shouldn't just exit here - we should clean up a bit, but we're going to do it anyway
+		std::cout << "[ERROR] Failed connection, exiting." << std::endl;
+		exit(-1);
+	}
+}
+
+// Startup Omniverse 
+static bool startOmniverse()
+{
+	// Register a function to be called whenever the library wants to print something to a log
+	omniClientSetLogCallback(
+		[](char const* threadName, char const* component, OmniClientLogLevel level, char const* message)
+		{
+			std::cout << "[" << omniClientGetLogLevelString(level) << "] " << message << std::endl;
+		});
+
+	// The default log level is "Info", set it to "Debug" to see all messages
+	omniClientSetLogLevel(eOmniClientLogLevel_Info);
+
+	// Initialize the library and pass it the version constant defined in OmniClient.h
+	// This allows the library to verify it was built with a compatible version. It will
+	// return false if there is a version mismatch.
+	if (!omniClientInitialize(kOmniClientVersion))
+	{
+		return false;
+	}
+
+	omniClientRegisterConnectionStatusCallback(nullptr, OmniClientConnectionStatusCallbackImpl);
+
+	return true;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// How many times each benchmark step runs, the fastest run is reported
+static const int kBenchmarkRepeats = 3;
+
+// Seconds elapsed since "start"
+static double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// A wavy grid of about triangleCount triangles with per point st uvs, large
+// enough to show how normal generation scales with the number of cores
+struct BenchmarkMesh
+{
+	VtVec3fArray points;
+	VtIntArray faceVertexCounts;
+	VtIntArray faceVertexIndices;
+	VtVec2fArray uvs;
+};
+
+static BenchmarkMesh createBenchmarkMesh(size_t triangleCount)
+{
+	const size_t quads = std::max<size_t>(1, triangleCount / 2);
+	const size_t cells = std::max<size_t>(1, size_t(std::sqrt(double(quads))));
+	const size_t columns = cells + 1;
+
+	BenchmarkMesh mesh;
+	mesh.points.resize(columns * columns);
+	mesh.uvs.resize(columns * columns);
+	WorkParallelForN(columns, [&](size_t begin, size_t end)
+	{
+		for (size_t row = begin; row < end; row++)
+		{
+			for (size_t column = 0; column < columns; column++)
+			{
+				const float u = float(column) / float(cells);
+				const float v = float(row) / float(cells);
+				const float height = 0.05f * std::sin(u * 40.0f) * std::cos(v * 40.0f);
+				mesh.points[row * columns + column] = GfVec3f(u, height, v);
+				mesh.uvs[row * columns + column] = GfVec2f(u, v);
+			}
+		}
+	});
+
+	mesh.faceVertexCounts.assign(cells * cells * 2, 3);
+	mesh.faceVertexIndices.resize(cells * cells * 6);
+	WorkParallelForN(cells, [&](size_t begin, size_t end)
+	{
+		for (size_t row = begin; row < end; row++)
+		{
+			for (size_t column = 0; column < cells; column++)
+			{
+				const int p0 = int(row * columns + column);
+				const int p1 = p0 + 1;
+				const int p2 = p0 + int(columns);
+				const int p3 = p2 + 1;
+				int* indices = mesh.faceVertexIndices.data() + (row * cells + column) * 6;
+				indices[0] = p0; indices[1] = p2; indices[2] = p1;
+				indices[3] = p1; indices[4] = p2; indices[5] = p3;
+			}
+		}
+	});
+	return mesh;
+}
+
+// Fastest of a few runs of one normal (and tangent) generation, in seconds
+static double timeNormalGeneration(const BenchmarkMesh& mesh, MeshNormalMode mode, bool withTangents)
+{
+	double best = 0.0;
+	for (int run = 0; run < kBenchmarkRepeats; run++)
+	{
+		VtVec3fArray normals;
+		VtVec4fArray tangents;
+		Clock::time_point start = Clock::now();
+		MeshTopology topology;
+		buildMeshTopology(mesh.points.size(), mesh.faceVertexCounts, mesh.faceVertexIndices, mode, topology);
+		computeNormals(mesh.points, mesh.faceVertexIndices, topology, mode, normals);
+		if (withTangents)
+		{
+			computeTangents(mesh.points, mesh.faceVertexIndices, topology, mesh.uvs, false, mode, normals, tangents);
+		}
+		const double seconds = secondsSince(start);
+		best = run == 0 ? seconds : std::min(best, seconds);
+	}
+	return best;
+}
+
+// Print the size and time of each level relative to LOD0
+static void printLodLevels(const std::vector<MeshLodLevelStats>& levels)
+{
+	std::cout << std::setw(6) << "level" << std::setw(12) << "triangles" << std::setw(11) << "kept"
+		<< std::setw(12) << "MB" << std::setw(11) << "kept" << std::setw(12) << "seconds" << std::endl;
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		const MeshLodLevelStats& stats = levels[level];
+		const double triangleRatio = levels[0].triangles ? double(stats.triangles) / double(levels[0].triangles) : 0.0;
+		const double byteRatio = levels[0].bytes ? double(stats.bytes) / double(levels[0].bytes) : 0.0;
+		std::cout << std::setw(6) << (kMeshLodVariantSet + std::to_string(level)) << std::setw(12) << stats.triangles
+			<< std::fixed << std::setprecision(1) << std::setw(10) << triangleRatio * 100.0 << "%"
+			<< std::setprecision(2) << std::setw(12) << stats.bytes / (1024.0 * 1024.0)
+			<< std::setprecision(1) << std::setw(10) << byteRatio * 100.0 << "%"
+			<< std::setprecision(3) << std::setw(12) << stats.seconds << std::endl;
+	}
+}
+
+// Time normal generation with 1, 2, 4... threads up to all cores and print the speedup over one thread
+static void runBenchmark(size_t triangleCount, MeshNormalMode mode, bool withTangents, const MeshLodOptions* lodOptions)
+{
+	const unsigned maxThreads = WorkGetPhysicalConcurrencyLimit();
+
+	Clock::time_point createStart = Clock::now();
+	const BenchmarkMesh mesh = createBenchmarkMesh(triangleCount);
+	const size_t triangles = mesh.faceVertexCounts.size();
+	std::cout << "Benchmark mesh: " << triangles << " triangles, " << mesh.points.size() << " points, created in "
+		<< std::fixed << std::setprecision(3) << secondsSince(createStart) << " s" << std::endl;
+	std::cout << "Generating " << (mode == eMeshNormals_Smooth ? "smooth" : "faceted") << " normals"
+		<< (withTangents ? " and tangents" : "") << ", best of " << kBenchmarkRepeats << " runs" << std::endl;
+	std::cout << std::setw(8) << "threads" << std::setw(12) << "seconds" << std::setw(14) << "Mtris/s"
+		<< std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::endl;
+
+	std::vector<unsigned> threadCounts;
+	for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	double singleThreadSeconds = 0.0;
+	for (unsigned threads : threadCounts)
+	{
+		WorkSetConcurrencyLimit(threads);
+		const double seconds = timeNormalGeneration(mesh, mode, withTangents);
+		if (threads == 1)
+		{
+			singleThreadSeconds = seconds;
+		}
+		const double speedup = seconds > 0.0 ? singleThreadSeconds / seconds : 0.0;
+		std::cout << std::setw(8) << threads << std::setw(12) << std::setprecision(4) << seconds
+			<< std::setw(14) << std::setprecision(2) << (seconds > 0.0 ? triangles / seconds / 1.0e6 : 0.0)
+			<< std::setw(9) << speedup << "x" << std::setw(11) << std::setprecision(0) << speedup / threads * 100.0 << "%" << std::endl;
+	}
+	WorkSetMaximumConcurrencyLimit();
+
+	// The levels of detail with all threads, LOD0 is the mesh itself
+	if (lodOptions)
+	{
+		std::vector<size_t> targets;
+		for (int level = 1; level <= lodOptions->levels; level++)
+		{
+			targets.push_back(std::max<size_t>(1, size_t(double(triangles) * std::pow(lodOptions->ratio, level))));
+		}
+		std::vector<SimplifiedMesh> simplified;
+		simplifyMesh(mesh.points, mesh.faceVertexCounts, mesh.faceVertexIndices, targets, simplified);
+		std::vector<MeshLodLevelStats> levels(simplified.size() + 1);
+		levels[0].triangles = triangles;
+		levels[0].bytes = mesh.points.size() * sizeof(GfVec3f) + (mesh.faceVertexCounts.size() + mesh.faceVertexIndices.size()) * sizeof(int);
+		for (size_t level = 0; level < simplified.size(); level++)
+		{
+			levels[level + 1].triangles = simplified[level].faceVertexCounts.size();
+			levels[level + 1].bytes = simplified[level].points.size() * sizeof(GfVec3f) +
+				(simplified[level].faceVertexCounts.size() + simplified[level].faceVertexIndices.size()) * sizeof(int);
+			levels[level + 1].seconds = simplified[level].seconds;
+		}
+		std::cout << "Simplifying into " << lodOptions->levels << " levels with " << maxThreads << " threads" << std::endl;
+		printLodLevels(levels);
+	}
+}
+
+// Generate and author normals for every mesh in the stage, returns non-zero on failure
+static int generateStageNormals(const UsdStageRefPtr& stage, MeshNormalMode mode, bool withTangents)
+{
+	std::vector<UsdGeomMesh> meshes;
+	for (const UsdPrim& prim : stage->Traverse())
+	{
+		if (prim.IsA<UsdGeomMesh>())
+		{
+			meshes.push_back(UsdGeomMesh(prim));
+		}
+	}
+
+	// Reading the stage is thread safe, so every mesh is computed in parallel
+	// (and each mesh spreads its faces over the threads as well)
+	Clock::time_point computeStart = Clock::now();
+	std::vector<GeneratedNormals> generated(meshes.size());
+	std::vector<char> computed(meshes.size(), 0);
+	WorkParallelForN(meshes.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			computed[i] = computeMeshNormals(meshes[i], mode, withTangents, generated[i]);
+		}
+	});
+	const double computeSeconds = secondsSince(computeStart);
+
+	// Authoring isn't thread safe, write everything in one change block so the
+	// stage only recomposes once
+	Clock::time_point authorStart = Clock::now();
+	size_t authoredCount = 0;
+	size_t tangentCount = 0;
+	size_t normalCount = 0;
+	{
+		MemoryScope memoryScope(eMemorySubsystem_GeometryAuthoring);
+		SdfChangeBlock changeBlock;
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			if (!computed[i])
+			{
+				std::cout << "Skipping mesh with invalid topology: " << meshes[i].GetPath() << std::endl;
+				continue;
+			}
+			authorMeshNormals(meshes[i], generated[i]);
+			authoredCount++;
+			normalCount += generated[i].normals.size();
+			tangentCount += generated[i].tangents.empty() ? 0 : 1;
+		}
+	}
+	const double authorSeconds = secondsSince(authorStart);
+
+	std::cout << "Generated " << normalCount << " normals for " << authoredCount << " of " << meshes.size() << " meshes";
+	if (withTangents)
+	{
+		std::cout << ", " << tangentCount << " with tangents";
+	}
+	std::cout << std::endl;
+	std::cout << std::fixed << std::setprecision(3) << "Normals compute: " << computeSeconds << " s, author: " << authorSeconds
+		<< " s" << std::endl;
+	return authoredCount == meshes.size() ? 0 : -3;
+}
+
+// Simplify every mesh into levels of detail and print what each level saves, returns non-zero if a mesh was skipped
+static int generateStageLods(const UsdStageRefPtr& stage, const MeshLodOptions& options)
+{
+	MeshLodResult result;
+	{
+		MemoryScope memoryScope(eMemorySubsystem_GeometryAuthoring);
+		result = generateMeshLods(stage, options);
+	}
+	for (const MeshLodSkip& skip : result.skipped)
+	{
+		std::cout << "Skipping " << skip.path << ": " << skip.reason << std::endl;
+	}
+	std::cout << "Generated " << options.levels << " levels for " << result.lodMeshCount << " of " << result.meshCount
+		<< " meshes, " << result.smallMeshCount << " under " << options.minTriangles << " triangles left alone" << std::endl;
+	printLodLevels(result.levels);
+	std::cout << std::fixed << std::setprecision(3) << "LOD compute: " << result.computeSeconds << " s, author: "
+		<< result.authorSeconds << " s" << std::endl;
+	return result.skipped.empty() ? 0 : -3;
+}
+
+static void printCmdLineArgHelp()
+{
+	std::cout << "Usage: omniMeshTool [options] stage_url" << std::endl;
+	std::cout << "  options:" << std::endl;
+	std::cout << "    -h, --help                    Print this help" << std::endl;
+	std::cout << "    -n, --normals smooth|faceted  How normals are generated [default: smooth]" << std::endl;
+	std::cout << "    -g, --tangents                Also generate tangents for meshes with st uvs" << std::endl;
+	std::cout << "    -t, --threads count           Number of threads [default: all cores]" << std::endl;
+	std::cout << "    -l, --lods levels             Also author this many simplified levels as LOD variants of every mesh" << std::endl;
+	std::cout << "    -r, --lod-ratio ratio         Fraction of the triangles kept by each level [default: 0.5]" << std::endl;
+	std::cout << "    -b, --benchmark triangles     Time normal generation on a generated mesh instead of a stage" << std::endl;
+	std::cout << "\n\nExamples:\n";
+	std::cout << " * author smooth normals for every mesh in a stage" << std::endl;
+	std::cout << "    > omniMeshTool omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * author faceted normals and tangents using 4 threads" << std::endl;
+	std::cout << "    > omniMeshTool -n faceted -g -t 4 omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * add 4 levels of detail, each with a quarter of the triangles of the previous one" << std::endl;
+	std::cout << "    > omniMeshTool -l 4 -r 0.25 omniverse://localhost/Users/test/city.usd" << std::endl;
+	std::cout << "\n * measure how normal and tangent generation scales on a 4 million triangle mesh" << std::endl;
+	std::cout << "    > omniMeshTool -b 4000000 -g" << std::endl;
+}
+
+// The program expects a path to a USD file and some options
+int main(int argc, char* argv[])
+{
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("omniMeshTool");
+
+	std::string stageUrl;
+	MeshNormalMode mode = eMeshNormals_Smooth;
+	bool withTangents = false;
+	size_t benchmarkTriangles = 0;
+	MeshLodOptions lodOptions;
+	lodOptions.levels = 0;
+
+	// Process the arguments
+	for (int x = 1; x < argc; x++)
+	{
+		if (strcmp(argv[x], "-h") == 0 || strcmp(argv[x], "--help") == 0)
+		{
+			printCmdLineArgHelp();
+			return 0;
+		}
+		else if (strcmp(argv[x], "-n") == 0 || strcmp(argv[x], "--normals") == 0)
+		{
+			if (x == argc - 1 || (strcmp(argv[x + 1], "smooth") != 0 && strcmp(argv[x + 1], "faceted") != 0))
+			{
+				std::cout << "ERROR: Expected smooth or faceted.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			mode = strcmp(argv[++x], "smooth") == 0 ? eMeshNormals_Smooth : eMeshNormals_Faceted;
+		}
+		else if (strcmp(argv[x], "-g") == 0 || strcmp(argv[x], "--tangents") == 0)
+		{
+			withTangents = true;
+		}
+		else if (strcmp(argv[x], "-t") == 0 || strcmp(argv[x], "--threads") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a thread count.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			WorkSetConcurrencyLimitArgument(std::atoi(argv[++x]));
+		}
+		else if (strcmp(argv[x], "-l") == 0 || strcmp(argv[x], "--lods") == 0)
+		{
+			if (x == argc - 1 || std::atoi(argv[x + 1]) <= 0)
+			{
+				std::cout << "ERROR: Missing a level count.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			lodOptions.levels = std::atoi(argv[++x]);
+		}
+		else if (strcmp(argv[x], "-r") == 0 || strcmp(argv[x], "--lod-ratio") == 0)
+		{
+			const double ratio = x == argc - 1 ? 0.0 : std::atof(argv[x + 1]);
+			if (ratio <= 0.0 || ratio >= 1.0)
+			{
+				std::cout << "ERROR: The ratio must be between 0 and 1.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			lodOptions.ratio = ratio;
+			x++;
+		}
+		else if (strcmp(argv[x], "-b") == 0 || strcmp(argv[x], "--benchmark") == 0)
+		{
+			if (x == argc - 1 || std::atoll(argv[x + 1]) <= 0)
+			{
+				std::cout << "ERROR: Missing a triangle count.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			benchmarkTriangles = size_t(std::atoll(argv[++x]));
+		}
+		else if (argv[x][0] == '-')
+		{
+			std::cout << "Unrecognized option: " << argv[x] << std::endl;
+			printCmdLineArgHelp();
+			return -1;
+		}
+		else
+		{
+			stageUrl = argv[x];
+		}
+	}
+
+	// The benchmark doesn't need a server
+	if (benchmarkTriangles > 0)
+	{
+		runBenchmark(benchmarkTriangles, mode, withTangents, lodOptions.levels > 0 ? &lodOptions : nullptr);
+		return 0;
+	}
+
+	if (stageUrl.empty())
+	{
+		std::cout << "Please provide an Omniverse stage URL to process." << std::endl;
+		return -1;
+	}
+
+	std::cout << "Omniverse Mesh Tool: " << stageUrl << std::endl;
+
+	startOmniverse();
+
+	UsdStageRefPtr stage = openStageWithPrefetch(stageUrl);
+	if (!stage)
+	{
+		std::cout << "Failure to open stage.  Exiting." << std::endl;
+		return -2;
+	}
+
+	// The normals are generated first so the levels carry them over
+	int result = generateStageNormals(stage, mode, withTangents);
+	if (lodOptions.levels > 0)
+	{
+		const int lodResult = generateStageLods(stage, lodOptions);
+		result = result ? result : lodResult;
+	}
+
+	Clock::time_point saveStart = Clock::now();
+	{
+		MemoryScope memoryScope(eMemorySubsystem_Export);
+		stage->Save();
+	}
+	std::cout << "Save: " << std::setprecision(3) << secondsSince(saveStart) << " s" << std::endl;
+
+	// The stage is a sophisticated object that needs to be destroyed properly.  
+	// Since stage is a smart pointer we can just reset it
+	stage.Reset();
+
+	omniClientShutdown();
+
+	return result;
+}
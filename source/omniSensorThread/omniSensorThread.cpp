@@ -81,6 +81,9 @@
 #include <pxr/usd/usdLux/domeLight.h>
 #include <pxr/usd/usdShade/shader.h>
 #include <pxr/usd/usd/modelAPI.h>
+#include "AssetPrefetch.h"
+#include "MemoryAccounting.h"
+#include "SensorZoneWriter.h"
 #ifdef _WIN32
 #include <conio.h>
 #endif
@@ -180,9 +183,9 @@ static std::string openOmniverseModel(const std::string& destinationPath)
 {
 	std::string stageUrl = destinationPath;
 
-	// Open the live stage
+	// Open the live stage, fetching its dependencies concurrently first
 	std::cout << "    Opening the stage : " << stageUrl.c_str() << std::endl;
-	gStage = pxr::UsdStage::Open(stageUrl);
+	gStage = openStageWithPrefetch(stageUrl);
 	if (!gStage)
 	{
 		std::cout << "    Failure to open model in Omniverse: " << stageUrl.c_str() << std::endl;
@@ -222,6 +225,7 @@ public:
 	DataStageWriterWorker() : stopped(false), variance(1.0f), step(0), runLimit(-1) {};
 	void doWork() {
 		std::time_t currentTime = std::time(0);
+		SensorZoneWriter writer(stage);
 		while (!stopped)
 		{
 			using namespace std::chrono_literals;
@@ -232,18 +236,16 @@ public:
 
 			omniUsdLiveWaitForPendingUpdates();
 
-			// Update the color this zone in the model
+			// Update the color this zone in the model, the same path the
+			// sensor_ingest Python module feeds batches of readings through
 			{
-				// Make a color change for the cube
-				UsdAttribute displayColorAttr = mesh.GetDisplayColorAttr();
-				VtVec3fArray valueArray;
-				GfVec3f rgbFace(0.463f * variance, 0.725f * variance, 0.0f);
-				valueArray.push_back(rgbFace);
+				const SensorRecord record = { int32_t(zone), variance };
 
 				// Use the mutex lock since we are making a change to the same layer from multiple threads
 				{
 					std::unique_lock<std::mutex> lk(gLogMutex);
-					displayColorAttr.Set(valueArray);
+					MemoryScope memoryScope(eMemorySubsystem_LiveProcessing);
+					writer.apply(&record, 1);
 					stage->Save();
 				}
 			}
@@ -267,6 +269,9 @@ public:
 // The program expects two arguments, input and output paths to a USD file
 int main(int argc, char* argv[])
 {
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("omniSensorThread");
+
     if (argc != 4)
     {
         std::cout << "Please provide a path where to keep the USD model and thread number." << std::endl;
@@ -315,7 +320,10 @@ int main(int argc, char* argv[])
 	w->runLimit = timeout;
 
 	// Start Live Edit with Omni Client Library
-	omniUsdLiveProcess();
+	{
+		MemoryScope memoryScope(eMemorySubsystem_LiveProcessing);
+		omniUsdLiveProcess();
+	}
 
 	// Create a running thread
 	std::cout << "    Worker thread started" << std::endl;
@@ -70,6 +70,9 @@
 #include <pxr/usd/usdLux/domeLight.h>
 #include <pxr/usd/usdShade/shader.h>
 #include <pxr/usd/usd/modelAPI.h>
+#include "AssetUpload.h"
+#include "MemoryAccounting.h"
+#include "SensorZoneGeometry.h"
 #ifdef _WIN32
 #include <conio.h>
 #endif
@@ -79,9 +82,6 @@ PXR_NAMESPACE_USING_DIRECTIVE
 // Globals for Omniverse Connection and base Stage
 static UsdStageRefPtr gStage;
 
-// Multiplatform array size
-#define HW_ARRAY_COUNT(array) (sizeof(array) / sizeof(array[0]))
-
 // Private tokens for building up SdfPaths. We recommend
 // constructing SdfPaths via tokens, as there is a performance
 // cost to constructing them directly via strings (effectively,
@@ -172,7 +172,10 @@ static std::string createOmniverseModel(const std::string& destinationPath)
 	std::cout << "    Finished deleting the old stage" << std::endl;
 
 	// Create this file in Omniverse cleanly
-	gStage = UsdStage::CreateNew(stageUrl);
+	{
+		MemoryScope memoryScope(eMemorySubsystem_StageOpen);
+		gStage = UsdStage::CreateNew(stageUrl);
+	}
 	if (!gStage)
 	{
 		std::cout << "    Failure to create model in Omniverse: "; std::cout << stageUrl.c_str(); std::cout << std::endl;
@@ -216,117 +219,12 @@ static void createDomeLight(const std::string& texturePath)
 	gStage->Save();
 }
 
-// Create a simple box in USD with normals and UV information
-double h = 50.0;
-int gBoxVertexIndices[] = { 0, 1, 2, 1, 3, 2, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11, 12, 13, 14, 12, 14, 15, 16, 17, 18, 16, 18, 19, 20, 21, 22, 20, 22, 23 };
-double gBoxNormals[][3] = { {0, 0, -1}, {0, 0, -1}, {0, 0, -1}, {0, 0, -1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, -1, 0}, {0, -1, 0}, {0, -1, 0}, {0, -1, 0}, {1, 0, 0}, {1, 0, 0}, {1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 1, 0}, {0, 1, 0}, {0, 1, 0}, {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0} };
-double gBoxPoints[][3] = { {h, -h, -h}, {-h, -h, -h}, {h, h, -h}, {-h, h, -h}, {h, h, h}, {-h, h, h}, {-h, -h, h}, {h, -h, h}, {h, -h, h}, {-h, -h, h}, {-h, -h, -h}, {h, -h, -h}, {h, h, h}, {h, -h, h}, {h, -h, -h}, {h, h, -h}, {-h, h, h}, {h, h, h}, {h, h, -h}, {-h, h, -h}, {-h, -h, h}, {-h, h, h}, {-h, h, -h}, {-h, -h, -h} };
-float gBoxUV[][2] = { {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 0} };
-
-struct Info
-{
-	UsdGeomMesh mesh;
-	UsdStageRefPtr stage;
-};
-
-// Create the sections of geometry in the model
-Info createZoneGeometry(int zoneNumber, int totalZones, std::string path)
-{
-	// Create a new USD for this layer
-	std::string layerName("/World");
-
-	// Create the geometry inside of "Root"
-	std::string boxName = layerName + "/box_";
-	boxName.append(std::to_string(zoneNumber));
-	UsdGeomMesh mesh = UsdGeomMesh::Define(gStage, SdfPath(boxName.c_str()));
-
-	// Define the information to pass back
-	Info returnInfo;
-	returnInfo.mesh = mesh;
-	returnInfo.stage = gStage;
-
-	if (!mesh)
-		return returnInfo;
-
-	// Set orientation
-	mesh.CreateOrientationAttr(VtValue(UsdGeomTokens->rightHanded));
-
-	// Calculate the offset for the box based on the zone number
-	int zoneSize = (int)floor(std::cbrt((double)totalZones));
-	if (zoneSize < 1)
-		zoneSize = 1;
-	float xOffset = (zoneNumber % zoneSize) * 150;
-	int yZone = zoneNumber % (zoneSize * zoneSize);
-	float yOffset = int(yZone / zoneSize) * 150;
-	float zOffset = int(floor(zoneNumber / (zoneSize * zoneSize))) * 150;
-
-	// Add all of the vertices
-	int num_vertices = HW_ARRAY_COUNT(gBoxPoints);
-	VtArray<GfVec3f> points;
-	points.resize(num_vertices);
-	for (int i = 0; i < num_vertices; i++)
-	{
-		points[i] = GfVec3f(gBoxPoints[i][0] + xOffset, gBoxPoints[i][1] + yOffset, gBoxPoints[i][2] + zOffset);
-	}
-	mesh.CreatePointsAttr(VtValue(points));
-
-	// Calculate indices for each triangle
-	int num_indices = HW_ARRAY_COUNT(gBoxVertexIndices); // 2 Triangles per face * 3 Vertices per Triangle * 6 Faces
-	VtArray<int> vecIndices;
-	vecIndices.resize(num_indices);
-	for (int i = 0; i < num_indices; i++)
-	{
-		vecIndices[i] = gBoxVertexIndices[i];
-	}
-	mesh.CreateFaceVertexIndicesAttr(VtValue(vecIndices));
-
-	// Add vertex normals
-	int num_normals = HW_ARRAY_COUNT(gBoxNormals);
-	VtArray<GfVec3f> meshNormals;
-	meshNormals.resize(num_vertices);
-	for (int i = 0; i < num_vertices; i++)
-	{
-		meshNormals[i] = GfVec3f((float)gBoxNormals[i][0], (float)gBoxNormals[i][1], (float)gBoxNormals[i][2]);
-	}
-	mesh.CreateNormalsAttr(VtValue(meshNormals));
-
-	// Add face vertex count
-	VtArray<int> faceVertexCounts;
-	faceVertexCounts.resize(12); // 2 Triangles per face * 6 faces
-	std::fill(faceVertexCounts.begin(), faceVertexCounts.end(), 3);
-	mesh.CreateFaceVertexCountsAttr(VtValue(faceVertexCounts));
-
-	// Set the color on the mesh
-	UsdPrim meshPrim = mesh.GetPrim();
-	UsdAttribute displayColorAttr = mesh.CreateDisplayColorAttr();
-	{
-		VtVec3fArray valueArray;
-		GfVec3f rgbFace(0.463f, 0.725f, 0.0f);
-		valueArray.push_back(rgbFace);
-		displayColorAttr.Set(valueArray);
-	}
-
-	// Set the UV (st) values for this mesh
-	UsdGeomPrimvar attr2 = mesh.CreatePrimvar(_tokens->st, SdfValueTypeNames->TexCoord2fArray);
-	{
-		int uv_count = HW_ARRAY_COUNT(gBoxUV);
-		VtVec2fArray valueArray;
-		valueArray.resize(uv_count);
-		for (int i = 0; i < uv_count; ++i)
-		{
-			valueArray[i].Set(gBoxUV[i]);
-		}
-
-		bool status = attr2.Set(valueArray);
-	}
-	attr2.SetInterpolation(UsdGeomTokens->vertex);
-
-	return returnInfo;
-}
-
 // The program expects two arguments, input and output paths to a USD file
 int main(int argc, char* argv[])
 {
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("omniSimpleSensor");
+
     if (argc !=4)
     {
         std::cout << "Please provide a path where to keep the USD model and thread count." << std::endl;
@@ -362,9 +260,13 @@ int main(int argc, char* argv[])
 	// Upload Dome Light texture to the Omniverse Server
 	const std::string domeLightHdr("kloofendal_48d_partly_cloudy.hdr");
 	{
-		std::string uriPath = baseUrl + "/Materials/" + domeLightHdr;
+		// Skipped when the server already has this version of the texture
+		AssetUploadOptions uploadOptions;
+		uploadOptions.files = { domeLightHdr };
 		std::cout << "    Upload the dome light texture" << std::endl;
-		omniClientWait(omniClientCopy(std::string("resources/Materials/" + domeLightHdr).c_str(), uriPath.c_str(), nullptr, nullptr));
+		AssetUploadResult upload = uploadChangedAssets("resources/Materials", baseUrl + "/Materials", uploadOptions);
+		std::cout << "    " << (upload.uploadedCount > 0 ? "Uploaded" : upload.failedCount > 0 ? "Failed to upload" : "Unchanged, skipped")
+			<< " in " << std::fixed << std::setprecision(3) << upload.seconds << " s" << std::defaultfloat << std::endl;
 	}
 
 	// Create a dome light to give it a nice sky
@@ -376,10 +278,13 @@ int main(int argc, char* argv[])
 	for (int x = 0; x < numberOfThreads; x++)
 	{
 		// Add zones of data to the model
-		Info returnInfo = createZoneGeometry(x, numberOfThreads, baseUrl);
+		createZoneGeometry(gStage, x, numberOfThreads);
 	}
 
-	gStage->Save();
+	{
+		MemoryScope memoryScope(eMemorySubsystem_Export);
+		gStage->Save();
+	}
 
 	// Commit the changes to the USD
 	omniUsdLiveWaitForPendingUpdates();
@@ -0,0 +1,334 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "StandIn.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	thread_local bool tFreeRequests = false;
+
+	std::string envString(const char* name, const std::string& fallback)
+	{
+		const char* value = std::getenv(name);
+		return value && value[0] ? std::string(value) : fallback;
+	}
+
+	double envDouble(const char* name, double fallback)
+	{
+		const char* value = std::getenv(name);
+		return value && value[0] ? std::max(0.0, std::atof(value)) : fallback;
+	}
+
+	uint64_t fnv1a(const std::string& text)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned char c : text)
+		{
+			hash = (hash ^ c) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint64_t splitMix64(uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	// Resolve . and .. in a / separated path, never going above the root
+	std::string normalizePath(const std::string& path)
+	{
+		std::vector<std::string> parts;
+		size_t start = 0;
+		while (start <= path.size())
+		{
+			size_t end = path.find('/', start);
+			if (end == std::string::npos)
+			{
+				end = path.size();
+			}
+			const std::string part = path.substr(start, end - start);
+			if (part == "..")
+			{
+				if (!parts.empty())
+				{
+					parts.pop_back();
+				}
+			}
+			else if (!part.empty() && part != ".")
+			{
+				parts.push_back(part);
+			}
+			start = end + 1;
+		}
+
+		std::string normalized;
+		for (const std::string& part : parts)
+		{
+			normalized += "/" + part;
+		}
+		if (normalized.empty() || (path.size() > 1 && path.back() == '/'))
+		{
+			normalized += "/";
+		}
+		return normalized;
+	}
+}
+
+const StandInConfig& StandInConfig::get()
+{
+	static const StandInConfig config = []()
+	{
+		StandInConfig c;
+		c.root = envString("OMNI_STANDIN_ROOT", (fs::temp_directory_path() / "omni_standin").string());
+		c.latencyMs = envDouble("OMNI_STANDIN_LATENCY_MS", 0);
+		c.jitterMs = envDouble("OMNI_STANDIN_JITTER_MS", 0);
+		c.bandwidthMbps = envDouble("OMNI_STANDIN_BANDWIDTH_MBPS", 0);
+		c.seed = std::strtoull(envString("OMNI_STANDIN_SEED", "1").c_str(), nullptr, 10);
+		c.user = envString("OMNI_STANDIN_USER", "standin");
+		c.pollMs = std::max(1, int(envDouble("OMNI_STANDIN_POLL_MS", 20)));
+		c.threads = std::max(1, int(envDouble("OMNI_STANDIN_THREADS", 16)));
+
+		std::error_code error;
+		fs::create_directories(c.root, error);
+		fprintf(stderr, "omniStandIn: serving omniverse:// from %s (latency %g ms, jitter %g ms, bandwidth %g Mbps, seed %llu)\n",
+			c.root.c_str(), c.latencyMs, c.jitterMs, c.bandwidthMbps, (unsigned long long)c.seed);
+		return c;
+	}();
+	return config;
+}
+
+bool StandInUrl::parse(const char* url)
+{
+	if (!url)
+	{
+		return false;
+	}
+	const std::string text(url);
+	const size_t schemeEnd = text.find("://");
+	if (schemeEnd == std::string::npos)
+	{
+		return false;
+	}
+	scheme = text.substr(0, schemeEnd);
+	if (scheme != "omniverse" && scheme != "omni")
+	{
+		return false;
+	}
+
+	const size_t hostStart = schemeEnd + 3;
+	const size_t hostEnd = std::min(text.find('/', hostStart), text.find('?', hostStart));
+	host = text.substr(hostStart, hostEnd == std::string::npos ? std::string::npos : hostEnd - hostStart);
+	if (host.empty())
+	{
+		return false;
+	}
+
+	path = "/";
+	query.clear();
+	if (hostEnd != std::string::npos)
+	{
+		const size_t queryStart = text.find('?', hostEnd);
+		path = normalizePath(text.substr(hostEnd, queryStart == std::string::npos ? std::string::npos : queryStart - hostEnd));
+		if (queryStart != std::string::npos)
+		{
+			query = text.substr(queryStart + 1);
+		}
+	}
+	return true;
+}
+
+std::string StandInUrl::localPath() const
+{
+	std::string folder = host;
+	std::replace(folder.begin(), folder.end(), ':', '_');
+	std::string local = StandInConfig::get().root + "/" + folder + path;
+	if (local.size() > 1 && local.back() == '/')
+	{
+		local.pop_back();
+	}
+	return local;
+}
+
+std::string StandInUrl::checkpointFolder() const
+{
+	std::string folder = host;
+	std::replace(folder.begin(), folder.end(), ':', '_');
+	return StandInConfig::get().root + "/.checkpoints/" + folder + path;
+}
+
+std::string StandInUrl::readPath() const
+{
+	const size_t checkpoint = query.rfind('&');
+	if (checkpoint != std::string::npos && checkpoint + 1 < query.size())
+	{
+		return checkpointFolder() + "/" + query.substr(checkpoint + 1);
+	}
+	return localPath();
+}
+
+bool isStandInUrl(const char* url)
+{
+	StandInUrl parsed;
+	return parsed.parse(url);
+}
+
+bool standInLocalPath(const char* url, std::string& localPath, bool& served)
+{
+	StandInUrl parsed;
+	served = parsed.parse(url);
+	if (served)
+	{
+		localPath = parsed.localPath();
+		return true;
+	}
+	if (!url)
+	{
+		return false;
+	}
+
+	const std::string text(url);
+	if (text.compare(0, 5, "file:") == 0)
+	{
+		// file:/path and file:///path, a file://host/path isn't local
+		size_t start = 5;
+		if (text.compare(start, 2, "//") == 0)
+		{
+			start += 2;
+			if (start < text.size() && text[start] != '/')
+			{
+				return false;
+			}
+		}
+		localPath = text.substr(start);
+		return true;
+	}
+	if (text.find("://") != std::string::npos)
+	{
+		return false;
+	}
+	localPath = text;
+	return true;
+}
+
+std::string standInAnchorUrl(const std::string& anchorUrl, const std::string& path)
+{
+	StandInUrl anchor;
+	if (path.find("://") != std::string::npos || !anchor.parse(anchorUrl.c_str()))
+	{
+		return path;
+	}
+	if (!path.empty() && path[0] == '/')
+	{
+		return anchor.serverPrefix() + normalizePath(path);
+	}
+	const std::string folder = anchor.path.substr(0, anchor.path.rfind('/') + 1);
+	return anchor.serverPrefix() + normalizePath(folder + path);
+}
+
+StandInLink& StandInLink::get()
+{
+	static StandInLink link;
+	return link;
+}
+
+StandInLink::Clock::duration StandInLink::transferTime(uint64_t bytes) const
+{
+	const double bandwidthMbps = StandInConfig::get().bandwidthMbps;
+	if (bytes == 0 || bandwidthMbps <= 0)
+	{
+		return Clock::duration::zero();
+	}
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(bytes * 8.0 / (bandwidthMbps * 1e6)));
+}
+
+StandInLink::Clock::time_point StandInLink::schedule(const char* op, const std::string& url, uint64_t downBytes, uint64_t upBytes)
+{
+	const Clock::time_point now = Clock::now();
+	if (tFreeRequests)
+	{
+		return now;
+	}
+
+	const StandInConfig& config = StandInConfig::get();
+	const std::string key = std::string(op) + "\n" + url;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	const uint64_t sequence = mSequence[key]++;
+
+	// Uniform in [0, 1) from the seed, the request and its sequence number
+	const double uniform = double(splitMix64(fnv1a(key) ^ splitMix64(config.seed) ^ splitMix64(sequence)) >> 11) * 0x1.0p-53;
+	const double delayMs = std::max(0.0, config.latencyMs + (2 * uniform - 1) * config.jitterMs);
+	Clock::time_point done = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(delayMs));
+
+	if (upBytes > 0)
+	{
+		done = std::max(done, mUpFree) + transferTime(upBytes);
+		mUpFree = done;
+	}
+	if (downBytes > 0)
+	{
+		done = std::max(done, mDownFree) + transferTime(downBytes);
+		mDownFree = done;
+	}
+	return done;
+}
+
+void StandInLink::charge(const char* op, const std::string& url, uint64_t downBytes, uint64_t upBytes)
+{
+	std::this_thread::sleep_until(schedule(op, url, downBytes, upBytes));
+}
+
+StandInLink::FreeScope::FreeScope()
+	: mPrevious(tFreeRequests)
+{
+	tFreeRequests = true;
+}
+
+StandInLink::FreeScope::~FreeScope()
+{
+	tFreeRequests = mPrevious;
+}
+
+uint64_t standInModifiedTimeNs(const std::string& localPath)
+{
+	struct stat status;
+	if (::stat(localPath.c_str(), &status) != 0)
+	{
+		return 0;
+	}
+	return uint64_t(status.st_mtim.tv_sec) * 1000000000ull + uint64_t(status.st_mtim.tv_nsec);
+}
@@ -0,0 +1,130 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// The stand-in serves every omniverse:// (and omni://) URL of the process from
+// a local folder, <root>/<host>/<path>, and makes every request wait as long
+// as it would over a link with the configured latency, jitter and bandwidth.
+// It's loaded with LD_PRELOAD (see run_with_standin.sh), so the samples run
+// against it unchanged.
+
+// Settings, read once from the environment
+struct StandInConfig
+{
+	std::string root;			// OMNI_STANDIN_ROOT
+	double latencyMs = 0;		// OMNI_STANDIN_LATENCY_MS, one way
+	double jitterMs = 0;		// OMNI_STANDIN_JITTER_MS, +/- around the latency
+	double bandwidthMbps = 0;	// OMNI_STANDIN_BANDWIDTH_MBPS, each direction, 0 for unlimited
+	uint64_t seed = 1;			// OMNI_STANDIN_SEED
+	std::string user;			// OMNI_STANDIN_USER, reported as the connected user and modifiedBy
+	int pollMs = 20;			// OMNI_STANDIN_POLL_MS, how often subscriptions and live layers look for changes
+	int threads = 16;			// OMNI_STANDIN_THREADS, requests completing at the same time
+
+	static const StandInConfig& get();
+};
+
+// A served URL broken into its host, path and query
+struct StandInUrl
+{
+	std::string scheme;		// omniverse or omni
+	std::string host;		// host[:port]
+	std::string path;		// always starts with /
+	std::string query;		// without the ?
+
+	// False for URLs the stand-in doesn't serve (file:, http:, plain paths)
+	bool parse(const char* url);
+
+	std::string serverPrefix() const
+	{
+		return scheme + "://" + host;
+	}
+	std::string withoutQuery() const
+	{
+		return serverPrefix() + path;
+	}
+	// Where the file lives under the root
+	std::string localPath() const;
+	// Where the checkpoints of the file live
+	std::string checkpointFolder() const;
+	// The file a read of the URL returns, a checkpoint when the query names one ("&3")
+	std::string readPath() const;
+};
+
+bool isStandInUrl(const char* url);
+
+// The local path of a served URL, or of a file: URL or plain path.  False for
+// anything else (http: and so on), which is left to the client library.
+bool standInLocalPath(const char* url, std::string& localPath, bool& served);
+
+// Join a relative path to the folder of a served URL, resolving . and ..
+std::string standInAnchorUrl(const std::string& anchorUrl, const std::string& path);
+
+// Decides when a request to the stand-in completes.  Every request pays the
+// latency plus a jitter that only depends on the seed, the operation, the URL
+// and how many times that operation was issued on that URL, so the same run
+// sees the same delays whatever the thread timing.  Transfers then queue for
+// a shared downstream or upstream link of the configured bandwidth.
+class StandInLink
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static StandInLink& get();
+
+	// When a request issued now that moves downBytes to the client and upBytes
+	// to the server completes
+	Clock::time_point schedule(const char* op, const std::string& url, uint64_t downBytes, uint64_t upBytes);
+
+	// Block the calling thread until the request would have completed
+	void charge(const char* op, const std::string& url, uint64_t downBytes, uint64_t upBytes);
+
+	// Requests of this thread complete immediately while the scope is alive,
+	// for the bookkeeping done on behalf of work that was already charged
+	class FreeScope
+	{
+	public:
+		FreeScope();
+		~FreeScope();
+
+	private:
+		bool mPrevious;
+	};
+
+private:
+	Clock::duration transferTime(uint64_t bytes) const;
+
+	std::mutex mMutex;
+	std::unordered_map<std::string, uint64_t> mSequence;
+	Clock::time_point mDownFree;
+	Clock::time_point mUpFree;
+};
+
+// Nanoseconds since the epoch of the last modification of a local file, 0 if missing
+uint64_t standInModifiedTimeNs(const std::string& localPath);
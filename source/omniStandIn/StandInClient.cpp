@@ -0,0 +1,686 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// The omniClient functions the samples use, answered by the stand-in for
+// omniverse:// URLs.  Everything else goes to the real client library through
+// dlsym(RTLD_NEXT), which finds it because this library is preloaded.
+
+#include "StandIn.h"
+#include "StandInRequests.h"
+
+#include "OmniClient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+#define STANDIN_REAL(function) static const auto real = reinterpret_cast<decltype(&function)>(dlsym(RTLD_NEXT, #function))
+
+namespace
+{
+	// The strings of a list entry, the entry points into them once the
+	// storage won't move anymore
+	struct EntryStrings
+	{
+		std::string relativePath;
+		std::string version;
+		std::string comment;
+		OmniClientListEntry entry = {};
+
+		void finalize()
+		{
+			const std::string& user = StandInConfig::get().user;
+			entry.relativePath = relativePath.c_str();
+			entry.version = version.c_str();
+			entry.comment = comment.c_str();
+			entry.modifiedBy = user.c_str();
+			entry.createdBy = user.c_str();
+		}
+	};
+
+	bool isLiveLayerName(const std::string& path)
+	{
+		const std::string extension = fs::path(path).extension().string();
+		return extension == ".usd" || extension == ".usda" || extension == ".usdc" || extension == ".live";
+	}
+
+	std::vector<uint32_t> listCheckpointNumbers(const std::string& folder)
+	{
+		std::vector<uint32_t> numbers;
+		std::error_code error;
+		for (fs::directory_iterator it(folder, error), end; !error && it != end; it.increment(error))
+		{
+			const std::string name = it->path().filename().string();
+			if (!name.empty() && name.find_first_not_of("0123456789") == std::string::npos)
+			{
+				numbers.push_back(uint32_t(std::strtoul(name.c_str(), nullptr, 10)));
+			}
+		}
+		std::sort(numbers.begin(), numbers.end());
+		return numbers;
+	}
+
+	// Fill the entry of a local file or folder, false when it doesn't exist
+	bool statLocal(const std::string& localPath, const std::string& checkpointFolder, EntryStrings& out)
+	{
+		struct stat status;
+		if (::stat(localPath.c_str(), &status) != 0)
+		{
+			return false;
+		}
+
+		const uint64_t modifiedNs = uint64_t(status.st_mtim.tv_sec) * 1000000000ull + uint64_t(status.st_mtim.tv_nsec);
+		out.entry.access = fOmniClientAccess_Read | fOmniClientAccess_Write | fOmniClientAccess_Admin;
+		out.entry.modifiedTimeNs = modifiedNs;
+		out.entry.createdTimeNs = modifiedNs;
+		if (S_ISDIR(status.st_mode))
+		{
+			out.entry.flags = fOmniClientItem_CanHaveChildren;
+		}
+		else
+		{
+			out.entry.flags = fOmniClientItem_ReadableFile | fOmniClientItem_WriteableFile | fOmniClientItem_DoesNotHaveChildren;
+			if (isLiveLayerName(localPath))
+			{
+				out.entry.flags |= fOmniClientItem_CanLiveUpdate;
+			}
+			if (!checkpointFolder.empty() && !listCheckpointNumbers(checkpointFolder).empty())
+			{
+				out.entry.flags |= fOmniClientItem_IsCheckpointed;
+			}
+			out.entry.size = uint64_t(status.st_size);
+		}
+		// Every write changes the modified time, which makes a fine version
+		out.version = std::to_string(modifiedNs);
+		return true;
+	}
+
+	uint64_t localFileSize(const std::string& localPath)
+	{
+		std::error_code error;
+		const uintmax_t size = fs::file_size(localPath, error);
+		return error ? 0 : uint64_t(size);
+	}
+
+	bool readLocalFile(const std::string& localPath, OmniClientContent& content)
+	{
+		std::ifstream file(localPath, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+		const size_t size = size_t(file.tellg());
+		content.buffer = std::malloc(std::max<size_t>(size, 1));
+		content.size = size;
+		content.free = std::free;
+		file.seekg(0);
+		return bool(file.read(static_cast<char*>(content.buffer), std::streamsize(size)));
+	}
+
+	// Write through a temporary file and a rename, so a process watching the
+	// file never reads it half written
+	bool writeLocalFile(const std::string& localPath, const void* data, size_t size)
+	{
+		std::error_code error;
+		fs::create_directories(fs::path(localPath).parent_path(), error);
+		const std::string temporaryPath = localPath + ".standin-tmp";
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!file || !file.write(static_cast<const char*>(data), std::streamsize(size)))
+			{
+				return false;
+			}
+		}
+		fs::rename(temporaryPath, localPath, error);
+		return !error;
+	}
+
+	OmniClientRequestId submit(const char* op, const std::string& url, uint64_t downBytes, uint64_t upBytes, std::function<void()> work)
+	{
+		return StandInRequests::get().submit(StandInLink::get().schedule(op, url, downBytes, upBytes), std::move(work));
+	}
+
+	// A stat subscription, polled for changes to the file
+	struct Subscription
+	{
+		StandInUrl url;
+		void* userData = nullptr;
+		OmniClientStatSubscribeCallback callback = nullptr;
+		OmniClientRequestId id = 0;
+		uint64_t pollKey = 0;
+		std::atomic<bool> active{ true };
+		std::mutex mutex;
+		bool existed = false;
+		uint64_t modifiedNs = 0;
+		uint64_t size = 0;
+	};
+
+	std::mutex gSubscriptionMutex;
+	std::vector<std::shared_ptr<Subscription>> gSubscriptions;
+
+	void pollSubscription(const std::shared_ptr<Subscription>& subscription)
+	{
+		EntryStrings strings;
+		strings.relativePath = fs::path(subscription->url.path).filename().string();
+		const bool exists = statLocal(subscription->url.localPath(), subscription->url.checkpointFolder(), strings);
+
+		OmniClientListEvent event;
+		{
+			std::lock_guard<std::mutex> lock(subscription->mutex);
+			if (exists == subscription->existed && (!exists ||
+				(strings.entry.modifiedTimeNs == subscription->modifiedNs && strings.entry.size == subscription->size)))
+			{
+				return;
+			}
+			event = !exists ? eOmniClientListEvent_Deleted : subscription->existed ? eOmniClientListEvent_Updated : eOmniClientListEvent_Created;
+			subscription->existed = exists;
+			subscription->modifiedNs = strings.entry.modifiedTimeNs;
+			subscription->size = strings.entry.size;
+		}
+
+		// The server would tell the client after the one way latency
+		submit("event", subscription->url.withoutQuery(), 0, 0, [subscription, strings, event]() mutable
+		{
+			if (subscription->active)
+			{
+				strings.finalize();
+				subscription->callback(subscription->userData, eOmniClientResult_Ok, event, &strings.entry);
+			}
+		});
+	}
+
+	void stopSubscription(OmniClientRequestId id)
+	{
+		std::shared_ptr<Subscription> subscription;
+		{
+			std::lock_guard<std::mutex> lock(gSubscriptionMutex);
+			auto it = std::find_if(gSubscriptions.begin(), gSubscriptions.end(),
+				[&](const std::shared_ptr<Subscription>& s) { return s->id == id; });
+			if (it == gSubscriptions.end())
+			{
+				return;
+			}
+			subscription = *it;
+			gSubscriptions.erase(it);
+		}
+		subscription->active = false;
+		StandInPoller::get().remove(subscription->pollKey);
+		StandInRequests::get().finish(id);
+	}
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientStat(char const* url, void* userData, OmniClientStatCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientStat);
+		return real(url, userData, callback);
+	}
+
+	return submit("stat", parsed.withoutQuery(), 0, 0, [parsed, userData, callback]()
+	{
+		EntryStrings strings;
+		strings.relativePath = fs::path(parsed.path).filename().string();
+		bool found = statLocal(parsed.readPath(), parsed.checkpointFolder(), strings);
+		if (!found && parsed.path == "/")
+		{
+			// The root of a server always exists
+			std::error_code error;
+			fs::create_directories(parsed.localPath(), error);
+			found = statLocal(parsed.localPath(), std::string(), strings);
+		}
+		strings.finalize();
+		if (callback)
+		{
+			callback(userData, found ? eOmniClientResult_Ok : eOmniClientResult_ErrorNotFound, found ? &strings.entry : nullptr);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientList(char const* url, void* userData, OmniClientListCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientList);
+		return real(url, userData, callback);
+	}
+
+	return submit("list", parsed.withoutQuery(), 0, 0, [parsed, userData, callback]()
+	{
+		const std::string localPath = parsed.localPath();
+		std::vector<EntryStrings> strings;
+		OmniClientResult result = eOmniClientResult_Ok;
+
+		std::error_code error;
+		if (fs::is_directory(localPath, error) || parsed.path == "/")
+		{
+			std::vector<std::string> names;
+			for (fs::directory_iterator it(localPath, error), end; !error && it != end; it.increment(error))
+			{
+				const std::string name = it->path().filename().string();
+				if (name.size() < 12 || name.compare(name.size() - 12, 12, ".standin-tmp") != 0)
+				{
+					names.push_back(name);
+				}
+			}
+			// Listed by name so every run sees the same order
+			std::sort(names.begin(), names.end());
+			for (const std::string& name : names)
+			{
+				StandInUrl child = parsed;
+				child.path = (parsed.path.back() == '/' ? parsed.path : parsed.path + "/") + name;
+				EntryStrings entry;
+				entry.relativePath = name;
+				if (statLocal(child.localPath(), child.checkpointFolder(), entry))
+				{
+					strings.push_back(std::move(entry));
+				}
+			}
+		}
+		else
+		{
+			// Listing a file lists just the file
+			EntryStrings entry;
+			entry.relativePath = fs::path(parsed.path).filename().string();
+			if (statLocal(localPath, parsed.checkpointFolder(), entry))
+			{
+				strings.push_back(std::move(entry));
+			}
+			else
+			{
+				result = eOmniClientResult_ErrorNotFound;
+			}
+		}
+
+		std::vector<OmniClientListEntry> entries;
+		for (EntryStrings& entry : strings)
+		{
+			entry.finalize();
+			entries.push_back(entry.entry);
+		}
+		if (callback)
+		{
+			callback(userData, result, uint32_t(entries.size()), entries.data());
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientReadFile(char const* url, void* userData, OmniClientReadFileCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientReadFile);
+		return real(url, userData, callback);
+	}
+
+	const std::string localPath = parsed.readPath();
+	return submit("read", parsed.withoutQuery(), localFileSize(localPath), 0, [localPath, userData, callback]()
+	{
+		OmniClientContent content = {};
+		const bool ok = readLocalFile(localPath, content);
+		const std::string version = std::to_string(standInModifiedTimeNs(localPath));
+		if (callback)
+		{
+			callback(userData, ok ? eOmniClientResult_Ok : eOmniClientResult_ErrorNotFound, version.c_str(), ok ? &content : nullptr);
+		}
+		// Unless the callback moved the content out
+		if (content.buffer && content.free)
+		{
+			content.free(content.buffer);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientWriteFile(char const* url, struct OmniClientContent* content, void* userData, OmniClientWriteFileCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientWriteFile);
+		return real(url, content, userData, callback);
+	}
+
+	// The library owns the content from here on
+	OmniClientContent owned = {};
+	if (content)
+	{
+		owned = *content;
+		*content = OmniClientContent{};
+	}
+	return submit("write", parsed.withoutQuery(), 0, owned.size, [parsed, owned, userData, callback]()
+	{
+		const bool ok = !parsed.query.empty() ? false : writeLocalFile(parsed.localPath(), owned.buffer, owned.size);
+		if (owned.buffer && owned.free)
+		{
+			owned.free(owned.buffer);
+		}
+		if (callback)
+		{
+			callback(userData, ok ? eOmniClientResult_Ok : eOmniClientResult_Error);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientCopy(char const* srcUrl, char const* dstUrl, void* userData, OmniClientCopyCallback callback, OmniClientCopyBehavior behavior) OMNICLIENT_NOEXCEPT
+{
+	std::string srcPath;
+	std::string dstPath;
+	bool srcServed = false;
+	bool dstServed = false;
+	if (!standInLocalPath(srcUrl, srcPath, srcServed) || !standInLocalPath(dstUrl, dstPath, dstServed) || (!srcServed && !dstServed))
+	{
+		STANDIN_REAL(omniClientCopy);
+		return real(srcUrl, dstUrl, userData, callback, behavior);
+	}
+	if (srcServed)
+	{
+		StandInUrl parsed;
+		parsed.parse(srcUrl);
+		srcPath = parsed.readPath();
+	}
+
+	// A copy on the server moves no data to or from the client
+	const uint64_t size = localFileSize(srcPath);
+	const std::string key = std::string(srcServed ? srcUrl : dstUrl);
+	return submit("copy", key, srcServed && !dstServed ? size : 0, !srcServed && dstServed ? size : 0,
+		[srcPath, dstPath, userData, callback, behavior]()
+	{
+		OmniClientResult result = eOmniClientResult_Ok;
+		std::error_code error;
+		if (!fs::exists(srcPath, error))
+		{
+			result = eOmniClientResult_ErrorNotFound;
+		}
+		else if (behavior == eOmniClientCopy_ErrorIfExists && fs::exists(dstPath, error))
+		{
+			result = eOmniClientResult_ErrorAlreadyExists;
+		}
+		else
+		{
+			fs::create_directories(fs::path(dstPath).parent_path(), error);
+			fs::copy(srcPath, dstPath, fs::copy_options::recursive | fs::copy_options::overwrite_existing, error);
+			result = error ? eOmniClientResult_Error : eOmniClientResult_Ok;
+		}
+		if (callback)
+		{
+			callback(userData, result);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientDelete(char const* url, void* userData, OmniClientDeleteCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientDelete);
+		return real(url, userData, callback);
+	}
+
+	return submit("delete", parsed.withoutQuery(), 0, 0, [parsed, userData, callback]()
+	{
+		std::error_code error;
+		const bool removed = fs::remove_all(parsed.localPath(), error) > 0;
+		fs::remove_all(parsed.checkpointFolder(), error);
+		if (callback)
+		{
+			callback(userData, removed ? eOmniClientResult_Ok : eOmniClientResult_ErrorNotFound);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientCreateFolder(char const* url, void* userData, OmniClientCreateFolderCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientCreateFolder);
+		return real(url, userData, callback);
+	}
+
+	return submit("createFolder", parsed.withoutQuery(), 0, 0, [parsed, userData, callback]()
+	{
+		std::error_code error;
+		OmniClientResult result = eOmniClientResult_Ok;
+		if (fs::exists(parsed.localPath(), error))
+		{
+			result = eOmniClientResult_ErrorAlreadyExists;
+		}
+		else if (!fs::create_directories(parsed.localPath(), error))
+		{
+			result = eOmniClientResult_Error;
+		}
+		if (callback)
+		{
+			callback(userData, result);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientCreateCheckpoint(char const* url, char const* comment, bool force, void* userData, OmniClientCreateCheckpointCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientCreateCheckpoint);
+		return real(url, comment, force, userData, callback);
+	}
+
+	const std::string commentText = comment ? comment : "";
+	return submit("checkpoint", parsed.withoutQuery(), 0, 0, [parsed, commentText, force, userData, callback]()
+	{
+		const std::string localPath = parsed.localPath();
+		const std::string folder = parsed.checkpointFolder();
+		OmniClientResult result = eOmniClientResult_Ok;
+		std::string query;
+
+		OmniClientContent content = {};
+		if (!readLocalFile(localPath, content))
+		{
+			result = eOmniClientResult_ErrorNotFound;
+		}
+		else
+		{
+			const std::vector<uint32_t> numbers = listCheckpointNumbers(folder);
+			const uint32_t latest = numbers.empty() ? 0 : numbers.back();
+			OmniClientContent latestContent = {};
+			if (!force && latest > 0 && readLocalFile(folder + "/" + std::to_string(latest), latestContent) &&
+				latestContent.size == content.size && std::memcmp(latestContent.buffer, content.buffer, content.size) == 0)
+			{
+				// Nothing changed since the last checkpoint
+				result = eOmniClientResult_OkLatest;
+				query = "&" + std::to_string(latest);
+			}
+			else
+			{
+				const std::string number = std::to_string(latest + 1);
+				const bool ok = writeLocalFile(folder + "/" + number, content.buffer, content.size) &&
+					writeLocalFile(folder + "/" + number + ".comment", commentText.data(), commentText.size());
+				result = ok ? eOmniClientResult_Ok : eOmniClientResult_Error;
+				query = "&" + number;
+			}
+			std::free(latestContent.buffer);
+		}
+		std::free(content.buffer);
+
+		if (callback)
+		{
+			callback(userData, result, result == eOmniClientResult_Ok || result == eOmniClientResult_OkLatest ? query.c_str() : nullptr);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientListCheckpoints(char const* url, void* userData, OmniClientListCheckpointsCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientListCheckpoints);
+		return real(url, userData, callback);
+	}
+
+	return submit("listCheckpoints", parsed.withoutQuery(), 0, 0, [parsed, userData, callback]()
+	{
+		const std::string folder = parsed.checkpointFolder();
+		const std::string name = fs::path(parsed.path).filename().string();
+		std::vector<EntryStrings> strings;
+		for (uint32_t number : listCheckpointNumbers(folder))
+		{
+			EntryStrings entry;
+			if (statLocal(folder + "/" + std::to_string(number), std::string(), entry))
+			{
+				// Relative to the folder of the file, so it combines into a URL that reads the checkpoint
+				entry.relativePath = name + "?&" + std::to_string(number);
+				entry.entry.flags |= fOmniClientItem_IsCheckpointed;
+				std::ifstream comment(folder + "/" + std::to_string(number) + ".comment", std::ios::binary);
+				entry.comment.assign(std::istreambuf_iterator<char>(comment), std::istreambuf_iterator<char>());
+				strings.push_back(std::move(entry));
+			}
+		}
+
+		std::error_code error;
+		const OmniClientResult result = fs::exists(parsed.localPath(), error) ? eOmniClientResult_Ok : eOmniClientResult_ErrorNotFound;
+		std::vector<OmniClientListEntry> entries;
+		for (EntryStrings& entry : strings)
+		{
+			entry.finalize();
+			entries.push_back(entry.entry);
+		}
+		if (callback)
+		{
+			callback(userData, result, uint32_t(entries.size()), entries.data());
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientGetServerInfo(char const* url, void* userData, OmniClientGetServerInfoCallback callback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientGetServerInfo);
+		return real(url, userData, callback);
+	}
+
+	return submit("serverInfo", parsed.serverPrefix(), 0, 0, [userData, callback]()
+	{
+		OmniClientServerInfo info = {};
+		info.version = "omniStandIn";
+		info.username = StandInConfig::get().user.c_str();
+		info.checkpointsEnabled = true;
+		if (callback)
+		{
+			callback(userData, eOmniClientResult_Ok, &info);
+		}
+	});
+}
+
+OMNICLIENT_EXPORT(OmniClientRequestId) omniClientStatSubscribe(char const* url, void* userData, OmniClientStatCallback callback, OmniClientStatSubscribeCallback subscribeCallback) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url))
+	{
+		STANDIN_REAL(omniClientStatSubscribe);
+		return real(url, userData, callback, subscribeCallback);
+	}
+
+	std::shared_ptr<Subscription> subscription = std::make_shared<Subscription>();
+	subscription->url = parsed;
+	subscription->userData = userData;
+	subscription->callback = subscribeCallback;
+	subscription->id = StandInRequests::get().open();
+
+	// Changes are reported against the state at the time of the subscription
+	EntryStrings strings;
+	subscription->existed = statLocal(parsed.localPath(), parsed.checkpointFolder(), strings);
+	subscription->modifiedNs = strings.entry.modifiedTimeNs;
+	subscription->size = strings.entry.size;
+
+	{
+		std::lock_guard<std::mutex> lock(gSubscriptionMutex);
+		gSubscriptions.push_back(subscription);
+	}
+	omniClientStat(url, userData, callback);
+	if (subscribeCallback)
+	{
+		subscription->pollKey = StandInPoller::get().add([subscription]() { pollSubscription(subscription); });
+	}
+	return subscription->id;
+}
+
+OMNICLIENT_EXPORT(void) omniClientStop(OmniClientRequestId requestId) OMNICLIENT_NOEXCEPT
+{
+	if (!StandInRequests::isStandInRequest(requestId))
+	{
+		STANDIN_REAL(omniClientStop);
+		real(requestId);
+		return;
+	}
+	// Requests complete on their own, only subscriptions can be stopped
+	stopSubscription(requestId);
+}
+
+OMNICLIENT_EXPORT(void) omniClientWait(OmniClientRequestId requestId) OMNICLIENT_NOEXCEPT
+{
+	if (!StandInRequests::isStandInRequest(requestId))
+	{
+		STANDIN_REAL(omniClientWait);
+		real(requestId);
+		return;
+	}
+	StandInRequests::get().wait(requestId);
+}
+
+OMNICLIENT_EXPORT(void) omniClientShutdown() OMNICLIENT_NOEXCEPT
+{
+	std::vector<OmniClientRequestId> subscriptions;
+	{
+		std::lock_guard<std::mutex> lock(gSubscriptionMutex);
+		for (const std::shared_ptr<Subscription>& subscription : gSubscriptions)
+		{
+			subscriptions.push_back(subscription->id);
+		}
+	}
+	for (OmniClientRequestId id : subscriptions)
+	{
+		stopSubscription(id);
+	}
+	StandInRequests::get().waitAll();
+
+	STANDIN_REAL(omniClientShutdown);
+	real();
+}
@@ -0,0 +1,194 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// omniUsdLive for layers served by the stand-in.  There's no delta protocol:
+// a writer's Save() puts the whole layer in the local file, the other
+// processes notice the new modified time and omniUsdLiveProcess() reloads
+// the layer, which USD turns into the usual change notices.
+
+#include "StandIn.h"
+#include "StandInRequests.h"
+#include "StandInResolver.h"
+
+#include "OmniClient.h"
+#include "OmniUsdLive.h"
+
+#include "pxr/usd/sdf/layer.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+	std::mutex gLiveMutex;
+	bool gDefaultEnabled = false;
+	std::unordered_map<std::string, OmniUsdLiveMode> gModes;
+	OmniUsdLiveQueuedCallback gQueuedCallback = nullptr;
+	uint64_t gPollKey = 0;
+	// The modified time of every live layer file as last seen by the poller
+	// and by omniUsdLiveProcess()
+	std::unordered_map<std::string, uint64_t> gPolledModifiedNs;
+	std::unordered_map<std::string, uint64_t> gProcessedModifiedNs;
+
+	struct LiveLayer
+	{
+		SdfLayerHandle layer;
+		std::string url;
+		std::string localPath;
+	};
+
+	std::vector<LiveLayer> liveLayers()
+	{
+		std::vector<LiveLayer> layers;
+		for (const SdfLayerHandle& layer : SdfLayer::GetLoadedLayers())
+		{
+			StandInUrl url;
+			if (layer && url.parse(layer->GetIdentifier().c_str()) && standInIsLiveUrl(url.withoutQuery()))
+			{
+				layers.push_back(LiveLayer{ layer, url.withoutQuery(), url.localPath() });
+			}
+		}
+		return layers;
+	}
+
+	// Runs on the poller thread, queues the callback when another process
+	// changed a live layer
+	void pollLiveLayers()
+	{
+		OmniUsdLiveQueuedCallback callback;
+		{
+			std::lock_guard<std::mutex> lock(gLiveMutex);
+			callback = gQueuedCallback;
+		}
+		if (!callback)
+		{
+			return;
+		}
+
+		std::string changedUrl;
+		for (const LiveLayer& layer : liveLayers())
+		{
+			const uint64_t modifiedNs = standInModifiedTimeNs(layer.localPath);
+			std::lock_guard<std::mutex> lock(gLiveMutex);
+			uint64_t& polled = gPolledModifiedNs[layer.localPath];
+			if (polled != 0 && polled != modifiedNs)
+			{
+				changedUrl = layer.url;
+			}
+			polled = modifiedNs;
+		}
+		if (!changedUrl.empty())
+		{
+			// The server would tell the client after the one way latency
+			StandInRequests::get().submit(StandInLink::get().schedule("live", changedUrl, 0, 0), [callback]() { callback(); });
+		}
+	}
+}
+
+bool standInIsLiveUrl(const std::string& url)
+{
+	StandInUrl parsed;
+	if (!parsed.parse(url.c_str()))
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(gLiveMutex);
+	auto mode = gModes.find(parsed.withoutQuery());
+	if (mode != gModes.end() && mode->second == OmniUsdLiveMode::eOmniUsdLiveModeEnabled)
+	{
+		return true;
+	}
+	if (mode != gModes.end() && mode->second == OmniUsdLiveMode::eOmniUsdLiveModeDisabled)
+	{
+		return false;
+	}
+	return gDefaultEnabled;
+}
+
+OMNICLIENT_EXPORT(void) omniUsdLiveSetDefaultEnabled(bool enabled) OMNICLIENT_NOEXCEPT
+{
+	std::lock_guard<std::mutex> lock(gLiveMutex);
+	gDefaultEnabled = enabled;
+}
+
+OMNICLIENT_EXPORT(bool) omniUsdLiveGetDefaultEnabled() OMNICLIENT_NOEXCEPT
+{
+	std::lock_guard<std::mutex> lock(gLiveMutex);
+	return gDefaultEnabled;
+}
+
+OMNICLIENT_EXPORT(void) omniUsdLiveSetModeForUrl(const char* url, OmniUsdLiveMode mode) OMNICLIENT_NOEXCEPT
+{
+	StandInUrl parsed;
+	if (parsed.parse(url))
+	{
+		std::lock_guard<std::mutex> lock(gLiveMutex);
+		gModes[parsed.withoutQuery()] = mode;
+	}
+}
+
+OMNICLIENT_EXPORT(void) omniUsdLiveSetQueuedCallback(OmniUsdLiveQueuedCallback callback) OMNICLIENT_NOEXCEPT
+{
+	std::lock_guard<std::mutex> lock(gLiveMutex);
+	gQueuedCallback = callback;
+	if (callback && gPollKey == 0)
+	{
+		gPollKey = StandInPoller::get().add(pollLiveLayers);
+	}
+}
+
+OMNICLIENT_EXPORT(void) omniUsdLiveProcess() OMNICLIENT_NOEXCEPT
+{
+	// The writer's save already paid for the transfer
+	StandInLink::FreeScope freeRequests;
+	for (const LiveLayer& layer : liveLayers())
+	{
+		// Local edits that weren't saved yet win over the file
+		if (layer.layer->IsDirty())
+		{
+			continue;
+		}
+		const uint64_t modifiedNs = standInModifiedTimeNs(layer.localPath);
+		{
+			std::lock_guard<std::mutex> lock(gLiveMutex);
+			uint64_t& processed = gProcessedModifiedNs[layer.localPath];
+			if (processed == modifiedNs)
+			{
+				continue;
+			}
+			processed = modifiedNs;
+		}
+		// Reload() compares the modified time with the one the layer was
+		// read or saved at, so this process's own saves don't reload
+		layer.layer->Reload();
+	}
+}
+
+OMNICLIENT_EXPORT(void) omniUsdLiveWaitForPendingUpdates() OMNICLIENT_NOEXCEPT
+{
+	// Saves are written before Save() returns, nothing is ever pending
+}
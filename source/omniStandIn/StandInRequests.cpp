@@ -0,0 +1,183 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "StandInRequests.h"
+#include "StandIn.h"
+
+StandInRequests& StandInRequests::get()
+{
+	static StandInRequests requests;
+	return requests;
+}
+
+StandInRequests::StandInRequests()
+{
+	for (int i = 0; i < StandInConfig::get().threads; ++i)
+	{
+		mThreads.emplace_back(&StandInRequests::worker, this);
+	}
+}
+
+StandInRequests::~StandInRequests()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mQueued.notify_all();
+	for (std::thread& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+StandInRequests::RequestId StandInRequests::submit(Clock::time_point due, std::function<void()> work)
+{
+	RequestId id;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		id = kStandInBit | mNextId++;
+		mPending.insert(id);
+		mQueue.push(Task{ due, id, std::move(work) });
+	}
+	mQueued.notify_all();
+	return id;
+}
+
+StandInRequests::RequestId StandInRequests::open()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	const RequestId id = kStandInBit | mNextId++;
+	mPending.insert(id);
+	return id;
+}
+
+void StandInRequests::finish(RequestId id)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPending.erase(id);
+	}
+	mFinished.notify_all();
+}
+
+void StandInRequests::wait(RequestId id)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mFinished.wait(lock, [&]() { return mPending.count(id) == 0; });
+}
+
+void StandInRequests::waitAll()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mFinished.wait(lock, [&]() { return mQueue.empty() && mPending.size() == 0; });
+}
+
+void StandInRequests::worker()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true)
+	{
+		if (mStopping)
+		{
+			return;
+		}
+		if (mQueue.empty())
+		{
+			mQueued.wait(lock);
+			continue;
+		}
+		const Clock::time_point due = mQueue.top().due;
+		if (Clock::now() < due)
+		{
+			mQueued.wait_until(lock, due);
+			continue;
+		}
+
+		Task task = mQueue.top();
+		mQueue.pop();
+		lock.unlock();
+		task.work();
+		lock.lock();
+		mPending.erase(task.id);
+		mFinished.notify_all();
+	}
+}
+
+StandInPoller& StandInPoller::get()
+{
+	static StandInPoller poller;
+	return poller;
+}
+
+StandInPoller::~StandInPoller()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mStopped.notify_all();
+	if (mThread.joinable())
+	{
+		mThread.join();
+	}
+}
+
+uint64_t StandInPoller::add(std::function<void()> check)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	const uint64_t key = mNextKey++;
+	mChecks.emplace(key, std::move(check));
+	if (!mThread.joinable())
+	{
+		mThread = std::thread(&StandInPoller::run, this);
+	}
+	return key;
+}
+
+void StandInPoller::remove(uint64_t key)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mChecks.erase(key);
+}
+
+void StandInPoller::run()
+{
+	const std::chrono::milliseconds interval(StandInConfig::get().pollMs);
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (!mStopped.wait_for(lock, interval, [&]() { return mStopping; }))
+	{
+		// Checks may add or remove checks, so run a copy without the lock
+		std::vector<std::function<void()>> checks;
+		for (const auto& check : mChecks)
+		{
+			checks.push_back(check.second);
+		}
+		lock.unlock();
+		for (const std::function<void()>& check : checks)
+		{
+			check();
+		}
+		lock.lock();
+	}
+}
@@ -0,0 +1,116 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Runs the stand-in's requests on a few worker threads once they are due.
+// Request ids have the top bit set so omniClientWait() and omniClientStop()
+// can tell them from the ids of the real client library.
+class StandInRequests
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	using RequestId = uint64_t;
+
+	static constexpr RequestId kStandInBit = RequestId(1) << 63;
+
+	static StandInRequests& get();
+
+	static bool isStandInRequest(RequestId id)
+	{
+		return (id & kStandInBit) != 0;
+	}
+
+	// Run work on a worker at due, the callbacks of the request run there
+	RequestId submit(Clock::time_point due, std::function<void()> work);
+
+	// An id that stays pending until finish(), for subscriptions
+	RequestId open();
+	void finish(RequestId id);
+
+	// Block until the request has completed (or the subscription has stopped)
+	void wait(RequestId id);
+	void waitAll();
+
+private:
+	struct Task
+	{
+		Clock::time_point due;
+		RequestId id;
+		std::function<void()> work;
+
+		// Earliest first, in submission order when due at the same time
+		bool operator<(const Task& other) const
+		{
+			return due != other.due ? due > other.due : id > other.id;
+		}
+	};
+
+	StandInRequests();
+	~StandInRequests();
+	void worker();
+
+	std::mutex mMutex;
+	std::condition_variable mQueued;
+	std::condition_variable mFinished;
+	std::priority_queue<Task> mQueue;
+	std::unordered_set<RequestId> mPending;
+	RequestId mNextId = 1;
+	bool mStopping = false;
+	std::vector<std::thread> mThreads;
+};
+
+// Calls the registered checks every OMNI_STANDIN_POLL_MS on a background
+// thread, which is how stat subscriptions and live layers notice changes
+// another process made under the root
+class StandInPoller
+{
+public:
+	static StandInPoller& get();
+
+	uint64_t add(std::function<void()> check);
+	void remove(uint64_t key);
+
+private:
+	StandInPoller() = default;
+	~StandInPoller();
+	void run();
+
+	std::mutex mMutex;
+	std::condition_variable mStopped;
+	std::unordered_map<uint64_t, std::function<void()>> mChecks;
+	uint64_t mNextKey = 1;
+	bool mStopping = false;
+	std::thread mThread;
+};
@@ -0,0 +1,255 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "StandInResolver.h"
+#include "StandIn.h"
+
+#include "pxr/base/arch/fileSystem.h"
+#include "pxr/base/tf/fileUtils.h"
+#include "pxr/base/tf/notice.h"
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/base/tf/weakBase.h"
+#include "pxr/usd/ar/asset.h"
+#include "pxr/usd/ar/assetInfo.h"
+#include "pxr/usd/ar/defineResolver.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/sdf/notice.h"
+
+#include <mutex>
+#include <unordered_map>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+PXR_NAMESPACE_OPEN_SCOPE
+AR_DEFINE_RESOLVER(StandInResolver, ArDefaultResolver);
+PXR_NAMESPACE_CLOSE_SCOPE
+
+namespace
+{
+	// The library is preloaded, so this runs before main() and before
+	// anything asks for the resolver
+	struct PreferStandInResolver
+	{
+		PreferStandInResolver()
+		{
+			ArSetPreferredResolver("StandInResolver");
+		}
+	} gPreferStandInResolver;
+
+	// The modified time of every served file as of the last read or save
+	// through USD, to tell which layers a save wrote
+	std::mutex gKnownMutex;
+	std::unordered_map<std::string, uint64_t> gKnownModifiedNs;
+
+	// Remember the modified time of a file, true when it changed
+	bool rememberModifiedTime(const std::string& localPath, uint64_t modifiedNs)
+	{
+		std::lock_guard<std::mutex> lock(gKnownMutex);
+		uint64_t& known = gKnownModifiedNs[localPath];
+		const bool changed = known != modifiedNs;
+		known = modifiedNs;
+		return changed;
+	}
+
+	bool isUnderRoot(const std::string& path)
+	{
+		const std::string& root = StandInConfig::get().root;
+		return path.size() > root.size() && path.compare(0, root.size(), root) == 0 && path[root.size()] == '/';
+	}
+
+	uint64_t fileSize(const std::string& localPath)
+	{
+		const int64_t length = ArchGetFileLength(localPath.c_str());
+		return length > 0 ? uint64_t(length) : 0;
+	}
+}
+
+// Ar has no hook for writing a layer, Sdf writes the resolved (local) path
+// itself.  A save is charged when Sdf announces it: the served layers whose
+// files changed since they were last read or saved are the ones it wrote.
+class StandInResolver::SaveListener : public TfWeakBase
+{
+public:
+	SaveListener()
+	{
+		mKey = TfNotice::Register(TfCreateWeakPtr(this), &SaveListener::onSave);
+	}
+
+	~SaveListener()
+	{
+		TfNotice::Revoke(mKey);
+	}
+
+private:
+	void onSave(const SdfNotice::LayerDidSaveLayerToFile&)
+	{
+		for (const SdfLayerHandle& layer : SdfLayer::GetLoadedLayers())
+		{
+			StandInUrl url;
+			if (!layer || !url.parse(layer->GetIdentifier().c_str()))
+			{
+				continue;
+			}
+			const std::string localPath = url.localPath();
+			if (!rememberModifiedTime(localPath, standInModifiedTimeNs(localPath)))
+			{
+				continue;
+			}
+			// A live layer would only send the changes, a small message
+			const std::string key = url.withoutQuery();
+			StandInLink::get().charge("write", key, 0, standInIsLiveUrl(key) ? 0 : fileSize(localPath));
+		}
+	}
+
+	TfNotice::Key mKey;
+};
+
+StandInResolver::StandInResolver()
+	: mSaveListener(new SaveListener())
+{
+}
+
+StandInResolver::~StandInResolver() = default;
+
+std::string StandInResolver::AnchorRelativePath(const std::string& anchorPath, const std::string& path)
+{
+	if (isStandInUrl(anchorPath.c_str()))
+	{
+		return standInAnchorUrl(anchorPath, path);
+	}
+	return ArDefaultResolver::AnchorRelativePath(anchorPath, path);
+}
+
+bool StandInResolver::IsRelativePath(const std::string& path)
+{
+	return !isStandInUrl(path.c_str()) && ArDefaultResolver::IsRelativePath(path);
+}
+
+bool StandInResolver::IsRepositoryPath(const std::string& path)
+{
+	return !isStandInUrl(path.c_str()) && ArDefaultResolver::IsRepositoryPath(path);
+}
+
+bool StandInResolver::IsSearchPath(const std::string& path)
+{
+	return !isStandInUrl(path.c_str()) && ArDefaultResolver::IsSearchPath(path);
+}
+
+std::string StandInResolver::ComputeNormalizedPath(const std::string& path)
+{
+	// The default would collapse the // of the scheme
+	StandInUrl url;
+	if (url.parse(path.c_str()))
+	{
+		return url.query.empty() ? url.withoutQuery() : url.withoutQuery() + "?" + url.query;
+	}
+	return ArDefaultResolver::ComputeNormalizedPath(path);
+}
+
+std::string StandInResolver::ComputeRepositoryPath(const std::string& path)
+{
+	return isStandInUrl(path.c_str()) ? path : ArDefaultResolver::ComputeRepositoryPath(path);
+}
+
+std::string StandInResolver::ComputeLocalPath(const std::string& path)
+{
+	// Where SdfLayer::CreateNew() writes a new layer
+	StandInUrl url;
+	return url.parse(path.c_str()) ? url.localPath() : ArDefaultResolver::ComputeLocalPath(path);
+}
+
+std::string StandInResolver::Resolve(const std::string& path)
+{
+	StandInUrl url;
+	if (!url.parse(path.c_str()))
+	{
+		return ArDefaultResolver::Resolve(path);
+	}
+	// Finding out whether the layer exists is a round trip to the server
+	StandInLink::get().charge("stat", url.withoutQuery(), 0, 0);
+	const std::string localPath = url.readPath();
+	return TfIsFile(localPath) ? localPath : std::string();
+}
+
+std::string StandInResolver::ResolveWithAssetInfo(const std::string& path, ArAssetInfo* assetInfo)
+{
+	if (!isStandInUrl(path.c_str()))
+	{
+		return ArDefaultResolver::ResolveWithAssetInfo(path, assetInfo);
+	}
+	return Resolve(path);
+}
+
+bool StandInResolver::FetchToLocalResolvedPath(const std::string& path, const std::string& resolvedPath)
+{
+	// The resolved path of a served layer already is a local file
+	return isStandInUrl(path.c_str()) || ArDefaultResolver::FetchToLocalResolvedPath(path, resolvedPath);
+}
+
+std::shared_ptr<ArAsset> StandInResolver::OpenAsset(const std::string& resolvedPath)
+{
+	if (isUnderRoot(resolvedPath))
+	{
+		StandInLink::get().charge("read", resolvedPath, fileSize(resolvedPath), 0);
+		rememberModifiedTime(resolvedPath, standInModifiedTimeNs(resolvedPath));
+	}
+	return ArDefaultResolver::OpenAsset(resolvedPath);
+}
+
+bool StandInResolver::CreatePathForLayer(const std::string& path)
+{
+	StandInUrl url;
+	if (!url.parse(path.c_str()))
+	{
+		return ArDefaultResolver::CreatePathForLayer(path);
+	}
+	const std::string folder = TfGetPathName(url.localPath());
+	return folder.empty() || TfIsDir(folder) || TfMakeDirs(folder, -1, true);
+}
+
+bool StandInResolver::CanWriteLayerToPath(const std::string& path, std::string* whyNot)
+{
+	StandInUrl url;
+	if (!url.parse(path.c_str()))
+	{
+		return ArDefaultResolver::CanWriteLayerToPath(path, whyNot);
+	}
+	if (!url.query.empty())
+	{
+		if (whyNot)
+		{
+			*whyNot = "checkpoints are read only";
+		}
+		return false;
+	}
+	return true;
+}
+
+bool StandInResolver::CanCreateNewLayerWithIdentifier(const std::string& identifier, std::string* whyNot)
+{
+	if (!isStandInUrl(identifier.c_str()))
+	{
+		return ArDefaultResolver::CanCreateNewLayerWithIdentifier(identifier, whyNot);
+	}
+	return CanWriteLayerToPath(identifier, whyNot);
+}
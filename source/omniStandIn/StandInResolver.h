@@ -0,0 +1,67 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include "pxr/pxr.h"
+#include "pxr/usd/ar/defaultResolver.h"
+
+#include <memory>
+#include <string>
+
+// Resolves omniverse:// layer and asset paths to the files under the
+// stand-in root, so USD reads and writes them locally.  Layer identifiers
+// stay URLs, only the resolved paths are local.  Reading a layer pays the
+// link like omniClientReadFile does, and saving one pays for the upload
+// (see StandInResolver.cpp).
+//
+// The library makes itself the preferred resolver when it's loaded, which
+// needs its plugInfo.json on PXR_PLUGINPATH_NAME.
+class StandInResolver : public pxr::ArDefaultResolver
+{
+public:
+	StandInResolver();
+	~StandInResolver() override;
+
+	std::string AnchorRelativePath(const std::string& anchorPath, const std::string& path) override;
+	bool IsRelativePath(const std::string& path) override;
+	bool IsRepositoryPath(const std::string& path) override;
+	bool IsSearchPath(const std::string& path) override;
+	std::string ComputeNormalizedPath(const std::string& path) override;
+	std::string ComputeRepositoryPath(const std::string& path) override;
+	std::string ComputeLocalPath(const std::string& path) override;
+	std::string Resolve(const std::string& path) override;
+	std::string ResolveWithAssetInfo(const std::string& path, pxr::ArAssetInfo* assetInfo) override;
+	bool FetchToLocalResolvedPath(const std::string& path, const std::string& resolvedPath) override;
+	std::shared_ptr<pxr::ArAsset> OpenAsset(const std::string& resolvedPath) override;
+	bool CreatePathForLayer(const std::string& path) override;
+	bool CanWriteLayerToPath(const std::string& path, std::string* whyNot) override;
+	bool CanCreateNewLayerWithIdentifier(const std::string& identifier, std::string* whyNot) override;
+
+private:
+	class SaveListener;
+	std::unique_ptr<SaveListener> mSaveListener;
+};
+
+// True when layers of the URL receive live updates (StandInLive.cpp)
+bool standInIsLiveUrl(const std::string& url);
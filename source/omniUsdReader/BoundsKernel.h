@@ -0,0 +1,101 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define OMNI_READER_USE_SSE 1
+#endif
+
+// Compute the min and max of an array of xyz float triples (eg. the data of a
+// VtVec3fArray).  NaN coordinates are ignored.  Returns false if there were no
+// points, otherwise outMin/outMax hold the per-component range.
+inline bool computePointsMinMax(const float* xyz, size_t count, float outMin[3], float outMax[3])
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	float mn[3] = { inf, inf, inf };
+	float mx[3] = { -inf, -inf, -inf };
+	size_t i = 0;
+
+#if OMNI_READER_USE_SSE
+	// 4 points are 12 floats, or 3 registers with the components rotating
+	// through the lanes: (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+	if (count >= 4)
+	{
+		__m128 min0 = _mm_set1_ps(inf), min1 = min0, min2 = min0;
+		__m128 max0 = _mm_set1_ps(-inf), max1 = max0, max2 = max0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const float* p = xyz + i * 3;
+			const __m128 v0 = _mm_loadu_ps(p);
+			const __m128 v1 = _mm_loadu_ps(p + 4);
+			const __m128 v2 = _mm_loadu_ps(p + 8);
+			// The accumulator is the second operand so a NaN in v is ignored
+			min0 = _mm_min_ps(v0, min0);
+			min1 = _mm_min_ps(v1, min1);
+			min2 = _mm_min_ps(v2, min2);
+			max0 = _mm_max_ps(v0, max0);
+			max1 = _mm_max_ps(v1, max1);
+			max2 = _mm_max_ps(v2, max2);
+		}
+
+		float lanes[12];
+		_mm_storeu_ps(lanes, min0);
+		_mm_storeu_ps(lanes + 4, min1);
+		_mm_storeu_ps(lanes + 8, min2);
+		for (int lane = 0; lane < 12; lane++)
+		{
+			const int component = lane % 3;
+			mn[component] = lanes[lane] < mn[component] ? lanes[lane] : mn[component];
+		}
+		_mm_storeu_ps(lanes, max0);
+		_mm_storeu_ps(lanes + 4, max1);
+		_mm_storeu_ps(lanes + 8, max2);
+		for (int lane = 0; lane < 12; lane++)
+		{
+			const int component = lane % 3;
+			mx[component] = lanes[lane] > mx[component] ? lanes[lane] : mx[component];
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		for (int component = 0; component < 3; component++)
+		{
+			const float value = xyz[i * 3 + component];
+			mn[component] = value < mn[component] ? value : mn[component];
+			mx[component] = value > mx[component] ? value : mx[component];
+		}
+	}
+
+	for (int component = 0; component < 3; component++)
+	{
+		outMin[component] = mn[component];
+		outMax[component] = mx[component];
+	}
+	return count > 0 && mn[0] <= mx[0] && mn[1] <= mx[1] && mn[2] <= mx[2];
+}
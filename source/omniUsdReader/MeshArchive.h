@@ -0,0 +1,103 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+/*###############################################################################
+#
+# The mesh archive written by "OmniUSDReader --extract" is a flat little-endian
+# file meant to be memory mapped and used without any parsing:
+#
+#	* MeshArchiveHeader at offset 0
+#	* MeshArchiveRecord[meshCount], one per UsdGeomMesh in traversal order
+#	* Sections, each starting on a 64 byte boundary, that hold the data of all
+#	  meshes back to back (a structure of arrays):
+#		* strings  - the mesh prim paths, each null terminated
+#		* points   - float32 xyz
+#		* counts   - int32 faceVertexCounts
+#		* indices  - int32 faceVertexIndices
+#		* normals  - float32 xyz
+#
+# Every offset is an absolute byte offset from the start of the file, so
+# (base + record.pointsOffset) is the first point of that mesh.
+#
+# This header only depends on the C++ standard library so downstream tools
+# can include it without USD.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstdint>
+
+static const char kMeshArchiveMagic[8] = { 'O', 'V', 'M', 'E', 'S', 'H', '\0', '\0' };
+static const uint32_t kMeshArchiveVersion = 1;
+static const uint64_t kMeshArchiveAlignment = 64;
+
+// How the normals of a mesh map to its topology
+enum MeshArchiveNormals : uint32_t
+{
+	eMeshArchiveNormals_None = 0,
+	eMeshArchiveNormals_Constant = 1,
+	eMeshArchiveNormals_Uniform = 2,
+	eMeshArchiveNormals_Vertex = 3,
+	eMeshArchiveNormals_FaceVarying = 4,
+};
+
+struct MeshArchiveHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t meshCount;
+	uint64_t recordsOffset;
+	uint64_t stringsOffset;
+	uint64_t stringsSize;
+	uint64_t pointsOffset;
+	uint64_t pointCount;
+	uint64_t countsOffset;
+	uint64_t faceCount;
+	uint64_t indicesOffset;
+	uint64_t indexCount;
+	uint64_t normalsOffset;
+	uint64_t normalCount;
+	uint64_t fileSize;
+};
+
+struct MeshArchiveRecord
+{
+	uint64_t pathOffset;
+	uint64_t pointsOffset;
+	uint64_t pointCount;
+	uint64_t countsOffset;
+	uint64_t faceCount;
+	uint64_t indicesOffset;
+	uint64_t indexCount;
+	uint64_t normalsOffset;
+	uint64_t normalCount;
+	uint32_t pathLength;
+	uint32_t normalsInterpolation;
+
+	// Row major local to world matrix (USD row vector convention)
+	double localToWorld[16];
+};
+
+static_assert(sizeof(MeshArchiveHeader) == 112, "MeshArchiveHeader layout changed");
+static_assert(sizeof(MeshArchiveRecord) == 208, "MeshArchiveRecord layout changed");
@@ -0,0 +1,240 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "MeshExtract.h"
+#include "MeshArchive.h"
+#include "StageTraversal.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/tf/token.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/primvarsAPI.h"
+#include "pxr/usd/usdGeom/xformCache.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+using Clock = std::chrono::steady_clock;
+
+// A mesh and its world transform, the only copy of the arrays is the write to the file
+struct ExtractedMesh : MeshData
+{
+	GfMatrix4d localToWorld;
+};
+
+static uint32_t toArchiveInterpolation(const TfToken& interpolation)
+{
+	if (interpolation == UsdGeomTokens->constant)
+		return eMeshArchiveNormals_Constant;
+	if (interpolation == UsdGeomTokens->uniform)
+		return eMeshArchiveNormals_Uniform;
+	if (interpolation == UsdGeomTokens->faceVarying)
+		return eMeshArchiveNormals_FaceVarying;
+	return eMeshArchiveNormals_Vertex;
+}
+
+void readMeshData(const UsdPrim& prim, MeshData& out)
+{
+	UsdGeomMesh mesh(prim);
+	out.path = prim.GetPath().GetString();
+	mesh.GetPointsAttr().Get(&out.points);
+	mesh.GetFaceVertexCountsAttr().Get(&out.faceVertexCounts);
+	mesh.GetFaceVertexIndicesAttr().Get(&out.faceVertexIndices);
+
+	static const TfToken normalsToken("normals");
+	UsdGeomPrimvar normalsPrimvar = UsdGeomPrimvarsAPI(prim).GetPrimvar(normalsToken);
+	if (normalsPrimvar && normalsPrimvar.HasAuthoredValue() && normalsPrimvar.ComputeFlattened(&out.normals))
+	{
+		out.normalsInterpolation = toArchiveInterpolation(normalsPrimvar.GetInterpolation());
+	}
+	else if (mesh.GetNormalsAttr().Get(&out.normals) && !out.normals.empty())
+	{
+		out.normalsInterpolation = toArchiveInterpolation(mesh.GetNormalsInterpolation());
+	}
+	else
+	{
+		out.normals.clear();
+	}
+}
+
+static uint64_t alignUp(uint64_t offset)
+{
+	return (offset + kMeshArchiveAlignment - 1) & ~(kMeshArchiveAlignment - 1);
+}
+
+// Writes with explicit offsets, padding with zeros up to each section start
+class ArchiveWriter
+{
+public:
+	explicit ArchiveWriter(FILE* file) : mFile(file) {}
+
+	void padTo(uint64_t offset)
+	{
+		static const char zeros[kMeshArchiveAlignment] = {};
+		while (mOffset < offset)
+		{
+			const size_t count = size_t(std::min<uint64_t>(offset - mOffset, sizeof(zeros)));
+			write(zeros, count);
+		}
+	}
+
+	void write(const void* data, size_t size)
+	{
+		if (size > 0 && fwrite(data, 1, size, mFile) != size)
+		{
+			mFailed = true;
+		}
+		mOffset += size;
+	}
+
+	bool failed() const { return mFailed; }
+
+private:
+	FILE* mFile;
+	uint64_t mOffset = 0;
+	bool mFailed = false;
+};
+
+MeshExtractResult extractMeshes(const UsdStageRefPtr& stage, const std::string& archivePath, const Usd_PrimFlagsPredicate& predicate)
+{
+	MeshExtractResult result;
+	Clock::time_point extractStart = Clock::now();
+
+	// Find the meshes, then read them in parallel mesh by mesh so one heavy subtree is still spread over all threads.
+	// Instanced meshes are found through their instance proxies, each with its own path and world transform.
+	const std::vector<UsdPrim> meshPrims = collectStagePrims(stage, [](const UsdPrim& prim) { return prim.IsA<UsdGeomMesh>(); },
+		UsdTraverseInstanceProxies(predicate));
+	std::vector<ExtractedMesh> meshes(meshPrims.size());
+	WorkParallelForN(meshPrims.size(), [&](size_t begin, size_t end)
+	{
+		UsdGeomXformCache xformCache(UsdTimeCode::Default());
+		for (size_t i = begin; i < end; i++)
+		{
+			readMeshData(meshPrims[i], meshes[i]);
+			meshes[i].localToWorld = xformCache.GetLocalToWorldTransform(meshPrims[i]);
+		}
+	});
+	result.extractSeconds = std::chrono::duration<double>(Clock::now() - extractStart).count();
+	result.meshCount = meshes.size();
+
+	// Lay out the file: header, records, then one aligned section per array type
+	MeshArchiveHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMeshArchiveMagic, sizeof(header.magic));
+	header.version = kMeshArchiveVersion;
+	header.meshCount = uint32_t(meshes.size());
+	header.recordsOffset = alignUp(sizeof(MeshArchiveHeader));
+
+	std::vector<MeshArchiveRecord> records(meshes.size());
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const ExtractedMesh& mesh = meshes[i];
+		MeshArchiveRecord& record = records[i];
+		memset(&record, 0, sizeof(record));
+		record.pathOffset = header.stringsSize;
+		record.pathLength = uint32_t(mesh.path.size());
+		record.pointsOffset = header.pointCount;
+		record.pointCount = mesh.points.size();
+		record.countsOffset = header.faceCount;
+		record.faceCount = mesh.faceVertexCounts.size();
+		record.indicesOffset = header.indexCount;
+		record.indexCount = mesh.faceVertexIndices.size();
+		record.normalsOffset = header.normalCount;
+		record.normalCount = mesh.normals.size();
+		record.normalsInterpolation = mesh.normalsInterpolation;
+		memcpy(record.localToWorld, mesh.localToWorld.GetArray(), sizeof(record.localToWorld));
+
+		header.stringsSize += mesh.path.size() + 1;
+		header.pointCount += record.pointCount;
+		header.faceCount += record.faceCount;
+		header.indexCount += record.indexCount;
+		header.normalCount += record.normalCount;
+	}
+
+	header.stringsOffset = alignUp(header.recordsOffset + records.size() * sizeof(MeshArchiveRecord));
+	header.pointsOffset = alignUp(header.stringsOffset + header.stringsSize);
+	header.countsOffset = alignUp(header.pointsOffset + header.pointCount * sizeof(GfVec3f));
+	header.indicesOffset = alignUp(header.countsOffset + header.faceCount * sizeof(int));
+	header.normalsOffset = alignUp(header.indicesOffset + header.indexCount * sizeof(int));
+	header.fileSize = header.normalsOffset + header.normalCount * sizeof(GfVec3f);
+
+	// Turn the element offsets in the records into absolute byte offsets
+	for (MeshArchiveRecord& record : records)
+	{
+		record.pathOffset += header.stringsOffset;
+		record.pointsOffset = header.pointsOffset + record.pointsOffset * sizeof(GfVec3f);
+		record.countsOffset = header.countsOffset + record.countsOffset * sizeof(int);
+		record.indicesOffset = header.indicesOffset + record.indicesOffset * sizeof(int);
+		record.normalsOffset = header.normalsOffset + record.normalsOffset * sizeof(GfVec3f);
+	}
+
+	result.dataBytes = (header.pointCount + header.normalCount) * sizeof(GfVec3f) + (header.faceCount + header.indexCount) * sizeof(int);
+	result.fileBytes = header.fileSize;
+
+	// Write each section with one large write per mesh array
+	Clock::time_point writeStart = Clock::now();
+	FILE* file = fopen(archivePath.c_str(), "wb");
+	if (!file)
+	{
+		return result;
+	}
+	ArchiveWriter writer(file);
+	writer.write(&header, sizeof(header));
+	writer.padTo(header.recordsOffset);
+	writer.write(records.data(), records.size() * sizeof(MeshArchiveRecord));
+	writer.padTo(header.stringsOffset);
+	for (const ExtractedMesh& mesh : meshes)
+	{
+		writer.write(mesh.path.c_str(), mesh.path.size() + 1);
+	}
+	writer.padTo(header.pointsOffset);
+	for (const ExtractedMesh& mesh : meshes)
+	{
+		writer.write(mesh.points.cdata(), mesh.points.size() * sizeof(GfVec3f));
+	}
+	writer.padTo(header.countsOffset);
+	for (const ExtractedMesh& mesh : meshes)
+	{
+		writer.write(mesh.faceVertexCounts.cdata(), mesh.faceVertexCounts.size() * sizeof(int));
+	}
+	writer.padTo(header.indicesOffset);
+	for (const ExtractedMesh& mesh : meshes)
+	{
+		writer.write(mesh.faceVertexIndices.cdata(), mesh.faceVertexIndices.size() * sizeof(int));
+	}
+	writer.padTo(header.normalsOffset);
+	for (const ExtractedMesh& mesh : meshes)
+	{
+		writer.write(mesh.normals.cdata(), mesh.normals.size() * sizeof(GfVec3f));
+	}
+	const bool closed = fclose(file) == 0;
+	result.writeSeconds = std::chrono::duration<double>(Clock::now() - writeStart).count();
+
+	result.success = closed && !writer.failed();
+	return result;
+}
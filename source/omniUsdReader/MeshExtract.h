@@ -0,0 +1,65 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "pxr/base/vt/types.h"
+#include "MeshArchive.h"
+
+// The arrays of one mesh.  They share their storage with USD so reading them
+// doesn't copy anything.
+struct MeshData
+{
+	std::string path;
+	pxr::VtVec3fArray points;
+	pxr::VtIntArray faceVertexCounts;
+	pxr::VtIntArray faceVertexIndices;
+	pxr::VtVec3fArray normals;
+	uint32_t normalsInterpolation = eMeshArchiveNormals_None;
+};
+
+// Read the arrays of a UsdGeomMesh.  primvars:normals wins over the normals
+// attribute and indexed normals are flattened.
+void readMeshData(const pxr::UsdPrim& prim, MeshData& out);
+
+struct MeshExtractResult
+{
+	bool success = false;
+	size_t meshCount = 0;
+
+	// Bytes of mesh data (points, counts, indices and normals) and of the whole file
+	uint64_t dataBytes = 0;
+	uint64_t fileBytes = 0;
+
+	double extractSeconds = 0.0;
+	double writeSeconds = 0.0;
+};
+
+// Read every UsdGeomMesh in parallel and write them to a mesh archive (see MeshArchive.h)
+MeshExtractResult extractMeshes(const pxr::UsdStageRefPtr& stage, const std::string& archivePath,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate);
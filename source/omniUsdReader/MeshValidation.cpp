@@ -0,0 +1,167 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "MeshValidation.h"
+#include "MeshExtract.h"
+#include "StageTraversal.h"
+#include "ValidationKernels.h"
+#include <chrono>
+#include "pxr/base/work/loops.h"
+#include "pxr/usd/usdGeom/mesh.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+// Normals are unit length when |length^2 - 1| is within this
+static const float kUnitLengthTolerance = 1e-3f;
+
+// Triangles are degenerate when the sine of their angle is below this
+static const float kDegenerateSinTolerance = 1e-6f;
+
+const char* meshIssueName(uint32_t issue)
+{
+	switch (issue)
+	{
+	case eMeshIssue_NonFinitePoints: return "non-finite points";
+	case eMeshIssue_BadFaceCounts: return "bad face vertex counts";
+	case eMeshIssue_IndexOutOfRange: return "indices out of range";
+	case eMeshIssue_DegenerateTriangles: return "degenerate triangles";
+	case eMeshIssue_MissingNormals: return "missing normals";
+	case eMeshIssue_NormalCountMismatch: return "normal count mismatch";
+	case eMeshIssue_NonUnitNormals: return "non-unit normals";
+	default: return "unknown";
+	}
+}
+
+// The number of normals a mesh needs for its interpolation
+static size_t expectedNormalCount(const MeshData& mesh)
+{
+	switch (mesh.normalsInterpolation)
+	{
+	case eMeshArchiveNormals_Constant: return 1;
+	case eMeshArchiveNormals_Uniform: return mesh.faceVertexCounts.size();
+	case eMeshArchiveNormals_FaceVarying: return mesh.faceVertexIndices.size();
+	default: return mesh.points.size();
+	}
+}
+
+static void validateMesh(const MeshData& mesh, bool requireNormals, MeshIssueReport& report)
+{
+	report.path = mesh.path;
+	report.pointCount = mesh.points.size();
+	const float* points = reinterpret_cast<const float*>(mesh.points.cdata());
+
+	report.nonFinitePoints = countNonFiniteFloats(points, mesh.points.size() * 3);
+	if (report.nonFinitePoints > 0)
+	{
+		report.issues |= eMeshIssue_NonFinitePoints;
+	}
+
+	// Every face needs 3 or more vertices and together they use all of the indices
+	const IntSummary counts = summarizeInts(mesh.faceVertexCounts.cdata(), mesh.faceVertexCounts.size());
+	const bool countsValid = mesh.faceVertexCounts.empty() ? mesh.faceVertexIndices.empty()
+		: counts.minValue >= 3 && counts.sum == int64_t(mesh.faceVertexIndices.size());
+	if (!countsValid)
+	{
+		report.issues |= eMeshIssue_BadFaceCounts;
+	}
+
+	const IntSummary indices = summarizeInts(mesh.faceVertexIndices.cdata(), mesh.faceVertexIndices.size());
+	const bool indicesValid = mesh.faceVertexIndices.empty() || (indices.minValue >= 0 && size_t(indices.maxValue) < mesh.points.size());
+	if (!indicesValid)
+	{
+		report.issues |= eMeshIssue_IndexOutOfRange;
+		report.minIndex = indices.minValue;
+		report.maxIndex = indices.maxValue;
+	}
+
+	// The triangles can only be walked safely once the topology is known to be valid
+	if (countsValid && indicesValid)
+	{
+		report.degenerateTriangles = countDegenerateTriangles(points, mesh.faceVertexCounts.cdata(), mesh.faceVertexCounts.size(),
+			mesh.faceVertexIndices.cdata(), kDegenerateSinTolerance);
+		if (report.degenerateTriangles > 0)
+		{
+			report.issues |= eMeshIssue_DegenerateTriangles;
+		}
+	}
+
+	if (mesh.normals.empty())
+	{
+		if (requireNormals)
+		{
+			report.issues |= eMeshIssue_MissingNormals;
+		}
+		return;
+	}
+	if (mesh.normals.size() != expectedNormalCount(mesh))
+	{
+		report.issues |= eMeshIssue_NormalCountMismatch;
+	}
+	report.nonUnitNormals = countNonUnitVectors(reinterpret_cast<const float*>(mesh.normals.cdata()), mesh.normals.size(), kUnitLengthTolerance);
+	if (report.nonUnitNormals > 0)
+	{
+		report.issues |= eMeshIssue_NonUnitNormals;
+	}
+}
+
+MeshValidationResult validateMeshes(const UsdStageRefPtr& stage, bool requireNormals, const Usd_PrimFlagsPredicate& predicate)
+{
+	MeshValidationResult result;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	const std::vector<UsdPrim> meshPrims = collectStagePrims(stage, [](const UsdPrim& prim) { return prim.IsA<UsdGeomMesh>(); }, predicate);
+
+	// Each mesh is read and checked by the same thread while its arrays are still in cache
+	std::vector<MeshIssueReport> reports(meshPrims.size());
+	std::vector<uint64_t> bytes(meshPrims.size(), 0);
+	WorkParallelForN(meshPrims.size(), [&](size_t begin, size_t end)
+	{
+		MeshData mesh;
+		for (size_t i = begin; i < end; i++)
+		{
+			mesh = MeshData();
+			readMeshData(meshPrims[i], mesh);
+			validateMesh(mesh, requireNormals, reports[i]);
+			bytes[i] = (mesh.points.size() + mesh.normals.size()) * sizeof(GfVec3f)
+				+ (mesh.faceVertexCounts.size() + mesh.faceVertexIndices.size()) * sizeof(int);
+		}
+	});
+
+	result.meshCount = meshPrims.size();
+	for (size_t i = 0; i < reports.size(); i++)
+	{
+		result.bytesChecked += bytes[i];
+		if (reports[i].issues == 0)
+		{
+			continue;
+		}
+		for (int bit = 0; bit < kMeshIssueCount; bit++)
+		{
+			result.meshesWithIssue[bit] += (reports[i].issues >> bit) & 1;
+		}
+		result.reports.push_back(std::move(reports[i]));
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
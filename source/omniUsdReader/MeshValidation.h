@@ -0,0 +1,81 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/primFlags.h"
+
+// The problems --validate looks for, as bit flags
+enum MeshIssue : uint32_t
+{
+	eMeshIssue_NonFinitePoints = 1 << 0,
+	eMeshIssue_BadFaceCounts = 1 << 1,
+	eMeshIssue_IndexOutOfRange = 1 << 2,
+	eMeshIssue_DegenerateTriangles = 1 << 3,
+	eMeshIssue_MissingNormals = 1 << 4,
+	eMeshIssue_NormalCountMismatch = 1 << 5,
+	eMeshIssue_NonUnitNormals = 1 << 6,
+};
+static const int kMeshIssueCount = 7;
+
+// Name of a single issue flag
+const char* meshIssueName(uint32_t issue);
+
+// What was wrong with one mesh
+struct MeshIssueReport
+{
+	std::string path;
+	uint32_t issues = 0;
+	size_t nonFinitePoints = 0;
+	size_t degenerateTriangles = 0;
+	size_t nonUnitNormals = 0;
+	int minIndex = 0;
+	int maxIndex = 0;
+	size_t pointCount = 0;
+};
+
+struct MeshValidationResult
+{
+	size_t meshCount = 0;
+
+	// Bytes of points, counts, indices and normals that were checked
+	uint64_t bytesChecked = 0;
+
+	double seconds = 0.0;
+
+	// The meshes with at least one issue, in traversal order
+	std::vector<MeshIssueReport> reports;
+
+	// Number of meshes with each issue, indexed by flag bit
+	size_t meshesWithIssue[kMeshIssueCount] = {};
+};
+
+// Check every UsdGeomMesh in parallel.  Missing normals are only reported when
+// requireNormals is set, many pipelines let the renderer compute them.
+MeshValidationResult validateMeshes(const pxr::UsdStageRefPtr& stage, bool requireNormals,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate);
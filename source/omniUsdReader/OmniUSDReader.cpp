@@ -24,7 +24,7 @@
 /*###############################################################################
 #
 # The "OmniUSDReader" application performs a few simple things:
-#	* Expects one argument, the path to a USD stage
+#	* Expects one argument, the path to a USD stage, and some options
 #		* Acceptable forms:
 #			* omniverse://localhost/Users/test/helloworld.usd
 #			* C:\USD\helloworld.usd
@@ -34,21 +34,49 @@
 #		* Set the Omniverse Client log level
 #		* Initialize the Omniverse Client library
 #		* Register an Omniverse Client status callback (using a static function)
+#	* Optionally prefetch the stage's layer and asset dependencies concurrently (--prefetch)
+#		* Optionally through a local cache of text layers converted to crate files (--layer-cache)
 #	* Open the USD stage
+#		* Optionally without payloads (--load-none), then load only the selected ones
+#		* Print the time and memory used by each phase
 #	* Print the stages up-axis
 #	* Print the stages linear units, or meters per unit setting
-#	* Traverse the stage prims and print the path of each one
+#	* Traverse the stage prims in parallel and print the path of each one
+#		* Or only count them with --count-only
+#	* Print the traversal time and prims per second
+#	* Or, with --report, write a JSON report of the stage contents instead of the paths
+#	* Or, with --bounds, write the world bounds of every boundable prim and print a spatial histogram
+#	* Or, with --extract, write all of the meshes to a flat archive that can be memory mapped
+#	* Or, with --validate, check every mesh for bad geometry and list the offending prims
 #	* Destroy the stage object
 #	* Shutdown the Omniverse Client library
 #
 ###############################################################################*/
 
 #include <iostream>
+#include <fstream>
 #include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <memory>
 #include "OmniClient.h"
 #include "pxr/usd/usd/stage.h"
 #include "pxr/usd/usd/primRange.h"
 #include "pxr/usd/usdGeom/metrics.h"
+#include "pxr/base/work/threadLimits.h"
+#include "StageTraversal.h"
+#include "StageReport.h"
+#include "StageBounds.h"
+#include "MeshExtract.h"
+#include "MeshValidation.h"
+#include "PayloadLoading.h"
+#include "ProcessMemory.h"
+#include "AssetPrefetch.h"
+#include "LayerCache.h"
+#include "MemoryAccounting.h"
 
 using namespace pxr;
 
@@ -89,42 +117,491 @@ static bool startOmniverse()
 	return true;
 }
 
-// The program expects one argument, a path to a USD file
+using Clock = std::chrono::steady_clock;
+
+// How many attributes are listed in the "largestAttributes" section of the report
+static const size_t kReportLargestAttributes = 20;
+
+// Seconds elapsed since "start"
+static double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Print the time and resident memory of one phase of the run
+static void printPhase(const char* phase, double seconds, size_t residentBefore)
+{
+	const double mb = 1.0 / (1024.0 * 1024.0);
+	const size_t resident = getResidentMemoryBytes();
+	std::cout << std::fixed << std::setprecision(3) << "Phase " << phase << ": " << seconds << " s, resident "
+		<< std::setprecision(1) << resident * mb << " MB (" << std::showpos << (double(resident) - double(residentBefore)) * mb
+		<< std::noshowpos << " MB)" << std::endl;
+}
+
+// Traverse the stage in parallel and print the prim paths, or just count them
+static void printPaths(const UsdStageRefPtr& stage, bool countOnly, const Usd_PrimFlagsPredicate& predicate)
+{
+	const size_t residentBefore = getResidentMemoryBytes();
+
+	// Each work item formats its subtree into its own buffer
+	Clock::time_point traverseStart = Clock::now();
+	PathListing listing = listStagePaths(stage, !countOnly, predicate);
+	const double traverseSeconds = secondsSince(traverseStart);
+
+	// Print the paths in the same order as stage->Traverse() with a few large writes
+	Clock::time_point writeStart = Clock::now();
+	if (!countOnly)
+	{
+		writePathListing(listing, stdout);
+	}
+	const double writeSeconds = secondsSince(writeStart);
+
+	const double primsPerSecond = traverseSeconds > 0.0 ? listing.primCount / traverseSeconds : 0.0;
+	printPhase("traverse", traverseSeconds, residentBefore);
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Traversed " << listing.primCount << " prims in " << traverseSeconds << " s using "
+		<< WorkGetConcurrencyLimit() << " threads (" << std::setprecision(0) << primsPerSecond << " prims/s)" << std::endl;
+	if (!countOnly)
+	{
+		std::cout << "Wrote " << listing.byteCount << " bytes of paths in " << std::setprecision(3) << writeSeconds << " s" << std::endl;
+	}
+}
+
+// Gather the stage statistics in parallel and write them to a JSON file
+static int writeReport(const UsdStageRefPtr& stage, const std::string& stageUrl, const std::string& reportPath, bool reportArrays,
+	double openSeconds, const Usd_PrimFlagsPredicate& predicate)
+{
+	const size_t residentBefore = getResidentMemoryBytes();
+	Clock::time_point reportStart = Clock::now();
+	StageStats stats = gatherStageStats(stage, kReportLargestAttributes, reportArrays, predicate);
+	const double reportSeconds = secondsSince(reportStart);
+	printPhase("report", reportSeconds, residentBefore);
+
+	std::ofstream reportFile(reportPath);
+	if (!reportFile)
+	{
+		std::cout << "Failure to open the report file: " << reportPath << std::endl;
+		return -3;
+	}
+	writeStageReportJson(stage, stageUrl, stats, openSeconds, reportSeconds, reportFile);
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Report of " << stats.primCount << " prims written to " << reportPath << " in " << reportSeconds << " s" << std::endl;
+	return 0;
+}
+
+// Compute the world bounds in parallel, write them to a text file and print a coarse spatial histogram
+static int writeBounds(const UsdStageRefPtr& stage, const std::string& boundsPath, int gridResolution,
+	const Usd_PrimFlagsPredicate& predicate)
+{
+	const size_t residentBefore = getResidentMemoryBytes();
+	Clock::time_point boundsStart = Clock::now();
+	StageBounds bounds = computeStageBounds(stage, true, predicate);
+	printPhase("bounds", secondsSince(boundsStart), residentBefore);
+
+	FILE* boundsFile = fopen(boundsPath.c_str(), "wb");
+	if (!boundsFile)
+	{
+		std::cout << "Failure to open the bounds file: " << boundsPath << std::endl;
+		return -3;
+	}
+	writePathListing(bounds.dump, boundsFile);
+	fclose(boundsFile);
+
+	std::cout << "Bounds of " << bounds.boundablePrims << " boundable prims written to " << boundsPath << " ("
+		<< bounds.fromExtent << " from extents, " << bounds.fromPoints << " from points, "
+		<< bounds.emptyBounds << " empty)" << std::endl;
+	if (bounds.stageBounds.IsEmpty())
+	{
+		std::cout << "Stage bounds: empty" << std::endl;
+		return 0;
+	}
+	std::cout << std::defaultfloat << std::setprecision(6);
+	std::cout << "Stage bounds: " << bounds.stageBounds.GetMin() << " - " << bounds.stageBounds.GetMax() << std::endl;
+
+	const int upAxis = UsdGeomGetStageUpAxis(stage) == UsdGeomTokens->z ? 2 : 1;
+	printBoundsGrid(buildBoundsGrid(bounds, gridResolution), upAxis, std::cout);
+	return 0;
+}
+
+// Extract every mesh in parallel into a mesh archive and print the throughput
+static int writeExtract(const UsdStageRefPtr& stage, const std::string& extractPath, const Usd_PrimFlagsPredicate& predicate)
+{
+	const size_t residentBefore = getResidentMemoryBytes();
+	MeshExtractResult extract = extractMeshes(stage, extractPath, predicate);
+	printPhase("extract", extract.extractSeconds, residentBefore);
+	if (!extract.success)
+	{
+		std::cout << "Failure to write the mesh archive: " << extractPath << std::endl;
+		return -3;
+	}
+
+	const double gigabytes = extract.dataBytes / (1024.0 * 1024.0 * 1024.0);
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << extract.meshCount << " meshes written to " << extractPath << " ("
+		<< extract.fileBytes / (1024.0 * 1024.0) << " MB)" << std::endl;
+	std::cout << "Extract: " << extract.extractSeconds << " s";
+	if (extract.extractSeconds > 0.0)
+		std::cout << ", " << gigabytes / extract.extractSeconds << " GB/s";
+	std::cout << std::endl;
+	std::cout << "Write: " << extract.writeSeconds << " s";
+	if (extract.writeSeconds > 0.0)
+		std::cout << ", " << gigabytes / extract.writeSeconds << " GB/s";
+	std::cout << std::endl;
+	return 0;
+}
+
+// Check every mesh in parallel and print the offending prims, returns -4 when any mesh has an issue
+static int writeValidation(const UsdStageRefPtr& stage, bool requireNormals, const Usd_PrimFlagsPredicate& predicate)
+{
+	const size_t residentBefore = getResidentMemoryBytes();
+	MeshValidationResult validation = validateMeshes(stage, requireNormals, predicate);
+	printPhase("validate", validation.seconds, residentBefore);
+
+	for (const MeshIssueReport& report : validation.reports)
+	{
+		std::cout << report.path << ":";
+		const char* separator = " ";
+		for (int bit = 0; bit < kMeshIssueCount; bit++)
+		{
+			const uint32_t issue = 1u << bit;
+			if (!(report.issues & issue))
+			{
+				continue;
+			}
+			std::cout << separator << meshIssueName(issue);
+			if (issue == eMeshIssue_NonFinitePoints)
+				std::cout << " (" << report.nonFinitePoints << " values)";
+			else if (issue == eMeshIssue_IndexOutOfRange)
+				std::cout << " (" << report.minIndex << " to " << report.maxIndex << " for " << report.pointCount << " points)";
+			else if (issue == eMeshIssue_DegenerateTriangles)
+				std::cout << " (" << report.degenerateTriangles << ")";
+			else if (issue == eMeshIssue_NonUnitNormals)
+				std::cout << " (" << report.nonUnitNormals << ")";
+			separator = ", ";
+		}
+		std::cout << std::endl;
+	}
+
+	std::cout << validation.reports.size() << " of " << validation.meshCount << " meshes have issues" << std::endl;
+	for (int bit = 0; bit < kMeshIssueCount; bit++)
+	{
+		if (validation.meshesWithIssue[bit] > 0)
+		{
+			std::cout << "    " << meshIssueName(1u << bit) << ": " << validation.meshesWithIssue[bit] << std::endl;
+		}
+	}
+	const double gigabytes = validation.bytesChecked / (1024.0 * 1024.0 * 1024.0);
+	std::cout << std::fixed << std::setprecision(3) << "Checked " << gigabytes * 1024.0 << " MB in " << validation.seconds << " s";
+	if (validation.seconds > 0.0)
+		std::cout << ", " << gigabytes / validation.seconds << " GB/s";
+	std::cout << std::endl;
+	return validation.reports.empty() ? 0 : -4;
+}
+
+// Print the command line arguments help
+static void printCmdLineArgHelp()
+{
+	std::cout << "Usage: OmniUSDReader [options] stage_url" << std::endl;
+	std::cout << "  options:" << std::endl;
+	std::cout << "    -h, --help                    Print this help" << std::endl;
+	std::cout << "    -c, --count-only              Count the prims without printing their paths" << std::endl;
+	std::cout << "    -t, --threads count           Number of traversal threads [default: all cores]" << std::endl;
+	std::cout << "    -r, --report file.json        Write a JSON report of the stage contents instead of the paths" << std::endl;
+	std::cout << "    -a, --report-arrays           With --report, also read every array for the largest attributes" << std::endl;
+	std::cout << "    -b, --bounds file.txt         Write the world bounds of every boundable prim instead of the paths" << std::endl;
+	std::cout << "    -g, --grid resolution         Cells per axis of the --bounds spatial histogram [default: 8]" << std::endl;
+	std::cout << "    -x, --extract file.bin        Write every mesh to a flat archive that can be memory mapped instead of the paths" << std::endl;
+	std::cout << "    -v, --validate                Check every mesh for bad geometry and list the offending prims instead of the paths" << std::endl;
+	std::cout << "    -m, --require-normals         With --validate, also report meshes without normals" << std::endl;
+	std::cout << "    -p, --prefetch                Fetch the layer and asset dependencies concurrently before opening the stage" << std::endl;
+	std::cout << "    -k, --layer-cache folder      Open text layers from crate conversions cached in a local folder" << std::endl;
+	std::cout << "    -n, --load-none               Open the stage without loading payloads, unloaded prims are still listed" << std::endl;
+	std::cout << "    -l, --load pattern            Load the payloads of prims matching a glob pattern (implies --load-none)" << std::endl;
+	std::cout << "    -d, --load-depth depth        Load the payloads of prims at most depth levels deep (implies --load-none)" << std::endl;
+	std::cout << "\n\nExamples:\n";
+	std::cout << " * print all of the prim paths in a stage" << std::endl;
+	std::cout << "    > OmniUSDReader omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * count the prims in a stage using 4 threads" << std::endl;
+	std::cout << "    > OmniUSDReader -c -t 4 omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * write a pre-flight report for a stage" << std::endl;
+	std::cout << "    > OmniUSDReader -r helloworld.json omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * write the prim bounds and a 16x16x16 spatial histogram of a stage" << std::endl;
+	std::cout << "    > OmniUSDReader -b bounds.txt -g 16 omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * extract the meshes of a stage to a mesh archive" << std::endl;
+	std::cout << "    > OmniUSDReader -x meshes.bin omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * check the meshes of a stage before uploading it, the exit code is non-zero when a mesh has an issue" << std::endl;
+	std::cout << "    > OmniUSDReader -v -m omniverse://localhost/Users/test/helloworld.usd" << std::endl;
+	std::cout << "\n * prefetch the dependencies of a stage with many references before opening it" << std::endl;
+	std::cout << "    > OmniUSDReader -p -c omniverse://localhost/Users/test/references.usd" << std::endl;
+	std::cout << "\n * open a large text stage through a local cache of crate conversions" << std::endl;
+	std::cout << "    > OmniUSDReader -k /tmp/layer_cache -c omniverse://localhost/Users/test/city.usda" << std::endl;
+	std::cout << "\n * list a large stage, only loading the payloads under /World/Buildings" << std::endl;
+	std::cout << "    > OmniUSDReader -l \"/World/Buildings/*\" omniverse://localhost/Users/test/city.usd" << std::endl;
+}
+
+// The program expects one argument, a path to a USD file, and some options
 int main(int argc, char* argv[])
 {
-    if (argc != 2)
-    {
-        std::cout << "Please provide an Omniverse stage URL to read." << std::endl;
-        return -1;
-    }
-
-    std::cout << "Omniverse USD Stage Traversal: " << argv[1] << std::endl;
-	
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("OmniUSDReader");
+
+	bool countOnly = false;
+	std::string stageUrl;
+	std::string reportPath;
+	bool reportArrays = false;
+	std::string boundsPath;
+	std::string extractPath;
+	int gridResolution = 8;
+	bool prefetch = false;
+	bool validate = false;
+	bool requireNormals = false;
+	std::string layerCacheFolder;
+	PayloadLoadOptions loadOptions;
+
+	// Process the arguments
+	for (int x = 1; x < argc; x++)
+	{
+		if (strcmp(argv[x], "-h") == 0 || strcmp(argv[x], "--help") == 0)
+		{
+			printCmdLineArgHelp();
+			return 0;
+		}
+		else if (strcmp(argv[x], "-c") == 0 || strcmp(argv[x], "--count-only") == 0)
+		{
+			countOnly = true;
+		}
+		else if (strcmp(argv[x], "-t") == 0 || strcmp(argv[x], "--threads") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a thread count.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			WorkSetConcurrencyLimitArgument(std::atoi(argv[++x]));
+		}
+		else if (strcmp(argv[x], "-r") == 0 || strcmp(argv[x], "--report") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a report file path.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			reportPath = argv[++x];
+		}
+		else if (strcmp(argv[x], "-a") == 0 || strcmp(argv[x], "--report-arrays") == 0)
+		{
+			reportArrays = true;
+		}
+		else if (strcmp(argv[x], "-b") == 0 || strcmp(argv[x], "--bounds") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a bounds file path.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			boundsPath = argv[++x];
+		}
+		else if (strcmp(argv[x], "-g") == 0 || strcmp(argv[x], "--grid") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a grid resolution.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			gridResolution = std::atoi(argv[++x]);
+		}
+		else if (strcmp(argv[x], "-x") == 0 || strcmp(argv[x], "--extract") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a mesh archive path.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			extractPath = argv[++x];
+		}
+		else if (strcmp(argv[x], "-v") == 0 || strcmp(argv[x], "--validate") == 0)
+		{
+			validate = true;
+		}
+		else if (strcmp(argv[x], "-m") == 0 || strcmp(argv[x], "--require-normals") == 0)
+		{
+			requireNormals = true;
+		}
+		else if (strcmp(argv[x], "-p") == 0 || strcmp(argv[x], "--prefetch") == 0)
+		{
+			prefetch = true;
+		}
+		else if (strcmp(argv[x], "-k") == 0 || strcmp(argv[x], "--layer-cache") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a layer cache folder.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			layerCacheFolder = argv[++x];
+		}
+		else if (strcmp(argv[x], "-n") == 0 || strcmp(argv[x], "--load-none") == 0)
+		{
+			loadOptions.loadNone = true;
+		}
+		else if (strcmp(argv[x], "-l") == 0 || strcmp(argv[x], "--load") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a payload path pattern.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			loadOptions.pattern = argv[++x];
+		}
+		else if (strcmp(argv[x], "-d") == 0 || strcmp(argv[x], "--load-depth") == 0)
+		{
+			if (x == argc - 1)
+			{
+				std::cout << "ERROR: Missing a payload depth.\n" << std::endl;
+				printCmdLineArgHelp();
+				return -1;
+			}
+			loadOptions.maxDepth = std::atoi(argv[++x]);
+		}
+		else if (argv[x][0] == '-')
+		{
+			std::cout << "Unrecognized option: " << argv[x] << std::endl;
+			printCmdLineArgHelp();
+			return -1;
+		}
+		else
+		{
+			stageUrl = argv[x];
+		}
+	}
+
+	if (stageUrl.empty())
+	{
+		std::cout << "Please provide an Omniverse stage URL to read." << std::endl;
+		return -1;
+	}
+
+	std::cout << "Omniverse USD Stage Traversal: " << stageUrl << std::endl;
+
 	startOmniverse();
 
-	UsdStageRefPtr stage = UsdStage::Open(argv[1]);
+	// With any of the payload options the stage is opened without payloads and
+	// the traversal includes the unloaded prims so the structure is still visible
+	const bool lazyLoad = loadOptions.isLazy();
+	const Usd_PrimFlagsPredicate predicate = lazyLoad ? unloadedStructurePredicate() : UsdPrimDefaultPredicate;
+
+	// The layer cache opens the layers during the dependency walk, the other assets are only fetched with --prefetch
+	std::unique_ptr<LayerCache> layerCache;
+	if (!layerCacheFolder.empty())
+	{
+		layerCache.reset(new LayerCache(layerCacheFolder));
+	}
+
+	// The prefetched layers are held until the stage has been opened from them
+	size_t residentBefore = getResidentMemoryBytes();
+	AssetPrefetchResult prefetchResult;
+	const bool walkDependencies = prefetch || layerCache;
+	if (walkDependencies)
+	{
+		AssetPrefetchOptions prefetchOptions;
+		prefetchOptions.followPayloads = !lazyLoad;
+		prefetchOptions.fetchAssets = prefetch;
+		if (layerCache)
+		{
+			prefetchOptions.openLayer = [&layerCache](const std::string& url) { return layerCache->open(url); };
+		}
+		prefetchResult = prefetchAssetDependencies(stageUrl, prefetchOptions);
+		printPhase("prefetch", prefetchResult.seconds, residentBefore);
+		std::cout << "Prefetched " << prefetchResult.layers.size() << " layers over " << prefetchResult.depth << " levels and "
+			<< prefetchResult.assetCount << " assets (" << prefetchResult.assetBytes / (1024.0 * 1024.0) << " MB), "
+			<< prefetchResult.failedCount << " failed" << std::endl;
+	}
+
+	residentBefore = getResidentMemoryBytes();
+	Clock::time_point openStart = Clock::now();
+	UsdStageRefPtr stage;
+	{
+		MemoryScope memoryScope(eMemorySubsystem_Composition);
+		stage = UsdStage::Open(stageUrl, lazyLoad ? UsdStage::LoadNone : UsdStage::LoadAll);
+	}
 	if (!stage)
 	{
 		std::cout << "Failure to open stage.  Exiting." << std::endl;
 		return -2;
 	}
-	
+	const double openSeconds = secondsSince(openStart);
+	printPhase("open", openSeconds, residentBefore);
+	if (walkDependencies)
+	{
+		std::cout << "Prefetch and open: " << std::setprecision(3) << prefetchResult.seconds + openSeconds << " s" << std::endl;
+		prefetchResult.layers.clear();
+	}
+	if (layerCache)
+	{
+		std::cout << "Layer cache: " << layerCache->hits() << " hits, " << layerCache->misses() << " misses ("
+			<< std::setprecision(1) << layerCache->hitRate() * 100.0 << "% hit rate), " << layerCache->uncached()
+			<< " not cached, " << std::setprecision(3) << layerCache->savedSeconds() << " s saved" << std::endl;
+	}
+
+	// Load only the payloads that were asked for
+	if (!loadOptions.pattern.empty() || loadOptions.maxDepth >= 0)
+	{
+		residentBefore = getResidentMemoryBytes();
+		Clock::time_point loadStart = Clock::now();
+		PayloadLoadResult loadResult = loadSelectedPayloads(stage, loadOptions);
+		printPhase("load", secondsSince(loadStart), residentBefore);
+		std::cout << "Loaded " << loadResult.loaded << " of " << loadResult.loadable << " payloads in "
+			<< loadResult.rounds << " rounds" << std::endl;
+	}
+	else if (lazyLoad)
+	{
+		std::cout << "Payloads not loaded: " << stage->FindLoadable().size() << std::endl;
+	}
+
 	// Print the up-axis
 	std::cout << "Stage up-axis: " << UsdGeomGetStageUpAxis(stage) << std::endl;
 
 	// Print the stage's linear units, or "meters per unit"
-	std::cout << "Meters per unit: " << std::setprecision(5) << UsdGeomGetStageMetersPerUnit(stage) << std::endl;
+	std::cout << "Meters per unit: " << std::defaultfloat << std::setprecision(5) << UsdGeomGetStageMetersPerUnit(stage) << std::endl;
 
-	// Traverse the stage and return the first UsdGeomMesh we find
-	auto range = stage->Traverse();
-	for (const auto& node : range)
+	int result = 0;
+	if (!reportPath.empty())
+	{
+		result = writeReport(stage, stageUrl, reportPath, reportArrays, openSeconds, predicate);
+	}
+	else if (!boundsPath.empty())
+	{
+		result = writeBounds(stage, boundsPath, gridResolution, predicate);
+	}
+	else if (!extractPath.empty())
 	{
-		std::cout << node.GetPath() << std::endl;
+		result = writeExtract(stage, extractPath, predicate);
 	}
+	else if (validate)
+	{
+		result = writeValidation(stage, requireNormals, predicate);
+	}
+	else
+	{
+		printPaths(stage, countOnly, predicate);
+	}
+
+	std::cout << std::fixed << std::setprecision(1) << "Peak resident memory: "
+		<< getPeakResidentMemoryBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
 
 	// The stage is a sophisticated object that needs to be destroyed properly.  
 	// Since stage is a smart pointer we can just reset it
 	stage.Reset();
 
 	omniClientShutdown();
+
+	return result;
 }
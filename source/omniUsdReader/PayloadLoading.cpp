@@ -0,0 +1,85 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "PayloadLoading.h"
+#include "MemoryAccounting.h"
+#include "pxr/base/tf/diagnostic.h"
+#include "pxr/base/tf/patternMatcher.h"
+#include "pxr/base/tf/stringUtils.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+// Stop expanding nested payloads after this many rounds
+static const int kMaxLoadRounds = 32;
+
+PayloadLoadResult loadSelectedPayloads(const UsdStageRefPtr& stage, const PayloadLoadOptions& options)
+{
+	MemoryScope memoryScope(eMemorySubsystem_Composition);
+	PayloadLoadResult result;
+
+	// The whole path has to match, TfPatternMatcher only searches for the pattern
+	const bool caseSensitive = true;
+	const bool isGlob = false;
+	TfPatternMatcher matcher("^" + TfStringGlobToRegex(options.pattern) + "$", caseSensitive, isGlob);
+	if (!options.pattern.empty() && !matcher.IsValid())
+	{
+		TF_WARN("Invalid payload path pattern: %s", options.pattern.c_str());
+	}
+
+	auto isSelected = [&](const SdfPath& path)
+	{
+		if (!options.pattern.empty() && matcher.IsValid() && matcher.Match(path.GetString()))
+		{
+			return true;
+		}
+		return options.maxDepth >= 0 && path.GetPathElementCount() <= size_t(options.maxDepth);
+	};
+
+	SdfPathSet requested;
+	for (int round = 0; round < kMaxLoadRounds; round++)
+	{
+		SdfPathSet toLoad;
+		for (const SdfPath& path : stage->FindLoadable())
+		{
+			if (requested.count(path) == 0 && isSelected(path))
+			{
+				toLoad.insert(path);
+			}
+		}
+		if (toLoad.empty())
+		{
+			break;
+		}
+
+		// Load without descendants so unselected nested payloads stay unloaded,
+		// the next round picks up the nested ones that match
+		stage->LoadAndUnload(toLoad, SdfPathSet(), UsdLoadWithoutDescendants);
+		requested.insert(toLoad.begin(), toLoad.end());
+		result.rounds++;
+	}
+
+	result.loadable = stage->FindLoadable().size();
+	// Prims can be requested and still not load (a payload that failed to open)
+	result.loaded = stage->GetLoadSet().size();
+	return result;
+}
@@ -0,0 +1,57 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "pxr/usd/usd/stage.h"
+
+// Which payloads to load after opening a stage with UsdStage::LoadNone
+struct PayloadLoadOptions
+{
+	// Open the stage without loading any payloads
+	bool loadNone = false;
+
+	// Load payloads on prims whose path matches this glob pattern (eg. "/World/Buildings/*")
+	std::string pattern;
+
+	// Load payloads on prims at most this many path elements deep, -1 to disable
+	int maxDepth = -1;
+
+	bool isLazy() const
+	{
+		return loadNone || !pattern.empty() || maxDepth >= 0;
+	}
+};
+
+struct PayloadLoadResult
+{
+	size_t loadable = 0;
+	size_t loaded = 0;
+	int rounds = 0;
+};
+
+// Load the payloads selected by the options.  Loaded payloads can expose nested
+// payloads, so the selection is repeated until nothing new matches.
+PayloadLoadResult loadSelectedPayloads(const pxr::UsdStageRefPtr& stage, const PayloadLoadOptions& options);
@@ -0,0 +1,218 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "StageBounds.h"
+#include "BoundsKernel.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include "pxr/base/gf/bbox3d.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+#include "pxr/usd/usdGeom/bboxCache.h"
+#include "pxr/usd/usdGeom/boundable.h"
+#include "pxr/usd/usdGeom/pointBased.h"
+#include "pxr/usd/usdGeom/xformCache.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+// Append one "path minX minY minZ maxX maxY maxZ source" line
+static void appendBoundsLine(std::string& buffer, const SdfPath& path, const GfRange3d& range, const char* source)
+{
+	char line[256];
+	const GfVec3d& mn = range.GetMin();
+	const GfVec3d& mx = range.GetMax();
+	snprintf(line, sizeof(line), " %.6g %.6g %.6g %.6g %.6g %.6g %s\n", mn[0], mn[1], mn[2], mx[0], mx[1], mx[2], source);
+	buffer += path.GetString();
+	buffer += line;
+}
+
+StageBounds computeStageBounds(const UsdStageRefPtr& stage, bool formatDump, const Usd_PrimFlagsPredicate& predicate)
+{
+	const std::vector<TraversalItem> items = splitStageTraversal(stage, 8 * size_t(WorkGetConcurrencyLimit()), 4, predicate);
+
+	struct ItemBounds
+	{
+		GfRange3d range;
+		size_t boundablePrims = 0;
+		size_t fromExtent = 0;
+		size_t fromPoints = 0;
+		size_t emptyBounds = 0;
+	};
+	std::vector<ItemBounds> itemBounds(items.size());
+
+	StageBounds result;
+	result.dump.buffers.resize(items.size());
+	result.centers.resize(items.size());
+
+	WorkParallelForN(items.size(), [&](size_t begin, size_t end)
+	{
+		const TfTokenVector purposes = { UsdGeomTokens->default_, UsdGeomTokens->render };
+		for (size_t i = begin; i < end; i++)
+		{
+			// The caches aren't safe to share between threads, so each work item has its own
+			UsdGeomBBoxCache bboxCache(UsdTimeCode::Default(), purposes);
+			UsdGeomXformCache xformCache(UsdTimeCode::Default());
+			ItemBounds& bounds = itemBounds[i];
+			std::string& buffer = result.dump.buffers[i];
+			std::vector<GfVec3d>& centers = result.centers[i];
+
+			visitTraversalItem(items[i], [&](const UsdPrim& prim)
+			{
+				if (!prim.IsA<UsdGeomBoundable>())
+				{
+					return;
+				}
+				bounds.boundablePrims++;
+
+				GfRange3d worldRange;
+				const char* source = "extent";
+				UsdGeomPointBased pointBased(prim);
+				if (pointBased && !pointBased.GetExtentAttr().HasAuthoredValue())
+				{
+					// No extent to rely on, bound the points and transform that to world space.
+					// Proxy and guide geometry is left out as the bounding box cache does.
+					source = "points";
+					VtVec3fArray points;
+					float mn[3], mx[3];
+					if (std::find(purposes.begin(), purposes.end(), pointBased.ComputePurpose()) != purposes.end() &&
+						pointBased.GetPointsAttr().Get(&points) &&
+						computePointsMinMax(reinterpret_cast<const float*>(points.cdata()), points.size(), mn, mx))
+					{
+						const GfBBox3d localBox(GfRange3d(GfVec3d(mn[0], mn[1], mn[2]), GfVec3d(mx[0], mx[1], mx[2])),
+							xformCache.GetLocalToWorldTransform(prim));
+						worldRange = localBox.ComputeAlignedRange();
+					}
+					bounds.fromPoints++;
+				}
+				else
+				{
+					worldRange = bboxCache.ComputeWorldBound(prim).ComputeAlignedRange();
+					bounds.fromExtent++;
+				}
+
+				if (worldRange.IsEmpty())
+				{
+					bounds.emptyBounds++;
+					return;
+				}
+				bounds.range.UnionWith(worldRange);
+				centers.push_back(worldRange.GetMidpoint());
+				if (formatDump)
+				{
+					appendBoundsLine(buffer, prim.GetPath(), worldRange, source);
+				}
+			}, predicate);
+		}
+	});
+
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		const ItemBounds& bounds = itemBounds[i];
+		result.stageBounds.UnionWith(bounds.range);
+		result.boundablePrims += bounds.boundablePrims;
+		result.fromExtent += bounds.fromExtent;
+		result.fromPoints += bounds.fromPoints;
+		result.emptyBounds += bounds.emptyBounds;
+		result.dump.primCount += result.centers[i].size();
+		result.dump.byteCount += result.dump.buffers[i].size();
+	}
+	return result;
+}
+
+BoundsGrid buildBoundsGrid(const StageBounds& bounds, int resolution)
+{
+	BoundsGrid grid;
+	grid.resolution = std::max(1, resolution);
+	grid.bounds = bounds.stageBounds;
+	grid.counts.assign(size_t(grid.resolution) * grid.resolution * grid.resolution, 0);
+	if (grid.bounds.IsEmpty())
+	{
+		return grid;
+	}
+
+	const GfVec3d size = grid.bounds.GetSize();
+	for (const std::vector<GfVec3d>& centers : bounds.centers)
+	{
+		for (const GfVec3d& center : centers)
+		{
+			int cell[3];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const double t = size[axis] > 0.0 ? (center[axis] - grid.bounds.GetMin()[axis]) / size[axis] : 0.0;
+				cell[axis] = std::min(grid.resolution - 1, std::max(0, int(t * grid.resolution)));
+			}
+			grid.at(cell[0], cell[1], cell[2])++;
+		}
+	}
+	return grid;
+}
+
+void printBoundsGrid(const BoundsGrid& grid, int upAxis, std::ostream& out)
+{
+	// The two axes of the ground plane, eg. X and Z for a Y-up stage
+	const int axisA = upAxis == 0 ? 1 : 0;
+	const int axisB = upAxis == 2 ? 1 : 2;
+	const char* axisNames = "XYZ";
+	const int n = grid.resolution;
+
+	auto count = [&](int a, int b, int up)
+	{
+		int cell[3];
+		cell[axisA] = a;
+		cell[axisB] = b;
+		cell[upAxis] = up;
+		return grid.at(cell[0], cell[1], cell[2]);
+	};
+
+	out << "Top down grid (" << axisNames[axisA] << " across, " << axisNames[axisB] << " down, "
+		<< n << "x" << n << " cells):" << std::endl;
+	for (int b = 0; b < n; b++)
+	{
+		for (int a = 0; a < n; a++)
+		{
+			size_t total = 0;
+			for (int up = 0; up < n; up++)
+			{
+				total += count(a, b, up);
+			}
+			out << std::setw(9) << total;
+		}
+		out << std::endl;
+	}
+
+	out << "Levels along " << axisNames[upAxis] << " (lowest first):" << std::endl;
+	for (int up = 0; up < n; up++)
+	{
+		size_t total = 0;
+		for (int b = 0; b < n; b++)
+		{
+			for (int a = 0; a < n; a++)
+			{
+				total += count(a, b, up);
+			}
+		}
+		out << std::setw(9) << total;
+	}
+	out << std::endl;
+}
@@ -0,0 +1,77 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+#include "pxr/base/gf/range3d.h"
+#include "pxr/base/gf/vec3d.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "StageTraversal.h"
+
+// World space bounds of every boundable prim in a stage
+struct StageBounds
+{
+	// One text line per prim: path, min xyz, max xyz and the bound source
+	PathListing dump;
+
+	// Center of every non-empty prim bound, one vector per work item
+	std::vector<std::vector<pxr::GfVec3d>> centers;
+
+	pxr::GfRange3d stageBounds;
+	size_t boundablePrims = 0;
+	size_t fromExtent = 0;
+	size_t fromPoints = 0;
+	size_t emptyBounds = 0;
+};
+
+// Compute the world bounds in parallel with one UsdGeomBBoxCache per work item.
+// Point based prims without an authored extent are bound from their points.
+StageBounds computeStageBounds(const pxr::UsdStageRefPtr& stage, bool formatDump,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate);
+
+// A coarse histogram of where the prim bound centers are in the stage bounds
+struct BoundsGrid
+{
+	int resolution = 0;
+	pxr::GfRange3d bounds;
+	std::vector<size_t> counts;
+
+	size_t& at(int x, int y, int z)
+	{
+		return counts[(size_t(z) * resolution + y) * resolution + x];
+	}
+	size_t at(int x, int y, int z) const
+	{
+		return counts[(size_t(z) * resolution + y) * resolution + x];
+	}
+};
+
+BoundsGrid buildBoundsGrid(const StageBounds& bounds, int resolution);
+
+// Print the grid collapsed along the up axis (a top down view) followed by
+// the counts for each level along the up axis
+void printBoundsGrid(const BoundsGrid& grid, int upAxis, std::ostream& out);
@@ -0,0 +1,309 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "StageReport.h"
+#include "StageTraversal.h"
+#include <algorithm>
+#include "pxr/base/js/json.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+#include "pxr/usd/usd/attribute.h"
+#include "pxr/usd/usd/relationship.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/metrics.h"
+#include "pxr/usd/usdShade/tokens.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+// Sort largest first (ties by path so the report is deterministic) and drop the rest
+static void trimLargestAttributes(std::vector<AttributeSize>& attributes, size_t maxCount)
+{
+	std::sort(attributes.begin(), attributes.end(), [](const AttributeSize& a, const AttributeSize& b)
+	{
+		return a.bytes != b.bytes ? a.bytes > b.bytes : a.path < b.path;
+	});
+	if (attributes.size() > maxCount)
+	{
+		attributes.resize(maxCount);
+	}
+}
+
+static void mergeCounts(std::map<std::string, size_t>& into, const std::map<std::string, size_t>& from)
+{
+	for (const auto& entry : from)
+	{
+		into[entry.first] += entry.second;
+	}
+}
+
+void StageStats::merge(const StageStats& other, size_t maxLargestAttributes)
+{
+	primCount += other.primCount;
+	mergeCounts(primsByType, other.primsByType);
+
+	meshCount += other.meshCount;
+	meshVertices += other.meshVertices;
+	meshFaces += other.meshFaces;
+	meshTriangles += other.meshTriangles;
+
+	boundPrims += other.boundPrims;
+	mergeCounts(bindingsByMaterial, other.bindingsByMaterial);
+
+	instanceCount += other.instanceCount;
+	prototypeCount += other.prototypeCount;
+	prototypePrimCount += other.prototypePrimCount;
+	mergeCounts(instancesByPrototype, other.instancesByPrototype);
+
+	attributeCount += other.attributeCount;
+	animatedAttributeCount += other.animatedAttributeCount;
+	timeSampleCount += other.timeSampleCount;
+
+	largestAttributes.insert(largestAttributes.end(), other.largestAttributes.begin(), other.largestAttributes.end());
+	trimLargestAttributes(largestAttributes, maxLargestAttributes);
+}
+
+// Accumulate the statistics for one prim
+static void gatherPrimStats(const UsdPrim& prim, bool inPrototype, size_t maxLargestAttributes, bool readArrays, StageStats& stats)
+{
+	stats.primCount++;
+	if (inPrototype)
+	{
+		stats.prototypePrimCount++;
+	}
+
+	const TfToken& typeName = prim.GetTypeName();
+	stats.primsByType[typeName.IsEmpty() ? std::string("(untyped)") : typeName.GetString()]++;
+
+	if (prim.IsInstance())
+	{
+		stats.instanceCount++;
+		stats.instancesByPrototype[prim.GetMaster().GetPath().GetString()]++;
+	}
+
+	// Only direct bindings are counted, collection based bindings are not resolved
+	if (UsdRelationship bindingRel = prim.GetRelationship(UsdShadeTokens->materialBinding))
+	{
+		SdfPathVector targets;
+		if (bindingRel.GetTargets(&targets) && !targets.empty())
+		{
+			stats.boundPrims++;
+			stats.bindingsByMaterial[targets[0].GetString()]++;
+		}
+	}
+
+	const bool isMesh = prim.IsA<UsdGeomMesh>();
+	if (isMesh)
+	{
+		stats.meshCount++;
+	}
+
+	for (const UsdAttribute& attr : prim.GetAttributes())
+	{
+		stats.attributeCount++;
+		const size_t numSamples = attr.GetNumTimeSamples();
+		if (numSamples > 0)
+		{
+			stats.animatedAttributeCount++;
+			stats.timeSampleCount += numSamples;
+		}
+
+		// The mesh totals only need the points and face counts.  The earliest
+		// time resolves to the first time sample, or the default value if there are none.
+		VtValue value;
+		const TfToken& name = attr.GetName();
+		if (isMesh && (name == UsdGeomTokens->points || name == UsdGeomTokens->faceVertexCounts)
+			&& attr.Get(&value, UsdTimeCode::EarliestTime()))
+		{
+			if (name == UsdGeomTokens->points && value.IsArrayValued())
+			{
+				stats.meshVertices += value.GetArraySize();
+			}
+			else if (value.IsHolding<VtIntArray>())
+			{
+				stats.meshFaces += value.GetArraySize();
+				for (int count : value.UncheckedGet<VtIntArray>())
+				{
+					if (count > 2)
+					{
+						stats.meshTriangles += count - 2;
+					}
+				}
+			}
+		}
+
+		// Only arrays are interesting when looking for the largest attributes
+		if (!readArrays)
+		{
+			continue;
+		}
+		const SdfValueTypeName valueType = attr.GetTypeName();
+		if (!valueType.IsArray())
+		{
+			continue;
+		}
+
+		// Every time sample is read, the topology may change over time
+		size_t elementCount = 0;
+		if (numSamples == 0)
+		{
+			if (value.IsEmpty() && !attr.Get(&value))
+			{
+				continue;
+			}
+			elementCount = value.IsArrayValued() ? value.GetArraySize() : 0;
+		}
+		else
+		{
+			std::vector<double> times;
+			attr.GetTimeSamples(&times);
+			for (double time : times)
+			{
+				VtValue sample;
+				if (attr.Get(&sample, time) && sample.IsArrayValued())
+				{
+					elementCount += sample.GetArraySize();
+				}
+			}
+		}
+
+		const size_t elementSize = valueType.GetScalarType().GetType().GetSizeof();
+		AttributeSize entry;
+		entry.bytes = elementCount * elementSize;
+		if (stats.largestAttributes.size() >= maxLargestAttributes && maxLargestAttributes > 0 &&
+			entry.bytes <= stats.largestAttributes.back().bytes)
+		{
+			continue;
+		}
+		entry.path = attr.GetPath().GetString();
+		entry.typeName = valueType.GetAsToken().GetString();
+		entry.timeSamples = numSamples;
+		stats.largestAttributes.push_back(std::move(entry));
+		trimLargestAttributes(stats.largestAttributes, maxLargestAttributes);
+	}
+}
+
+StageStats gatherStageStats(const UsdStageRefPtr& stage, size_t maxLargestAttributes, bool readArrays, const Usd_PrimFlagsPredicate& predicate)
+{
+	// The regular traversal work items, followed by one item per prototype.
+	// Traverse() doesn't descend into prototypes so their prims are only seen here.
+	std::vector<TraversalItem> items = splitStageTraversal(stage, 8 * size_t(WorkGetConcurrencyLimit()), 4, predicate);
+	const size_t firstPrototypeItem = items.size();
+	const std::vector<UsdPrim> prototypes = stage->GetMasters();
+	for (const UsdPrim& prototype : prototypes)
+	{
+		items.push_back({ prototype, true });
+	}
+
+	std::vector<StageStats> itemStats(items.size());
+	WorkParallelForN(items.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const bool inPrototype = i >= firstPrototypeItem;
+			visitTraversalItem(items[i], [&](const UsdPrim& prim)
+			{
+				gatherPrimStats(prim, inPrototype, maxLargestAttributes, readArrays, itemStats[i]);
+			}, predicate);
+		}
+	});
+
+	StageStats stats;
+	for (const StageStats& other : itemStats)
+	{
+		stats.merge(other, maxLargestAttributes);
+	}
+	stats.prototypeCount = prototypes.size();
+	stats.arraysRead = readArrays;
+	return stats;
+}
+
+static JsObject countsToJson(const std::map<std::string, size_t>& counts)
+{
+	JsObject object;
+	for (const auto& entry : counts)
+	{
+		object[entry.first] = JsValue(uint64_t(entry.second));
+	}
+	return object;
+}
+
+void writeStageReportJson(const UsdStageRefPtr& stage, const std::string& stageUrl, const StageStats& stats,
+	double openSeconds, double reportSeconds, std::ostream& out)
+{
+	JsObject timing;
+	timing["openSeconds"] = JsValue(openSeconds);
+	timing["reportSeconds"] = JsValue(reportSeconds);
+	timing["threads"] = JsValue(uint64_t(WorkGetConcurrencyLimit()));
+
+	JsObject prims;
+	prims["total"] = JsValue(uint64_t(stats.primCount));
+	prims["byType"] = JsValue(countsToJson(stats.primsByType));
+
+	JsObject meshes;
+	meshes["count"] = JsValue(uint64_t(stats.meshCount));
+	meshes["vertices"] = JsValue(uint64_t(stats.meshVertices));
+	meshes["faces"] = JsValue(uint64_t(stats.meshFaces));
+	meshes["triangles"] = JsValue(uint64_t(stats.meshTriangles));
+
+	JsObject bindings;
+	bindings["boundPrims"] = JsValue(uint64_t(stats.boundPrims));
+	bindings["materials"] = JsValue(uint64_t(stats.bindingsByMaterial.size()));
+	bindings["byMaterial"] = JsValue(countsToJson(stats.bindingsByMaterial));
+
+	JsObject instancing;
+	instancing["instances"] = JsValue(uint64_t(stats.instanceCount));
+	instancing["prototypes"] = JsValue(uint64_t(stats.prototypeCount));
+	instancing["prototypePrims"] = JsValue(uint64_t(stats.prototypePrimCount));
+	instancing["instancesByPrototype"] = JsValue(countsToJson(stats.instancesByPrototype));
+
+	JsObject timeSamples;
+	timeSamples["attributes"] = JsValue(uint64_t(stats.attributeCount));
+	timeSamples["animatedAttributes"] = JsValue(uint64_t(stats.animatedAttributeCount));
+	timeSamples["samples"] = JsValue(uint64_t(stats.timeSampleCount));
+
+	JsArray largest;
+	for (const AttributeSize& attribute : stats.largestAttributes)
+	{
+		JsObject entry;
+		entry["path"] = JsValue(attribute.path);
+		entry["type"] = JsValue(attribute.typeName);
+		entry["bytes"] = JsValue(uint64_t(attribute.bytes));
+		entry["timeSamples"] = JsValue(uint64_t(attribute.timeSamples));
+		largest.push_back(JsValue(entry));
+	}
+
+	JsObject report;
+	report["stage"] = JsValue(stageUrl);
+	report["upAxis"] = JsValue(UsdGeomGetStageUpAxis(stage).GetString());
+	report["metersPerUnit"] = JsValue(UsdGeomGetStageMetersPerUnit(stage));
+	report["timing"] = JsValue(timing);
+	report["prims"] = JsValue(prims);
+	report["meshes"] = JsValue(meshes);
+	report["materialBindings"] = JsValue(bindings);
+	report["instancing"] = JsValue(instancing);
+	report["timeSamples"] = JsValue(timeSamples);
+	report["largestAttributes"] = stats.arraysRead ? JsValue(largest) : JsValue(std::string("skipped, use --report-arrays"));
+
+	JsWriteToStream(JsValue(report), out);
+	out << std::endl;
+}
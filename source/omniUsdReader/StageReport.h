@@ -0,0 +1,86 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/primFlags.h"
+
+// One entry in the "largest attributes" list
+struct AttributeSize
+{
+	std::string path;
+	std::string typeName;
+	size_t bytes = 0;
+	size_t timeSamples = 0;
+};
+
+// Statistics gathered by the --report mode.  Each traversal work item fills
+// its own StageStats and they are merged in traversal order afterwards.
+struct StageStats
+{
+	size_t primCount = 0;
+	std::map<std::string, size_t> primsByType;
+
+	size_t meshCount = 0;
+	size_t meshVertices = 0;
+	size_t meshFaces = 0;
+	size_t meshTriangles = 0;
+
+	size_t boundPrims = 0;
+	std::map<std::string, size_t> bindingsByMaterial;
+
+	size_t instanceCount = 0;
+	size_t prototypeCount = 0;
+	size_t prototypePrimCount = 0;
+	std::map<std::string, size_t> instancesByPrototype;
+
+	size_t attributeCount = 0;
+	size_t animatedAttributeCount = 0;
+	size_t timeSampleCount = 0;
+
+	// Largest first, at most maxLargestAttributes entries after merge().  Only
+	// gathered for a detailed report, which reads every array value.
+	bool arraysRead = false;
+	std::vector<AttributeSize> largestAttributes;
+
+	void merge(const StageStats& other, size_t maxLargestAttributes);
+};
+
+// Gather the stage statistics in parallel.  Prototype (master) subtrees are
+// visited once each so instanced geometry is only counted one time.  USD
+// can't tell the length of an array without reading it: the mesh totals read
+// the points and face counts of every mesh, and the largest attributes are
+// only gathered with readArrays, which reads every time sample of every array
+// attribute.
+StageStats gatherStageStats(const pxr::UsdStageRefPtr& stage, size_t maxLargestAttributes, bool readArrays,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate);
+
+// Write the statistics as a JSON object
+void writeStageReportJson(const pxr::UsdStageRefPtr& stage, const std::string& stageUrl, const StageStats& stats,
+	double openSeconds, double reportSeconds, std::ostream& out);
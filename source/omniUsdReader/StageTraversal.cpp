@@ -0,0 +1,120 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#include "StageTraversal.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+std::vector<TraversalItem> splitStageTraversal(const UsdStageRefPtr& stage, size_t minItems, int maxDepth,
+	const Usd_PrimFlagsPredicate& predicate)
+{
+	// Start with the top-level subtrees, filtering the children with the same
+	// predicate as the traversal so the split matches Traverse(predicate)
+	std::vector<TraversalItem> items;
+	for (const UsdPrim& child : stage->GetPseudoRoot().GetFilteredChildren(predicate))
+	{
+		items.push_back({ child, true });
+	}
+
+	for (int depth = 0; depth < maxDepth && items.size() < minItems; depth++)
+	{
+		std::vector<TraversalItem> splitItems;
+		splitItems.reserve(items.size() * 2);
+		bool didSplit = false;
+		for (const TraversalItem& item : items)
+		{
+			if (!item.subtree || item.prim.GetFilteredChildren(predicate).empty())
+			{
+				splitItems.push_back(item);
+				continue;
+			}
+
+			// The prim itself comes first, then each of its child subtrees
+			splitItems.push_back({ item.prim, false });
+			for (const UsdPrim& child : item.prim.GetFilteredChildren(predicate))
+			{
+				splitItems.push_back({ child, true });
+			}
+			didSplit = true;
+		}
+		items.swap(splitItems);
+		if (!didSplit)
+		{
+			break;
+		}
+	}
+	return items;
+}
+
+PathListing listStagePaths(const UsdStageRefPtr& stage, bool formatPaths, const Usd_PrimFlagsPredicate& predicate)
+{
+	// Several items per thread so an uneven subtree doesn't leave threads idle
+	const size_t minItems = 8 * size_t(WorkGetConcurrencyLimit());
+	const std::vector<TraversalItem> items = splitStageTraversal(stage, minItems, 4, predicate);
+
+	PathListing listing;
+	listing.buffers.resize(items.size());
+	std::vector<size_t> counts(items.size(), 0);
+
+	WorkParallelForN(items.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			std::string& buffer = listing.buffers[i];
+			size_t count = 0;
+			visitTraversalItem(items[i], [&](const UsdPrim& prim)
+			{
+				count++;
+				if (formatPaths)
+				{
+					buffer += prim.GetPath().GetString();
+					buffer += '\n';
+				}
+			}, predicate);
+			counts[i] = count;
+		}
+	});
+
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		listing.primCount += counts[i];
+		listing.byteCount += listing.buffers[i].size();
+	}
+	return listing;
+}
+
+void writePathListing(const PathListing& listing, FILE* stream)
+{
+	// Each buffer holds a whole subtree, so this is one write per work item
+	// rather than one flush per prim
+	for (const std::string& buffer : listing.buffers)
+	{
+		if (!buffer.empty())
+		{
+			fwrite(buffer.data(), 1, buffer.size(), stream);
+		}
+	}
+	fflush(stream);
+}
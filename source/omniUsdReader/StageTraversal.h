@@ -0,0 +1,120 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "pxr/usd/usd/primRange.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+
+// The default Traverse() predicate without UsdPrimIsLoaded, so prims whose
+// payloads have not been loaded are still visited (but not their contents)
+inline pxr::Usd_PrimFlagsPredicate unloadedStructurePredicate()
+{
+	return pxr::UsdPrimIsActive && pxr::UsdPrimIsDefined && !pxr::UsdPrimIsAbstract;
+}
+
+// A unit of traversal work.  Either a whole subtree rooted at "prim" or,
+// when a subtree was split to spread work over more threads, just the
+// prim itself (its children are then separate work items that follow it).
+struct TraversalItem
+{
+	pxr::UsdPrim prim;
+	bool subtree = true;
+};
+
+// Split the stage into an ordered list of work items.  Visiting the items in
+// order, depth-first within each subtree, produces exactly the same prim order
+// as stage->Traverse(predicate).  Subtrees are split level by level until there are at
+// least minItems items or maxDepth levels have been split, so that stages with
+// a single "/World" style root still spread over all threads.
+std::vector<TraversalItem> splitStageTraversal(const pxr::UsdStageRefPtr& stage, size_t minItems, int maxDepth = 4,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate);
+
+// Visit the prims of one work item in stage->Traverse(predicate) order
+template <typename Fn>
+void visitTraversalItem(const TraversalItem& item, Fn&& fn,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate)
+{
+	if (!item.subtree)
+	{
+		fn(item.prim);
+		return;
+	}
+	for (const pxr::UsdPrim& prim : pxr::UsdPrimRange(item.prim, predicate))
+	{
+		fn(prim);
+	}
+}
+
+// Gather the prims accepted by filter in parallel, in stage->Traverse(predicate) order
+template <typename Filter>
+std::vector<pxr::UsdPrim> collectStagePrims(const pxr::UsdStageRefPtr& stage, Filter&& filter,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate)
+{
+	const std::vector<TraversalItem> items = splitStageTraversal(stage, 8 * size_t(pxr::WorkGetConcurrencyLimit()), 4, predicate);
+	std::vector<std::vector<pxr::UsdPrim>> itemPrims(items.size());
+	pxr::WorkParallelForN(items.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			visitTraversalItem(items[i], [&](const pxr::UsdPrim& prim)
+			{
+				if (filter(prim))
+				{
+					itemPrims[i].push_back(prim);
+				}
+			}, predicate);
+		}
+	});
+
+	std::vector<pxr::UsdPrim> prims;
+	for (const std::vector<pxr::UsdPrim>& primsOfItem : itemPrims)
+	{
+		prims.insert(prims.end(), primsOfItem.begin(), primsOfItem.end());
+	}
+	return prims;
+}
+
+// Result of a parallel path listing, one buffer per work item in traversal order
+struct PathListing
+{
+	std::vector<std::string> buffers;
+	size_t primCount = 0;
+	size_t byteCount = 0;
+};
+
+// Traverse the stage in parallel.  When formatPaths is false only the prim
+// count is gathered and no path strings are built.
+PathListing listStagePaths(const pxr::UsdStageRefPtr& stage, bool formatPaths,
+	const pxr::Usd_PrimFlagsPredicate& predicate = pxr::UsdPrimDefaultPredicate);
+
+// Write the listing buffers to a C stream in order with large writes
+void writePathListing(const PathListing& listing, FILE* stream);
@@ -0,0 +1,262 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OMNI_READER_USE_SSE 1
+#endif
+
+// The kernels behind --validate.  Each one streams over a flat array once so
+// validation runs close to memory bandwidth.
+
+#if OMNI_READER_USE_SSE
+// Number of set lanes in a 4 lane compare mask
+inline int countMaskLanes(__m128 mask)
+{
+	static const int kLaneCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	return kLaneCounts[_mm_movemask_ps(mask)];
+}
+#endif
+
+// Count the NaN and infinite values in a float array
+inline size_t countNonFiniteFloats(const float* values, size_t count)
+{
+	size_t nonFinite = 0;
+	size_t i = 0;
+
+#if OMNI_READER_USE_SSE
+	// x * 0 is NaN only when x is NaN or infinite
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 product = _mm_mul_ps(_mm_loadu_ps(values + i), zero);
+		nonFinite += countMaskLanes(_mm_cmpunord_ps(product, product));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		nonFinite += std::isfinite(values[i]) ? 0 : 1;
+	}
+	return nonFinite;
+}
+
+struct IntSummary
+{
+	int minValue = std::numeric_limits<int>::max();
+	int maxValue = std::numeric_limits<int>::min();
+	int64_t sum = 0;
+};
+
+// The min, max and (64 bit) sum of an int array, eg. faceVertexCounts or faceVertexIndices
+inline IntSummary summarizeInts(const int* values, size_t count)
+{
+	IntSummary summary;
+	size_t i = 0;
+
+#if OMNI_READER_USE_SSE
+	if (count >= 4)
+	{
+		__m128i minValues = _mm_set1_epi32(summary.minValue);
+		__m128i maxValues = _mm_set1_epi32(summary.maxValue);
+		__m128i sums = _mm_setzero_si128();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+
+			// SSE2 has no 32 bit min/max, select with the compare masks instead
+			const __m128i less = _mm_cmplt_epi32(v, minValues);
+			minValues = _mm_or_si128(_mm_and_si128(less, v), _mm_andnot_si128(less, minValues));
+			const __m128i greater = _mm_cmpgt_epi32(v, maxValues);
+			maxValues = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, maxValues));
+
+			// Sign extend to 64 bits so large index arrays can't overflow the sum
+			const __m128i sign = _mm_srai_epi32(v, 31);
+			sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(v, sign));
+			sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(v, sign));
+		}
+
+		int lanes[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), minValues);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			summary.minValue = lanes[lane] < summary.minValue ? lanes[lane] : summary.minValue;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), maxValues);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			summary.maxValue = lanes[lane] > summary.maxValue ? lanes[lane] : summary.maxValue;
+		}
+		int64_t laneSums[2];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(laneSums), sums);
+		summary.sum = laneSums[0] + laneSums[1];
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		summary.minValue = values[i] < summary.minValue ? values[i] : summary.minValue;
+		summary.maxValue = values[i] > summary.maxValue ? values[i] : summary.maxValue;
+		summary.sum += values[i];
+	}
+	return summary;
+}
+
+// Count the xyz vectors whose length differs from 1 by more than tolerance
+// (compared on the squared length), NaN vectors included
+inline size_t countNonUnitVectors(const float* xyz, size_t count, float tolerance)
+{
+	size_t nonUnit = 0;
+	size_t i = 0;
+
+#if OMNI_READER_USE_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 tolerances = _mm_set1_ps(tolerance);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	for (; i + 4 <= count; i += 4)
+	{
+		// The squares of 4 vectors, (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+		const float* p = xyz + i * 3;
+		const __m128 v0 = _mm_loadu_ps(p);
+		const __m128 v1 = _mm_loadu_ps(p + 4);
+		const __m128 v2 = _mm_loadu_ps(p + 8);
+		const __m128 s0 = _mm_mul_ps(v0, v0);
+		const __m128 s1 = _mm_mul_ps(v1, v1);
+		const __m128 s2 = _mm_mul_ps(v2, v2);
+
+		// Transpose to one register per component
+		const __m128 a = _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(1, 0, 3, 0)); // x0 x1 y1 z1
+		const __m128 b = _mm_shuffle_ps(s1, s2, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+		const __m128 c = _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+		const __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 1, 0));
+		const __m128 y = _mm_shuffle_ps(c, b, _MM_SHUFFLE(3, 1, 2, 0));
+		const __m128 z = _mm_shuffle_ps(c, s2, _MM_SHUFFLE(3, 0, 3, 1));
+
+		// Not (|len^2 - 1| <= tolerance) is also true for NaN
+		const __m128 error = _mm_and_ps(_mm_sub_ps(_mm_add_ps(_mm_add_ps(x, y), z), one), absMask);
+		nonUnit += countMaskLanes(_mm_cmpnle_ps(error, tolerances));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const float* v = xyz + i * 3;
+		const float error = std::fabs(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] - 1.0f);
+		nonUnit += error <= tolerance ? 0 : 1;
+	}
+	return nonUnit;
+}
+
+// Count the degenerate triangles of a polygon mesh, each face fan triangulated.
+// A triangle is degenerate when the sine of the angle between its two edges
+// from the first vertex is below sinTolerance (which includes zero length
+// edges).  The counts and indices must already be known to be valid.
+inline size_t countDegenerateTriangles(const float* points, const int* faceVertexCounts, size_t faceCount,
+	const int* faceVertexIndices, float sinTolerance)
+{
+	const float toleranceSquared = sinTolerance * sinTolerance;
+	size_t degenerate = 0;
+
+	// |e1 x e2|^2 <= tolerance^2 * |e1|^2 * |e2|^2
+	auto isDegenerate = [&](const float* p0, const float* p1, const float* p2)
+	{
+		const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		const float cx = e1[1] * e2[2] - e1[2] * e2[1];
+		const float cy = e1[2] * e2[0] - e1[0] * e2[2];
+		const float cz = e1[0] * e2[1] - e1[1] * e2[0];
+		const float e1Squared = e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2];
+		const float e2Squared = e2[0] * e2[0] + e2[1] * e2[1] + e2[2] * e2[2];
+		return cx * cx + cy * cy + cz * cz <= toleranceSquared * e1Squared * e2Squared;
+	};
+
+#if OMNI_READER_USE_SSE
+	// Gather 4 triangles at a time into one register per component
+	float gathered[9][4];
+	int batch = 0;
+	const __m128 tolerances = _mm_set1_ps(toleranceSquared);
+	auto flush = [&]()
+	{
+		const __m128 p0x = _mm_loadu_ps(gathered[0]), p0y = _mm_loadu_ps(gathered[1]), p0z = _mm_loadu_ps(gathered[2]);
+		const __m128 e1x = _mm_sub_ps(_mm_loadu_ps(gathered[3]), p0x);
+		const __m128 e1y = _mm_sub_ps(_mm_loadu_ps(gathered[4]), p0y);
+		const __m128 e1z = _mm_sub_ps(_mm_loadu_ps(gathered[5]), p0z);
+		const __m128 e2x = _mm_sub_ps(_mm_loadu_ps(gathered[6]), p0x);
+		const __m128 e2y = _mm_sub_ps(_mm_loadu_ps(gathered[7]), p0y);
+		const __m128 e2z = _mm_sub_ps(_mm_loadu_ps(gathered[8]), p0z);
+		const __m128 cx = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+		const __m128 cy = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+		const __m128 cz = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+		const __m128 crossSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz));
+		const __m128 e1Squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, e1x), _mm_mul_ps(e1y, e1y)), _mm_mul_ps(e1z, e1z));
+		const __m128 e2Squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, e2x), _mm_mul_ps(e2y, e2y)), _mm_mul_ps(e2z, e2z));
+		const __m128 limit = _mm_mul_ps(tolerances, _mm_mul_ps(e1Squared, e2Squared));
+		degenerate += countMaskLanes(_mm_cmple_ps(crossSquared, limit));
+		batch = 0;
+	};
+#endif
+
+	size_t faceStart = 0;
+	for (size_t face = 0; face < faceCount; face++)
+	{
+		const int* faceIndices = faceVertexIndices + faceStart;
+		const float* p0 = points + size_t(faceIndices[0]) * 3;
+		for (int corner = 1; corner + 1 < faceVertexCounts[face]; corner++)
+		{
+			const float* p1 = points + size_t(faceIndices[corner]) * 3;
+			const float* p2 = points + size_t(faceIndices[corner + 1]) * 3;
+#if OMNI_READER_USE_SSE
+			for (int component = 0; component < 3; component++)
+			{
+				gathered[component][batch] = p0[component];
+				gathered[3 + component][batch] = p1[component];
+				gathered[6 + component][batch] = p2[component];
+			}
+			if (++batch == 4)
+			{
+				flush();
+			}
+#else
+			degenerate += isDegenerate(p0, p1, p2) ? 1 : 0;
+#endif
+		}
+		faceStart += size_t(faceVertexCounts[face]);
+	}
+
+#if OMNI_READER_USE_SSE
+	for (int lane = 0; lane < batch; lane++)
+	{
+		const float p0[3] = { gathered[0][lane], gathered[1][lane], gathered[2][lane] };
+		const float p1[3] = { gathered[3][lane], gathered[4][lane], gathered[5][lane] };
+		const float p2[3] = { gathered[6][lane], gathered[7][lane], gathered[8][lane] };
+		degenerate += isDegenerate(p0, p1, p2) ? 1 : 0;
+	}
+#endif
+	return degenerate;
+}
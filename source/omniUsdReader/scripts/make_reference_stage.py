@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################
+
+# Writes a stage with many referenced asset layers, used to compare
+# "OmniUSDReader --prefetch" with a plain open:
+#
+#   make_reference_stage.py omniverse://localhost/Users/test/references 1000
+#
+# creates <folder>/references.usd that references <folder>/assets/asset_<n>.usd
+# and each asset layer uses the textures in <folder>/textures.
+
+# Python built-in
+import argparse
+import os
+import sys
+
+# USD imports
+from pxr import Gf, Sdf, UsdGeom
+
+# Omni imports
+import omni.client
+
+
+TEXTURES = ["Fieldstone_BaseColor.png", "Fieldstone_N.png", "Fieldstone_ORM.png"]
+
+
+def createAssetLayer(assetUrl):
+    layer = Sdf.Layer.CreateNew(assetUrl)
+    layer.defaultPrim = "Asset"
+    asset = Sdf.PrimSpec(layer, "Asset", Sdf.SpecifierDef, "Xform")
+
+    # A single quad is enough, the benchmark is about the number of layers
+    mesh = Sdf.PrimSpec(asset, "Mesh", Sdf.SpecifierDef, "Mesh")
+    points = Sdf.AttributeSpec(mesh, "points", Sdf.ValueTypeNames.Point3fArray)
+    points.default = [Gf.Vec3f(-50, 0, -50), Gf.Vec3f(50, 0, -50), Gf.Vec3f(50, 0, 50), Gf.Vec3f(-50, 0, 50)]
+    counts = Sdf.AttributeSpec(mesh, "faceVertexCounts", Sdf.ValueTypeNames.IntArray)
+    counts.default = [4]
+    indices = Sdf.AttributeSpec(mesh, "faceVertexIndices", Sdf.ValueTypeNames.IntArray)
+    indices.default = [0, 1, 2, 3]
+
+    # Texture asset paths, relative to the asset layer
+    shader = Sdf.PrimSpec(asset, "Shader", Sdf.SpecifierDef, "Shader")
+    for texture in TEXTURES:
+        name = "inputs:" + os.path.splitext(texture)[0].split("_")[-1].lower() + "_texture"
+        attribute = Sdf.AttributeSpec(shader, name, Sdf.ValueTypeNames.Asset)
+        attribute.default = Sdf.AssetPath("../textures/" + texture)
+
+    layer.Save()
+
+
+def createReferenceStage(folderUrl, count):
+    for texture in TEXTURES:
+        omni.client.copy("resources/Materials/Fieldstone/" + texture, folderUrl + "/textures/" + texture)
+
+    stageUrl = folderUrl + "/references.usd"
+    layer = Sdf.Layer.CreateNew(stageUrl)
+    layer.defaultPrim = "World"
+    layer.SetInfo(UsdGeom.Tokens.upAxis, UsdGeom.Tokens.y)
+    world = Sdf.PrimSpec(layer, "World", Sdf.SpecifierDef, "Xform")
+
+    # Lay the assets out on a square grid
+    columns = max(1, int(count ** 0.5))
+    for index in range(count):
+        createAssetLayer(folderUrl + "/assets/asset_%d.usd" % index)
+
+        prim = Sdf.PrimSpec(world, "asset_%d" % index, Sdf.SpecifierDef, "Xform")
+        prim.referenceList.Prepend(Sdf.Reference("./assets/asset_%d.usd" % index))
+        translate = Sdf.AttributeSpec(prim, "xformOp:translate", Sdf.ValueTypeNames.Double3)
+        translate.default = Gf.Vec3d((index % columns) * 150.0, 0.0, (index // columns) * 150.0)
+        opOrder = Sdf.AttributeSpec(prim, "xformOpOrder", Sdf.ValueTypeNames.TokenArray)
+        opOrder.default = ["xformOp:translate"]
+
+    layer.Save()
+    return stageUrl
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Write a stage with many referenced layers",
+                                     formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("folder", help="Folder URL or path to write the stage to")
+    parser.add_argument("count", type=int, nargs="?", default=1000, help="Number of referenced layers")
+    args = parser.parse_args()
+
+    if not omni.client.initialize():
+        sys.exit("[ERROR] Unable to initialize Omniverse client, exiting.")
+    print("Wrote " + createReferenceStage(args.folder.rstrip("/"), args.count))
+    omni.client.shutdown()
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Compare the open time of a stage with many references with and without
+# --prefetch.  Run from the repo root after building:
+#
+#   ./source/omniUsdReader/scripts/prefetch_benchmark.sh omniverse://localhost/Users/test/references 1000
+#
+# The stage is written with make_reference_stage.py unless it already exists.
+# The plain open runs first so it can't benefit from a cache warmed by the prefetch.
+
+set -e
+
+FOLDER=${1:-omniverse://localhost/Users/test/references}
+COUNT=${2:-1000}
+ROOT_DIR="$( cd "$(dirname "$0")/../../.." >/dev/null 2>&1 ; pwd -P )"
+
+pushd $ROOT_DIR > /dev/null
+
+export USD_LIB_DIR=${ROOT_DIR}/_build/linux-x86_64/release
+export OMNI_CLIENT_DIR=${ROOT_DIR}/_build/target-deps/omni_client_library/release
+export LD_LIBRARY_PATH=${LD_LIBRARY_PATH}:${USD_LIB_DIR}:${OMNI_CLIENT_DIR}
+export PYTHONPATH=${USD_LIB_DIR}/python:${OMNI_CLIENT_DIR}/bindings-python
+
+if [ "${SKIP_GENERATE}" != "1" ]; then
+    ${ROOT_DIR}/_build/target-deps/python/python ./source/omniUsdReader/scripts/make_reference_stage.py ${FOLDER} ${COUNT}
+fi
+
+echo "--- Without prefetch"
+./_build/linux-x86_64/release/OmniUSDReader -c ${FOLDER}/references.usd | grep -E "Phase (open|traverse)|Traversed"
+echo "--- With prefetch"
+./_build/linux-x86_64/release/OmniUSDReader -c -p ${FOLDER}/references.usd | grep -E "Phase (prefetch|open|traverse)|Prefetch|Traversed"
+
+popd > /dev/null
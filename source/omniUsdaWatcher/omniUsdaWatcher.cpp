@@ -62,6 +62,8 @@
 #include "pxr/usd/usd/stage.h"
 #include "pxr/usd/usd/primRange.h"
 #include "pxr/usd/usdGeom/metrics.h"
+#include "AssetPrefetch.h"
+#include "MemoryAccounting.h"
 #ifdef _WIN32
 #include <conio.h>
 #endif
@@ -233,12 +235,16 @@ public:
 		{
 			using namespace std::chrono_literals;
 			std::this_thread::sleep_for(100ms);
-			omniUsdLiveProcess();
+			{
+				MemoryScope memoryScope(eMemorySubsystem_LiveProcessing);
+				omniUsdLiveProcess();
+			}
 			currentTime = std::time(0);
 			// export USDA if it's been more than a second and the last update was after the last USDA export time
 			if (currentTime - *lastUpdateTime > 0 && *lastUsdaWriteTime <= *lastUpdateTime)
 			{
 				std::cout << "Writing USDA file...";
+				MemoryScope memoryScope(eMemorySubsystem_Export);
 				if (!stage->GetRootLayer()->Export(*usdaPath))
 				{
 					std::cout << "Unable to export stage" << std::endl;
@@ -258,6 +264,9 @@ public:
 // The program expects two arguments, input and output paths to a USD file
 int main(int argc, char* argv[])
 {
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("omniUsdaWatcher");
+
     if (argc != 3)
     {
         std::cout << "Please provide an Omniverse stage URL to read and a local file path to write the USDA file." << std::endl;
@@ -285,8 +294,8 @@ int main(int argc, char* argv[])
 	// Enable live mode for this stage's URL
 	omniUsdLiveSetModeForUrl(normalizedStageUrl.c_str(), OmniUsdLiveMode::eOmniUsdLiveModeEnabled);
 
-	// Open the live stage
-	pxr::UsdStageRefPtr stage = pxr::UsdStage::Open(normalizedStageUrl);
+	// Open the live stage, fetching its dependencies concurrently first
+	pxr::UsdStageRefPtr stage = openStageWithPrefetch(normalizedStageUrl);
 	if (!stage)
 	{
 		std::cout << "Failure to open stage.  Exiting." << std::endl;
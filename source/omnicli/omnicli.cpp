@@ -29,6 +29,7 @@
 #include <condition_variable>
 #include <ctype.h>
 #include <inttypes.h>
+#include <memory>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,6 +40,11 @@
 
 #include <pxr/pxr.h>
 #include <pxr/usd/usd/stage.h>
+#include <AssetPrefetch.h>
+#include <CommandLine.h>
+#include <LayerCache.h>
+#include <ListFormat.h>
+#include <MemoryAccounting.h>
 
 static const int MAX_URL_SIZE = 2048;
 
@@ -47,6 +53,8 @@ bool g_haveUpdates = false;
 std::mutex g_mutex;
 std::condition_variable g_cv;
 PXR_NS::UsdStageRefPtr g_stage;
+std::unique_ptr<LayerCache> g_layerCache;
+bool g_stageFromLayerCache = false;
 
 template<class Mutex>
 auto make_lock(Mutex& m)
@@ -62,88 +70,6 @@ bool iequal(std::string const& a, std::string const& b)
 		std::equal(a.begin(), a.end(), b.begin(), [](auto a, auto b) { return tolower(a) == tolower(b); });
 }
 
-/*
-Tokenize a line using the Windows command line rules:
-* Arguments are delimited by white space, which is either a space or a tab.
-* A string surrounded by double quotation marks is interpreted as a single argument,
-	regardless of white space contained within. A quoted string can be embedded in an argument.
-* A double quotation mark preceded by a backslash, \", is interpreted as a literal double quotation mark (").
-* Backslashes are interpreted literally, unless they immediately precede a double quotation mark.
-* If an even number of backslashes is followed by a double quotation mark, then one backslash (\) is placed in
-	the argv array for every pair of backslashes (\\), and the double quotation mark (") is interpreted as a string
-delimiter.
-* If an odd number of backslashes is followed by a double quotation mark, then one backslash (\) is placed in the argv
-array for every pair of backslashes (\\) and the double quotation mark is interpreted as an escape sequence by the
-remaining backslash, causing a literal double quotation mark (") to be placed in argv.
-*/
-std::vector<std::string> tokenize(char const* line)
-{
-	std::vector<std::string> tokens;
-	std::string token;
-	bool inWhiteSpace = true;
-	bool inQuote = false;
-	uint32_t backslashCount = 0;
-	for (char const* p = line; *p; p++)
-	{
-		if (*p == '\n')
-		{
-			break;
-		}
-		if (inWhiteSpace)
-		{
-			if (*p == ' ' || *p == '\t')
-			{
-				continue;
-			}
-			else
-			{
-				inWhiteSpace = false;
-			}
-		}
-		if (*p == '\\')
-		{
-			backslashCount++;
-			continue;
-		}
-		if (*p == '\"')
-		{
-			token.append(backslashCount / 2, '\\');
-			if (backslashCount % 2 == 1)
-			{
-				token.push_back('\"');
-			}
-			else
-			{
-				inQuote = !inQuote;
-			}
-			backslashCount = 0;
-			continue;
-		}
-		if (backslashCount > 0)
-		{
-			token.append(backslashCount, '\\');
-			backslashCount = 0;
-		}
-		if (!inQuote && (*p == ' ' || *p == '\t'))
-		{
-			tokens.emplace_back(std::move(token));
-			token.clear();
-			inWhiteSpace = true;
-			continue;
-		}
-		token.push_back(*p);
-	}
-	if (backslashCount > 0)
-	{
-		token.append(backslashCount, '\\');
-	}
-	if (!token.empty())
-	{
-		tokens.emplace_back(std::move(token));
-	}
-	return tokens;
-}
-
 int resultToRetcode(OmniClientResult result)
 {
 	switch (result)
@@ -169,140 +95,9 @@ void printResult(OmniClientResult result)
 	printf("%s\n", omniClientGetResultString(result));
 }
 
-char const* formatTime(uint64_t tns)
-{
-	time_t time = (time_t)(tns / 1'000'000'000);
-	static char timeStr[30];
-	strftime(timeStr, sizeof(timeStr), "%F %T", localtime(&time));
-	return timeStr;
-}
-
-std::string getAccessString(uint16_t access)
-{
-	std::string accessString;
-	if (access & fOmniClientAccess_Read)
-	{
-		if (!accessString.empty())
-		{
-			accessString += ", ";
-		}
-		accessString += "Read";
-	}
-	if (access & fOmniClientAccess_Write)
-	{
-		if (!accessString.empty())
-		{
-			accessString += ", ";
-		}
-		accessString += "Write";
-	}
-	if (access & fOmniClientAccess_Admin)
-	{
-		if (!accessString.empty())
-		{
-			accessString += ", ";
-		}
-		accessString += "Admin";
-	}
-	if (accessString.empty())
-	{
-		accessString = "None";
-	}
-	return accessString;
-}
-
 void printListEntries(uint32_t numEntries, struct OmniClientListEntry const* entries)
 {
-	size_t longestOwner = 0;
-	size_t longestType = 0;
-	std::vector<std::string> types;
-	for (uint32_t i = 0; i < numEntries; i++)
-	{
-		if (entries[i].createdBy != nullptr)
-		{
-			longestOwner = std::max(longestOwner, strlen(entries[i].createdBy));
-		}
-		std::string type;
-		{
-			auto flags = entries[i].flags;
-			if (flags & fOmniClientItem_IsInsideMount)
-			{
-				type.append("mounted ");
-			}
-			if (flags & fOmniClientItem_ReadableFile)
-			{
-				auto size = entries[i].size;
-				auto sizeSuffix = "B ";
-				if (size > 1000 * 1000 * 1000)
-				{
-					size /= 1000 * 1000 * 1000;
-					sizeSuffix = "GB ";
-				}
-				else if (size > 1000 * 1000)
-				{
-					size /= 1000 * 1000;
-					sizeSuffix = "MB ";
-				}
-				else if (size > 1000)
-				{
-					size /= 1000;
-					sizeSuffix = "KB ";
-				}
-				type.append(std::to_string(size));
-				type.append(sizeSuffix);
-
-				if ((flags & fOmniClientItem_WriteableFile) == 0)
-				{
-					type.append("read-only ");
-				}
-				type.append("file ");
-			}
-			if (flags & fOmniClientItem_IsMount)
-			{
-				type.append("mount-point ");
-			}
-			else if (flags & fOmniClientItem_CanHaveChildren)
-			{
-				if (flags & fOmniClientItem_DoesNotHaveChildren)
-				{
-					type.append("empty-folder ");
-				}
-				else
-				{
-					type.append("folder ");
-				}
-			}
-			if (flags & fOmniClientItem_CanLiveUpdate)
-			{
-				type.append("live ");
-			}
-			if (flags & fOmniClientItem_IsOmniObject)
-			{
-				type.append("omni-object ");
-			}
-			if (flags & fOmniClientItem_IsChannel)
-			{
-				type.append("channel ");
-			}
-			if (flags & fOmniClientItem_IsCheckpointed)
-			{
-				type.append("checkpointed ");
-			}
-		}
-		longestType = std::max(longestType, type.size());
-		types.emplace_back(std::move(type));
-	}
-	for (uint32_t i = 0; i < numEntries; i++)
-	{
-		auto ownerStr = entries[i].createdBy;
-		if (ownerStr == nullptr)
-		{
-			ownerStr = "";
-		}
-		//     Date, type/size, owner, relative name
-		printf("%18s  %*s %*s %s %s\n", formatTime(entries[i].modifiedTimeNs), (int)longestType, types[i].c_str(),
-			(int)longestOwner, ownerStr, entries[i].relativePath, entries[i].comment);
-	}
+	fputs(formatListEntries(numEntries, entries).c_str(), stdout);
 }
 
 int list(ArgVec const& args)
@@ -664,11 +459,25 @@ int loadUsd(ArgVec const& args)
 		return EXIT_FAILURE;
 	}
 	auto lock = make_lock(g_mutex);
-	g_stage = PXR_NS::UsdStage::Open(args[1].data());
+	AssetPrefetchOptions options;
+	if (g_layerCache)
+	{
+		options.openLayer = [](std::string const& url) { return g_layerCache->open(url); };
+	}
+	size_t hits = g_layerCache ? g_layerCache->hits() : 0;
+	size_t misses = g_layerCache ? g_layerCache->misses() : 0;
+	double savedSeconds = g_layerCache ? g_layerCache->savedSeconds() : 0.0;
+	g_stage = openStageWithPrefetch(args[1].data(), PXR_NS::UsdStage::LoadAll, options);
 	if (!g_stage)
 	{
 		return EXIT_FAILURE;
 	}
+	g_stageFromLayerCache = g_layerCache && g_layerCache->anyFromCache(g_stage->GetUsedLayers());
+	if (g_layerCache)
+	{
+		printf("Layer cache: %zu hits, %zu misses, %.3f s saved\n", g_layerCache->hits() - hits,
+			g_layerCache->misses() - misses, g_layerCache->savedSeconds() - savedSeconds);
+	}
 	return EXIT_SUCCESS;
 }
 
@@ -682,6 +491,13 @@ int saveUsd(ArgVec const& args)
 	auto lock = make_lock(g_mutex);
 	PXR_NS::TfErrorMark errorMark;
 	errorMark.SetMark();
+	MemoryScope memoryScope(eMemorySubsystem_Export);
+	if (args.size() <= 1 && g_stageFromLayerCache)
+	{
+		// Layers from the cache are crate data, an edited one would be written as crate to its text URL
+		printf("The stage was loaded through the layer cache, save it to a different URL\n");
+		return EXIT_FAILURE;
+	}
 	if (args.size() <= 1)
 	{
 		g_stage->Save();
@@ -705,6 +521,33 @@ int closeUsd(ArgVec const& args)
 		return EXIT_FAILURE;
 	}
 	g_stage = nullptr;
+	g_stageFromLayerCache = false;
+	return EXIT_SUCCESS;
+}
+
+int layerCache(ArgVec const& args)
+{
+	if (args.size() <= 1)
+	{
+		if (g_layerCache)
+		{
+			printf("Layer cache: %s\n", g_layerCache->folder().c_str());
+			printf("%zu hits, %zu misses (%.1f%% hit rate), %zu not cached, %.3f s saved\n", g_layerCache->hits(),
+				g_layerCache->misses(), g_layerCache->hitRate() * 100.0, g_layerCache->uncached(), g_layerCache->savedSeconds());
+		}
+		else
+		{
+			printf("Layer cache disabled\n");
+		}
+		return EXIT_SUCCESS;
+	}
+	auto lock = make_lock(g_mutex);
+	if (args[1] == "off")
+	{
+		g_layerCache.reset();
+		return EXIT_SUCCESS;
+	}
+	g_layerCache.reset(new LayerCache(args[1]));
 	return EXIT_SUCCESS;
 }
 
@@ -1132,6 +975,7 @@ Command commands[] = {
 	{ "load", "<url>", "Load a USD file", loadUsd },
 	{ "save", "[url]", "Save a previously loaded USD file (optionally to a different URL)", saveUsd },
 	{ "close", nullptr, "Close a previously loaded USD file", closeUsd },
+	{ "cache", "[folder|off]", "Load text layers through a local cache of crate conversions\n The stage can then only be saved to a different URL", layerCache },
 	{ "live", "[on|off]", "Turn live mode on/off", live },
 	{ "lock", "[url]", "Lock a USD file (defaults to loaded stage root)", lock },
 	{ "unlock", "[url]", "Unlock a USD file (defaults to loaded stage root)", unlock },
@@ -1215,6 +1059,9 @@ int run(ArgVec const& args)
 
 int main(int argc, char const* const* argv)
 {
+	// Off unless OMNI_MEMORY_REPORT is set
+	MemoryAccounting memoryAccounting("omnicli");
+
 	ArgVec args;
 	if (argc > 1)
 	{
@@ -1233,6 +1080,7 @@ int main(int argc, char const* const* argv)
 			{
 				g_haveUpdates = false;
 				printf("Processing live updates\n");
+				MemoryScope memoryScope(eMemorySubsystem_LiveProcessing);
 				omniUsdLiveProcess();
 			}
 			while (!g_haveUpdates && !g_shutdown)
@@ -25,9 +25,12 @@
 
 # Python built-in
 import argparse
+import array
 import logging
 import math
+import random
 import sys
+import time
 
 # USD imports
 from pxr import Gf, Sdf, Usd, UsdLux, UsdGeom, UsdShade, UsdPhysics
@@ -469,6 +472,136 @@ def run_live_edit(prim, stageUrl):
         else:
             LOGGER.info("Enter 't' to transform or 'q' to quit.")
 
+def run_xform_benchmark(prim_count):
+    """Set and read the transforms of prim_count prims of an in memory stage, once
+    with TransformPrimSRT and get_srt_xform_from_prim one prim at a time and once
+    with BatchTransformPrimSRT, and log the times and the speedup"""
+    if not xform_utils.xform_batch:
+        LOGGER.error("The xform_batch module is not built, there is no native path to compare with")
+        return
+
+    # Angles stay where the euler decomposition is unique so the reads can be compared
+    rng = random.Random(1)
+    translations = array.array("d", (rng.uniform(-1000.0, 1000.0) for _ in range(3 * prim_count)))
+    rotations = array.array("d")
+    for _ in range(prim_count):
+        rotations.extend((rng.uniform(-170.0, 170.0), rng.uniform(-80.0, 80.0), rng.uniform(-170.0, 170.0)))
+    scales = array.array("d", (rng.uniform(0.5, 2.0) for _ in range(3 * prim_count)))
+    prim_paths = ["/World/xform_%d" % i for i in range(prim_count)]
+
+    def create_stage():
+        bench_stage = Usd.Stage.CreateInMemory()
+        for prim_path in prim_paths:
+            UsdGeom.Xform.Define(bench_stage, prim_path)
+        return bench_stage
+
+    def timed(fn):
+        start = time.perf_counter()
+        result = fn()
+        return time.perf_counter() - start, result
+
+    def python_set(bench_stage):
+        for i, prim_path in enumerate(prim_paths):
+            xform_utils.TransformPrimSRT(
+                bench_stage,
+                prim_path,
+                translation=Gf.Vec3d(*translations[3 * i:3 * i + 3]),
+                rotation_euler=Gf.Vec3d(*rotations[3 * i:3 * i + 3]),
+                scale=Gf.Vec3d(*scales[3 * i:3 * i + 3]),
+            ).do()
+
+    def python_get(bench_stage):
+        return [xform_utils.get_srt_xform_from_prim(bench_stage.GetPrimAtPath(prim_path)) for prim_path in prim_paths]
+
+    # The first set adds the xform ops, later ones only write values
+    python_stage = create_stage()
+    python_times = [timed(lambda: python_set(python_stage))[0], timed(lambda: python_set(python_stage))[0]]
+    python_get_time, python_srt = timed(lambda: python_get(python_stage))
+
+    native_stage = create_stage()
+    prepare_time, batch = timed(lambda: xform_utils.BatchTransformPrimSRT(native_stage, prim_paths))
+    native_times = [prepare_time + timed(lambda: batch.do(translations, rotations, scales))[0],
+                    timed(lambda: batch.do(translations, rotations, scales))[0]]
+    native_get_time, native_srt = timed(batch.get)
+
+    LOGGER.info("Transform benchmark, %d prims", prim_count)
+    LOGGER.info("%-12s %12s %12s %9s", "", "python ms", "native ms", "speedup")
+    for name, python_time, native_time in (("first set", python_times[0], native_times[0]),
+                                           ("set", python_times[1], native_times[1]),
+                                           ("get", python_get_time, native_get_time)):
+        LOGGER.info("%-12s %12.2f %12.2f %8.1fx", name, python_time * 1000.0, native_time * 1000.0,
+                    python_time / max(native_time, 1e-9))
+
+    # Both paths must read back what was set, and read the same thing from either stage
+    max_difference = 0.0
+    for i, srt in enumerate(python_srt):
+        for channel, values in enumerate((translations, rotations, scales)):
+            for axis in range(3):
+                expected = values[3 * i + axis]
+                max_difference = max(max_difference, abs(srt[channel][axis] - expected),
+                                      abs(native_srt[channel][3 * i + axis] - expected))
+    LOGGER.info("Largest difference from the values set: %g", max_difference)
+
+
+def run_decompose_benchmark(matrix_count, rotation_order=Gf.Vec3i(0, 1, 2)):
+    """Decompose matrix_count SRT matrices with xform_batch.decompose_matrices on
+    one thread and on all of them, time extract_srt_xform_from_matrix4 on a
+    sample, and log the times and the largest differences from the Python results"""
+    if not xform_utils.xform_batch:
+        LOGGER.error("The xform_batch module is not built, there is no native path to compare with")
+        return
+
+    # A few thousand distinct matrices built with Gf, repeated up to matrix_count.
+    # The middle axis of the rotation order stays away from gimbal lock.
+    rng = random.Random(2)
+    distinct = min(matrix_count, 4096)
+    sample = []
+    for _ in range(distinct):
+        euler = [rng.uniform(-170.0, 170.0) for _ in range(3)]
+        euler[rotation_order[1]] = rng.uniform(-80.0, 80.0)
+        sample.append(xform_utils.TransformPrimSRT.construct_transform_matrix_from_srt(
+            Gf.Vec3d(*(rng.uniform(-1000.0, 1000.0) for _ in range(3))),
+            Gf.Vec3d(*euler),
+            rotation_order,
+            Gf.Vec3d(*(rng.uniform(0.5, 2.0) for _ in range(3)))))
+    distinct_matrices = array.array("d", (value for matrix in sample for row in matrix for value in row))
+    matrices = distinct_matrices * (matrix_count // distinct) + distinct_matrices[:16 * (matrix_count % distinct)]
+    translations, rotations, scales = [array.array("d", bytes(24 * matrix_count)) for _ in range(3)]
+
+    def timed(fn):
+        start = time.perf_counter()
+        fn()
+        return time.perf_counter() - start
+
+    serial_time = timed(lambda: xform_utils.xform_batch.decompose_matrices(
+        matrices, translations, rotations, scales, tuple(rotation_order), parallel=False))
+    parallel_time = timed(lambda: xform_utils.xform_batch.decompose_matrices(
+        matrices, translations, rotations, scales, tuple(rotation_order)))
+
+    # extract_srt_xform_from_matrix4 orthonormalizes its argument in place and
+    # returns translate, scale (1 after that) and the angles in rotation order sequence
+    python_results = []
+    python_time = timed(lambda: python_results.extend(
+        xform_utils.extract_srt_xform_from_matrix4(Gf.Matrix4d(matrix), rotation_order) for matrix in sample))
+    python_time *= matrix_count / distinct
+
+    LOGGER.info("Matrix decomposition benchmark, %d matrices, rotation order %s", matrix_count, tuple(rotation_order))
+    for name, seconds in (("python", python_time), ("native 1 thread", serial_time), ("native", parallel_time)):
+        LOGGER.info("%-16s %10.2f ms %8.2f M matrices/s %8.1fx", name, seconds * 1000.0,
+                    matrix_count / max(seconds, 1e-9) / 1e6, python_time / max(seconds, 1e-9))
+    LOGGER.info("(the python time is measured on %d matrices)", distinct)
+
+    # The scale is compared with Gf.Transform, the Python reference drops it
+    differences = [0.0, 0.0, 0.0]
+    for i, (translate, _, rotate) in enumerate(python_results):
+        scale = Gf.Transform(sample[i]).GetScale()
+        for axis in range(3):
+            differences[0] = max(differences[0], abs(translations[3 * i + axis] - translate[axis]))
+            differences[1] = max(differences[1], abs(rotations[3 * i + rotation_order[axis]] - rotate[axis]))
+            differences[2] = max(differences[2], abs(scales[3 * i + axis] - scale[axis]))
+    LOGGER.info("Largest difference from the Python results: translate %g, rotate %g degrees, scale %g", *differences)
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Python Omniverse Client Sample",
                                      formatter_class=argparse.ArgumentDefaultsHelpFormatter)
@@ -477,9 +610,21 @@ if __name__ == "__main__":
     parser.add_argument("-p", "--path", action="store", default="omniverse://localhost/Users/test")
     parser.add_argument("-v", "--verbose", action='store_true', default=False)
     parser.add_argument("-e", "--existing", action="store")
+    parser.add_argument("-x", "--xform-benchmark", action="store", type=int, metavar="PRIMS",
+                        help="Compare the Python and native batch transform paths on an in memory stage and exit")
+    parser.add_argument("-m", "--decompose-benchmark", action="store", type=int, metavar="MATRICES",
+                        help="Compare the Python and native matrix decompositions (e.g. 1000000) and exit")
 
     args = parser.parse_args()
 
+    if args.xform_benchmark:
+        run_xform_benchmark(args.xform_benchmark)
+        sys.exit(0)
+
+    if args.decompose_benchmark:
+        run_decompose_benchmark(args.decompose_benchmark)
+        sys.exit(0)
+
     existing_stage = args.existing
     live_edit = args.live or bool(existing_stage)
     destination_path = args.path
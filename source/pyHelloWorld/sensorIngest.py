@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+
+###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################
+
+# Feed simulated sensor readings into the SimpleSensorExample stage created by
+# omniSimpleSensor, the way a Python sensor adapter would.
+#
+# Readings are packed into buffers of (int32 zone, float32 value) records and
+# handed to the native sensor_ingest module, which applies a whole buffer with
+# the same path omniSensorThread uses for its zone (SensorZoneWriter).
+# --benchmark does the same on an in memory stage and compares it with setting
+# displayColor from Python, both once per reading and once per zone per batch.
+# The native path only writes the last reading of each zone in a batch, so the
+# benchmark also runs batches of one reading per zone, where nothing coalesces.
+
+# Python built-in
+import argparse
+import logging
+import math
+import struct
+import sys
+import time
+
+# USD imports
+from pxr import Gf, Usd, UsdGeom, Vt
+
+# Internal imports
+import log
+
+# Native sensor ingestion, built with the C++ samples (source/sensorIngest)
+try:
+    import sensor_ingest
+except ImportError:
+    sensor_ingest = None
+
+
+LOGGER = log.get_logger("PySensorIngest", level=logging.INFO)
+
+# One reading, the layout of SensorRecord in SensorZoneWriter.h
+RECORD = struct.Struct("<if")
+
+# The reading rate a Python adapter has to sustain
+TARGET_VALUES_PER_SECOND = 1000000
+
+
+def make_batches(zone_count, batch_size, batch_count=4):
+    """Simulated readings, batch_count buffers of batch_size records cycling over the zones"""
+    batches = []
+    for b in range(batch_count):
+        records = bytearray(RECORD.size * batch_size)
+        for i in range(batch_size):
+            reading = b * batch_size + i
+            RECORD.pack_into(records, RECORD.size * i, reading % zone_count, math.cos(reading))
+        batches.append(records)
+    return batches
+
+
+def ingest(stage, batches, value_count, save):
+    """Apply value_count readings with sensor_ingest, returns the seconds taken and the writer"""
+    writer = sensor_ingest.ZoneWriter(stage)
+    batch_size = len(batches[0]) // RECORD.size
+    start = time.perf_counter()
+    for applied in range(0, value_count, batch_size):
+        writer.apply(batches[(applied // batch_size) % len(batches)], save)
+    return time.perf_counter() - start, writer
+
+
+def ingest_per_value(stage, batches, value_count):
+    """Set displayColor one reading at a time, returns the seconds taken"""
+    attrs = {}
+    batch_size = len(batches[0]) // RECORD.size
+    start = time.perf_counter()
+    applied = 0
+    while applied < value_count:
+        records = batches[(applied // batch_size) % len(batches)]
+        for zone, value in RECORD.iter_unpack(records):
+            attr = attrs.get(zone)
+            if attr is None:
+                attr = attrs[zone] = UsdGeom.Mesh(stage.GetPrimAtPath("/World/box_%d" % zone)).GetDisplayColorAttr()
+            attr.Set(Vt.Vec3fArray([Gf.Vec3f(0.463 * value, 0.725 * value, 0.0)]))
+            applied += 1
+            if applied == value_count:
+                break
+    return time.perf_counter() - start
+
+
+def ingest_coalesced(stage, batches, value_count):
+    """Set displayColor once per zone per batch from Python like the native path, returns the seconds and zone writes"""
+    attrs = {}
+    batch_size = len(batches[0]) // RECORD.size
+    start = time.perf_counter()
+    zone_writes = 0
+    for applied in range(0, value_count, batch_size):
+        records = batches[(applied // batch_size) % len(batches)]
+        last = {}
+        for zone, value in RECORD.iter_unpack(records[:RECORD.size * (value_count - applied)]):
+            last[zone] = value
+        for zone, value in last.items():
+            attr = attrs.get(zone)
+            if attr is None:
+                attr = attrs[zone] = UsdGeom.Mesh(stage.GetPrimAtPath("/World/box_%d" % zone)).GetDisplayColorAttr()
+            attr.Set(Vt.Vec3fArray([Gf.Vec3f(0.463 * value, 0.725 * value, 0.0)]))
+        zone_writes += len(last)
+    return time.perf_counter() - start, zone_writes
+
+
+def log_rate(name, value_count, zone_writes, seconds):
+    rate = value_count / max(seconds, 1e-9)
+    LOGGER.info("%-14s %10d values %10d zone writes %8.3f s %12.0f values/s %12.0f zone writes/s", name, value_count,
+                zone_writes, seconds, rate, zone_writes / max(seconds, 1e-9))
+    return rate
+
+
+def run_case(stage, zone_count, value_count, batch_size):
+    """Compare the native and the Python paths for batches of batch_size readings, returns the native values/s"""
+    batches = make_batches(zone_count, batch_size)
+    LOGGER.info("Batches of %d readings over %d zones", batch_size, zone_count)
+    seconds, writer = ingest(stage, batches, value_count, False)
+    native_rate = log_rate("native", writer.values, writer.zone_writes, seconds)
+
+    # The Python paths are far slower, a smaller run is enough for their rates
+    python_count = min(value_count, 200000)
+    log_rate("python", python_count, python_count, ingest_per_value(stage, batches, python_count))
+    python_seconds, python_writes = ingest_coalesced(stage, batches, python_count)
+    python_rate = log_rate("python batch", python_count, python_writes, python_seconds)
+    LOGGER.info("Speedup over python batch %.1fx", native_rate / python_rate)
+    return native_rate
+
+
+def run_benchmark(zone_count, value_count, batch_size):
+    """Ingest readings into an in memory stage of zone_count boxes"""
+    stage = Usd.Stage.CreateInMemory()
+    for zone in range(zone_count):
+        UsdGeom.Mesh.Define(stage, "/World/box_%d" % zone).CreateDisplayColorAttr(Vt.Vec3fArray([Gf.Vec3f(0.463, 0.725, 0.0)]))
+
+    LOGGER.info("Sensor ingestion benchmark, %d zones", zone_count)
+    native_rate = run_case(stage, zone_count, value_count, batch_size)
+
+    # Every reading is a zone write when a batch has no more readings than there are zones,
+    # that's the rate the target is measured against
+    if batch_size > zone_count:
+        native_rate = run_case(stage, zone_count, value_count, zone_count)
+    LOGGER.info("Target of %d values/s with one write per reading %s", TARGET_VALUES_PER_SECOND,
+                "met" if native_rate >= TARGET_VALUES_PER_SECOND else "missed")
+
+
+def run_live(path, value_count, batch_size):
+    """Ingest readings into the live SimpleSensorExample stage, saving after each batch"""
+    import omni.client
+
+    if not omni.client.initialize():
+        sys.exit("[ERROR] Unable to initialize Omniverse client, exiting.")
+    omni.client.usd_live_set_default_enabled(True)
+
+    stageUrl = path + "/SimpleSensorExample.usd"
+    stage = Usd.Stage.Open(stageUrl)
+    if not stage:
+        sys.exit("[ERROR] Unable to open stage " + stageUrl)
+
+    world = stage.GetPrimAtPath("/World")
+    zone_count = len([child for child in world.GetChildren() if child.GetName().startswith("box_")]) if world else 0
+    if zone_count == 0:
+        sys.exit("[ERROR] No zones in %s, create them with omniSimpleSensor" % stageUrl)
+
+    LOGGER.info("Ingesting %d readings into %d zones of %s", value_count, zone_count, stageUrl)
+    seconds, writer = ingest(stage, make_batches(zone_count, batch_size), value_count, True)
+    log_rate("live", writer.values, writer.zone_writes, seconds)
+
+    omni.client.usd_live_wait_for_pending_updates()
+    stage = None
+    omni.client.shutdown()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Python Omniverse Sensor Ingestion Sample",
+                                     formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+    parser.add_argument("-p", "--path", action="store", default="omniverse://localhost/Users/test",
+                        help="Folder of the SimpleSensorExample.usd stage")
+    parser.add_argument("-b", "--benchmark", action="store_true", default=False,
+                        help="Use an in memory stage and compare with the per value Python path")
+    parser.add_argument("-z", "--zones", action="store", type=int, default=1000, help="Zones of the benchmark stage")
+    parser.add_argument("-n", "--values", action="store", type=int, default=10000000, help="Readings to ingest")
+    parser.add_argument("-s", "--batch", action="store", type=int, default=100000, help="Readings per batch")
+
+    args = parser.parse_args()
+
+    if not sensor_ingest:
+        sys.exit("[ERROR] The sensor_ingest module is not built, build the C++ samples first.")
+
+    if args.benchmark:
+        run_benchmark(args.zones, args.values, args.batch)
+    else:
+        run_live(args.path, args.values, args.batch)
@@ -23,6 +23,7 @@
 #
 ###############################################################################
 
+import array
 import logging
 from typing import Union, Optional, List, Tuple
 
@@ -30,6 +31,12 @@ from pxr import Gf, Sdf, Tf, Usd, UsdGeom
 
 import log
 
+# Native batch transforms, built with the C++ samples (source/xformBatch)
+try:
+    import xform_batch
+except ImportError:
+    xform_batch = None
+
 
 LOGGER = log.get_logger("PyHelloWorld", level=logging.INFO)
 
@@ -435,4 +442,98 @@ def get_srt_xform_from_prim(
     if scale is None:
         scale = default_scale
 
-    return translate, rot_xyz, scale
\ No newline at end of file
+    return translate, rot_xyz, scale
+
+
+def _vec3_rows(values):
+    """Flat float64 view of a buffer of 3 values per prim, or None"""
+    if values is None:
+        return None
+    return memoryview(values).cast("B").cast("d")
+
+
+class BatchTransformPrimSRT:
+    """Transform many prims at once.
+
+    Values are buffers of float64 with 3 values per prim, in prim_paths order:
+    numpy arrays of shape (N, 3), array.array('d') of length 3 * N, memoryviews...
+    Rotations are the euler angles about X, Y and Z in degrees like TransformPrimSRT's
+    rotation_euler, applied in rotation_order.
+
+    The native xform_batch module writes the translate, rotate and scale ops of all
+    of the prims in one Sdf.ChangeBlock. Prims it can't write (matrix or pivot xform
+    ops, time samples...) and every prim when the module isn't built fall back to
+    TransformPrimSRT one prim at a time.
+
+    Args:
+        stage (Usd.Stage): Stage of the prims.
+        prim_paths (List[str]): Prim paths.
+        rotation_order (Gf.Vec3i): Rotation order (e.g. (0, 1, 2) means XYZ). None means XYZ.
+    """
+
+    def __init__(self,
+            stage: Usd.Stage,
+            prim_paths: List[str],
+            rotation_order: Optional[Gf.Vec3i] = Gf.Vec3i(0, 1, 2),
+        ):
+        self._stage = stage
+        self._prim_paths = [str(prim_path) for prim_path in prim_paths]
+        if rotation_order is None:
+            rotation_order = Gf.Vec3i(0, 1, 2)
+        self._rotation_order = rotation_order
+        self._batch = None
+        self._fallback = list(range(len(self._prim_paths)))
+
+        if xform_batch:
+            self._batch = xform_batch.XformBatch(stage, self._prim_paths, tuple(rotation_order))
+            rejected = dict(self._batch.rejected())
+            for prim_path, reason in rejected.items():
+                LOGGER.debug("%s %s, using TransformPrimSRT", prim_path, reason)
+            self._fallback = [i for i, prim_path in enumerate(self._prim_paths) if prim_path in rejected]
+
+    def __len__(self):
+        return len(self._prim_paths)
+
+    @property
+    def native(self) -> bool:
+        """True when the native module is used"""
+        return self._batch is not None
+
+    def do(self, translations=None, rotations_euler=None, scales=None):
+        """Set the transforms, a None buffer leaves that part of every transform unchanged"""
+        if self._batch:
+            self._batch.set_srt(translations, rotations_euler, scales)
+        if not self._fallback:
+            return
+
+        translations, rotations_euler, scales = [_vec3_rows(values) for values in (translations, rotations_euler, scales)]
+        for i in self._fallback:
+            prim = self._stage.GetPrimAtPath(self._prim_paths[i])
+            translate, rot_xyz, scale = get_srt_xform_from_prim(prim)
+            TransformPrimSRT(
+                self._stage,
+                self._prim_paths[i],
+                translation=Gf.Vec3d(*translations[3 * i:3 * i + 3]) if translations is not None else translate,
+                rotation_euler=Gf.Vec3d(*rotations_euler[3 * i:3 * i + 3]) if rotations_euler is not None else rot_xyz,
+                rotation_order=self._rotation_order,
+                scale=Gf.Vec3d(*scales[3 * i:3 * i + 3]) if scales is not None else scale,
+            ).do()
+
+    def get(self) -> Tuple[array.array, array.array, array.array]:
+        """Decompose the local transforms into translate, rotation euler and scale buffers.
+
+        The native module decomposes the full local transform, so unlike
+        get_srt_xform_from_prim the rotation order is honored and matrix ops keep their scale.
+        """
+        count = 3 * len(self._prim_paths)
+        translations, rotations_euler, scales = [array.array("d", bytes(8 * count)) for _ in range(3)]
+        if self._batch:
+            self._batch.get_srt(translations, rotations_euler, scales)
+            return translations, rotations_euler, scales
+
+        for i, prim_path in enumerate(self._prim_paths):
+            translate, rot_xyz, scale = get_srt_xform_from_prim(self._stage.GetPrimAtPath(prim_path))
+            translations[3 * i:3 * i + 3] = array.array("d", translate)
+            rotations_euler[3 * i:3 * i + 3] = array.array("d", rot_xyz)
+            scales[3 * i:3 * i + 3] = array.array("d", scale)
+        return translations, rotations_euler, scales
@@ -0,0 +1,193 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// sensor_ingest, a Python extension module that feeds batches of sensor
+// readings into the SimpleSensorExample stage through the same
+// SensorZoneWriter path omniSensorThread uses.
+//
+// Readings are handed over as one contiguous buffer of 8 byte (zone, value)
+// records through the buffer protocol, read in place without a Python object
+// per reading, and applied with the GIL released:
+//
+//	records = numpy.zeros(n, dtype=[("zone", "<i4"), ("value", "<f4")])
+//	writer = sensor_ingest.ZoneWriter(stage)
+//	writer.apply(records)
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <boost/python.hpp>
+#include "SensorZoneWriter.h"
+#include "pxr/base/tf/pyLock.h"
+#include "pxr/usd/usd/stage.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace bp = boost::python;
+
+// True for the buffer formats of an int32 followed by a float32: "if" with an
+// optional byte order ("<if", "=if"), or a struct like numpy's "T{<i:zone:<f:value:}"
+static bool isSensorRecordFormat(const char* format)
+{
+	std::string types;
+	for (const char* c = format; *c; c++)
+	{
+		if (*c == ':')
+		{
+			// Skip a field name
+			c = std::strchr(c + 1, ':');
+			if (!c)
+			{
+				return false;
+			}
+		}
+		else if (*c == '>' || *c == '!')
+		{
+			return false;
+		}
+		else if (!std::strchr("T{}@=<", *c))
+		{
+			types += *c;
+		}
+	}
+	return types == "if";
+}
+
+// The readings of a buffer of SensorRecords, bytes-like objects are taken as
+// packed records too.  Raises ValueError (std::invalid_argument) otherwise.
+class SensorRecordBuffer
+{
+public:
+	explicit SensorRecordBuffer(const bp::object& object)
+	{
+		if (PyObject_GetBuffer(object.ptr(), &mView, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+		{
+			bp::throw_error_already_set();
+		}
+
+		const char* format = mView.format ? mView.format : "B";
+		const bool bytes = mView.itemsize == 1 && format[0] && std::strchr("Bbc", format[0]) && format[1] == '\0';
+		std::string error;
+		if (!bytes && (mView.itemsize != sizeof(SensorRecord) || !isSensorRecordFormat(format)))
+		{
+			error = "records must be (int32 zone, float32 value) pairs, got format '" + std::string(format) + "'";
+		}
+		else if (size_t(mView.len) % sizeof(SensorRecord) != 0)
+		{
+			error = "records must be a whole number of 8 byte (zone, value) pairs, got " + std::to_string(mView.len) + " bytes";
+		}
+		if (!error.empty())
+		{
+			PyBuffer_Release(&mView);
+			throw std::invalid_argument(error);
+		}
+	}
+
+	~SensorRecordBuffer()
+	{
+		PyBuffer_Release(&mView);
+	}
+
+	SensorRecordBuffer(const SensorRecordBuffer&) = delete;
+	SensorRecordBuffer& operator=(const SensorRecordBuffer&) = delete;
+
+	const SensorRecord* data() const
+	{
+		return static_cast<const SensorRecord*>(mView.buf);
+	}
+
+	size_t size() const
+	{
+		return size_t(mView.len) / sizeof(SensorRecord);
+	}
+
+private:
+	Py_buffer mView;
+};
+
+class ZoneWriter
+{
+public:
+	explicit ZoneWriter(const UsdStagePtr& stage)
+		: mStage(stage)
+	{
+		if (!mStage)
+		{
+			throw std::invalid_argument("stage is invalid");
+		}
+		mWriter.reset(new SensorZoneWriter(mStage));
+	}
+
+	// Apply a batch of readings and optionally save the stage (sending the
+	// changes of a live layer), returns the number of zones written
+	size_t apply(const bp::object& records, bool save)
+	{
+		SensorRecordBuffer buffer(records);
+
+		TF_PY_ALLOW_THREADS_IN_SCOPE();
+		const size_t written = mWriter->apply(buffer.data(), buffer.size());
+		if (save)
+		{
+			mStage->Save();
+		}
+		return written;
+	}
+
+	size_t values() const
+	{
+		return mWriter->stats().values;
+	}
+
+	size_t zoneWrites() const
+	{
+		return mWriter->stats().zoneWrites;
+	}
+
+	size_t unknownValues() const
+	{
+		return mWriter->stats().unknownValues;
+	}
+
+private:
+	UsdStageRefPtr mStage;
+	std::unique_ptr<SensorZoneWriter> mWriter;
+};
+
+BOOST_PYTHON_MODULE(sensor_ingest)
+{
+	// The stage converters are registered by the pxr modules
+	bp::import("pxr.Usd");
+
+	bp::scope().attr("RECORD_SIZE") = sizeof(SensorRecord);
+
+	bp::class_<ZoneWriter, boost::noncopyable>("ZoneWriter",
+		"Apply (zone, value) sensor readings to the /World/box_<zone> displayColor of a SimpleSensorExample stage.\n"
+		"Only the last reading of each zone in a batch is written.",
+		bp::init<UsdStagePtr>((bp::arg("stage"))))
+		.def("apply", &ZoneWriter::apply, (bp::arg("records"), bp::arg("save") = false),
+			"Apply a buffer of (int32 zone, float32 value) records and return the number of zones written")
+		.add_property("values", &ZoneWriter::values, "Readings received")
+		.add_property("zone_writes", &ZoneWriter::zoneWrites, "Zone colors written")
+		.add_property("unknown_values", &ZoneWriter::unknownValues, "Readings dropped because their zone has no box");
+}
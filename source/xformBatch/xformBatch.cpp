@@ -0,0 +1,314 @@
+/*###############################################################################
+#
+# Copyright 2021 NVIDIA Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+###############################################################################*/
+
+// xform_batch, a Python extension module that applies and reads the transforms
+// of many prims at once for pyHelloWorld's xform_utils.py.
+//
+// Values are exchanged through the Python buffer protocol as float64 arrays
+// with 3 values per prim (numpy arrays, array.array('d'), memoryviews...), so
+// no Python object is created per prim or per value.  The work itself runs
+// with the GIL released.
+//
+//	batch = xform_batch.XformBatch(stage, primPaths, (0, 1, 2))
+//	batch.set_srt(translations, rotations, scales)
+//	batch.get_srt(translations, rotations, scales)
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/python.hpp>
+#include "BulkXformUpdate.h"
+#include "SrtDecompose.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/tf/pyLock.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/xformable.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace bp = boost::python;
+
+// A C contiguous float64 buffer holding count rows of width values, kAnyCount
+// accepts any number of rows.  Raises ValueError (std::invalid_argument) when
+// the object doesn't fit.
+class DoubleBuffer
+{
+public:
+	static constexpr size_t kAnyCount = size_t(-1);
+
+	DoubleBuffer(const bp::object& object, size_t count, size_t width, bool writable, const char* name)
+	{
+		const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+		if (PyObject_GetBuffer(object.ptr(), &mView, flags) != 0)
+		{
+			bp::throw_error_already_set();
+		}
+
+		const char* format = mView.format ? mView.format : "B";
+		if (*format == '@' || *format == '=' || *format == '<')
+		{
+			format++;
+		}
+		std::string error;
+		if (std::strcmp(format, "d") != 0 || mView.itemsize != sizeof(double))
+		{
+			error = std::string(name) + " must hold float64 values, got format '" + (mView.format ? mView.format : "B") + "'";
+		}
+		else if (count == kAnyCount ? size_t(mView.len) % (width * sizeof(double)) != 0 : size_t(mView.len) != count * width * sizeof(double))
+		{
+			error = std::string(name) + " must hold " + (count == kAnyCount ? std::string("N") : std::to_string(count)) +
+				" x " + std::to_string(width) + " values, got " + std::to_string(size_t(mView.len) / sizeof(double));
+		}
+		if (!error.empty())
+		{
+			PyBuffer_Release(&mView);
+			throw std::invalid_argument(error);
+		}
+	}
+
+	~DoubleBuffer()
+	{
+		PyBuffer_Release(&mView);
+	}
+
+	DoubleBuffer(const DoubleBuffer&) = delete;
+	DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+	double* data() const
+	{
+		return static_cast<double*>(mView.buf);
+	}
+
+	size_t size() const
+	{
+		return size_t(mView.len) / sizeof(double);
+	}
+
+private:
+	Py_buffer mView;
+};
+
+// A rotation order like Gf.Vec3i(0, 1, 2) or (2, 1, 0), None is XYZ
+static GfVec3i rotationOrderFromPython(const bp::object& object)
+{
+	if (object.is_none())
+	{
+		return GfVec3i(0, 1, 2);
+	}
+	if (bp::len(object) != 3)
+	{
+		throw std::invalid_argument("rotation_order must have 3 axes");
+	}
+	GfVec3i order(0, 1, 2);
+	for (int i = 0; i < 3; i++)
+	{
+		order[i] = bp::extract<int>(object[i]);
+	}
+	bool used[3] = { false, false, false };
+	for (int i = 0; i < 3; i++)
+	{
+		if (order[i] < 0 || order[i] > 2 || used[order[i]])
+		{
+			throw std::invalid_argument("rotation_order must be a permutation of (0, 1, 2)");
+		}
+		used[order[i]] = true;
+	}
+	return order;
+}
+
+class XformBatch
+{
+public:
+	XformBatch(const UsdStagePtr& stage, const bp::object& primPaths, const bp::object& rotationOrder)
+		: mStage(stage)
+		, mRotationOrder(rotationOrderFromPython(rotationOrder))
+		, mUpdater(mStage, mRotationOrder)
+	{
+		if (!mStage)
+		{
+			throw std::invalid_argument("stage is invalid");
+		}
+		const size_t count = size_t(bp::len(primPaths));
+		mPrims.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const SdfPath path = bp::extract<SdfPath>(primPaths[i]);
+			const UsdPrim prim = mStage->GetPrimAtPath(path);
+			if (!prim)
+			{
+				throw std::invalid_argument("Invalid prim path to transform: " + path.GetString());
+			}
+			mPrims.push_back(prim);
+		}
+
+		// Adding ops goes through Usd, the Python notice listeners take the GIL themselves
+		TF_PY_ALLOW_THREADS_IN_SCOPE();
+		mUpdater.prepare(mPrims);
+		mTargets.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			mTargets[i] = mUpdater.indexOf(mPrims[i].GetPath());
+		}
+		mValues.resize(mUpdater.size());
+	}
+
+	size_t size() const
+	{
+		return mPrims.size();
+	}
+
+	// Write the given channels of every prim that was not rejected, None leaves
+	// a channel unchanged.  All of the writes share one SdfChangeBlock.
+	void setSrt(const bp::object& translations, const bp::object& rotations, const bp::object& scales)
+	{
+		const size_t count = mPrims.size();
+		std::unique_ptr<DoubleBuffer> buffers[3];
+		const bp::object* objects[3] = { &translations, &rotations, &scales };
+		const char* names[3] = { "translations", "rotations", "scales" };
+		uint8_t channels = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			if (!objects[c]->is_none())
+			{
+				buffers[c].reset(new DoubleBuffer(*objects[c], count, 3, false, names[c]));
+				channels |= uint8_t(1 << c);
+			}
+		}
+
+		TF_PY_ALLOW_THREADS_IN_SCOPE();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (mTargets[i] == BulkXformUpdater::kRejected)
+			{
+				continue;
+			}
+			XformSrt& value = mValues[mTargets[i]];
+			if (buffers[0])
+			{
+				const double* t = buffers[0]->data() + 3 * i;
+				value.translate = GfVec3d(t[0], t[1], t[2]);
+			}
+			if (buffers[1])
+			{
+				const double* r = buffers[1]->data() + 3 * i;
+				value.rotateXYZ = GfVec3f(float(r[0]), float(r[1]), float(r[2]));
+			}
+			if (buffers[2])
+			{
+				const double* s = buffers[2]->data() + 3 * i;
+				value.scale = GfVec3f(float(s[0]), float(s[1]), float(s[2]));
+			}
+		}
+		mUpdater.write(mValues, channels);
+	}
+
+	// Read the local transform of every prim, rejected ones included, and
+	// decompose it into the output buffers.  Unlike extract_srt_xform_from_matrix4
+	// in xform_utils.py the scale is kept.  Prims are read in parallel.
+	void getSrt(const bp::object& translations, const bp::object& rotations, const bp::object& scales)
+	{
+		const size_t count = mPrims.size();
+		DoubleBuffer translate(translations, count, 3, true, "translations");
+		DoubleBuffer rotate(rotations, count, 3, true, "rotations");
+		DoubleBuffer scale(scales, count, 3, true, "scales");
+
+		TF_PY_ALLOW_THREADS_IN_SCOPE();
+		mMatrices.resize(count);
+		WorkParallelForN(count, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				bool resetsXformStack = false;
+				mMatrices[i].SetIdentity();
+				UsdGeomXformable(mPrims[i]).GetLocalTransformation(&mMatrices[i], &resetsXformStack);
+			}
+		});
+		if (count > 0)
+		{
+			decomposeSrt(mMatrices[0].data(), count, mRotationOrder, translate.data(), rotate.data(), scale.data());
+		}
+	}
+
+	// (path, reason) of the prims set_srt() skips
+	bp::list rejected() const
+	{
+		bp::list result;
+		for (const auto& rejected : mUpdater.rejected())
+		{
+			result.append(bp::make_tuple(rejected.first.GetString(), std::string(rejected.second)));
+		}
+		return result;
+	}
+
+private:
+	UsdStageRefPtr mStage;
+	GfVec3i mRotationOrder;
+	BulkXformUpdater mUpdater;
+	std::vector<UsdPrim> mPrims;
+	std::vector<size_t> mTargets;
+	std::vector<XformSrt> mValues;
+	std::vector<GfMatrix4d> mMatrices;
+};
+
+// Decompose row-major 4x4 float64 matrices (the layout of Gf.Matrix4d),
+// parallel=False keeps to the calling thread
+static void decomposeMatrices(const bp::object& matrices, const bp::object& translations, const bp::object& rotations,
+	const bp::object& scales, const bp::object& rotationOrder, bool parallel)
+{
+	const GfVec3i order = rotationOrderFromPython(rotationOrder);
+	DoubleBuffer matrix(matrices, DoubleBuffer::kAnyCount, 16, false, "matrices");
+	const size_t count = matrix.size() / 16;
+	DoubleBuffer translate(translations, count, 3, true, "translations");
+	DoubleBuffer rotate(rotations, count, 3, true, "rotations");
+	DoubleBuffer scale(scales, count, 3, true, "scales");
+
+	TF_PY_ALLOW_THREADS_IN_SCOPE();
+	decomposeSrt(matrix.data(), count, order, translate.data(), rotate.data(), scale.data(), parallel);
+}
+
+BOOST_PYTHON_MODULE(xform_batch)
+{
+	// The stage and path converters are registered by the pxr modules
+	bp::import("pxr.Usd");
+
+	bp::class_<XformBatch, boost::noncopyable>("XformBatch",
+		"Apply and read the SRT transforms of many prims with float64 buffers of 3 values per prim.\n"
+		"Rotations are the angles about X, Y and Z in degrees, applied in rotation_order.",
+		bp::init<UsdStagePtr, bp::object, bp::object>((bp::arg("stage"), bp::arg("prim_paths"), bp::arg("rotation_order") = bp::object())))
+		.def("__len__", &XformBatch::size)
+		.def("set_srt", &XformBatch::setSrt, (bp::arg("translations") = bp::object(), bp::arg("rotations") = bp::object(), bp::arg("scales") = bp::object()),
+			"Write translate, rotate and scale ops, None leaves a channel unchanged")
+		.def("get_srt", &XformBatch::getSrt, (bp::arg("translations"), bp::arg("rotations"), bp::arg("scales")),
+			"Decompose the local transforms into writable buffers")
+		.def("rejected", &XformBatch::rejected,
+			"(path, reason) of the prims whose xform ops set_srt() can't write, use TransformPrimSRT for those");
+
+	bp::def("decompose_matrices", &decomposeMatrices,
+		(bp::arg("matrices"), bp::arg("translations"), bp::arg("rotations"), bp::arg("scales"), bp::arg("rotation_order") = bp::object(),
+			bp::arg("parallel") = true),
+		"Decompose an (N, 4, 4) float64 buffer of matrices into translate, rotate and scale buffers");
+}